@@ -0,0 +1,11 @@
+#
+# SPDX-License-Identifier: Apache-2.0
+# Copyright (C) 2019 ifm electronic, gmbh
+#
+# Dependencies of the exported `ifm3d_ros2::ifm3d_ros2_conversions` target
+# that `ament_export_dependencies()` cannot express (components, CMake
+# modules).
+#
+find_package(ifm3d 1.1.1 CONFIG REQUIRED COMPONENTS framegrabber)
+find_package(JPEG REQUIRED)
+find_package(Threads REQUIRED)
@@ -0,0 +1,93 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_CAMERA_MODEL_HPP_
+#define IFM3D_ROS2_CAMERA_MODEL_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Intrinsic model ids of the O3R imagers (see the `TOF_INFO` / `RGB_INFO`
+ * buffers).
+ */
+constexpr std::uint32_t model_bouguet = 0;
+constexpr std::uint32_t model_fisheye = 2;
+
+/**
+ * Intrinsic model of an imager: `model_id` and its parameters, e.g.,
+ * `fx, fy, mx, my, alpha, k1 .. k5` for the Bouguet model.
+ */
+struct IntrinsicModel
+{
+  std::uint32_t model_id{};
+  std::array<float, 32> parameters{};
+
+  bool operator==(const IntrinsicModel& other) const
+  {
+    return this->model_id == other.model_id && this->parameters == other.parameters;
+  }
+};
+
+/**
+ * Calibration of an imager as reported by the device: the intrinsic model
+ * (optic frame to pixels), its inverse (pixels to rays) and the pose of the
+ * optic frame in the user frame.
+ */
+struct OpticCalibration
+{
+  IntrinsicModel intrinsics{};
+  IntrinsicModel inverse_intrinsics{};
+  std::array<float, 6> extrinsics{};  // trans_x, trans_y, trans_z (meters), rot_x, rot_y, rot_z (radians)
+
+  bool operator==(const OpticCalibration& other) const
+  {
+    return this->intrinsics == other.intrinsics && this->inverse_intrinsics == other.inverse_intrinsics &&
+           this->extrinsics == other.extrinsics;
+  }
+};
+
+/**
+ * Returns `true` if `model_id` is one of the models below.
+ */
+IFM3D_ROS2_PUBLIC
+bool is_supported_model(std::uint32_t model_id);
+
+/**
+ * Row-major rotation of the optic frame into the user frame,
+ * `R = Rx(rot_x) * Ry(rot_y) * Rz(rot_z)`.
+ */
+IFM3D_ROS2_PUBLIC
+std::array<float, 9> extrinsic_rotation(const std::array<float, 6>& extrinsics);
+
+/**
+ * Unit vectors (rays, interleaved x, y, z in the optic frame) through the
+ * centers of the `width * height` pixels, from the inverse intrinsic model.
+ * Returns `false` for unsupported models.
+ */
+IFM3D_ROS2_PUBLIC
+bool pixel_rays(const IntrinsicModel& inverse_intrinsics, std::uint32_t width, std::uint32_t height,
+                std::vector<float>& rays);
+
+/**
+ * Projects the `[begin, end)` points (SoA, optic frame) to pixel
+ * coordinates, i.e., column `u` and row `v` with pixel centers at integers.
+ * Points behind the imager get `u = v = -1`. Vectorized; `model` must be
+ * supported.
+ */
+IFM3D_ROS2_PUBLIC
+void project_points(const IntrinsicModel& model, const float* x, const float* y, const float* z, float* u, float* v,
+                    std::size_t begin, std::size_t end);
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_CAMERA_MODEL_HPP_
@@ -7,7 +7,10 @@
 #ifndef IFM3D_ROS2_CAMERA_NODE_HPP_
 #define IFM3D_ROS2_CAMERA_NODE_HPP_
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -17,18 +20,52 @@
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp_lifecycle/lifecycle_node.hpp>
 
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
 #include <rcl_interfaces/msg/set_parameters_result.hpp>
+#include <nav_msgs/msg/occupancy_grid.hpp>
+#include <nav_msgs/msg/odometry.hpp>
+#include <sensor_msgs/msg/camera_info.hpp>
 #include <sensor_msgs/msg/compressed_image.hpp>
 #include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/imu.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
-
+#include <tf2/buffer_core.h>
+#include <tf2_msgs/msg/tf_message.hpp>
+
+#include <ifm3d_ros2/change_detection.hpp>
+#include <ifm3d_ros2/confidence.hpp>
+#include <ifm3d_ros2/conversions.hpp>
+#include <ifm3d_ros2/governor.hpp>
+#include <ifm3d_ros2/ground_plane.hpp>
+#include <ifm3d_ros2/guided_filter.hpp>
+#include <ifm3d_ros2/height_grid.hpp>
+#include <ifm3d_ros2/metrics.hpp>
+#include <ifm3d_ros2/motion_compensation.hpp>
+#include <ifm3d_ros2/pixel_stats.hpp>
+#include <ifm3d_ros2/port_standby.hpp>
+#include <ifm3d_ros2/preview.hpp>
+#include <ifm3d_ros2/rectification.hpp>
+#include <ifm3d_ros2/rgb_registration.hpp>
+#include <ifm3d_ros2/sectors.hpp>
+#include <ifm3d_ros2/snapshot.hpp>
+#include <ifm3d_ros2/thread_accounting.hpp>
+#include <ifm3d_ros2/transition_worker.hpp>
+#include <ifm3d_ros2/topic_schedule.hpp>
 #include <ifm3d_ros2/visibility_control.h>
+#include <ifm3d_ros2/worker_pool.hpp>
 
+#include <ifm3d_ros2/msg/depth_tiles.hpp>
 #include <ifm3d_ros2/msg/extrinsics.hpp>
+#include <ifm3d_ros2/msg/ground_plane.hpp>
+#include <ifm3d_ros2/msg/height_map.hpp>
+#include <ifm3d_ros2/msg/resource_usage.hpp>
+#include <ifm3d_ros2/msg/sector_summary.hpp>
 #include <ifm3d_ros2/srv/dump.hpp>
 #include <ifm3d_ros2/srv/config.hpp>
 #include <ifm3d_ros2/srv/softon.hpp>
 #include <ifm3d_ros2/srv/softoff.hpp>
+#include <ifm3d_ros2/srv/power_state.hpp>
+#include <ifm3d_ros2/srv/stats.hpp>
 
 #include <ifm3d/device/device.h>
 #include <ifm3d/fg.h>
@@ -38,6 +75,9 @@ using TC_RETVAL = rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::Cal
 using ImageMsg = sensor_msgs::msg::Image;
 using ImagePublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<ImageMsg>>;
 
+using CameraInfoMsg = sensor_msgs::msg::CameraInfo;
+using CameraInfoPublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<CameraInfoMsg>>;
+
 using CompressedImageMsg = sensor_msgs::msg::CompressedImage;
 using CompressedImagePublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<CompressedImageMsg>>;
 
@@ -47,6 +87,33 @@ using PCLPublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<PCLMsg
 using ExtrinsicsMsg = ifm3d_ros2::msg::Extrinsics;
 using ExtrinsicsPublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<ExtrinsicsMsg>>;
 
+using DepthTilesMsg = ifm3d_ros2::msg::DepthTiles;
+using DepthTilesPublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<DepthTilesMsg>>;
+
+using ResourceUsageMsg = ifm3d_ros2::msg::ResourceUsage;
+using ResourceUsagePublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<ResourceUsageMsg>>;
+
+using SectorSummaryMsg = ifm3d_ros2::msg::SectorSummary;
+using SectorSummaryPublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<SectorSummaryMsg>>;
+
+using GroundPlaneMsg = ifm3d_ros2::msg::GroundPlane;
+using GroundPlanePublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<GroundPlaneMsg>>;
+
+using OccupancyGridMsg = nav_msgs::msg::OccupancyGrid;
+using OccupancyGridPublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<OccupancyGridMsg>>;
+
+using HeightMapMsg = ifm3d_ros2::msg::HeightMap;
+using HeightMapPublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<HeightMapMsg>>;
+
+using DiagnosticArrayMsg = diagnostic_msgs::msg::DiagnosticArray;
+using DiagnosticArrayPublisher = std::shared_ptr<rclcpp_lifecycle::LifecyclePublisher<DiagnosticArrayMsg>>;
+
+using TFMessage = tf2_msgs::msg::TFMessage;
+using TFSubscription = rclcpp::Subscription<TFMessage>::SharedPtr;
+
+using OdometryMsg = nav_msgs::msg::Odometry;
+using ImuMsg = sensor_msgs::msg::Imu;
+
 using DumpRequest = std::shared_ptr<ifm3d_ros2::srv::Dump::Request>;
 using DumpResponse = std::shared_ptr<ifm3d_ros2::srv::Dump::Response>;
 using DumpService = ifm3d_ros2::srv::Dump;
@@ -67,6 +134,16 @@ using SoftonResponse = std::shared_ptr<ifm3d_ros2::srv::Softon::Response>;
 using SoftonService = ifm3d_ros2::srv::Softon;
 using SoftonServer = rclcpp::Service<ifm3d_ros2::srv::Softon>::SharedPtr;
 
+using PowerStateRequest = std::shared_ptr<ifm3d_ros2::srv::PowerState::Request>;
+using PowerStateResponse = std::shared_ptr<ifm3d_ros2::srv::PowerState::Response>;
+using PowerStateService = ifm3d_ros2::srv::PowerState;
+using PowerStateServer = rclcpp::Service<ifm3d_ros2::srv::PowerState>::SharedPtr;
+
+using StatsRequest = std::shared_ptr<ifm3d_ros2::srv::Stats::Request>;
+using StatsResponse = std::shared_ptr<ifm3d_ros2::srv::Stats::Response>;
+using StatsService = ifm3d_ros2::srv::Stats;
+using StatsServer = rclcpp::Service<ifm3d_ros2::srv::Stats>::SharedPtr;
+
 /**
    * provide legacy schema masks and lookup to buffer ids
    * (until interfaces changes)
@@ -84,13 +161,14 @@ namespace ifm3d_legacy
 //  const std::uint16_t INTR_CAL = (1 << 8);        // 2**8
 //  const std::uint16_t INV_INTR_CAL = (1 << 9);    // 2**9
 //  const std::uint16_t JSON_MODEL = (1 << 10);     // 2**10
-//  const std::uint16_t IMG_DIS_NOISE = (1 << 11);  // 2**11
+  const std::uint16_t IMG_DIS_NOISE = (1 << 11);  // 2**11
 
   std::map<std::uint16_t, ifm3d::buffer_id> schema_mask_buffer_id_map{
     {IMG_RDIS, ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE},
     {IMG_AMP, ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE},
     {IMG_RAMP, ifm3d::buffer_id::AMPLITUDE_IMAGE},
-    {IMG_CART, ifm3d::buffer_id::XYZ}
+    {IMG_CART, ifm3d::buffer_id::XYZ},
+    {IMG_DIS_NOISE, ifm3d::buffer_id::RADIAL_DISTANCE_NOISE}
   };
 
   ifm3d::FrameGrabber::BufferList buffer_list_from_schema_mask(const std::uint16_t mask)
@@ -109,6 +187,72 @@ namespace ifm3d_legacy
 
 namespace ifm3d_ros2
 {
+/**
+ * Copy of the frame data the processing stages work on, taken by the publish
+ * loop. Only the parts some enabled stage needs are filled in.
+ */
+struct StageFrame
+{
+  std_msgs::msg::Header header{};  // of the optical frame
+  std::vector<float> xyz{};  // interleaved x, y, z
+  std_msgs::msg::Header xyz_header{};  // of `xyz`, in the frame of ~/cloud
+  std::vector<std::uint16_t> confidence{};  // along with `xyz` while stages exclude points by confidence
+  std::vector<float> distance{};  // radial distance, `width * height`
+  std::uint32_t width{};
+  std::uint32_t height{};
+  std::vector<std::uint8_t> jpeg{};  // RGB image
+  OpticCalibration calibration{};  // of the imager, set along with `distance` or `jpeg`
+};
+
+/**
+ * Encodings the `~/distance` topic can be published in.
+ */
+enum class DistanceOutput
+{
+  NATIVE,  // as delivered by the camera (typically 32FC1 meters)
+  MM16,    // 16UC1 millimeters, 0 == invalid
+};
+
+/**
+ * Encodings the `~/cloud` topic can be published in.
+ */
+enum class CloudEncoding
+{
+  FLOAT32,   // FLOAT32 x, y, z in meters
+  INT16_MM,  // INT16 x, y, z in millimeters, see `cloud_int16_scale`
+};
+
+/**
+ * Suppression of the ToF streams of frames showing an unchanged scene.
+ */
+enum class ChangeDetection
+{
+  OFF,
+  SKIP,   // publish all streams of changed frames and keyframes, nothing otherwise
+  TILES,  // publish the changed tiles on `~/distance_tiles`, all streams only on keyframes
+};
+
+/**
+ * Parameters the publish loop applies from the next frame on, without a
+ * reconfiguration. Changed on the executor, read through a `SnapshotCell`.
+ */
+struct LiveParams
+{
+  int timeout_millis{};
+  float timeout_tolerance_secs{};
+  float frame_latency_thresh{};  // seconds
+};
+
+/**
+ * How the frame rate governor lowers the rate of a head.
+ */
+enum class GovernorMode
+{
+  OFF,
+  DECIMATE,   // the publish loop skips frames
+  FRAMERATE,  // the framerate of the port is lowered
+};
+
 /**
  * Managed node that implements an ifm3d camera driver for ROS 2 software
  * systems.
@@ -223,15 +367,27 @@ protected:
   void Config(std::shared_ptr<rmw_request_id_t> request_header, ConfigRequest req, ConfigResponse resp);
 
   /**
-   * Implementation of the SoftOff service.
+   * Implementation of the SoftOff service: also puts the node into standby.
    */
   void Softoff(std::shared_ptr<rmw_request_id_t> request_header, SoftoffRequest req, SoftoffResponse resp);
 
   /**
-   * Implementation of the SoftOn service.
+   * Implementation of the SoftOn service: also ends the standby.
    */
   void Softon(std::shared_ptr<rmw_request_id_t> request_header, SoftonRequest req, SoftonResponse resp);
 
+  /**
+   * Implementation of the PowerState service: switches a batch of ports in
+   * one configuration update, through `power_cam_` rather than `cam_`.
+   */
+  void PowerState(std::shared_ptr<rmw_request_id_t> request_header, PowerStateRequest req, PowerStateResponse resp);
+
+  /**
+   * Implementation of the Stats service: hands the request to the publish
+   * loop, which accumulates the statistics.
+   */
+  void Stats(std::shared_ptr<rmw_request_id_t> request_header, StatsRequest req, StatsResponse resp);
+
   /**
    * Callback that gets called when a parameter(s) is attempted to be set
    *
@@ -250,6 +406,12 @@ protected:
    */
   void init_params();
 
+  /**
+   * Reads a `[min, max]` double array parameter, falling back to `[0, 1]`
+   * (with a warning) if it is malformed.
+   */
+  std::array<float, 2> get_range_parameter(const std::string& name);
+
   /**
    * Thread function that publishes data to clients
    */
@@ -261,6 +423,128 @@ protected:
    */
   void stop_publish_loop();
 
+  /**
+   * Runs a lifecycle transition the node requested of itself, on
+   * `transition_worker_`. Only transitions from the states the request
+   * applies to, e.g., a deactivation that another one got ahead of is a
+   * no-op. Returns whether the node ended up where the request leads.
+   */
+  bool run_transition(TransitionRequest request);
+
+  /**
+   * Enters (or leaves) the standby, in which the port is idle on purpose: the
+   * publish loop neither waits for frames nor counts timeouts, and it wakes
+   * up right away when the standby ends.
+   */
+  void set_standby(bool standby);
+
+  /**
+   * Stops following the standby of this head's port as switched by the
+   * `PowerState` service of any head (see `port_standby_`).
+   */
+  void unlisten_port_standby();
+
+  /**
+   * Stops the processing stages: waits for the running job, drops the queued
+   * one and leaves the shared grid.
+   */
+  void stop_stages();
+
+  /**
+   * Empties the cells this head contributes to the shared grid, while it
+   * streams no frames (standby, timeouts). Called by the publish loop.
+   */
+  void clear_grid_contribution();
+
+  /**
+   * Smooths the distance image `dist` in place, guided by `amp`, and moves
+   * the points of `xyz` (if set) to the smoothed distances. Runs on the
+   * publish loop, before any ToF output is converted.
+   */
+  void filter_distance(ifm3d::Buffer& dist, ifm3d::Buffer& amp, ifm3d::Buffer* xyz);
+
+  /**
+   * Publishes the results of `pixel_stats_` on `~/stats/*`.
+   */
+  void publish_stats(const std_msgs::msg::Header& header);
+
+  /**
+   * Publishes the subscribed `~/confidence/*` masks of `conf`.
+   */
+  void publish_confidence_masks(const ifm3d::Buffer& conf, const std_msgs::msg::Header& header);
+
+  /**
+   * Runs the enabled processing stages on `frame`, after invalidating the
+   * points excluded by confidence. Runs on `stage_worker_`.
+   */
+  void process_stages(StageFrame& frame);
+
+  /**
+   * Estimates the ground plane of `xyz`, publishes it and the cloud split
+   * into ground and obstacles.
+   */
+  void remove_ground(const std::vector<float>& xyz, const std_msgs::msg::Header& header);
+
+  /**
+   * Bins `xyz` into the height grid of this head, publishes the (shared)
+   * grid when due.
+   */
+  void update_grid(const std::vector<float>& xyz, const std_msgs::msg::Header& header);
+
+  /**
+   * Samples the latest RGB frame of `color_exchange_` at the pixels of
+   * `frame`, publishes the result as `~/rgb_registered`.
+   */
+  void register_rgb(const StageFrame& frame);
+
+  /**
+   * Undistorts the RGB image of `frame`, publishes it as `~/rgb_rect`.
+   */
+  void rectify_rgb(const StageFrame& frame);
+
+  /**
+   * Timer callback that samples and publishes the resource usage of the
+   * process.
+   */
+  void publish_resource_usage();
+
+  /**
+   * Connects `power_cam_` if not yet connected, returns an empty string on
+   * success and the error otherwise. Requires `power_mutex_`.
+   */
+  std::string connect_power_cam();
+
+  /**
+   * Sets the framerate of the port to `factor` times its nominal framerate
+   * (read on the first call), through `power_cam_`. Blocks on the device, run
+   * on `governor_worker_` while active.
+   */
+  bool apply_rate_factor(double factor);
+
+  /**
+   * Timer callback of the frame rate governor: feeds it the figures of the
+   * last period, applies its decision and publishes it on `/diagnostics`.
+   */
+  void govern();
+
+  /**
+   * `/tf_static` callback: adds the transforms to `tf_buffer_` and looks up
+   * the transform of the clouds into `cloud_target_frame_` again.
+   */
+  void on_tf_static(const TFMessage& msg);
+
+  /**
+   * The cached transform from the optical frame into `cloud_target_frame_`,
+   * `nullptr` while it is not known (or not wanted).
+   */
+  std::shared_ptr<const PointTransform> cloud_transform() const;
+
+  /**
+   * Odometry / IMU callback: appends a twist to `twist_ring_`, dropping
+   * samples older than the last one.
+   */
+  void on_twist(const builtin_interfaces::msg::Time& stamp, const TwistSample& twist);
+
 private:
   rclcpp::Logger logger_;
   // global mutex on ifm3d core data structures `cam_`, `fg_`, `im_`
@@ -270,31 +554,188 @@ private:
   std::uint16_t xmlrpc_port_{};
   std::string password_{};
   std::uint16_t schema_mask_{};
-  int timeout_millis_{};
-  float timeout_tolerance_secs_{};
-  float frame_latency_thresh_{};  // seconds
+  SnapshotCell<LiveParams> live_params_{};  // the publish loop pins it once per frame
   bool sync_clocks_{};
   std::uint16_t pcic_port_{};
+  std::string metrics_bind_address_{};
+  std::uint16_t metrics_port_{};
+  float resource_usage_period_secs_{};
+  GovernorMode governor_mode_{ GovernorMode::OFF };
+  float governor_period_secs_{};
+  DistanceOutput distance_output_{ DistanceOutput::NATIVE };
+  CloudEncoding cloud_encoding_{ CloudEncoding::FLOAT32 };
+  bool cloud_intensity_{};
+  float cloud_intensity_max_{};
+  bool cloud_sigma_{};
+  float cloud_noise_threshold_{};  // meters, 0 == off
+  std::string cloud_target_frame_{};  // empty == optical frame
+  std::string deskew_topic_{};        // empty == off
+  bool deskew_imu_{};                 // IMU rather than odometry messages
+  float deskew_max_hold_secs_{};
+  bool distance_filter_{};
+  float preview_rate_hz_{};
+  std::array<float, 2> preview_distance_range_{};
+  std::array<float, 2> preview_amplitude_range_{};
+  ChangeDetection change_detection_{ ChangeDetection::OFF };
+  float change_keyframe_interval_secs_{};
+  ConfidenceBits confidence_bits_{};
+  std::uint16_t stage_confidence_exclude_{};  // confidence bits of the points the stages ignore
+  bool ground_removal_{};
+  bool height_grid_{};
+  std::string grid_name_{};
+  std::string grid_frame_{};
+  GridParams grid_params_{};
+  int grid_min_points_{};
+  float grid_rate_hz_{};
+  std::string rgb_registration_{};
+  float rgb_registration_max_age_{};  // seconds
+  bool rgb_rectify_{};
+  int worker_threads_{};
+  bool configured_once_{};
+
+  std::shared_ptr<HeadMetrics> metrics_{};
 
   DumpServer dump_srv_{};
   ConfigServer config_srv_{};
   SoftoffServer soft_off_srv_{};
   SoftonServer soft_on_srv_{};
+  PowerStateServer power_state_srv_{};
+  StatsServer stats_srv_{};
 
   ifm3d::Device::Ptr cam_{};
   ifm3d::FrameGrabber::Ptr fg_{};
 
+  // connection of the PowerState service and the governor, created on first
+  // use so that configuration updates neither wait for `gil_` nor hold it
+  std::mutex power_mutex_{};
+  ifm3d::Device::Ptr power_cam_{};
+
   ImagePublisher conf_pub_{};
+  std::array<ImagePublisher, num_confidence_masks> conf_mask_pubs_{};  // by `ConfidenceMask`
   ImagePublisher distance_pub_{};
+  ImagePublisher distance_noise_pub_{};
   ImagePublisher amplitude_pub_{};
   ImagePublisher raw_amplitude_pub_{};
   PCLPublisher cloud_pub_{};
   ExtrinsicsPublisher extrinsics_pub_{};
   CompressedImagePublisher rgb_pub_{};
+  CompressedImagePublisher distance_preview_pub_{};
+  CompressedImagePublisher amplitude_preview_pub_{};
+  DepthTilesPublisher distance_tiles_pub_{};
+  SectorSummaryPublisher sectors_pub_{};
+  PCLPublisher cloud_ground_pub_{};
+  PCLPublisher cloud_obstacles_pub_{};
+  GroundPlanePublisher ground_plane_pub_{};
+  OccupancyGridPublisher grid_pub_{};  // created on configure, the topic depends on `grid_name`
+  HeightMapPublisher grid_height_pub_{};
+  ImagePublisher rgb_registered_pub_{};
+  ImagePublisher rgb_rect_pub_{};
+  CameraInfoPublisher rgb_rect_info_pub_{};
+  ImagePublisher stats_mean_pub_{};
+  ImagePublisher stats_stddev_pub_{};
+  ImagePublisher stats_valid_ratio_pub_{};
+  ResourceUsagePublisher resource_usage_pub_{};
+  DiagnosticArrayPublisher diagnostics_pub_{};
+
+  // per-stream converters, only touched by the publish loop
+  ImageConverter distance_conv_{};
+  ImageConverter distance_noise_conv_{};
+  ImageConverter conf_conv_{};
+  ImageConverter amplitude_conv_{};
+  ImageConverter raw_amplitude_conv_{};
+  QuantizedCloudConverter cloud_int16_conv_{};
+  PreviewRenderer distance_preview_{};
+  PreviewRenderer amplitude_preview_{};
+  ChangeDetector change_detector_{};
+  SectorReducer sector_reducer_{};
+  TopicScheduler topic_scheduler_{};
+
+  // processing stages, run on `stage_worker_` off the publish loop
+  GroundPlaneEstimator ground_estimator_{};
+  std::vector<float> ground_points_{};
+  std::vector<float> obstacle_points_{};
+  HeightGrid grid_{};
+  std::shared_ptr<SharedGrid> shared_grid_{};
+  std::size_t grid_contributor_{};
+  std::vector<GridCell> grid_cells_{};
+  std::shared_ptr<ColorFrameExchange> color_exchange_{};
+  RgbRegistration rgb_registration_lut_{};
+  RgbImage color_image_{};  // decoded RGB frame `color_sequence_`
+  std::uint64_t color_sequence_{};
+  RgbImage rect_source_{};
+  std::shared_ptr<RemapTable> rect_table_{};  // kept across reconnects, rebuilt if the calibration changes
+  std::unique_ptr<WorkerPool> worker_pool_{};
+  std::unique_ptr<LatestJobWorker> stage_worker_{};
+
+  // spatial filter, run on the publish loop with a pool of its own
+  GuidedFilter guided_filter_{};
+  std::vector<float> filtered_distance_{};
+  std::unique_ptr<WorkerPool> filter_pool_{};
+
+  // temporal statistics: the Stats service hands the number of frames to the
+  // publish loop, which owns `pixel_stats_`
+  PixelStats pixel_stats_{};
+  std::atomic<std::uint32_t> stats_request_{};
+  std::atomic_bool stats_running_{};
+
+  rclcpp::TimerBase::SharedPtr resource_usage_timer_{};
+  ResourceSampler resource_sampler_{};
+
+  // frame rate governor: decides on its timer, sets the framerate on
+  // `governor_worker_` (falling back to decimation through
+  // `governor_rate_failed_` until the next activation), the publish loop
+  // keeps one frame in `governor_decimation_` while decimating and adds up
+  // its busy time in `loop_busy_nanos_`
+  struct GovernorTotals
+  {
+    std::chrono::steady_clock::time_point time{};
+    std::uint64_t publishes{};
+    double publish_secs{};
+    std::int64_t loop_busy_nanos{};
+  };
+  FrameRateGovernor governor_{};
+  rclcpp::TimerBase::SharedPtr governor_timer_{};
+  std::unique_ptr<LatestJobWorker> governor_worker_{};
+  std::atomic_bool governor_rate_failed_{};
+  bool governor_decimate_{};  // decimating, as configured or fallen back to
+  HostCpuSampler host_cpu_sampler_{};
+  GovernorTotals governor_last_{};
+  std::atomic<std::uint32_t> governor_decimation_{ 1 };
+  std::atomic<std::int64_t> loop_busy_nanos_{};
+  double nominal_framerate_{};  // Hz, read in `on_configure()`, 0 until read from the device
+
+  // static transforms, only fed from `/tf_static`, for `cloud_target_frame_`
+  std::unique_ptr<tf2::BufferCore> tf_buffer_{};
+  TFSubscription tf_static_sub_{};
+  mutable std::mutex cloud_transform_mutex_{};
+  std::shared_ptr<const PointTransform> cloud_transform_{};
+
+  // motion compensation: the twist subscription writes `twist_ring_`, the
+  // publish loop reads it into `twist_scratch_`
+  rclcpp::SubscriptionBase::SharedPtr twist_sub_{};
+  std::int64_t last_twist_nanos_{};
+  TwistRing twist_ring_{};
+  std::vector<TwistSample> twist_scratch_{};
+  std::vector<float> cloud_points_{};  // the points in the frame of ~/cloud, for the sectors and the stages
 
   std::thread pub_loop_{};
   std::atomic_bool test_destroy_{};
 
+  // lifecycle transitions requested by the node itself (after a fault in the
+  // publish loop, after a parameter change), run one at a time off the
+  // threads requesting them
+  std::unique_ptr<TransitionWorker> transition_worker_{};
+
+  // standby after Softoff, the publish loop sleeps on `standby_cv_` rather
+  // than waiting for frames under `gil_`
+  std::atomic_bool standby_{};
+  std::mutex standby_mutex_{};
+  std::condition_variable standby_cv_{};
+  // switch of this head's port shared by the heads of the process, listened
+  // to while ACTIVE
+  std::shared_ptr<PortStandby> port_standby_{};
+  std::size_t port_standby_listener_{};
+
   std::string camera_frame_{};
   std::string optical_frame_{};
 
@@ -0,0 +1,117 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_CHANGE_DETECTION_HPP_
+#define IFM3D_ROS2_CHANGE_DETECTION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Flags the pixels of `cur` that differ from `ref` by more than the noise of
+ * a ToF distance measurement, i.e., `|cur - ref| > abs + rel * ref`. A pixel
+ * turning valid or invalid (distance <= 0 or NaN) also counts as a change.
+ * Writes 1 (changed) or 0 into `changed`.
+ */
+IFM3D_ROS2_PUBLIC
+void flag_changed_pixels(const float* cur, const float* ref, std::uint8_t* changed, std::size_t n, float abs,
+                         float rel);
+
+/**
+ * Detects which tiles of a distance image changed since the last published
+ * one.
+ *
+ * `compare()` flags the changed tiles of a new frame against the reference,
+ * `commit()` then updates the reference with what was actually published.
+ * Comparing each tile against its last published content (rather than the
+ * previous frame) keeps slow drifts from going unnoticed.
+ */
+class IFM3D_ROS2_PUBLIC ChangeDetector
+{
+public:
+  struct Params
+  {
+    std::uint32_t tile_size{ 16 };
+    float threshold_abs{ 0.02F };  // meters
+    float threshold_rel{ 0.01F };  // fraction of the distance
+    float min_fraction{ 0.02F };   // fraction of changed pixels making a tile "changed"
+  };
+
+  struct Result
+  {
+    bool keyframe{};  // all tiles flagged, regardless of their content
+    std::size_t tiles_changed{};
+  };
+
+  void configure(const Params& params);
+
+  /**
+   * Drops the reference, making the next frame a keyframe.
+   */
+  void reset();
+
+  /**
+   * Flags the tiles of `distance` (`width` x `height` meters) that changed.
+   * Without a reference (or on a size change) or if `force_keyframe` is set,
+   * the frame is a keyframe and all tiles are flagged.
+   */
+  Result compare(const float* distance, std::uint32_t width, std::uint32_t height, bool force_keyframe);
+
+  /**
+   * Updates the reference from `distance` (the frame of the last `compare()`)
+   * for the flagged tiles, or for all of them if `all_tiles` is set.
+   */
+  void commit(const float* distance, bool all_tiles);
+
+  /**
+   * Appends the pixels of the flagged tiles of `distance`, tile after tile,
+   * each row-major and clipped to the image.
+   */
+  void append_changed_tiles(const float* distance, std::vector<float>& out) const;
+
+  /**
+   * One entry per tile (row-major), 1 if it was flagged by `compare()`.
+   */
+  const std::vector<std::uint8_t>& tile_map() const
+  {
+    return this->tile_map_;
+  }
+
+  std::uint32_t tile_size() const
+  {
+    return this->params_.tile_size;
+  }
+
+  std::uint32_t tiles_x() const
+  {
+    return this->tiles_x_;
+  }
+
+  std::uint32_t tiles_y() const
+  {
+    return this->tiles_y_;
+  }
+
+private:
+  Params params_{};
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+  std::uint32_t tiles_x_{};
+  std::uint32_t tiles_y_{};
+  std::vector<float> reference_{};
+  std::vector<std::uint8_t> changed_{};  // per pixel scratch
+  std::vector<std::uint32_t> counts_{};  // changed pixels per tile
+  std::vector<std::uint8_t> tile_map_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_CHANGE_DETECTION_HPP_
@@ -0,0 +1,80 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_CONFIDENCE_HPP_
+#define IFM3D_ROS2_CONFIDENCE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Masks decoded from the confidence image. `VALID` is set where none of the
+ * invalid bits are, the others where any of their bits are.
+ */
+enum class ConfidenceMask : std::size_t
+{
+  VALID = 0,
+  SATURATED,
+  LOW_AMPLITUDE,
+  OUT_OF_RANGE,
+};
+
+constexpr std::size_t num_confidence_masks = 4;
+
+/**
+ * Name of a mask, as in its topic (`~/confidence/<name>`).
+ */
+IFM3D_ROS2_PUBLIC
+const char* confidence_mask_name(ConfidenceMask mask);
+
+/**
+ * Parses a mask name, `false` if there is none of that name.
+ */
+IFM3D_ROS2_PUBLIC
+bool parse_confidence_mask(const std::string& name, ConfidenceMask& out);
+
+/**
+ * Bits of the confidence image tested per mask (any of them), indexed by
+ * `ConfidenceMask`. For `VALID`, these are the bits flagging invalid pixels.
+ */
+using ConfidenceBits = std::array<std::uint16_t, num_confidence_masks>;
+
+/**
+ * Decodes `n` confidence pixels into mono8 masks (255 where set, 0
+ * elsewhere), in one pass: `out[mask]` receives `n` bytes, masks with a
+ * `nullptr` output are skipped. Bits wider than the pixels (above 0xFF for
+ * 8 bit images) never match, see `confidence_bits_fit()`.
+ */
+IFM3D_ROS2_PUBLIC
+void decode_confidence(const std::uint16_t* conf, std::size_t n, const ConfidenceBits& bits,
+                       const std::array<std::uint8_t*, num_confidence_masks>& out);
+
+IFM3D_ROS2_PUBLIC
+void decode_confidence(const std::uint8_t* conf, std::size_t n, const ConfidenceBits& bits,
+                       const std::array<std::uint8_t*, num_confidence_masks>& out);
+
+/**
+ * Whether all of `bits` fit into confidence pixels of `pixel_bytes` bytes.
+ */
+IFM3D_ROS2_PUBLIC
+bool confidence_bits_fit(const ConfidenceBits& bits, std::size_t pixel_bytes);
+
+/**
+ * Invalidates (sets to NaN) the points of `xyz` (`n` interleaved x, y, z)
+ * whose confidence has any of `bits` set.
+ */
+IFM3D_ROS2_PUBLIC
+void exclude_points(float* xyz, const std::uint16_t* conf, std::size_t n, std::uint16_t bits);
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_CONFIDENCE_HPP_
@@ -0,0 +1,298 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_CONVERSIONS_HPP_
+#define IFM3D_ROS2_CONVERSIONS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rclcpp/logger.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <std_msgs/msg/header.hpp>
+
+#include <ifm3d/fg.h>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+//
+// Generic (runtime dispatched) conversions of ifm3d buffers to ROS messages.
+//
+// Buffers are taken by non-const reference because `ifm3d::Buffer::begin()`,
+// `end()` don't have const overloads.
+//
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::Image ifm3d_to_ros_image(ifm3d::Buffer& image, const std_msgs::msg::Header& header,
+                                           const rclcpp::Logger& logger);
+
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::Image ifm3d_to_ros_image(ifm3d::Buffer&& image, const std_msgs::msg::Header& header,
+                                           const rclcpp::Logger& logger);
+
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::CompressedImage ifm3d_to_ros_compressed_image(ifm3d::Buffer& image,
+                                                                const std_msgs::msg::Header& header,
+                                                                const std::string& format,  // "jpeg" or "png"
+                                                                const rclcpp::Logger& logger);
+
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::CompressedImage ifm3d_to_ros_compressed_image(ifm3d::Buffer&& image,
+                                                                const std_msgs::msg::Header& header,
+                                                                const std::string& format, const rclcpp::Logger& logger);
+
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud(ifm3d::Buffer& image, const std_msgs::msg::Header& header,
+                                                 const rclcpp::Logger& logger);
+
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud(ifm3d::Buffer&& image, const std_msgs::msg::Header& header,
+                                                 const rclcpp::Logger& logger);
+
+/**
+ * Compile-time description of an `ifm3d::pixel_format`: the C++ type of a
+ * channel, the number of channels and the matching ROS image encoding.
+ */
+template <ifm3d::pixel_format F>
+struct PixelTraits;
+
+#define IFM3D_ROS2_PIXEL_TRAITS(FORMAT, TYPE, CHANNELS, ENCODING)                                                     \
+  template <>                                                                                                        \
+  struct PixelTraits<ifm3d::pixel_format::FORMAT>                                                                    \
+  {                                                                                                                  \
+    using value_type = TYPE;                                                                                         \
+    static constexpr std::uint32_t channels = CHANNELS;                                                              \
+    static constexpr std::uint32_t bytes_per_pixel = sizeof(TYPE) * CHANNELS;                                        \
+    static constexpr const char* encoding = ENCODING;                                                                \
+  }
+
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_8U, std::uint8_t, 1, "8UC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_8S, std::int8_t, 1, "8SC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_16U, std::uint16_t, 1, "16UC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_16S, std::int16_t, 1, "16SC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_32U, std::uint32_t, 1, "32UC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_32S, std::int32_t, 1, "32SC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_32F, float, 1, "32FC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_64U, std::uint64_t, 1, "64UC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_64F, double, 1, "64FC1");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_16U2, std::uint16_t, 2, "16UC2");
+IFM3D_ROS2_PIXEL_TRAITS(FORMAT_32F3, float, 3, "32FC3");
+
+#undef IFM3D_ROS2_PIXEL_TRAITS
+
+/**
+ * Precomputed encoding metadata of a pixel format, for code that only knows
+ * the format at runtime.
+ */
+struct EncodingInfo
+{
+  const char* encoding;
+  std::uint32_t bytes_per_pixel;
+};
+
+constexpr auto max_pixel_format = static_cast<std::size_t>(ifm3d::pixel_format::FORMAT_32F3);
+
+template <ifm3d::pixel_format F>
+constexpr EncodingInfo make_encoding_info()
+{
+  return EncodingInfo{ PixelTraits<F>::encoding, PixelTraits<F>::bytes_per_pixel };
+}
+
+constexpr std::array<EncodingInfo, max_pixel_format + 1> encoding_table{
+  make_encoding_info<ifm3d::pixel_format::FORMAT_8U>(),   make_encoding_info<ifm3d::pixel_format::FORMAT_8S>(),
+  make_encoding_info<ifm3d::pixel_format::FORMAT_16U>(),  make_encoding_info<ifm3d::pixel_format::FORMAT_16S>(),
+  make_encoding_info<ifm3d::pixel_format::FORMAT_32U>(),  make_encoding_info<ifm3d::pixel_format::FORMAT_32S>(),
+  make_encoding_info<ifm3d::pixel_format::FORMAT_32F>(),  make_encoding_info<ifm3d::pixel_format::FORMAT_64U>(),
+  make_encoding_info<ifm3d::pixel_format::FORMAT_64F>(),  make_encoding_info<ifm3d::pixel_format::FORMAT_16U2>(),
+  make_encoding_info<ifm3d::pixel_format::FORMAT_32F3>(),
+};
+
+/**
+ * Copies the pixels of `image` into `out` (whose `width` and `height` must
+ * already be set). Instantiated per pixel format so that the pixel size and
+ * encoding are compile-time constants.
+ */
+template <ifm3d::pixel_format F>
+void copy_image(ifm3d::Buffer& image, sensor_msgs::msg::Image& out)
+{
+  using Traits = PixelTraits<F>;
+  out.encoding = Traits::encoding;
+  out.step = out.width * Traits::bytes_per_pixel;
+
+  const auto* src = image.ptr<std::uint8_t>(0);
+  out.data.assign(src, src + static_cast<std::size_t>(out.step) * out.height);
+}
+
+/**
+ * Converts the images of one stream (e.g., `~/distance`) to ROS messages.
+ *
+ * The pixel format of a stream does not change from frame to frame, so the
+ * kernel is selected once, on the first frame, and only re-selected if the
+ * format ever changes.
+ */
+class IFM3D_ROS2_PUBLIC ImageConverter
+{
+public:
+  using Kernel = void (*)(ifm3d::Buffer&, sensor_msgs::msg::Image&);
+
+  sensor_msgs::msg::Image operator()(ifm3d::Buffer& image, const std_msgs::msg::Header& header,
+                                     const rclcpp::Logger& logger);
+
+  /**
+   * Forgets the selected kernel (e.g., after a reconfiguration).
+   */
+  void reset()
+  {
+    this->kernel_ = nullptr;
+  }
+
+  static Kernel select(ifm3d::pixel_format format);
+
+private:
+  ifm3d::pixel_format format_{};
+  Kernel kernel_{ nullptr };
+};
+
+/**
+ * Millimeter distance images (16UC1) reserve 0 for invalid pixels, and
+ * saturate at 65535 (i.e., 65535 reads as ">= 65.535 m").
+ *
+ * The inverse conversion is `meters = mm * 0.001` for every `mm != 0`.
+ */
+constexpr std::uint16_t mm16_invalid = 0;
+constexpr std::uint16_t mm16_max = 65535;
+
+/**
+ * Converts `n` distances in meters to millimeters, rounding to the nearest
+ * millimeter. Non-positive and NaN distances map to `mm16_invalid`.
+ */
+IFM3D_ROS2_PUBLIC
+void distance_to_mm16(const float* src, std::uint16_t* dst, std::size_t n);
+
+/**
+ * Converts a `FORMAT_32F` (meters) distance buffer into a 16UC1 image in
+ * millimeters, see `distance_to_mm16()`.
+ */
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::Image ifm3d_to_ros_distance_mm16(ifm3d::Buffer& image, const std_msgs::msg::Header& header,
+                                                   const rclcpp::Logger& logger);
+
+/**
+ * Scale of the INT16 coordinates of quantized clouds: meters per LSB, i.e.
+ * the `x`, `y`, `z` fields hold millimeters and `meters = 0.001 * value`.
+ * Coordinates beyond +-32.767 m saturate, NaN coordinates become 0, so
+ * `(0, 0, 0)` marks an invalid point.
+ */
+constexpr float cloud_int16_scale = 0.001F;
+
+/**
+ * Rigid transform of points, `p' = R * p + t`, as the rows of `[R | t]`.
+ */
+using PointTransform = std::array<float, 12>;
+
+/**
+ * Transforms `n` points (interleaved x, y, z) from `src` into `dst`, which
+ * must not overlap. Invalid points, i.e., the origin (as ifm3d marks them)
+ * and NaN, are copied unchanged.
+ */
+IFM3D_ROS2_PUBLIC
+void transform_points(const PointTransform& transform, const float* src, float* dst, std::size_t n);
+
+/**
+ * Quantizes `n` floats (meters) to INT16 millimeters, see
+ * `cloud_int16_scale`.
+ */
+IFM3D_ROS2_PUBLIC
+void quantize_mm16(const float* src, std::int16_t* dst, std::size_t n);
+
+/**
+ * Maps `n` amplitudes linearly to 8 bit intensities, `max_value` and above
+ * map to 255.
+ */
+template <typename T>
+void amplitude_to_u8(const T* src, std::uint8_t* dst, std::size_t n, float max_value);
+
+/**
+ * Converts XYZ buffers into compact point clouds with INT16 `x`, `y`, `z`
+ * fields in millimeters (6 bytes per point) and, optionally, a UINT8
+ * `intensity` field derived from an amplitude buffer (7 bytes per point).
+ * Invalid points are kept in place as `(0, 0, 0)`, the clouds are therefore
+ * never `is_dense`.
+ *
+ * Keeps a scratch buffer across frames, so use one instance per stream.
+ */
+class IFM3D_ROS2_PUBLIC QuantizedCloudConverter
+{
+public:
+  /**
+   * `amplitude` may be `nullptr` (or empty) to omit the intensity field.
+   * `intensity_max` is the amplitude mapped to an intensity of 255. With a
+   * `transform`, the points are transformed before they are quantized.
+   */
+  sensor_msgs::msg::PointCloud2 operator()(ifm3d::Buffer& xyz, ifm3d::Buffer* amplitude, float intensity_max,
+                                           const std_msgs::msg::Header& header, const rclcpp::Logger& logger,
+                                           const PointTransform* transform = nullptr);
+
+private:
+  std::vector<float> xyz_m_{};
+  std::vector<std::int16_t> xyz_mm_{};
+  std::vector<std::uint8_t> intensity_{};
+};
+
+/**
+ * Copies `n` points (interleaved x, y, z in meters) to `out`, invalidating
+ * (NaN) the points whose distance noise (meters) exceeds `max_noise`. With
+ * `with_sigma`, the noise follows each point (`out` is interleaved x, y, z,
+ * sigma). Points with a NaN noise are kept. With a `transform`, the points
+ * are transformed on the way, except for invalid ones (see
+ * `transform_points()`).
+ */
+IFM3D_ROS2_PUBLIC
+void filter_noisy_points(const float* xyz, const float* noise, float* out, std::size_t n, float max_noise,
+                         bool with_sigma, const PointTransform* transform = nullptr);
+
+/**
+ * Converts an XYZ buffer and its distance noise buffer (`FORMAT_32F`, meters)
+ * into a point cloud with FLOAT32 `x`, `y`, `z` fields and, optionally, a
+ * FLOAT32 `sigma` field holding the noise. Points noisier than `max_noise`
+ * are NaN, `+Inf` keeps all of them. With a `transform`, the points are
+ * transformed on the way (`header` should name the target frame). Invalid
+ * points stay in place, so the cloud is not `is_dense`.
+ */
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud_with_noise(ifm3d::Buffer& xyz, ifm3d::Buffer& noise, bool with_sigma,
+                                                            float max_noise, const std_msgs::msg::Header& header,
+                                                            const rclcpp::Logger& logger,
+                                                            const PointTransform* transform = nullptr);
+
+/**
+ * Converts a `FORMAT_32F3` XYZ buffer into a point cloud with FLOAT32 `x`,
+ * `y`, `z` fields, transforming the points while copying them into the
+ * message (`header` should name the target frame). Invalid points stay at
+ * the origin (or NaN), so the cloud is not `is_dense`.
+ */
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud_transformed(ifm3d::Buffer& xyz, const PointTransform& transform,
+                                                             const std_msgs::msg::Header& header,
+                                                             const rclcpp::Logger& logger);
+
+/**
+ * Converts `n` points (interleaved x, y, z in meters) into an unorganized
+ * (`height` 1) point cloud with FLOAT32 `x`, `y`, `z` fields, e.g., for the
+ * outputs of processing stages which drop points.
+ */
+IFM3D_ROS2_PUBLIC
+sensor_msgs::msg::PointCloud2 xyz_to_ros_cloud(const float* xyz, std::size_t n, const std_msgs::msg::Header& header);
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_CONVERSIONS_HPP_
@@ -0,0 +1,102 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_GOVERNOR_HPP_
+#define IFM3D_ROS2_GOVERNOR_HPP_
+
+#include <string>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Figures of one governor period.
+ */
+struct GovernorInputs
+{
+  double host_cpu_load{};    // busy fraction of all cores of the host, 0 .. 1
+  double publish_latency{};  // mean `publish()` call (seconds), grows as subscribers push back
+  double loop_load{};        // busy fraction of the publish loop; close to 1, frames queue up in the framegrabber
+};
+
+/**
+ * Limits of the governor. Exceeding any of them lowers the rate right away,
+ * all of them must be clear for `restore_periods` periods in a row to raise
+ * it again.
+ */
+struct GovernorLimits
+{
+  double cpu_high{ 0.85 };         // degrade above
+  double cpu_low{ 0.6 };           // restore below
+  double publish_latency{ 0.01 };  // seconds, degrade above, restore below half of it
+  double loop_load{ 0.9 };         // degrade above, restore if still below 80 % of it at the higher rate
+  int max_level{ 3 };
+  int restore_periods{ 3 };
+};
+
+enum class GovernorAction
+{
+  HOLD,
+  DEGRADE,
+  RESTORE,
+};
+
+/**
+ * Decides on the frame rate of a head from the load of the host and of its
+ * publish loop, trading frames for latency: at level `n`, the head runs at
+ * `1 / (n + 1)` of its nominal rate.
+ *
+ * Steps down fast (one level per period under pressure) and up slowly (one
+ * level after `restore_periods` calm periods), so that the rate does not
+ * oscillate around a limit.
+ */
+class IFM3D_ROS2_PUBLIC FrameRateGovernor
+{
+public:
+  explicit FrameRateGovernor(const GovernorLimits& limits = GovernorLimits());
+
+  /**
+   * Takes the figures of the last period, returns what changed.
+   */
+  GovernorAction update(const GovernorInputs& inputs);
+
+  /**
+   * Back to the nominal rate, e.g., once the head starts streaming again.
+   */
+  void reset();
+
+  int level() const
+  {
+    return this->level_;
+  }
+
+  /**
+   * Fraction of the nominal rate at the current level.
+   */
+  double rate_factor() const
+  {
+    return 1.0 / (this->level_ + 1);
+  }
+
+  /**
+   * Why the last `update()` decided as it did, for the diagnostics.
+   */
+  const std::string& reason() const
+  {
+    return this->reason_;
+  }
+
+private:
+  GovernorLimits limits_;
+  int level_{};
+  int calm_periods_{};
+  std::string reason_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_GOVERNOR_HPP_
@@ -0,0 +1,121 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_GROUND_PLANE_HPP_
+#define IFM3D_ROS2_GROUND_PLANE_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace ifm3d_ros2
+{
+/**
+ * Plane `a * x + b * y + c * z + d = 0` with a unit normal `(a, b, c)`.
+ */
+struct Plane
+{
+  float a{};
+  float b{};
+  float c{};
+  float d{};
+
+  float distance(float x, float y, float z) const
+  {
+    return this->a * x + this->b * y + this->c * z + this->d;
+  }
+};
+
+/**
+ * Estimates the ground plane of point clouds with a preemptive RANSAC
+ * (Nister, 2003) seeded from the plane of the previous frame.
+ *
+ * Hypotheses are drawn from a random subset of the points, half of them
+ * among the points close to the previous plane, and must be within
+ * `max_tilt_rad` of `up`. They are scored block by block on that subset,
+ * halving the surviving hypotheses after each block, until one is left or
+ * the time budget runs out. The winner is then refined by a least squares
+ * fit to its inliers among all points.
+ */
+class IFM3D_ROS2_PUBLIC GroundPlaneEstimator
+{
+public:
+  struct Params
+  {
+    float threshold{ 0.03F };  // meters, inlier distance
+    std::array<float, 3> up{ { 0.0F, 0.0F, 1.0F } };
+    float max_tilt_rad{ 0.26F };
+    float min_inlier_ratio{ 0.2F };  // of the valid points, for a plane to be valid
+    std::size_t num_hypotheses{ 64 };
+    std::size_t num_samples{ 1024 };
+    std::chrono::microseconds time_budget{ 10000 };
+  };
+
+  struct Result
+  {
+    bool valid{};
+    bool seeded{};     // the previous plane took part
+    bool timed_out{};  // scoring stopped early, because of the time budget
+    Plane plane{};
+    std::size_t inliers{};
+    std::size_t points{};  // valid points
+  };
+
+  void configure(const Params& params);
+
+  /**
+   * Forgets the previous plane.
+   */
+  void reset();
+
+  /**
+   * Estimates the plane of `n` points (interleaved x, y, z in meters, NaN or
+   * the origin for invalid points). Uses `pool` for the passes over all
+   * points.
+   */
+  Result estimate(const float* xyz, std::size_t n, WorkerPool& pool);
+
+  /**
+   * Splits the valid points into `ground` (within `threshold` of `plane`)
+   * and `obstacles` (interleaved x, y, z).
+   */
+  void split(const float* xyz, std::size_t n, const Plane& plane, std::vector<float>& ground,
+             std::vector<float>& obstacles, WorkerPool& pool);
+
+private:
+  struct Hypothesis
+  {
+    Plane plane;
+    std::uint32_t score;
+  };
+
+  bool make_hypothesis(std::size_t i, std::size_t j, std::size_t k, Plane& out) const;
+  std::uint32_t count_inliers(const Plane& plane, std::size_t begin, std::size_t end) const;
+
+  Params params_{};
+  std::mt19937 rng_{ 5489U };
+  bool has_previous_{};
+  Plane previous_{};
+
+  // random subset of the valid points, SoA for the vectorized scoring
+  std::vector<float> sx_{};
+  std::vector<float> sy_{};
+  std::vector<float> sz_{};
+
+  std::vector<std::uint32_t> near_previous_{};  // indices into the subset
+  std::vector<Hypothesis> hypotheses_{};
+  std::vector<std::uint8_t> labels_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_GROUND_PLANE_HPP_
@@ -0,0 +1,90 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_GUIDED_FILTER_HPP_
+#define IFM3D_ROS2_GUIDED_FILTER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace ifm3d_ros2
+{
+/**
+ * Edge-preserving smoothing of distance images, guided by the amplitude
+ * image (He et al., "Guided Image Filtering"): within every window, the
+ * distance is fitted as a linear function of the amplitude, so that edges of
+ * the amplitude survive while flat areas are averaged.
+ *
+ * All window means are box filters of running sums, i.e., the cost per pixel
+ * does not depend on the radius. Invalid pixels (0 or NaN) do not contribute
+ * to any window and stay invalid. The guide is normalized to a mean of 1 per
+ * frame, so `eps` does not depend on the amplitude scale.
+ *
+ * Keeps its buffers across frames, so use one instance per stream.
+ */
+class IFM3D_ROS2_PUBLIC GuidedFilter
+{
+public:
+  struct Params
+  {
+    std::uint32_t radius{ 2 };  // windows are (2 * radius + 1)^2 pixels
+    float eps{ 0.01F };  // regularization, larger values smooth across weaker edges
+  };
+
+  void configure(const Params& params);
+
+  const Params& params() const
+  {
+    return this->params_;
+  }
+
+  /**
+   * Writes the filtered `width * height` distance image `distance` (meters)
+   * to `out`, guided by `amplitude` (same size).
+   */
+  void operator()(const float* distance, const float* amplitude, std::uint32_t width, std::uint32_t height, float* out,
+                  WorkerPool& pool);
+
+  void operator()(const float* distance, const std::uint16_t* amplitude, std::uint32_t width, std::uint32_t height,
+                  float* out, WorkerPool& pool);
+
+private:
+  template <typename T>
+  void filter(const float* distance, const T* amplitude, std::uint32_t width, std::uint32_t height, float* out,
+              WorkerPool& pool);
+
+  Params params_{};
+
+  // per pixel planes: the normalized guide, the weighted inputs of the box
+  // filters and their window sums (reused for the coefficients)
+  std::vector<float> guide_{};
+  std::vector<float> w_{};
+  std::vector<float> wi_{};
+  std::vector<float> wp_{};
+  std::vector<float> wii_{};
+  std::vector<float> wip_{};
+  std::vector<float> n_{};
+  std::vector<float> si_{};
+  std::vector<float> sp_{};
+  std::vector<float> sii_{};
+  std::vector<float> sip_{};
+};
+
+/**
+ * Moves the `n` points of `xyz` (interleaved x, y, z) along their rays from
+ * the radial distance `distance` to `filtered`. Points with an invalid
+ * distance are left alone.
+ */
+IFM3D_ROS2_PUBLIC
+void rescale_points(float* xyz, const float* distance, const float* filtered, std::size_t n);
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_GUIDED_FILTER_HPP_
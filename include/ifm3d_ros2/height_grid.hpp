@@ -0,0 +1,176 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_HEIGHT_GRID_HPP_
+#define IFM3D_ROS2_HEIGHT_GRID_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace ifm3d_ros2
+{
+/**
+ * Geometry of a 2.5D grid in the x-y plane of the cloud frame.
+ */
+struct GridParams
+{
+  float resolution{ 0.05F };  // meters per cell
+  std::uint32_t width{ 200 };  // cells along x
+  std::uint32_t height{ 200 };  // cells along y
+  float origin_x{ -5.0F };  // meters, corner of cell (0, 0)
+  float origin_y{ -5.0F };
+  float min_z{ 0.05F };  // points below are ground, between min_z and max_z obstacles
+  float max_z{ 2.0F };  // points above (e.g., ceilings) are ignored
+
+  bool operator==(const GridParams& other) const
+  {
+    return this->resolution == other.resolution && this->width == other.width && this->height == other.height &&
+           this->origin_x == other.origin_x && this->origin_y == other.origin_y && this->min_z == other.min_z &&
+           this->max_z == other.max_z;
+  }
+};
+
+/**
+ * Per cell statistics of a height grid.
+ */
+struct GridCell
+{
+  float max_height;  // highest obstacle point, -inf if none
+  std::uint32_t obstacles;  // points between `min_z` and `max_z`
+  std::uint32_t ground;  // points below `min_z`
+
+  static constexpr GridCell empty()
+  {
+    return GridCell{ -std::numeric_limits<float>::infinity(), 0, 0 };
+  }
+};
+
+/**
+ * Bins point clouds into a grid of `GridCell`s (row-major, x along rows).
+ *
+ * Binning is split across the threads of a `WorkerPool`: each thread first
+ * computes the cell indices of its points (vectorized), then scatters them
+ * into a partial grid of its own. The partial grids are merged at the end,
+ * so the threads never contend on a cell.
+ */
+class IFM3D_ROS2_PUBLIC HeightGrid
+{
+public:
+  void configure(const GridParams& params);
+
+  const GridParams& params() const
+  {
+    return this->params_;
+  }
+
+  const std::vector<GridCell>& cells() const
+  {
+    return this->cells_;
+  }
+
+  /**
+   * Replaces the cells by the statistics of `n` points (interleaved x, y, z
+   * in meters, NaN or the origin for invalid points).
+   */
+  void bin(const float* xyz, std::size_t n, WorkerPool& pool);
+
+  /**
+   * Occupancy of every cell, as in `nav_msgs/OccupancyGrid`: 100 with at
+   * least `min_points` obstacle points, 0 for cells which only saw ground and
+   * -1 (unknown) otherwise.
+   */
+  static void to_occupancy(const std::vector<GridCell>& cells, std::uint32_t min_points, std::vector<std::int8_t>& out);
+
+private:
+  GridParams params_{};
+  std::vector<GridCell> cells_{};
+  std::vector<std::vector<GridCell>> partials_{};
+  std::vector<std::int32_t> cell_x_{};
+  std::vector<std::int32_t> cell_y_{};
+};
+
+/**
+ * Grid combining the latest `HeightGrid` of several heads, e.g., the heads of
+ * a multi-head process loaded into one component container.
+ *
+ * Grids are shared by name: every head acquiring the same name joins the same
+ * grid and contributes its latest cells. The merged cells take the maximum of
+ * the heights and the sum of the point counts.
+ */
+class IFM3D_ROS2_PUBLIC SharedGrid
+{
+public:
+  /**
+   * Returns the grid named `name`, creating it with `params` if needed. An
+   * empty name returns a grid of its own. The geometry of existing grids
+   * stays as is, check `params()`.
+   */
+  static std::shared_ptr<SharedGrid> acquire(const std::string& name, const GridParams& params);
+
+  explicit SharedGrid(const GridParams& params) : params_(params)
+  {
+  }
+
+  const GridParams& params() const
+  {
+    return this->params_;
+  }
+
+  /**
+   * Adds a contributor, returns its id.
+   */
+  std::size_t join();
+
+  /**
+   * Removes the contributor `id` and its cells.
+   */
+  void leave(std::size_t id);
+
+  /**
+   * Replaces the cells of the contributor `id`.
+   */
+  void update(std::size_t id, const HeightGrid& grid);
+
+  /**
+   * Empties the cells of the contributor `id`, e.g., while its head streams
+   * no frames, so that they do not linger in the merged grid.
+   */
+  void clear(std::size_t id);
+
+  /**
+   * Claims the next publication: returns `true` (at most) once per `period`
+   * among all contributors, so that the merged grid goes out once, at the
+   * given rate.
+   */
+  bool claim_publication(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration period);
+
+  /**
+   * Merges the cells of all contributors into `out`.
+   */
+  void merge(std::vector<GridCell>& out) const;
+
+private:
+  const GridParams params_;
+
+  mutable std::mutex mutex_{};
+  std::size_t next_id_{};
+  std::map<std::size_t, std::vector<GridCell>> contributions_{};
+  std::chrono::steady_clock::time_point last_publication_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_HEIGHT_GRID_HPP_
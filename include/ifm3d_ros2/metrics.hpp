@@ -0,0 +1,262 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_METRICS_HPP_
+#define IFM3D_ROS2_METRICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Monotonically increasing counter. Safe to bump from any thread.
+ */
+class IFM3D_ROS2_PUBLIC Counter
+{
+public:
+  void inc(std::uint64_t n = 1)
+  {
+    this->value_.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  std::uint64_t value() const
+  {
+    return this->value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::uint64_t> value_{ 0 };
+};
+
+/**
+ * Counters told apart by one more label, one per value of it (e.g., one per
+ * topic), fixed at construction.
+ */
+class IFM3D_ROS2_PUBLIC LabeledCounters
+{
+public:
+  explicit LabeledCounters(std::vector<std::string> values);
+
+  Counter& operator[](std::size_t i)
+  {
+    return this->counters_[i];
+  }
+
+  const Counter& operator[](std::size_t i) const
+  {
+    return this->counters_[i];
+  }
+
+  /**
+   * The label values, by index.
+   */
+  const std::vector<std::string>& values() const
+  {
+    return this->values_;
+  }
+
+  std::size_t size() const
+  {
+    return this->values_.size();
+  }
+
+private:
+  std::vector<std::string> values_;
+  std::unique_ptr<Counter[]> counters_;
+};
+
+/**
+ * A value that can go up and down (e.g., a queue depth).
+ */
+class IFM3D_ROS2_PUBLIC Gauge
+{
+public:
+  void set(std::int64_t v)
+  {
+    this->value_.store(v, std::memory_order_relaxed);
+  }
+
+  void inc(std::int64_t n = 1)
+  {
+    this->value_.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  void dec(std::int64_t n = 1)
+  {
+    this->value_.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  std::int64_t value() const
+  {
+    return this->value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<std::int64_t> value_{ 0 };
+};
+
+/**
+ * Fixed-bucket histogram of durations (seconds).
+ *
+ * Buckets are stored non-cumulatively so that `observe()` is a single
+ * relaxed increment plus a CAS on the sum; the cumulative view required by
+ * the exposition format is computed at scrape time.
+ */
+class IFM3D_ROS2_PUBLIC Histogram
+{
+public:
+  /**
+   * `bounds` are the (strictly increasing) upper bounds of the buckets, the
+   * implicit `+Inf` bucket is appended internally.
+   */
+  explicit Histogram(std::vector<double> bounds);
+
+  void observe(double seconds);
+
+  void observe_since(std::chrono::steady_clock::time_point start)
+  {
+    this->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+
+  const std::vector<double>& bounds() const
+  {
+    return this->bounds_;
+  }
+
+  /**
+   * Cumulative bucket counts, one per bound plus `+Inf`.
+   */
+  std::vector<std::uint64_t> cumulative_counts() const;
+
+  std::uint64_t count() const
+  {
+    return this->count_.load(std::memory_order_relaxed);
+  }
+
+  double sum() const
+  {
+    return this->sum_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> buckets_;
+  std::atomic<std::uint64_t> count_{ 0 };
+  std::atomic<double> sum_{ 0.0 };
+};
+
+/**
+ * Performance counters of a single camera head (i.e., one `CameraNode`).
+ *
+ * The frame path only ever touches the atomics in here. Scraping reads them
+ * without taking any lock that the frame path would also take.
+ */
+struct IFM3D_ROS2_PUBLIC HeadMetrics
+{
+  /**
+   * `topic_names` label the `topics_skipped` counters.
+   */
+  explicit HeadMetrics(std::string head_name, std::vector<std::string> topic_names = {});
+
+  const std::string head;
+
+  Counter frames_in;         // frames delivered by the framegrabber
+  Counter frames_out;        // frames fully converted and published
+  Counter frames_dropped;    // frames received but not (fully) published
+  Counter frames_unchanged;  // frames whose ToF streams were suppressed (static scene), not in `frames_out`
+  Counter frames_skipped;    // frames skipped by the frame rate governor
+  Counter timeouts;          // waits for a frame that timed out
+  Counter reconnects;        // re-initializations of the ifm3d core structures
+  Gauge queue_depth;         // frames held by the publish loop, not yet published
+
+  Counter transitions_coalesced;  // lifecycle transition requests merged into a queued one
+  Counter transitions_failed;     // lifecycle transitions requested by the node that failed
+
+  LabeledCounters topics_skipped;  // by topic, past their deadline
+
+  Counter conversion_cpu_nanos;  // CPU time of the publish loop spent converting
+  Counter publish_cpu_nanos;     // CPU time of the publish loop spent publishing
+
+  Histogram conversion_seconds;   // ifm3d buffer -> ROS message
+  Histogram publish_seconds;      // `publish()` call
+  Histogram stage_seconds;        // message of a processing stage, converted and published
+  Histogram dump_seconds;         // `Dump` service round trip
+  Histogram config_seconds;       // `Config` service round trip
+  Histogram power_state_seconds;  // `PowerState` configuration update(s)
+  Histogram transition_seconds;   // lifecycle transition requested by the node, from the request to its end
+};
+
+/**
+ * Whether `request` (an HTTP request, starting with its request line) asks
+ * for the metrics: a `GET` of exactly `/metrics` or `/`, with or without a
+ * query string.
+ */
+IFM3D_ROS2_PUBLIC
+bool is_scrape_request(const std::string& request);
+
+/**
+ * Process-wide registry of `HeadMetrics` plus the (optional) HTTP endpoint
+ * serving them in the OpenMetrics text format.
+ *
+ * In a multi-head process all camera nodes share the same registry and
+ * therefore the same endpoint; each head is distinguished by its `head`
+ * label.
+ */
+class IFM3D_ROS2_PUBLIC MetricsRegistry
+{
+public:
+  static MetricsRegistry& instance();
+
+  ~MetricsRegistry();
+
+  /**
+   * Creates and registers the metrics of a head. The registry only keeps a
+   * weak reference, heads disappear from the exposition once the returned
+   * pointer is released.
+   */
+  std::shared_ptr<HeadMetrics> register_head(const std::string& head, std::vector<std::string> topic_names = {});
+
+  /**
+   * Starts the HTTP endpoint on `address:port` if not yet running.
+   *
+   * Returns an empty string on success (or if the endpoint is already
+   * running on the requested address/port) and a description of the problem
+   * otherwise.
+   */
+  std::string start_server(const std::string& address, std::uint16_t port);
+
+  /**
+   * Renders all registered metrics in the OpenMetrics text format.
+   */
+  std::string render();
+
+private:
+  MetricsRegistry() = default;
+  void serve();
+
+  std::mutex heads_mutex_{};
+  std::vector<std::weak_ptr<HeadMetrics>> heads_{};
+
+  std::mutex server_mutex_{};
+  std::string server_address_{};
+  std::uint16_t server_port_{};
+  int listen_fd_{ -1 };
+  std::atomic_bool server_running_{ false };
+  std::thread server_thread_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_METRICS_HPP_
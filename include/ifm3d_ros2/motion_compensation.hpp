@@ -0,0 +1,103 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_MOTION_COMPENSATION_HPP_
+#define IFM3D_ROS2_MOTION_COMPENSATION_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ifm3d_ros2/conversions.hpp>
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Velocity of the robot at `stamp_nanos`, in its own (body) frame: meters
+ * and radians per second.
+ */
+struct TwistSample
+{
+  std::int64_t stamp_nanos{};
+  std::array<float, 3> linear{};
+  std::array<float, 3> angular{};
+};
+
+/**
+ * Ring of the latest twists, written by one thread (the odometry or IMU
+ * subscription) and read by others (the publish loops) without locks.
+ *
+ * Each slot is guarded by a sequence number (a seqlock): the writer marks the
+ * slot as being written, fills it and publishes the sample's index, readers
+ * drop samples overwritten while they copied them.
+ */
+class IFM3D_ROS2_PUBLIC TwistRing
+{
+public:
+  static constexpr std::size_t capacity = 256;
+
+  /**
+   * Appends a sample, overwriting the oldest one once full. Samples must be
+   * pushed in the order of their stamps, by one thread at a time.
+   */
+  void push(const TwistSample& sample);
+
+  /**
+   * Copies the samples from the last one at or before `since_nanos` on to
+   * `out`, oldest first. Returns `false` if there are none.
+   */
+  bool snapshot(std::int64_t since_nanos, std::vector<TwistSample>& out) const;
+
+  /**
+   * Drops all samples, e.g., before the clock restarts. Called by the writing
+   * thread, or while there is none.
+   */
+  void clear();
+
+private:
+  struct Slot
+  {
+    std::atomic<std::uint64_t> sequence{};  // 2 * index + 1 while written, 2 * index + 2 once written
+    std::atomic<std::int64_t> stamp_nanos{};
+    std::array<std::atomic<float>, 6> twist{};
+  };
+
+  std::array<Slot, capacity> slots_{};
+  std::atomic<std::uint64_t> pushed_{};
+  std::atomic<std::uint64_t> cleared_{};  // `pushed_` at the last `clear()`
+};
+
+/**
+ * Integrates the twists `samples` (oldest first, as returned by
+ * `TwistRing::snapshot()`) from `from_nanos` to `to_nanos`, giving the pose
+ * of the robot at `to_nanos` in its frame at `from_nanos`.
+ *
+ * The twist is interpolated linearly between samples and held after the last
+ * one. Fails if the samples do not reach back to `from_nanos`, or if
+ * `to_nanos` is more than `max_hold_nanos` past the last sample.
+ */
+IFM3D_ROS2_PUBLIC
+bool integrate_motion(const std::vector<TwistSample>& samples, std::int64_t from_nanos, std::int64_t to_nanos,
+                      std::int64_t max_hold_nanos, PointTransform& motion);
+
+/**
+ * `a * b`, i.e., applying `b` first, then `a`.
+ */
+IFM3D_ROS2_PUBLIC
+PointTransform compose_transforms(const PointTransform& a, const PointTransform& b);
+
+/**
+ * Inverse of a rigid transform.
+ */
+IFM3D_ROS2_PUBLIC
+PointTransform invert_transform(const PointTransform& transform);
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_MOTION_COMPENSATION_HPP_
@@ -0,0 +1,88 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_PIXEL_STATS_HPP_
+#define IFM3D_ROS2_PIXEL_STATS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Per-pixel temporal statistics of a stream of distance images: mean,
+ * standard deviation and the fraction of frames in which a pixel was valid.
+ *
+ * Every frame is folded in with a (vectorized) Welford update, so the cost
+ * per frame is constant and the variance does not suffer from cancellation.
+ * The buffers are kept across runs, only the first frame of another size
+ * allocates.
+ */
+class IFM3D_ROS2_PUBLIC PixelStats
+{
+public:
+  /**
+   * Starts accumulating the next `frames` frames, dropping the previous
+   * results.
+   */
+  void start(std::uint32_t frames);
+
+  /**
+   * `true` while frames are being accumulated.
+   */
+  bool active() const
+  {
+    return this->added_ < this->requested_;
+  }
+
+  std::uint32_t frames() const
+  {
+    return this->added_;
+  }
+
+  std::uint32_t width() const
+  {
+    return this->width_;
+  }
+
+  std::uint32_t height() const
+  {
+    return this->height_;
+  }
+
+  /**
+   * Adds a `width * height` distance image (0 or NaN for invalid pixels).
+   * A frame of another size than the previous ones restarts the
+   * accumulation. Returns `true` for the frame completing it.
+   */
+  bool add(const float* distance, std::uint32_t width, std::uint32_t height);
+
+  /**
+   * The results, `width() * height()` each: mean and (population) standard
+   * deviation of the valid samples, NaN for pixels never valid, and the
+   * fraction of the frames in which a pixel was valid.
+   */
+  void mean(float* out) const;
+  void stddev(float* out) const;
+  void valid_ratio(float* out) const;
+
+private:
+  std::uint32_t requested_{};
+  std::uint32_t added_{};
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+
+  std::vector<float> count_{};  // valid samples
+  std::vector<float> mean_{};
+  std::vector<float> m2_{};  // sum of the squared deviations from the mean
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_PIXEL_STATS_HPP_
@@ -0,0 +1,62 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_PORT_STANDBY_HPP_
+#define IFM3D_ROS2_PORT_STANDBY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Standby of one port of a VPU, as switched by the `PowerState` service of
+ * any head of the process: the head streaming from the port listens, so that
+ * it goes into (and out of) standby whichever head switched its port.
+ *
+ * Switches are shared by VPU address and port.
+ */
+class IFM3D_ROS2_PUBLIC PortStandby
+{
+public:
+  using Listener = std::function<void(bool standby)>;
+
+  /**
+   * Returns the switch of `port` of the VPU at `ip`, creating it if needed.
+   */
+  static std::shared_ptr<PortStandby> acquire(const std::string& ip, std::uint16_t port);
+
+  /**
+   * Adds a listener, returns its id.
+   */
+  std::size_t listen(Listener listener);
+
+  /**
+   * Removes the listener `id`. Once this returns, it is not called anymore.
+   */
+  void unlisten(std::size_t id);
+
+  /**
+   * Calls the listeners with `standby`, returns how many there are.
+   */
+  std::size_t set(bool standby);
+
+private:
+  std::mutex mutex_{};
+  std::size_t next_id_{};
+  std::map<std::size_t, Listener> listeners_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_PORT_STANDBY_HPP_
@@ -0,0 +1,125 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_PREVIEW_HPP_
+#define IFM3D_ROS2_PREVIEW_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rclcpp/logger.hpp>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <std_msgs/msg/header.hpp>
+
+#include <ifm3d/fg.h>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Colormaps of the preview images.
+ */
+enum class Colormap
+{
+  TURBO,  // perceptually smooth rainbow, near is blue, far is red
+  GRAY,
+};
+
+/**
+ * Parses "turbo" / "gray", returns false (and leaves `out` alone) otherwise.
+ */
+IFM3D_ROS2_PUBLIC
+bool parse_colormap(const std::string& name, Colormap& out);
+
+/**
+ * A colormap as a 256 entry RGB lookup table. Entry 0 is black and reserved
+ * for invalid pixels, entries 1 .. 255 span the colormap.
+ */
+using ColormapLut = std::array<std::uint8_t, 256 * 3>;
+
+IFM3D_ROS2_PUBLIC
+ColormapLut make_colormap_lut(Colormap colormap);
+
+/**
+ * Maps `n` values linearly from `[min_value, max_value]` to the LUT indices
+ * `[1, 255]`, clamping values outside of the range. Values that are not
+ * positive (including NaN) map to index 0, i.e., invalid.
+ */
+template <typename T>
+void range_to_lut_index(const T* src, std::uint8_t* dst, std::size_t n, float min_value, float max_value);
+
+/**
+ * JPEG-encodes `height` rows of `width` packed RGB pixels into `out`.
+ * Returns an empty string on success, the libjpeg error message otherwise.
+ */
+IFM3D_ROS2_PUBLIC
+std::string encode_jpeg_rgb(const std::uint8_t* rgb, std::uint32_t width, std::uint32_t height, int quality,
+                            std::vector<std::uint8_t>& out);
+
+/**
+ * Packed RGB pixels of a decoded JPEG image.
+ */
+struct RgbImage
+{
+  std::vector<std::uint8_t> pixels{};
+  std::uint32_t width{};
+  std::uint32_t height{};
+  std::uint32_t scale_denom{ 1 };  // the encoded image is `scale_denom` times larger
+};
+
+/**
+ * Reads the size of a JPEG image from its header, without decoding it.
+ * Returns an empty string on success, the libjpeg error message otherwise.
+ */
+IFM3D_ROS2_PUBLIC
+std::string read_jpeg_size(const std::uint8_t* data, std::size_t size, std::uint32_t& width, std::uint32_t& height);
+
+/**
+ * Decodes a JPEG image into `out`, scaled down by 2, 4 or 8 as long as it
+ * stays at least `min_width * min_height` (libjpeg scales while decoding, at
+ * a fraction of the cost). Returns an empty string on success, the libjpeg
+ * error message otherwise.
+ */
+IFM3D_ROS2_PUBLIC
+std::string decode_jpeg_rgb(const std::uint8_t* data, std::size_t size, std::uint32_t min_width,
+                            std::uint32_t min_height, RgbImage& out);
+
+/**
+ * Renders single channel images (distance, amplitude) as colormapped,
+ * JPEG-compressed 8 bit previews, in the format `image_transport`'s
+ * `compressed` plugin produces.
+ *
+ * Keeps scratch buffers across frames, so use one instance per stream.
+ */
+class IFM3D_ROS2_PUBLIC PreviewRenderer
+{
+public:
+  explicit PreviewRenderer(Colormap colormap = Colormap::TURBO, int quality = 80);
+
+  void set_colormap(Colormap colormap);
+  void set_quality(int quality);
+
+  /**
+   * `image` must be `FORMAT_8U`, `FORMAT_16U` or `FORMAT_32F`. Values are
+   * mapped from `[min_value, max_value]` onto the colormap.
+   */
+  sensor_msgs::msg::CompressedImage operator()(ifm3d::Buffer& image, float min_value, float max_value,
+                                               const std_msgs::msg::Header& header, const rclcpp::Logger& logger);
+
+private:
+  ColormapLut lut_{};
+  int quality_{};
+  std::vector<std::uint8_t> index_{};
+  std::vector<std::uint8_t> rgb_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_PREVIEW_HPP_
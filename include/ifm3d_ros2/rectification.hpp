@@ -0,0 +1,104 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_RECTIFICATION_HPP_
+#define IFM3D_ROS2_RECTIFICATION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <ifm3d_ros2/camera_model.hpp>
+#include <ifm3d_ros2/visibility_control.h>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace ifm3d_ros2
+{
+/**
+ * Pinhole camera of a rectified image, `u = fx * x / z + cx` with pixel
+ * centers at integers (as in `sensor_msgs/CameraInfo`).
+ */
+struct PinholeModel
+{
+  float fx{};
+  float fy{};
+  float cx{};
+  float cy{};
+};
+
+/**
+ * Hash of an intrinsic model and the image size, identifying a `RemapTable`.
+ */
+IFM3D_ROS2_PUBLIC
+std::uint64_t calibration_hash(const IntrinsicModel& model, std::uint32_t width, std::uint32_t height);
+
+/**
+ * Fixed-point table undistorting the images of one imager into the pinhole
+ * camera with its focal lengths and principal point (without skew).
+ *
+ * Every output pixel stores the offset of its top left source pixel and
+ * 8 bit bilinear weights. Remapping gathers the four neighbors of the pixels
+ * of a row first, then blends them with integer arithmetic, vectorized.
+ */
+class IFM3D_ROS2_PUBLIC RemapTable
+{
+public:
+  /**
+   * Builds the table for `width * height` images (at least 2 * 2) of an
+   * imager with the intrinsic model `model`. Returns `nullptr` for
+   * unsupported models.
+   */
+  static std::shared_ptr<RemapTable> build(const IntrinsicModel& model, std::uint32_t width, std::uint32_t height,
+                                           WorkerPool& pool);
+
+  std::uint64_t hash() const
+  {
+    return this->hash_;
+  }
+
+  std::uint32_t width() const
+  {
+    return this->width_;
+  }
+
+  std::uint32_t height() const
+  {
+    return this->height_;
+  }
+
+  const PinholeModel& pinhole() const
+  {
+    return this->pinhole_;
+  }
+
+  /**
+   * Undistorts the packed RGB image `src` into `dst`, both `width() *
+   * height()`. Pixels seeing outside of `src` are black.
+   *
+   * Keeps the row buffers of the workers across calls, so a table remaps
+   * one image at a time.
+   */
+  void remap(const std::uint8_t* src, std::uint8_t* dst, WorkerPool& pool);
+
+private:
+  std::uint64_t hash_{};
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+  PinholeModel pinhole_{};
+
+  std::vector<std::int32_t> offsets_{};  // byte offset of the top left source pixel, -1 if outside
+  std::vector<std::uint16_t> wx_{};  // weight of the right neighbors, 0 .. 256
+  std::vector<std::uint16_t> wy_{};  // weight of the bottom neighbors, 0 .. 256
+
+  // per chunk of rows: the four gathered neighbors and the blended pixels of
+  // a row, 5 * `width_` words
+  std::vector<std::uint32_t> rows_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_RECTIFICATION_HPP_
@@ -0,0 +1,146 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_RGB_REGISTRATION_HPP_
+#define IFM3D_ROS2_RGB_REGISTRATION_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ifm3d_ros2/camera_model.hpp>
+#include <ifm3d_ros2/visibility_control.h>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace ifm3d_ros2
+{
+/**
+ * Samples an RGB image at the pixels of a ToF imager, giving a color image
+ * registered to the distance image.
+ *
+ * The rays of the ToF pixels, rotated into the RGB optic frame, do not depend
+ * on the distance, so they are computed once per calibration (the LUT). Per
+ * frame, a pixel at distance `d` is at `d * ray + t` in the RGB optic frame,
+ * which is projected through the RGB intrinsics and sampled bilinearly.
+ */
+class IFM3D_ROS2_PUBLIC RgbRegistration
+{
+public:
+  /**
+   * Prepares the registration of a `width * height` ToF imager to an RGB
+   * imager, rebuilding the LUT only if anything changed. Returns `false` if
+   * either intrinsic model is not supported.
+   */
+  bool configure(const OpticCalibration& tof, std::uint32_t width, std::uint32_t height, const OpticCalibration& rgb);
+
+  std::uint32_t width() const
+  {
+    return this->width_;
+  }
+
+  std::uint32_t height() const
+  {
+    return this->height_;
+  }
+
+  /**
+   * Writes the `width() * height()` registered pixels (packed RGB) to `out`.
+   * `distance` is the radial distance (meters, 0 or NaN if invalid), `rgb`
+   * the packed RGB image, decoded at `1 / rgb_scale_denom` of its calibrated
+   * resolution. Pixels without a valid distance or outside of the RGB image
+   * are black.
+   */
+  void operator()(const float* distance, const std::uint8_t* rgb, std::uint32_t rgb_width, std::uint32_t rgb_height,
+                  std::uint32_t rgb_scale_denom, std::uint8_t* out, WorkerPool& pool);
+
+private:
+  bool valid_{};
+  OpticCalibration tof_{};
+  OpticCalibration rgb_{};
+  std::uint32_t width_{};
+  std::uint32_t height_{};
+
+  // rays of the ToF pixels in the RGB optic frame (SoA) and the ToF origin
+  std::vector<float> rx_{};
+  std::vector<float> ry_{};
+  std::vector<float> rz_{};
+  std::array<float, 3> t_{};
+
+  // per frame scratch: points in the RGB optic frame, their pixel coordinates
+  // (then the bilinear weights) and top left neighbors
+  std::vector<float> px_{};
+  std::vector<float> py_{};
+  std::vector<float> pz_{};
+  std::vector<float> u_{};
+  std::vector<float> v_{};
+  std::vector<std::int32_t> ix_{};
+  std::vector<std::int32_t> iy_{};
+};
+
+/**
+ * Latest frame of an RGB imager, as exchanged between heads.
+ */
+struct ColorFrame
+{
+  std::uint64_t sequence{};
+  std::int64_t stamp_nanos{};
+  OpticCalibration calibration{};
+  std::vector<std::uint8_t> jpeg{};
+};
+
+/**
+ * Hands the latest frame of a 2D head to the 3D heads registering against it,
+ * e.g., the heads of an O3R loaded into one component container.
+ *
+ * Exchanges are shared by name. The 2D head only copies its frames in while
+ * a 3D head asked for them recently, i.e., while someone subscribes to the
+ * registered image.
+ */
+class IFM3D_ROS2_PUBLIC ColorFrameExchange
+{
+public:
+  /**
+   * Returns the exchange named `name`, creating it if needed.
+   */
+  static std::shared_ptr<ColorFrameExchange> acquire(const std::string& name);
+
+  /**
+   * Marks frames as wanted, as of `now_nanos` (steady clock).
+   */
+  void request(std::int64_t now_nanos);
+
+  /**
+   * Returns `true` if frames were requested within `window_nanos` of
+   * `now_nanos`.
+   */
+  bool wanted(std::int64_t now_nanos, std::int64_t window_nanos) const;
+
+  /**
+   * Replaces the latest frame, assigning its `sequence`.
+   */
+  void post(std::shared_ptr<ColorFrame> frame);
+
+  /**
+   * The latest frame, `nullptr` if none was posted yet.
+   */
+  std::shared_ptr<const ColorFrame> latest() const;
+
+private:
+  std::atomic<std::int64_t> last_request_{ -1 };
+
+  mutable std::mutex mutex_{};
+  std::uint64_t next_sequence_{ 1 };
+  std::shared_ptr<const ColorFrame> latest_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_RGB_REGISTRATION_HPP_
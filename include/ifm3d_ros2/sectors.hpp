@@ -0,0 +1,115 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_SECTORS_HPP_
+#define IFM3D_ROS2_SECTORS_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * `atan2(y, x)` with an absolute error below 1e-5 rad, written so that loops
+ * calling it vectorize: the quadrant corrections are blended in
+ * arithmetically since selecting between computed values (or guarding the
+ * division) keeps GCC from if-converting the loop body.
+ */
+inline float fast_atan2(float y, float x)
+{
+  constexpr float pi = 3.14159265F;
+  constexpr float pi_2 = 1.57079633F;
+
+  const float ax = std::fabs(x);
+  const float ay = std::fabs(y);
+  const float mx = ax > ay ? ax : ay;
+  const float mn = ax > ay ? ay : ax;
+  const float a = mn / (mx + 1e-30F);
+  const float s = a * a;
+  float r = a * (0.99997726F +
+                 s * (-0.33262347F + s * (0.19354346F + s * (-0.11643287F + s * (0.05265332F + s * -0.01172120F)))));
+  r += (ay > ax ? 1.0F : 0.0F) * (pi_2 - 2.0F * r);  // r = pi/2 - r
+  r += (x < 0.0F ? 1.0F : 0.0F) * (pi - 2.0F * r);   // r = pi - r
+  return std::copysign(r, y);
+}
+
+/**
+ * Reduces point clouds to the nearest point per angular sector and height
+ * band, e.g., for a safety watchdog.
+ *
+ * Sectors split the azimuth `atan2(y, x)` from `angle_min` to `angle_max`,
+ * bands split `z` at `band_limits` (`num_bands + 1` increasing edges). The
+ * distance of a point is its horizontal range `sqrt(x^2 + y^2)`. Points
+ * outside of all sectors or bands, and invalid points (NaN or the origin),
+ * are ignored.
+ */
+class IFM3D_ROS2_PUBLIC SectorReducer
+{
+public:
+  struct Params
+  {
+    std::uint32_t num_sectors{};
+    float angle_min{};
+    float angle_max{};
+    std::vector<float> band_limits{};
+  };
+
+  void configure(const Params& params);
+
+  const Params& params() const
+  {
+    return this->params_;
+  }
+
+  std::uint32_t num_bands() const
+  {
+    return this->params_.band_limits.size() < 2 ? 0 : static_cast<std::uint32_t>(this->params_.band_limits.size() - 1);
+  }
+
+  /**
+   * Reduces `n` points (interleaved x, y, z in meters). The results are
+   * available through `min_range()` and `point_count()` until the next call.
+   */
+  void reduce(const float* xyz, std::size_t n);
+
+  /**
+   * Per bin (`band * num_sectors + sector`): range of the nearest point,
+   * `+Inf` if the bin is empty.
+   */
+  const std::vector<float>& min_range() const
+  {
+    return this->min_range_;
+  }
+
+  /**
+   * Per bin: number of points.
+   */
+  const std::vector<std::uint32_t>& point_count() const
+  {
+    return this->point_count_;
+  }
+
+private:
+  Params params_{};
+  std::size_t num_bins_{};
+
+  // per point scratch
+  std::vector<std::int32_t> sector_{};
+  std::vector<std::int32_t> band_{};
+  std::vector<float> range2_{};  // squared horizontal range
+  std::vector<float> z_{};
+
+  std::vector<float> min_range_{};
+  std::vector<std::uint32_t> point_count_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_SECTORS_HPP_
@@ -0,0 +1,51 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_SHARED_REGISTRY_HPP_
+#define IFM3D_ROS2_SHARED_REGISTRY_HPP_
+
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ifm3d_ros2
+{
+/**
+ * Returns the `T` shared under `name` by the heads of a process, creating it
+ * with `make()` if none of that name is alive.
+ *
+ * There is one registry per `T`, holding weak references only: an instance
+ * is destroyed with its last user, and the next `acquire_shared()` of its
+ * name creates a new one. Instantiate it in a single library, the registry
+ * lives in its function local statics.
+ */
+template <typename T, typename MakeT>
+std::shared_ptr<T> acquire_shared(const std::string& name, MakeT&& make)
+{
+  static std::mutex registry_mutex;
+  static std::map<std::string, std::weak_ptr<T>> registry;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto it = registry.begin(); it != registry.end();)
+  {
+    it = it->second.expired() && it->first != name ? registry.erase(it) : std::next(it);
+  }
+
+  auto& entry = registry[name];
+  auto instance = entry.lock();
+  if (!instance)
+  {
+    instance = make();
+    entry = instance;
+  }
+  return instance;
+}
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_SHARED_REGISTRY_HPP_
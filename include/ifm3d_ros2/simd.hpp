@@ -0,0 +1,36 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_SIMD_HPP_
+#define IFM3D_ROS2_SIMD_HPP_
+
+//
+// Helpers for the per-pixel kernels. Rather than hand-written intrinsics for
+// each target (x86 hosts and the aarch64 VPU), kernels are written as
+// branch-free loops over contiguous arrays and annotated so that the compiler
+// vectorizes them for whatever the target supports. The `omp simd` pragma
+// needs `-fopenmp-simd` (no OpenMP runtime involved), which the build sets for
+// the targets containing kernels.
+//
+// `std::sqrt()` only vectorizes without `errno` (`-fno-math-errno`), which the
+// build sets per source file: add the files of new kernels calling it there.
+//
+// Floating point reductions (sums) only vectorize with an explicit
+// `reduction` clause, e.g., `IFM3D_ROS2_PRAGMA_SIMD_REDUCTION(+ : sum)`.
+//
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IFM3D_ROS2_RESTRICT __restrict__
+#define IFM3D_ROS2_PRAGMA(x) _Pragma(#x)
+#define IFM3D_ROS2_PRAGMA_SIMD _Pragma("omp simd")
+#define IFM3D_ROS2_PRAGMA_SIMD_REDUCTION(...) IFM3D_ROS2_PRAGMA(omp simd reduction(__VA_ARGS__))
+#else
+#define IFM3D_ROS2_RESTRICT
+#define IFM3D_ROS2_PRAGMA_SIMD
+#define IFM3D_ROS2_PRAGMA_SIMD_REDUCTION(...)
+#endif
+
+#endif  // IFM3D_ROS2_SIMD_HPP_
@@ -0,0 +1,159 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_SNAPSHOT_HPP_
+#define IFM3D_ROS2_SNAPSHOT_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ifm3d_ros2
+{
+/**
+ * Immutable value published by a `SnapshotCell`, numbered from 1 on.
+ */
+template <typename T>
+struct Snapshot
+{
+  std::uint64_t version;
+  T value;
+};
+
+/**
+ * Hands values from any number of writers to a single reader thread, e.g.,
+ * parameters changed on the executor to the publish loop (RCU-style).
+ *
+ * Writers copy the current value, change it and swap the copy in, one at a
+ * time. The reader pins the current snapshot with two atomic stores and
+ * loads, never taking a lock nor waiting for a writer: it sees every field
+ * of one and the same version, for as long as it keeps it pinned.
+ *
+ * Replaced snapshots are freed by the next write, except for the one the
+ * reader still has pinned (a single hazard pointer), so at most one of them
+ * is kept around.
+ */
+template <typename T>
+class SnapshotCell
+{
+public:
+  explicit SnapshotCell(T value = T()) : current_(new Snapshot<T>{ 1, std::move(value) })
+  {
+  }
+
+  ~SnapshotCell()
+  {
+    for (const auto* snapshot : this->retired_)
+    {
+      delete snapshot;
+    }
+    delete this->current_.load();
+  }
+
+  SnapshotCell(const SnapshotCell&) = delete;
+  SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+  /**
+   * Replaces the value. Returns the new version.
+   */
+  std::uint64_t store(T value)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    return this->swap(std::move(value));
+  }
+
+  /**
+   * Calls `modify(T&)` on a copy of the current value, then publishes the
+   * copy, so that concurrent updates of different fields do not get lost.
+   * Returns the new version.
+   */
+  template <typename F>
+  std::uint64_t update(F&& modify)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    T value = this->current_.load()->value;
+    modify(value);
+    return this->swap(std::move(value));
+  }
+
+  /**
+   * Copy of the current snapshot, for threads other than the reader.
+   */
+  Snapshot<T> copy() const
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    return *this->current_.load();
+  }
+
+  /**
+   * Pins the current snapshot and returns it; the reader thread only. It stays
+   * valid until the next `pin()` or `unpin()`.
+   */
+  const Snapshot<T>& pin()
+  {
+    const Snapshot<T>* snapshot = this->current_.load();
+    while (true)
+    {
+      this->hazard_.store(snapshot);
+      // still current once announced: no writer can free it from now on
+      const Snapshot<T>* current = this->current_.load();
+      if (current == snapshot)
+      {
+        return *snapshot;
+      }
+      snapshot = current;
+    }
+  }
+
+  /**
+   * Releases the pinned snapshot (if any).
+   */
+  void unpin()
+  {
+    this->hazard_.store(nullptr);
+  }
+
+private:
+  // under `mutex_`
+  std::uint64_t swap(T value)
+  {
+    const auto* previous = this->current_.load();
+    const auto version = previous->version + 1;
+    this->current_.store(new Snapshot<T>{ version, std::move(value) });
+    this->retired_.push_back(previous);
+
+    const auto* pinned = this->hazard_.load();
+    std::size_t kept = 0;
+    for (const auto* snapshot : this->retired_)
+    {
+      if (snapshot == pinned)
+      {
+        this->retired_[kept++] = snapshot;
+      }
+      else
+      {
+        delete snapshot;
+      }
+    }
+    this->retired_.resize(kept);
+    return version;
+  }
+
+  // sequentially consistent throughout: the reader's store to `hazard_` and
+  // the writer's store to `current_` must not pass the loads that follow them
+  std::atomic<const Snapshot<T>*> current_;
+  std::atomic<const Snapshot<T>*> hazard_{};
+
+  mutable std::mutex mutex_{};
+  std::vector<const Snapshot<T>*> retired_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_SNAPSHOT_HPP_
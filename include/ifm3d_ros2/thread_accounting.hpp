@@ -0,0 +1,144 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_THREAD_ACCOUNTING_HPP_
+#define IFM3D_ROS2_THREAD_ACCOUNTING_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <time.h>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Process-wide map of kernel thread ids to the role they play in the driver
+ * (e.g., "/ifm3d/camera/publish_loop").
+ *
+ * Threads register themselves by calling `tag()`. A thread can play several
+ * roles (e.g., an executor thread serving both services and timers), in which
+ * case the roles are accumulated.
+ */
+class IFM3D_ROS2_PUBLIC ThreadRegistry
+{
+public:
+  static ThreadRegistry& instance();
+
+  /**
+   * Associates `role` with the calling thread. Optionally sets the kernel
+   * name of the thread (truncated to 15 characters).
+   */
+  void tag(const std::string& role, const std::string& thread_name = "");
+
+  /**
+   * Roles of thread `tid`, empty if the thread never tagged itself.
+   */
+  std::string role(pid_t tid);
+
+  /**
+   * Forgets about threads that no longer exist.
+   */
+  void prune(const std::vector<pid_t>& alive);
+
+  static pid_t current_tid();
+
+private:
+  ThreadRegistry() = default;
+
+  std::mutex mutex_{};
+  std::map<pid_t, std::string> roles_{};
+};
+
+/**
+ * CPU time consumed by the calling thread (nanoseconds).
+ */
+inline std::uint64_t thread_cpu_nanos()
+{
+  timespec ts{};
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<std::uint64_t>(ts.tv_nsec);
+}
+
+/**
+ * Figures of a single thread of this process.
+ */
+struct ThreadSample
+{
+  pid_t tid{};
+  std::string name{};
+  std::string role{};
+  double cpu_time{};  // seconds, since the thread started
+  double cpu_load{};  // fraction of one core since the previous sample
+  std::uint64_t voluntary_ctx_switches{};
+  std::uint64_t involuntary_ctx_switches{};
+};
+
+/**
+ * Figures of the whole process plus each of its threads.
+ */
+struct ResourceSample
+{
+  double period{};            // seconds covered by the `cpu_load` figures
+  double process_cpu_load{};  // sum over all threads (1.0 == one core)
+  std::uint64_t rss_bytes{};
+  std::uint64_t heap_in_use_bytes{};
+  std::vector<ThreadSample> threads{};
+};
+
+/**
+ * Samples per-thread CPU time (from `/proc/self/task/<tid>/stat`, so with the
+ * resolution of a clock tick), context switches and the memory usage of the
+ * process.
+ *
+ * Each instance keeps the previous sample to derive loads, so every consumer
+ * should own its own sampler. Only reads `/proc/self`, it never interacts
+ * with the threads being measured.
+ */
+class IFM3D_ROS2_PUBLIC ResourceSampler
+{
+public:
+  ResourceSample sample();
+
+private:
+  std::chrono::steady_clock::time_point last_wall_{};
+  std::map<pid_t, double> last_cpu_time_{};
+};
+
+/**
+ * Samples the load of the whole host from `/proc/stat`: the fraction of the
+ * time all cores spent busy (i.e., neither idle nor waiting for I/O) since
+ * the previous sample.
+ */
+class IFM3D_ROS2_PUBLIC HostCpuSampler
+{
+public:
+  /**
+   * `stat_path` in the format of `/proc/stat`, for the tests.
+   */
+  explicit HostCpuSampler(std::string stat_path = "/proc/stat");
+
+  /**
+   * Busy fraction of all cores, 0 .. 1, 0 on the first call or if
+   * `/proc/stat` cannot be read.
+   */
+  double sample();
+
+private:
+  std::string stat_path_;
+  std::uint64_t last_busy_{};
+  std::uint64_t last_total_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_THREAD_ACCOUNTING_HPP_
@@ -0,0 +1,112 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_TOPIC_SCHEDULE_HPP_
+#define IFM3D_ROS2_TOPIC_SCHEDULE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Topics the publish loop converts from every frame, in the order of their
+ * default priority (see `frame_topic_names()`).
+ */
+enum class FrameTopic : std::size_t
+{
+  CLOUD,
+  DISTANCE,
+  CONFIDENCE,  // with the `~/confidence/*` masks
+  AMPLITUDE,   // with its preview
+  RGB,
+  DISTANCE_NOISE,
+  RAW_AMPLITUDE,
+};
+
+constexpr std::size_t num_frame_topics = 7;
+
+/**
+ * Topic name (relative to the node) of `topic`, e.g., "raw_amplitude".
+ */
+IFM3D_ROS2_PUBLIC
+const char* frame_topic_name(FrameTopic topic);
+
+/**
+ * Looks up a topic by its name. Returns `false` for unknown names.
+ */
+IFM3D_ROS2_PUBLIC
+bool frame_topic_from_name(const std::string& name, FrameTopic& topic);
+
+/**
+ * Names of all topics, most important first.
+ */
+IFM3D_ROS2_PUBLIC
+std::vector<std::string> frame_topic_names();
+
+/**
+ * Decides, topic by topic, what the publish loop still converts from a frame.
+ *
+ * Topics go out most important first. Each has a deadline, relative to the
+ * reception of the frame: a topic whose expected cost (a moving average of
+ * its conversion and publication) would end past its deadline is skipped for
+ * this frame. Skipping lowers the expected cost a bit, so a skipped topic is
+ * tried again once the load goes down rather than being starved for good.
+ */
+class IFM3D_ROS2_PUBLIC TopicScheduler
+{
+public:
+  TopicScheduler();
+
+  /**
+   * Sets the order (`priorities`, most important first, topics left out
+   * follow in their default order) and the deadlines (seconds, by
+   * `FrameTopic`, `<= 0` for none).
+   */
+  void configure(const std::vector<FrameTopic>& priorities, const std::array<double, num_frame_topics>& deadlines);
+
+  /**
+   * All topics, most important first.
+   */
+  const std::array<FrameTopic, num_frame_topics>& order() const
+  {
+    return this->order_;
+  }
+
+  /**
+   * Whether `topic` still fits into its deadline, `elapsed` seconds after the
+   * frame was received. Lowers the expected cost of `topic` if not.
+   */
+  bool admit(FrameTopic topic, double elapsed);
+
+  /**
+   * Accounts the time `topic` took (seconds) to its expected cost.
+   */
+  void account(FrameTopic topic, double cost);
+
+  double deadline(FrameTopic topic) const
+  {
+    return this->deadlines_[static_cast<std::size_t>(topic)];
+  }
+
+  double expected_cost(FrameTopic topic) const
+  {
+    return this->costs_[static_cast<std::size_t>(topic)];
+  }
+
+private:
+  std::array<FrameTopic, num_frame_topics> order_{};
+  std::array<double, num_frame_topics> deadlines_{};
+  std::array<double, num_frame_topics> costs_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_TOPIC_SCHEDULE_HPP_
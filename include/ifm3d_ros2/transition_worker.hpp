@@ -0,0 +1,152 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_TRANSITION_WORKER_HPP_
+#define IFM3D_ROS2_TRANSITION_WORKER_HPP_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Lifecycle transitions a node requests of itself, e.g., from its publish
+ * loop, which must not run them in place.
+ */
+enum class TransitionRequest : std::size_t
+{
+  DEACTIVATE,   // the head stopped delivering frames (or failed)
+  RECONFIGURE,  // a parameter changed that only takes effect on configuration
+};
+
+constexpr std::size_t num_transition_requests = 2;
+
+/**
+ * Name of `request`, e.g., "reconfigure".
+ */
+IFM3D_ROS2_PUBLIC
+const char* transition_request_name(TransitionRequest request);
+
+/**
+ * Lifecycle transition a node runs for a request.
+ */
+enum class TransitionStep
+{
+  NONE,  // nothing (left) to do from the current state
+  DEACTIVATE,
+  CLEANUP,
+};
+
+/**
+ * The transition `request` calls for in the state `state_id` (of
+ * `lifecycle_msgs::msg::State`): a deactivation only while active, a
+ * reconfiguration deactivates an active node and cleans up an inactive one.
+ * Nothing from any other state, e.g., a request that another one got ahead
+ * of.
+ */
+IFM3D_ROS2_PUBLIC
+TransitionStep transition_step(TransitionRequest request, std::uint8_t state_id);
+
+/**
+ * Timings of a transition run by the `TransitionWorker`.
+ */
+struct TransitionTiming
+{
+  TransitionRequest request{};
+  double wait_seconds{};      // from the (first) request to the start of the transition
+  double run_seconds{};       // of the transition itself
+  std::uint64_t coalesced{};  // requests merged into this one while it was queued
+  bool ok{};
+};
+
+/**
+ * Runs the lifecycle transitions a node requests of itself on a thread of its
+ * own, one at a time.
+ *
+ * Requests queue up in the order they came in. A request of a kind that is
+ * already queued (and did not start yet) is merged into it, so a burst of
+ * faults costs a single transition. A request arriving while the same kind
+ * runs is queued again: the state may have changed in the meantime, the
+ * handler decides whether there is anything left to do.
+ */
+class IFM3D_ROS2_PUBLIC TransitionWorker
+{
+public:
+  /**
+   * Runs the transition, returns whether it succeeded. Exceptions count as a
+   * failure.
+   */
+  using Handler = std::function<bool(TransitionRequest)>;
+
+  /**
+   * Called on the worker thread after each transition.
+   */
+  using Observer = std::function<void(const TransitionTiming&)>;
+
+  /**
+   * `on_start` (if set) runs first on the worker thread.
+   */
+  explicit TransitionWorker(Handler handler, Observer observer = {}, std::function<void()> on_start = {});
+
+  /**
+   * Stops, then waits for the running transition (if any) to finish. Must not
+   * be called from the handler.
+   */
+  ~TransitionWorker();
+
+  TransitionWorker(const TransitionWorker&) = delete;
+  TransitionWorker& operator=(const TransitionWorker&) = delete;
+
+  /**
+   * Queues `request`. Returns `false` if it was merged into a queued one or
+   * if the worker is stopped. Never blocks on a running transition, so it is
+   * safe to call from the handler and from the threads a transition joins.
+   */
+  bool request(TransitionRequest request);
+
+  /**
+   * Drops the queued requests and refuses new ones. Does not wait for the
+   * running transition, which may need the caller (e.g., a transition of the
+   * node itself) to finish.
+   */
+  void stop();
+
+  /**
+   * Waits until nothing is queued or running. Returns `false` on timeout.
+   */
+  bool wait_idle(std::chrono::milliseconds timeout);
+
+private:
+  void run(const std::function<void()>& on_start);
+
+  using Clock = std::chrono::steady_clock;
+
+  Handler handler_;
+  Observer observer_;
+
+  std::mutex mutex_{};
+  std::condition_variable cv_{};
+  std::condition_variable idle_cv_{};
+  std::deque<TransitionRequest> queue_{};  // every kind at most once
+  std::array<Clock::time_point, num_transition_requests> requested_at_{};
+  std::array<std::uint64_t, num_transition_requests> coalesced_{};
+  bool running_{};
+  bool stop_{};
+  std::thread thread_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_TRANSITION_WORKER_HPP_
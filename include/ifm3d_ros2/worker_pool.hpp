@@ -0,0 +1,127 @@
+// -*- c++ -*-
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#ifndef IFM3D_ROS2_WORKER_POOL_HPP_
+#define IFM3D_ROS2_WORKER_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ifm3d_ros2/visibility_control.h>
+
+namespace ifm3d_ros2
+{
+/**
+ * Fixed set of threads splitting data parallel loops (e.g., over the rows or
+ * points of a frame) between them.
+ *
+ * The pool is meant for the processing stages of a single head, which run
+ * one at a time: `parallel_for()` is not reentrant and must only be called
+ * from one thread at a time.
+ */
+class IFM3D_ROS2_PUBLIC WorkerPool
+{
+public:
+  /**
+   * Starts `num_threads` workers in addition to the calling thread of
+   * `parallel_for()`. `on_start` (if set) runs first on every worker, e.g.,
+   * to tag it in the `ThreadRegistry`.
+   */
+  explicit WorkerPool(std::size_t num_threads, std::function<void()> on_start = {});
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /**
+   * Number of threads taking part in a `parallel_for()`, including the caller.
+   */
+  std::size_t concurrency() const
+  {
+    return this->workers_.size() + 1;
+  }
+
+  /**
+   * Calls `fn(begin, end)` on `concurrency()` contiguous chunks of `[0, n)`
+   * in parallel and blocks until all of them returned. The caller processes
+   * the first chunk. Rethrows the first exception thrown by `fn`.
+   */
+  void parallel_for(std::size_t n, const std::function<void(std::size_t, std::size_t)>& fn);
+
+  /**
+   * Same as `parallel_for()`, but passes the index of the chunk as well, i.e.,
+   * calls `fn(chunk, begin, end)`, e.g., to accumulate into per-chunk partial
+   * results. Returns the number of chunks: `concurrency()`, 1 for small `n`
+   * and 0 for an empty range.
+   */
+  std::size_t parallel_chunks(std::size_t n, const std::function<void(std::size_t, std::size_t, std::size_t)>& fn);
+
+private:
+  void run(std::size_t index, const std::function<void()>& on_start);
+  void run_chunk(std::size_t index);
+
+  std::vector<std::thread> workers_{};
+
+  std::mutex mutex_{};
+  std::condition_variable start_cv_{};
+  std::condition_variable done_cv_{};
+  const std::function<void(std::size_t, std::size_t, std::size_t)>* job_{};
+  std::size_t job_size_{};
+  std::uint64_t generation_{};
+  std::size_t pending_{};
+  std::exception_ptr error_{};
+  bool stop_{};
+};
+
+/**
+ * Runs jobs on a dedicated thread, keeping only the most recent one queued.
+ *
+ * Frame processing stages hand their work to it so that they never delay the
+ * publish loop: when a stage falls behind, stale frames are dropped instead
+ * of queued.
+ */
+class IFM3D_ROS2_PUBLIC LatestJobWorker
+{
+public:
+  /**
+   * `on_start` (if set) runs first on the worker thread.
+   */
+  explicit LatestJobWorker(std::function<void()> on_start = {});
+
+  /**
+   * Waits for the running job (if any) to finish, drops the queued one.
+   */
+  ~LatestJobWorker();
+
+  LatestJobWorker(const LatestJobWorker&) = delete;
+  LatestJobWorker& operator=(const LatestJobWorker&) = delete;
+
+  /**
+   * Queues `job`, replacing the queued job that did not start yet (if any).
+   * Returns `false` if a job was replaced, i.e., dropped. Jobs must not
+   * throw.
+   */
+  bool post(std::function<void()> job);
+
+private:
+  void run(const std::function<void()>& on_start);
+
+  std::mutex mutex_{};
+  std::condition_variable cv_{};
+  std::function<void()> queued_{};
+  bool stop_{};
+  std::thread thread_{};
+};
+
+}  // namespace ifm3d_ros2
+
+#endif  // IFM3D_ROS2_WORKER_POOL_HPP_
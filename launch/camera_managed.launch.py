@@ -37,6 +37,8 @@ def launch_setup(context, *args, **kwargs):
     node_name = LaunchConfiguration('name').perform(context)
     params = LaunchConfiguration('params').perform(context)
     node_namespace = LaunchConfiguration('namespace').perform(context)
+    executor = LaunchConfiguration('executor').perform(context)
+    threads = LaunchConfiguration('threads').perform(context)
 
     parameters.append(params)
 
@@ -57,6 +59,7 @@ def launch_setup(context, *args, **kwargs):
           output='screen',
           parameters=parameters,
           remappings=remaps,
+          arguments=['--executor', executor, '--threads', threads],
           log_cmd=True,
           )
 
@@ -222,5 +225,9 @@ def generate_launch_description():
         DeclareLaunchArgument('name', default_value = 'camera'),
         DeclareLaunchArgument('params', default_value = []),
         DeclareLaunchArgument('namespace', default_value = 'ifm3d'),
+        DeclareLaunchArgument('executor', default_value = 'multi',
+                              description = 'single, static, events or multi'),
+        DeclareLaunchArgument('threads', default_value = '0',
+                              description = 'threads of the multi executor, 0 == one per CPU'),
         OpaqueFunction(function = launch_setup)
         ])
@@ -4,19 +4,123 @@
  */
 
 #include <cstdio>
+#include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 #include <rclcpp/rclcpp.hpp>
 #include <ifm3d_ros2/camera_node.hpp>
 
+#if __has_include(<rclcpp/experimental/executors/events_executor/events_executor.hpp>)
+#include <rclcpp/experimental/executors/events_executor/events_executor.hpp>
+#define IFM3D_ROS2_HAS_EVENTS_EXECUTOR 1
+#endif
+
+namespace
+{
+void usage(const std::string& prog)
+{
+  std::cerr << "Usage: " << prog << " [--executor single|static|events|multi] [--threads N] [--ros-args ...]\n"
+            << "\n"
+            << "  --executor, -e  Executor spinning the camera node (default: multi)\n"
+            << "  --threads, -t   Number of threads of the `multi` executor (default: 0, i.e., one per CPU)\n";
+}
+
+std::shared_ptr<rclcpp::Executor> make_executor(const std::string& type, std::size_t num_threads,
+                                                const rclcpp::Logger& logger)
+{
+  if (type != "multi" && num_threads > 1)
+  {
+    RCLCPP_WARN(logger, "--threads %zu ignored by the `%s` executor", num_threads, type.c_str());
+  }
+
+  if (type == "single")
+  {
+    return std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  }
+  if (type == "static")
+  {
+    return std::make_shared<rclcpp::executors::StaticSingleThreadedExecutor>();
+  }
+  if (type == "events")
+  {
+#ifdef IFM3D_ROS2_HAS_EVENTS_EXECUTOR
+    return std::make_shared<rclcpp::experimental::executors::EventsExecutor>();
+#else
+    RCLCPP_ERROR(logger, "The `events` executor is not available in this ROS 2 distribution");
+    return nullptr;
+#endif
+  }
+  if (type == "multi")
+  {
+    return std::make_shared<rclcpp::executors::MultiThreadedExecutor>(rclcpp::ExecutorOptions(), num_threads);
+  }
+
+  RCLCPP_ERROR(logger, "Unknown executor type: %s", type.c_str());
+  return nullptr;
+}
+
+}  // namespace
+
 int main(int argc, char** argv)
 {
   std::setvbuf(stdout, NULL, _IONBF, BUFSIZ);
-  rclcpp::init(argc, argv);
-  rclcpp::executors::MultiThreadedExecutor exec;
+  const auto args = rclcpp::init_and_remove_ros_arguments(argc, argv);
+  const auto logger = rclcpp::get_logger("camera_standalone");
+
+  std::string executor_type = "multi";
+  std::size_t num_threads = 0;
+
+  for (std::size_t i = 1; i < args.size(); ++i)
+  {
+    const auto& arg = args[i];
+    const bool has_value = i + 1 < args.size();
+
+    if ((arg == "--executor" || arg == "-e") && has_value)
+    {
+      executor_type = args[++i];
+    }
+    else if ((arg == "--threads" || arg == "-t") && has_value)
+    {
+      // signed, `std::stoul` would wrap "-1" around to the largest count
+      long long value = -1;
+      try
+      {
+        value = std::stoll(args[++i]);
+      }
+      catch (const std::exception&)
+      {
+        // not a number, rejected below like a negative one
+      }
+      if (value < 0)
+      {
+        usage(args[0]);
+        rclcpp::shutdown();
+        return 1;
+      }
+      num_threads = static_cast<std::size_t>(value);
+    }
+    else
+    {
+      usage(args[0]);
+      rclcpp::shutdown();
+      return (arg == "--help" || arg == "-h") ? 0 : 1;
+    }
+  }
+
+  auto exec = make_executor(executor_type, num_threads, logger);
+  if (!exec)
+  {
+    rclcpp::shutdown();
+    return 1;
+  }
+  RCLCPP_INFO(logger, "executor: %s (threads: %zu)", executor_type.c_str(), num_threads);
+
   rclcpp::NodeOptions options;
   auto cam = std::make_shared<ifm3d_ros2::CameraNode>(options);
-  exec.add_node(cam->get_node_base_interface());
-  exec.spin();
+  exec->add_node(cam->get_node_base_interface());
+  ifm3d_ros2::ThreadRegistry::instance().tag("executor");
+  exec->spin();
 
   rclcpp::shutdown();
   return 0;
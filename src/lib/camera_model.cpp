@@ -0,0 +1,180 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/camera_model.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <ifm3d_ros2/sectors.hpp>
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+constexpr float pi = 3.14159265F;
+
+// closer than this (meters), points count as behind the imager
+constexpr float min_depth = 1e-4F;
+
+void project_bouguet(const std::array<float, 32>& p, const float* IFM3D_ROS2_RESTRICT x,
+                     const float* IFM3D_ROS2_RESTRICT y, const float* IFM3D_ROS2_RESTRICT z,
+                     float* IFM3D_ROS2_RESTRICT u, float* IFM3D_ROS2_RESTRICT v, std::size_t begin, std::size_t end)
+{
+  const float fx = p[0];
+  const float fy = p[1];
+  const float mx = p[2];
+  const float my = p[3];
+  const float alpha = p[4];
+  const float k1 = p[5];
+  const float k2 = p[6];
+  const float k3 = p[7];
+  const float k4 = p[8];
+  const float k5 = p[9];
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    // blended rather than selected, see `fast_atan2()`
+    const float front = z[i] > min_depth ? 1.0F : 0.0F;
+    const float zi = z[i] > min_depth ? z[i] : 1.0F;
+    const float xn = x[i] / zi;
+    const float yn = y[i] / zi;
+    const float r2 = xn * xn + yn * yn;
+    const float radial = 1.0F + r2 * (k1 + r2 * (k2 + r2 * k5));
+    const float h = 2.0F * xn * yn;
+    const float xd = xn * radial + k3 * h + k4 * (r2 + 2.0F * xn * xn);
+    const float yd = yn * radial + k3 * (r2 + 2.0F * yn * yn) + k4 * h;
+    u[i] = front * ((xd + alpha * yd) * fx + mx - 0.5F + 1.0F) - 1.0F;
+    v[i] = front * (yd * fy + my - 0.5F + 1.0F) - 1.0F;
+  }
+}
+
+void project_fisheye(const std::array<float, 32>& p, const float* IFM3D_ROS2_RESTRICT x,
+                     const float* IFM3D_ROS2_RESTRICT y, const float* IFM3D_ROS2_RESTRICT z,
+                     float* IFM3D_ROS2_RESTRICT u, float* IFM3D_ROS2_RESTRICT v, std::size_t begin, std::size_t end)
+{
+  const float fx = p[0];
+  const float fy = p[1];
+  const float mx = p[2];
+  const float my = p[3];
+  const float alpha = p[4];
+  const float k1 = p[5];
+  const float k2 = p[6];
+  const float k3 = p[7];
+  const float k4 = p[8];
+  const float theta_max = p[9];
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    // the fisheye model covers rays beyond 90 degrees, `theta_max` bounds it
+    // (arithmetic blends instead of selects, see `fast_atan2()`)
+    const float r2 = x[i] * x[i] + y[i] * y[i];
+    const float lxy = std::sqrt(r2);
+    const float theta = fast_atan2(lxy, z[i]);
+    const float front = (theta < theta_max ? 1.0F : 0.0F) * (r2 + z[i] * z[i] > 0.0F ? 1.0F : 0.0F);
+    const float phi = theta + (theta < theta_max ? 0.0F : 1.0F) * (theta_max - theta);
+    const float phi2 = phi * phi;
+    const float radial = 1.0F + phi2 * (k1 + phi2 * (k2 + phi2 * (k3 + phi2 * k4)));
+    const float scale = theta * radial / (lxy + 1e-30F);
+    const float xd = scale * x[i];
+    const float yd = scale * y[i];
+    u[i] = front * ((xd + alpha * yd) * fx + mx - 0.5F + 1.0F) - 1.0F;
+    v[i] = front * (yd * fy + my - 0.5F + 1.0F) - 1.0F;
+  }
+}
+
+}  // namespace
+
+bool is_supported_model(std::uint32_t model_id)
+{
+  return model_id == model_bouguet || model_id == model_fisheye;
+}
+
+std::array<float, 9> extrinsic_rotation(const std::array<float, 6>& extrinsics)
+{
+  const float cx = std::cos(extrinsics[3]);
+  const float sx = std::sin(extrinsics[3]);
+  const float cy = std::cos(extrinsics[4]);
+  const float sy = std::sin(extrinsics[4]);
+  const float cz = std::cos(extrinsics[5]);
+  const float sz = std::sin(extrinsics[5]);
+
+  // Rx * Ry * Rz
+  return { { cy * cz, -cy * sz, sy,                                     //
+             cx * sz + sx * sy * cz, cx * cz - sx * sy * sz, -sx * cy,  //
+             sx * sz - cx * sy * cz, sx * cz + cx * sy * sz, cx * cy } };
+}
+
+bool pixel_rays(const IntrinsicModel& inverse_intrinsics, std::uint32_t width, std::uint32_t height,
+                std::vector<float>& rays)
+{
+  if (!is_supported_model(inverse_intrinsics.model_id))
+  {
+    return false;
+  }
+
+  const auto& p = inverse_intrinsics.parameters;
+  const float fx = p[0];
+  const float fy = p[1];
+  const float mx = p[2];
+  const float my = p[3];
+  const float alpha = p[4];
+
+  // computed once per calibration, so plainly
+  rays.resize(static_cast<std::size_t>(width) * height * 3);
+  auto* ray = rays.data();
+  for (std::uint32_t row = 0; row < height; ++row)
+  {
+    for (std::uint32_t col = 0; col < width; ++col, ray += 3)
+    {
+      const float cy = (static_cast<float>(row) + 0.5F - my) / fy;
+      const float cx = (static_cast<float>(col) + 0.5F - mx) / fx - alpha * cy;
+
+      if (inverse_intrinsics.model_id == model_bouguet)
+      {
+        const float r2 = cx * cx + cy * cy;
+        const float radial = 1.0F + r2 * (p[5] + r2 * (p[6] + r2 * p[9]));
+        const float h = 2.0F * cx * cy;
+        const float dx = radial * cx + p[7] * h + p[8] * (r2 + 2.0F * cx * cx);
+        const float dy = radial * cy + p[7] * (r2 + 2.0F * cy * cy) + p[8] * h;
+        const float norm = 1.0F / std::sqrt(dx * dx + dy * dy + 1.0F);
+        ray[0] = dx * norm;
+        ray[1] = dy * norm;
+        ray[2] = norm;
+      }
+      else
+      {
+        const float theta_s = std::sqrt(cx * cx + cy * cy);
+        const float phi = std::min(theta_s, p[9]);
+        const float phi2 = phi * phi;
+        const float radial = 1.0F + phi2 * (p[5] + phi2 * (p[6] + phi2 * (p[7] + phi2 * p[8])));
+        const float theta = std::clamp(theta_s * radial, 0.0F, pi);
+        const float s = theta_s > 0.0F ? std::sin(theta) / theta_s : 0.0F;
+        ray[0] = s * cx;
+        ray[1] = s * cy;
+        ray[2] = std::cos(theta);
+      }
+    }
+  }
+  return true;
+}
+
+void project_points(const IntrinsicModel& model, const float* x, const float* y, const float* z, float* u, float* v,
+                    std::size_t begin, std::size_t end)
+{
+  if (model.model_id == model_fisheye)
+  {
+    project_fisheye(model.parameters, x, y, z, u, v, begin, end);
+  }
+  else
+  {
+    project_bouguet(model.parameters, x, y, z, u, v, begin, end);
+  }
+}
+
+}  // namespace ifm3d_ros2
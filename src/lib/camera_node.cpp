@@ -5,182 +5,120 @@
 
 #include <ifm3d_ros2/camera_node.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <functional>
 #include <exception>
 #include <iostream>
+#include <limits>
 
 #include <lifecycle_msgs/msg/state.hpp>
-#include <sensor_msgs/image_encodings.hpp>
+#include <tf2/exceptions.h>
 
+#include <ifm3d_ros2/conversions.hpp>
 #include <ifm3d_ros2/qos.hpp>
 
 #include <ifm3d/contrib/nlohmann/json.hpp>
+#include <ifm3d/deserialize/struct_rgb_info_v1.hpp>
+#include <ifm3d/deserialize/struct_tof_info_v4.hpp>
 
-sensor_msgs::msg::Image ifm3d_to_ros_image(ifm3d::Buffer& image,  // Need non-const image because image.begin(),
-                                                                 // image.end() don't have const overloads.
-                                           const std_msgs::msg::Header& header, const rclcpp::Logger& logger)
-{
-  static constexpr auto max_pixel_format = static_cast<std::size_t>(ifm3d::pixel_format::FORMAT_32F3);
-  static constexpr auto image_format_info = [] {
-    auto image_format_info = std::array<const char*, max_pixel_format + 1>{};
-
-    {
-      using namespace ifm3d;
-      using namespace sensor_msgs::image_encodings;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_8U)] = TYPE_8UC1;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_8S)] = TYPE_8SC1;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_16U)] = TYPE_16UC1;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_16S)] = TYPE_16SC1;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_32U)] = "32UC1";
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_32S)] = TYPE_32SC1;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_32F)] = TYPE_32FC1;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_64U)] = "64UC1";
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_64F)] = TYPE_64FC1;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_16U2)] = TYPE_16UC2;
-      image_format_info[static_cast<std::size_t>(pixel_format::FORMAT_32F3)] = TYPE_32FC3;
-    }
-
-    return image_format_info;
-  }();
-
-  const auto format = static_cast<std::size_t>(image.dataFormat());
-
-  sensor_msgs::msg::Image result{};
-  result.header = header;
-  result.height = image.height();
-  result.width = image.width();
-  result.is_bigendian = 0;
-
-  if (image.begin<std::uint8_t>() == image.end<std::uint8_t>())
-  {
-    return result;
-  }
-
-  if (format >= max_pixel_format)
-  {
-    RCLCPP_ERROR(logger, "Pixel format out of range (%ld >= %ld)", format, max_pixel_format);
-    return result;
-  }
+using json = nlohmann::json;
+using namespace std::chrono_literals;
 
-  result.encoding = image_format_info.at(format);
-  result.step = result.width * sensor_msgs::image_encodings::bitDepth(image_format_info.at(format)) / 8;
-  result.data.insert(result.data.end(), image.ptr<>(0), std::next(image.ptr<>(0), result.step * result.height));
+namespace ifm3d_ros2
+{
+namespace
+{
+constexpr auto xmlrpc_base_port = 50010;
+// PCIC ports of a VPU: `port0` .. `port7` listen on 50010 .. 50017
+constexpr auto max_port_index = 7;
 
-  if (result.encoding.empty())
-  {
-    RCLCPP_WARN(logger, "Can't handle encoding %ld (32U == %ld, 64U == %ld)", format,
-                static_cast<std::size_t>(ifm3d::pixel_format::FORMAT_32U),
-                static_cast<std::size_t>(ifm3d::pixel_format::FORMAT_64U));
-    result.encoding = sensor_msgs::image_encodings::TYPE_8UC1;
-  }
+// `PowerState` results besides the ifm3d error codes
+constexpr std::int32_t power_state_not_active = -1;
+constexpr std::int32_t power_state_bad_request = -3;
+constexpr std::int32_t power_state_no_connection = -4;
+constexpr std::int32_t power_state_failed = -5;
 
-  return result;
-}
+// a 2D head keeps handing its frames to the registering heads for this long
+// after the last request
+constexpr std::int64_t color_request_window_nanos = 1000000000;
 
-sensor_msgs::msg::Image ifm3d_to_ros_image(ifm3d::Buffer&& image, const std_msgs::msg::Header& header,
-                                           const rclcpp::Logger& logger)
+/**
+ * Calibration of an imager from its deserialized `TOF_INFO` / `RGB_INFO`.
+ */
+template <typename InfoT>
+OpticCalibration to_optic_calibration(const InfoT& info)
 {
-  return ifm3d_to_ros_image(image, header, logger);
+  const auto copy_model = [](const auto& src, IntrinsicModel& dst) {
+    dst.model_id = src.model_id;
+    std::copy_n(src.model_parameters.begin(), std::min(src.model_parameters.size(), dst.parameters.size()),
+                dst.parameters.begin());
+  };
+
+  OpticCalibration calibration;
+  copy_model(info.intrinsic_calibration, calibration.intrinsics);
+  copy_model(info.inverse_intrinsic_calibration, calibration.inverse_intrinsics);
+  const auto& pose = info.extrinsic_optic_to_user;
+  calibration.extrinsics = { { pose.trans_x, pose.trans_y, pose.trans_z, pose.rot_x, pose.rot_y, pose.rot_z } };
+  return calibration;
 }
 
-sensor_msgs::msg::CompressedImage ifm3d_to_ros_compressed_image(ifm3d::Buffer& image,  // Need non-const image because
-                                                                                      // image.begin(), image.end()
-                                                                                      // don't have const overloads.
-                                                                const std_msgs::msg::Header& header,
-                                                                const std::string& format,  // "jpeg" or "png"
-                                                                const rclcpp::Logger& logger)
+/**
+ * The `ports` section of a configuration update switching the ports (by
+ * index) to `state`.
+ */
+std::string port_states_json(const std::vector<int>& port_indices, const std::string& state)
 {
-  sensor_msgs::msg::CompressedImage result{};
-  result.header = header;
-  result.format = format;
-
-  if (const auto dataFormat = image.dataFormat();
-      dataFormat != ifm3d::pixel_format::FORMAT_8S && dataFormat != ifm3d::pixel_format::FORMAT_8U)
+  json ports = json::object();
+  for (const auto idx : port_indices)
   {
-    RCLCPP_ERROR(logger, "Invalid data format for %s data (%ld)", format.c_str(), static_cast<std::size_t>(dataFormat));
-    return result;
+    ports["port" + std::to_string(idx)]["state"] = state;
   }
-
-  result.data.insert(result.data.end(), image.ptr<>(0), std::next(image.ptr<>(0), image.width() * image.height()));
-  return result;
+  return json{ { "ports", ports } }.dump();
 }
 
-sensor_msgs::msg::CompressedImage ifm3d_to_ros_compressed_image(ifm3d::Buffer&& image,
-                                                                const std_msgs::msg::Header& header,
-                                                                const std::string& format, const rclcpp::Logger& logger)
+std::int64_t steady_nanos()
 {
-  return ifm3d_to_ros_compressed_image(image, header, format, logger);
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
 }
 
-sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud(ifm3d::Buffer& image,  // Need non-const image because image.begin(),
-                                                                       // image.end() don't have const overloads.
-                                                 const std_msgs::msg::Header& header, const rclcpp::Logger& logger)
+/**
+ * Converts a buffer to a ROS message via `convert` and publishes it,
+ * accounting the time spent in either stage to `metrics`.
+ */
+template <typename PublisherT, typename ConvertT>
+void convert_and_publish(const PublisherT& pub, ConvertT&& convert, HeadMetrics& metrics)
 {
-  sensor_msgs::msg::PointCloud2 result{};
-  result.header = header;
-  result.height = image.height();
-  result.width = image.width();
-  result.is_bigendian = false;
-
-  if (image.begin<std::uint8_t>() == image.end<std::uint8_t>())
-  {
-    return result;
-  }
-
-  if (image.dataFormat() != ifm3d::pixel_format::FORMAT_32F3 && image.dataFormat() != ifm3d::pixel_format::FORMAT_32F)
-  {
-    RCLCPP_ERROR(logger, "Unsupported pixel format %ld for point cloud", static_cast<std::size_t>(image.dataFormat()));
-    return result;
-  }
-
-  sensor_msgs::msg::PointField x_field{};
-  x_field.name = "x";
-  x_field.offset = 0;
-  x_field.datatype = sensor_msgs::msg::PointField::FLOAT32;
-  x_field.count = 1;
-
-  sensor_msgs::msg::PointField y_field{};
-  y_field.name = "y";
-  y_field.offset = 4;
-  y_field.datatype = sensor_msgs::msg::PointField::FLOAT32;
-  y_field.count = 1;
-
-  sensor_msgs::msg::PointField z_field{};
-  z_field.name = "z";
-  z_field.offset = 8;
-  z_field.datatype = sensor_msgs::msg::PointField::FLOAT32;
-  z_field.count = 1;
-
-  result.fields = {
-    x_field,
-    y_field,
-    z_field,
-  };
-
-  result.point_step = result.fields.size() * sizeof(float);
-  result.row_step = result.point_step * result.width;
-  result.is_dense = true;
-  result.data.insert(result.data.end(), image.ptr<>(0), std::next(image.ptr<>(0), result.row_step * result.height));
-
-  return result;
+  const auto cpu_convert = thread_cpu_nanos();
+  const auto t_convert = std::chrono::steady_clock::now();
+  const auto msg = convert();
+  metrics.conversion_seconds.observe_since(t_convert);
+
+  const auto cpu_publish = thread_cpu_nanos();
+  const auto t_publish = std::chrono::steady_clock::now();
+  pub->publish(msg);
+  metrics.publish_seconds.observe_since(t_publish);
+
+  const auto cpu_done = thread_cpu_nanos();
+  metrics.conversion_cpu_nanos.inc(cpu_publish - cpu_convert);
+  metrics.publish_cpu_nanos.inc(cpu_done - cpu_publish);
 }
 
-sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud(ifm3d::Buffer&& image, const std_msgs::msg::Header& header,
-                                                 const rclcpp::Logger& logger)
+/**
+ * Converts and publishes a message off the per-frame topics of the publish
+ * loop (i.e., of a processing stage), accounting the whole round trip to
+ * `seconds` only.
+ */
+template <typename PublisherT, typename ConvertT>
+void convert_and_publish(const PublisherT& pub, ConvertT&& convert, Histogram& seconds)
 {
-  return ifm3d_to_ros_cloud(image, header, logger);
+  const auto t_start = std::chrono::steady_clock::now();
+  pub->publish(convert());
+  seconds.observe_since(t_start);
 }
 
-using json = nlohmann::json;
-using namespace std::chrono_literals;
-
-namespace ifm3d_ros2
-{
-namespace
-{
-constexpr auto xmlrpc_base_port = 50010;
-
 }  // namespace
 
 CameraNode::CameraNode(const rclcpp::NodeOptions& opts) : CameraNode::CameraNode("camera", opts)
@@ -202,6 +140,8 @@ CameraNode::CameraNode(const std::string& node_name, const rclcpp::NodeOptions&
   RCLCPP_INFO(this->logger_, "camera frame: %s", this->camera_frame_.c_str());
   RCLCPP_INFO(this->logger_, "optical frame: %s", this->optical_frame_.c_str());
 
+  this->metrics_ = MetricsRegistry::instance().register_head(this->get_fully_qualified_name(), frame_topic_names());
+
   // declare our parameters and default values -- parameters defined in
   // the passed in `opts` (via __params:=/path/to/params.yaml on cmd line)
   // will override our default values specified.
@@ -214,13 +154,39 @@ CameraNode::CameraNode(const std::string& node_name, const rclcpp::NodeOptions&
   // Set up our publishers.
   //
   this->conf_pub_ = this->create_publisher<ImageMsg>("~/confidence", ifm3d_ros2::LowLatencyQoS());
+  for (std::size_t mask = 0; mask < num_confidence_masks; ++mask)
+  {
+    this->conf_mask_pubs_[mask] = this->create_publisher<ImageMsg>(
+        std::string("~/confidence/") + confidence_mask_name(static_cast<ConfidenceMask>(mask)),
+        ifm3d_ros2::LowLatencyQoS());
+  }
   this->distance_pub_ = this->create_publisher<ImageMsg>("~/distance", ifm3d_ros2::LowLatencyQoS());
+  this->distance_noise_pub_ = this->create_publisher<ImageMsg>("~/distance_noise", ifm3d_ros2::LowLatencyQoS());
   this->amplitude_pub_ = this->create_publisher<ImageMsg>("~/amplitude", ifm3d_ros2::LowLatencyQoS());
   this->raw_amplitude_pub_ = this->create_publisher<ImageMsg>("~/raw_amplitude", ifm3d_ros2::LowLatencyQoS());
   this->cloud_pub_ = this->create_publisher<PCLMsg>("~/cloud", ifm3d_ros2::LowLatencyQoS());
   this->extrinsics_pub_ = this->create_publisher<ExtrinsicsMsg>("~/extrinsics", ifm3d_ros2::LowLatencyQoS());
 
   this->rgb_pub_ = this->create_publisher<CompressedImageMsg>("~/rgb", ifm3d_ros2::LowLatencyQoS());
+  this->distance_preview_pub_ =
+      this->create_publisher<CompressedImageMsg>("~/distance_preview/compressed", ifm3d_ros2::LowLatencyQoS());
+  this->amplitude_preview_pub_ =
+      this->create_publisher<CompressedImageMsg>("~/amplitude_preview/compressed", ifm3d_ros2::LowLatencyQoS());
+  this->distance_tiles_pub_ = this->create_publisher<DepthTilesMsg>("~/distance_tiles", ifm3d_ros2::LowLatencyQoS());
+  this->sectors_pub_ = this->create_publisher<SectorSummaryMsg>("~/sectors", ifm3d_ros2::LowLatencyQoS());
+  this->cloud_ground_pub_ = this->create_publisher<PCLMsg>("~/cloud_ground", ifm3d_ros2::LowLatencyQoS());
+  this->cloud_obstacles_pub_ = this->create_publisher<PCLMsg>("~/cloud_obstacles", ifm3d_ros2::LowLatencyQoS());
+  this->ground_plane_pub_ = this->create_publisher<GroundPlaneMsg>("~/ground_plane", ifm3d_ros2::LowLatencyQoS());
+  this->rgb_registered_pub_ = this->create_publisher<ImageMsg>("~/rgb_registered", ifm3d_ros2::LowLatencyQoS());
+  this->rgb_rect_pub_ = this->create_publisher<ImageMsg>("~/rgb_rect", ifm3d_ros2::LowLatencyQoS());
+  this->rgb_rect_info_pub_ =
+      this->create_publisher<CameraInfoMsg>("~/rgb_rect/camera_info", ifm3d_ros2::LowLatencyQoS());
+  this->stats_mean_pub_ = this->create_publisher<ImageMsg>("~/stats/mean", ifm3d_ros2::LatchedQoS());
+  this->stats_stddev_pub_ = this->create_publisher<ImageMsg>("~/stats/stddev", ifm3d_ros2::LatchedQoS());
+  this->stats_valid_ratio_pub_ = this->create_publisher<ImageMsg>("~/stats/valid_ratio", ifm3d_ros2::LatchedQoS());
+  this->resource_usage_pub_ =
+      this->create_publisher<ResourceUsageMsg>("~/resource_usage", ifm3d_ros2::LowLatencyQoS());
+  this->diagnostics_pub_ = this->create_publisher<DiagnosticArrayMsg>("/diagnostics", rclcpp::SystemDefaultsQoS());
 
   RCLCPP_INFO(this->logger_, "After publishers declaration");
 
@@ -243,6 +209,31 @@ CameraNode::CameraNode(const std::string& node_name, const rclcpp::NodeOptions&
       "~/Softon", std::bind(&ifm3d_ros2::CameraNode::Softon, this, std::placeholders::_1, std::placeholders::_2,
                             std::placeholders::_3));
 
+  this->power_state_srv_ = this->create_service<PowerStateService>(
+      "~/PowerState", std::bind(&ifm3d_ros2::CameraNode::PowerState, this, std::placeholders::_1,
+                                std::placeholders::_2, std::placeholders::_3));
+
+  this->stats_srv_ = this->create_service<StatsService>(
+      "~/Stats", std::bind(&ifm3d_ros2::CameraNode::Stats, this, std::placeholders::_1, std::placeholders::_2,
+                           std::placeholders::_3));
+
+  const std::string fqn = this->get_fully_qualified_name();
+  this->transition_worker_ = std::make_unique<TransitionWorker>(
+      [this](TransitionRequest request) { return this->run_transition(request); },
+      [this](const TransitionTiming& timing) {
+        this->metrics_->transition_seconds.observe(timing.wait_seconds + timing.run_seconds);
+        this->metrics_->transitions_coalesced.inc(timing.coalesced);
+        if (!timing.ok)
+        {
+          this->metrics_->transitions_failed.inc();
+        }
+        RCLCPP_INFO(this->logger_, "Transition '%s' %s after %.3f s (queued %.3f s, %lu requests coalesced)",
+                    transition_request_name(timing.request), timing.ok ? "done" : "failed",
+                    timing.wait_seconds + timing.run_seconds, timing.wait_seconds,
+                    static_cast<unsigned long>(timing.coalesced));
+      },
+      [fqn] { ThreadRegistry::instance().tag(fqn + std::string("/transitions"), "ifm3d_lifecycle"); });
+
   RCLCPP_INFO(this->logger_, "node created, waiting for `configure()`...");
 }
 
@@ -252,6 +243,8 @@ CameraNode::~CameraNode()
 
   try
   {
+    // before anything a transition could touch goes away
+    this->transition_worker_.reset();
     this->stop_publish_loop();
   }
   catch (...)
@@ -288,20 +281,532 @@ TC_RETVAL CameraNode::on_configure(const rclcpp_lifecycle::State& prev_state)
   this->get_parameter("schema_mask", this->schema_mask_);
   RCLCPP_INFO(this->logger_, "schema_mask: %u", this->schema_mask_);
 
-  this->get_parameter("timeout_millis", this->timeout_millis_);
-  RCLCPP_INFO(this->logger_, "timeout_millis: %d", this->timeout_millis_);
+  LiveParams live;
+  this->get_parameter("timeout_millis", live.timeout_millis);
+  RCLCPP_INFO(this->logger_, "timeout_millis: %d", live.timeout_millis);
 
-  this->get_parameter("timeout_tolerance_secs", this->timeout_tolerance_secs_);
-  RCLCPP_INFO(this->logger_, "timeout_tolerance_secs: %f", this->timeout_tolerance_secs_);
+  this->get_parameter("timeout_tolerance_secs", live.timeout_tolerance_secs);
+  RCLCPP_INFO(this->logger_, "timeout_tolerance_secs: %f", live.timeout_tolerance_secs);
 
-  this->get_parameter("frame_latency_thresh", this->frame_latency_thresh_);
-  RCLCPP_INFO(this->logger_, "frame_latency_thresh (seconds): %f", this->frame_latency_thresh_);
+  this->get_parameter("frame_latency_thresh", live.frame_latency_thresh);
+  RCLCPP_INFO(this->logger_, "frame_latency_thresh (seconds): %f", live.frame_latency_thresh);
+
+  this->live_params_.store(live);
 
   this->get_parameter("sync_clocks", this->sync_clocks_);
   RCLCPP_INFO(this->logger_, "sync_clocks: %s", this->sync_clocks_ ? "true" : "false");
 
+  this->get_parameter("metrics_bind_address", this->metrics_bind_address_);
+  RCLCPP_INFO(this->logger_, "metrics_bind_address: %s", this->metrics_bind_address_.c_str());
+
+  this->get_parameter("metrics_port", this->metrics_port_);
+  RCLCPP_INFO(this->logger_, "metrics_port: %u", this->metrics_port_);
+
+  this->get_parameter("resource_usage_period_secs", this->resource_usage_period_secs_);
+  RCLCPP_INFO(this->logger_, "resource_usage_period_secs: %f", this->resource_usage_period_secs_);
+
+  std::string governor;
+  this->get_parameter("governor", governor);
+  RCLCPP_INFO(this->logger_, "governor: %s", governor.c_str());
+  if (governor == "decimate")
+  {
+    this->governor_mode_ = GovernorMode::DECIMATE;
+  }
+  else if (governor == "framerate")
+  {
+    this->governor_mode_ = GovernorMode::FRAMERATE;
+  }
+  else
+  {
+    if (governor != "off")
+    {
+      RCLCPP_WARN(this->logger_, "Unknown governor '%s', using 'off'", governor.c_str());
+    }
+    this->governor_mode_ = GovernorMode::OFF;
+  }
+
+  this->get_parameter("governor_period_secs", this->governor_period_secs_);
+  RCLCPP_INFO(this->logger_, "governor_period_secs: %f", this->governor_period_secs_);
+  if (this->governor_mode_ != GovernorMode::OFF && this->governor_period_secs_ <= 0.0F)
+  {
+    RCLCPP_WARN(this->logger_, "governor_period_secs must be positive, using 1");
+    this->governor_period_secs_ = 1.0F;
+  }
+
+  GovernorLimits governor_limits;
+  this->get_parameter("governor_cpu_high", governor_limits.cpu_high);
+  this->get_parameter("governor_cpu_low", governor_limits.cpu_low);
+  RCLCPP_INFO(this->logger_, "governor_cpu_high: %f, governor_cpu_low: %f", governor_limits.cpu_high,
+              governor_limits.cpu_low);
+  if (!(governor_limits.cpu_low < governor_limits.cpu_high))
+  {
+    RCLCPP_WARN(this->logger_, "governor_cpu_low must be below governor_cpu_high, using %f",
+                governor_limits.cpu_high * 0.7);
+    governor_limits.cpu_low = governor_limits.cpu_high * 0.7;
+  }
+  this->get_parameter("governor_publish_latency", governor_limits.publish_latency);
+  RCLCPP_INFO(this->logger_, "governor_publish_latency: %f", governor_limits.publish_latency);
+  this->get_parameter("governor_max_level", governor_limits.max_level);
+  RCLCPP_INFO(this->logger_, "governor_max_level: %d", governor_limits.max_level);
+  this->governor_ = FrameRateGovernor(governor_limits);
+
+  double frame_budget_ms = 0.0;
+  this->get_parameter("frame_budget_ms", frame_budget_ms);
+  RCLCPP_INFO(this->logger_, "frame_budget_ms: %f", frame_budget_ms);
+
+  std::vector<std::string> topic_priorities;
+  this->get_parameter("topic_priorities", topic_priorities);
+  std::vector<double> topic_deadlines_ms;
+  this->get_parameter("topic_deadlines_ms", topic_deadlines_ms);
+  if (!topic_deadlines_ms.empty() && topic_deadlines_ms.size() != topic_priorities.size())
+  {
+    RCLCPP_WARN(this->logger_, "topic_deadlines_ms must hold one deadline per entry of topic_priorities, using "
+                               "frame_budget_ms for all topics");
+    topic_deadlines_ms.clear();
+  }
+
+  std::vector<FrameTopic> priorities;
+  std::array<double, num_frame_topics> deadlines{};
+  deadlines.fill(frame_budget_ms * 1e-3);
+  for (std::size_t i = 0; i < topic_priorities.size(); ++i)
+  {
+    FrameTopic topic{};
+    if (!frame_topic_from_name(topic_priorities[i], topic))
+    {
+      RCLCPP_WARN(this->logger_, "Unknown topic '%s' in topic_priorities, ignoring it", topic_priorities[i].c_str());
+      continue;
+    }
+    priorities.push_back(topic);
+    // 0 keeps the frame budget, a negative deadline means none
+    if (!topic_deadlines_ms.empty() && topic_deadlines_ms[i] != 0.0)
+    {
+      deadlines[static_cast<std::size_t>(topic)] = topic_deadlines_ms[i] * 1e-3;
+    }
+  }
+  this->topic_scheduler_.configure(priorities, deadlines);
+  for (const auto topic : this->topic_scheduler_.order())
+  {
+    const auto deadline = this->topic_scheduler_.deadline(topic);
+    RCLCPP_INFO(this->logger_, "topic ~/%s: %s %.1f ms", frame_topic_name(topic),
+                deadline > 0.0 ? "deadline" : "no deadline", deadline > 0.0 ? deadline * 1e3 : 0.0);
+  }
+
+  std::string distance_output;
+  this->get_parameter("distance_output", distance_output);
+  RCLCPP_INFO(this->logger_, "distance_output: %s", distance_output.c_str());
+  if (distance_output == "mm16")
+  {
+    this->distance_output_ = DistanceOutput::MM16;
+  }
+  else
+  {
+    if (distance_output != "native")
+    {
+      RCLCPP_WARN(this->logger_, "Unknown distance_output '%s', using 'native'", distance_output.c_str());
+    }
+    this->distance_output_ = DistanceOutput::NATIVE;
+  }
+
+  std::string cloud_encoding;
+  this->get_parameter("cloud_encoding", cloud_encoding);
+  RCLCPP_INFO(this->logger_, "cloud_encoding: %s", cloud_encoding.c_str());
+  if (cloud_encoding == "int16_mm")
+  {
+    this->cloud_encoding_ = CloudEncoding::INT16_MM;
+  }
+  else
+  {
+    if (cloud_encoding != "float32")
+    {
+      RCLCPP_WARN(this->logger_, "Unknown cloud_encoding '%s', using 'float32'", cloud_encoding.c_str());
+    }
+    this->cloud_encoding_ = CloudEncoding::FLOAT32;
+  }
+
+  this->get_parameter("cloud_intensity", this->cloud_intensity_);
+  RCLCPP_INFO(this->logger_, "cloud_intensity: %s", this->cloud_intensity_ ? "true" : "false");
+
+  this->get_parameter("cloud_intensity_max", this->cloud_intensity_max_);
+  RCLCPP_INFO(this->logger_, "cloud_intensity_max: %f", this->cloud_intensity_max_);
+
+  this->get_parameter("cloud_sigma", this->cloud_sigma_);
+  RCLCPP_INFO(this->logger_, "cloud_sigma: %s", this->cloud_sigma_ ? "true" : "false");
+
+  this->get_parameter("cloud_noise_threshold", this->cloud_noise_threshold_);
+  RCLCPP_INFO(this->logger_, "cloud_noise_threshold: %f", this->cloud_noise_threshold_);
+  if (this->cloud_noise_threshold_ < 0.0F)
+  {
+    RCLCPP_WARN(this->logger_, "cloud_noise_threshold must not be negative, using 0 (off)");
+    this->cloud_noise_threshold_ = 0.0F;
+  }
+  if ((this->cloud_sigma_ || this->cloud_noise_threshold_ > 0.0F) && this->cloud_encoding_ != CloudEncoding::FLOAT32)
+  {
+    RCLCPP_WARN(this->logger_, "cloud_sigma and cloud_noise_threshold need cloud_encoding float32, ignoring them");
+    this->cloud_sigma_ = false;
+    this->cloud_noise_threshold_ = 0.0F;
+  }
+
+  this->get_parameter("cloud_target_frame", this->cloud_target_frame_);
+  RCLCPP_INFO(this->logger_, "cloud_target_frame: %s", this->cloud_target_frame_.c_str());
+  {
+    std::lock_guard<std::mutex> lock(this->cloud_transform_mutex_);
+    this->cloud_transform_.reset();
+  }
+  this->tf_static_sub_.reset();
+  this->tf_buffer_.reset();
+  if (!this->cloud_target_frame_.empty())
+  {
+    // static transforms are latched, so the whole tree arrives right away
+    this->tf_buffer_ = std::make_unique<tf2::BufferCore>();
+    this->tf_static_sub_ = this->create_subscription<TFMessage>(
+        "/tf_static", rclcpp::QoS(100).reliable().transient_local(),
+        [this](const TFMessage::SharedPtr msg) { this->on_tf_static(*msg); });
+  }
+
+  this->get_parameter("deskew_topic", this->deskew_topic_);
+  RCLCPP_INFO(this->logger_, "deskew_topic: %s", this->deskew_topic_.c_str());
+
+  std::string deskew_source;
+  this->get_parameter("deskew_source", deskew_source);
+  RCLCPP_INFO(this->logger_, "deskew_source: %s", deskew_source.c_str());
+  if (deskew_source == "imu")
+  {
+    this->deskew_imu_ = true;
+  }
+  else
+  {
+    if (deskew_source != "odometry")
+    {
+      RCLCPP_WARN(this->logger_, "Unknown deskew_source '%s', using 'odometry'", deskew_source.c_str());
+    }
+    this->deskew_imu_ = false;
+  }
+
+  this->get_parameter("deskew_max_hold", this->deskew_max_hold_secs_);
+  RCLCPP_INFO(this->logger_, "deskew_max_hold: %f", this->deskew_max_hold_secs_);
+  if (this->deskew_max_hold_secs_ < 0.0F)
+  {
+    RCLCPP_WARN(this->logger_, "deskew_max_hold must not be negative, using 0");
+    this->deskew_max_hold_secs_ = 0.0F;
+  }
+
+  // the twists of an earlier configuration may be from another clock
+  this->twist_sub_.reset();
+  this->twist_ring_.clear();
+  this->last_twist_nanos_ = 0;
+  if (!this->deskew_topic_.empty() && this->cloud_target_frame_.empty())
+  {
+    RCLCPP_WARN(this->logger_, "deskew_topic needs cloud_target_frame (the frame of the twists), ignoring it");
+    this->deskew_topic_.clear();
+  }
+  if (!this->deskew_topic_.empty())
+  {
+    if (this->deskew_imu_)
+    {
+      // the angular velocity only, the IMU is assumed to be aligned with the
+      // target frame
+      this->twist_sub_ = this->create_subscription<ImuMsg>(
+          this->deskew_topic_, rclcpp::SensorDataQoS(), [this](const ImuMsg::SharedPtr msg) {
+            TwistSample twist;
+            twist.angular = { { static_cast<float>(msg->angular_velocity.x),
+                                static_cast<float>(msg->angular_velocity.y),
+                                static_cast<float>(msg->angular_velocity.z) } };
+            this->on_twist(msg->header.stamp, twist);
+          });
+    }
+    else
+    {
+      this->twist_sub_ = this->create_subscription<OdometryMsg>(
+          this->deskew_topic_, rclcpp::SensorDataQoS(), [this](const OdometryMsg::SharedPtr msg) {
+            if (!msg->child_frame_id.empty() && msg->child_frame_id != this->cloud_target_frame_)
+            {
+              RCLCPP_WARN_ONCE(this->logger_, "The odometry twists are in %s rather than cloud_target_frame %s!",
+                               msg->child_frame_id.c_str(), this->cloud_target_frame_.c_str());
+            }
+            const auto& v = msg->twist.twist;
+            TwistSample twist;
+            twist.linear = { { static_cast<float>(v.linear.x), static_cast<float>(v.linear.y),
+                               static_cast<float>(v.linear.z) } };
+            twist.angular = { { static_cast<float>(v.angular.x), static_cast<float>(v.angular.y),
+                                static_cast<float>(v.angular.z) } };
+            this->on_twist(msg->header.stamp, twist);
+          });
+    }
+  }
+
+  this->get_parameter("distance_filter", this->distance_filter_);
+  RCLCPP_INFO(this->logger_, "distance_filter: %s", this->distance_filter_ ? "true" : "false");
+
+  GuidedFilter::Params filter_params;
+  int distance_filter_radius = 0;
+  this->get_parameter("distance_filter_radius", distance_filter_radius);
+  RCLCPP_INFO(this->logger_, "distance_filter_radius: %d", distance_filter_radius);
+  if (distance_filter_radius > 0)
+  {
+    filter_params.radius = static_cast<std::uint32_t>(distance_filter_radius);
+  }
+  else
+  {
+    RCLCPP_WARN(this->logger_, "distance_filter_radius must be positive, using %u", filter_params.radius);
+  }
+
+  float distance_filter_eps = 0.0F;
+  this->get_parameter("distance_filter_eps", distance_filter_eps);
+  RCLCPP_INFO(this->logger_, "distance_filter_eps: %f", distance_filter_eps);
+  if (distance_filter_eps > 0.0F)
+  {
+    filter_params.eps = distance_filter_eps;
+  }
+  else
+  {
+    RCLCPP_WARN(this->logger_, "distance_filter_eps must be positive, using %f", filter_params.eps);
+  }
+  this->guided_filter_.configure(filter_params);
+
+  this->get_parameter("preview_rate_hz", this->preview_rate_hz_);
+  RCLCPP_INFO(this->logger_, "preview_rate_hz: %f", this->preview_rate_hz_);
+
+  std::string preview_colormap;
+  this->get_parameter("preview_colormap", preview_colormap);
+  RCLCPP_INFO(this->logger_, "preview_colormap: %s", preview_colormap.c_str());
+  Colormap colormap = Colormap::TURBO;
+  if (!parse_colormap(preview_colormap, colormap))
+  {
+    RCLCPP_WARN(this->logger_, "Unknown preview_colormap '%s', using 'turbo'", preview_colormap.c_str());
+  }
+  this->distance_preview_.set_colormap(colormap);
+  this->amplitude_preview_.set_colormap(colormap);
+
+  int preview_jpeg_quality = 0;
+  this->get_parameter("preview_jpeg_quality", preview_jpeg_quality);
+  RCLCPP_INFO(this->logger_, "preview_jpeg_quality: %d", preview_jpeg_quality);
+  this->distance_preview_.set_quality(preview_jpeg_quality);
+  this->amplitude_preview_.set_quality(preview_jpeg_quality);
+
+  this->preview_distance_range_ = this->get_range_parameter("preview_distance_range");
+  this->preview_amplitude_range_ = this->get_range_parameter("preview_amplitude_range");
+
+  std::string change_detection;
+  this->get_parameter("change_detection", change_detection);
+  RCLCPP_INFO(this->logger_, "change_detection: %s", change_detection.c_str());
+  if (change_detection == "skip")
+  {
+    this->change_detection_ = ChangeDetection::SKIP;
+  }
+  else if (change_detection == "tiles")
+  {
+    this->change_detection_ = ChangeDetection::TILES;
+  }
+  else
+  {
+    if (change_detection != "off")
+    {
+      RCLCPP_WARN(this->logger_, "Unknown change_detection '%s', using 'off'", change_detection.c_str());
+    }
+    this->change_detection_ = ChangeDetection::OFF;
+  }
+
+  ChangeDetector::Params change_params;
+  int change_tile_size = 0;
+  this->get_parameter("change_tile_size", change_tile_size);
+  RCLCPP_INFO(this->logger_, "change_tile_size: %d", change_tile_size);
+  change_params.tile_size = static_cast<std::uint32_t>(std::max(change_tile_size, 1));
+
+  this->get_parameter("change_threshold_abs", change_params.threshold_abs);
+  RCLCPP_INFO(this->logger_, "change_threshold_abs: %f", change_params.threshold_abs);
+
+  this->get_parameter("change_threshold_rel", change_params.threshold_rel);
+  RCLCPP_INFO(this->logger_, "change_threshold_rel: %f", change_params.threshold_rel);
+
+  this->get_parameter("change_min_fraction", change_params.min_fraction);
+  RCLCPP_INFO(this->logger_, "change_min_fraction: %f", change_params.min_fraction);
+  this->change_detector_.configure(change_params);
+
+  this->get_parameter("change_keyframe_interval_secs", this->change_keyframe_interval_secs_);
+  RCLCPP_INFO(this->logger_, "change_keyframe_interval_secs: %f", this->change_keyframe_interval_secs_);
+
+  SectorReducer::Params sector_params;
+  int sector_count = 0;
+  this->get_parameter("sector_count", sector_count);
+  RCLCPP_INFO(this->logger_, "sector_count: %d", sector_count);
+  sector_params.num_sectors = static_cast<std::uint32_t>(std::max(sector_count, 0));
+
+  const auto sector_angles = this->get_range_parameter("sector_angle_range");
+  sector_params.angle_min = sector_angles[0];
+  sector_params.angle_max = sector_angles[1];
+
+  std::vector<double> sector_band_limits;
+  this->get_parameter("sector_band_limits", sector_band_limits);
+  if (sector_band_limits.size() < 2 || !std::is_sorted(sector_band_limits.begin(), sector_band_limits.end()))
+  {
+    RCLCPP_WARN(this->logger_, "sector_band_limits must hold at least two increasing edges, disabling ~/sectors");
+    sector_params.num_sectors = 0;
+  }
+  sector_params.band_limits.assign(sector_band_limits.begin(), sector_band_limits.end());
+  this->sector_reducer_.configure(sector_params);
+
+  std::vector<std::int64_t> confidence_bits;
+  this->get_parameter("confidence_bits", confidence_bits);
+  this->confidence_bits_ = ConfidenceBits{ { 0x1, 0x2, 0x4, 0x8 } };
+  if (confidence_bits.size() == num_confidence_masks &&
+      std::all_of(confidence_bits.begin(), confidence_bits.end(),
+                  [](std::int64_t bits) { return bits >= 0 && bits <= 0xFFFF; }))
+  {
+    std::copy(confidence_bits.begin(), confidence_bits.end(), this->confidence_bits_.begin());
+    RCLCPP_INFO(this->logger_, "confidence_bits: [0x%x, 0x%x, 0x%x, 0x%x]", this->confidence_bits_[0],
+                this->confidence_bits_[1], this->confidence_bits_[2], this->confidence_bits_[3]);
+    if (!confidence_bits_fit(this->confidence_bits_, sizeof(std::uint8_t)))
+    {
+      RCLCPP_WARN(this->logger_, "confidence_bits above 0xFF only apply to 16 bit confidence images");
+    }
+  }
+  else
+  {
+    RCLCPP_WARN(this->logger_, "confidence_bits must hold four bit masks, using [0x1, 0x2, 0x4, 0x8]");
+  }
+
+  std::vector<std::string> stage_confidence_exclude;
+  this->get_parameter("stage_confidence_exclude", stage_confidence_exclude);
+  this->stage_confidence_exclude_ = 0;
+  for (const auto& name : stage_confidence_exclude)
+  {
+    RCLCPP_INFO(this->logger_, "stage_confidence_exclude: %s", name.c_str());
+    ConfidenceMask mask{};
+    if (name == "invalid")
+    {
+      this->stage_confidence_exclude_ |= this->confidence_bits_[static_cast<std::size_t>(ConfidenceMask::VALID)];
+    }
+    else if (parse_confidence_mask(name, mask) && mask != ConfidenceMask::VALID)
+    {
+      this->stage_confidence_exclude_ |= this->confidence_bits_[static_cast<std::size_t>(mask)];
+    }
+    else
+    {
+      RCLCPP_WARN(this->logger_, "Unknown confidence mask '%s' in stage_confidence_exclude, ignoring it",
+                  name.c_str());
+    }
+  }
+
+  this->get_parameter("ground_removal", this->ground_removal_);
+  RCLCPP_INFO(this->logger_, "ground_removal: %s", this->ground_removal_ ? "true" : "false");
+
+  GroundPlaneEstimator::Params ground_params;
+  this->get_parameter("ground_threshold", ground_params.threshold);
+  RCLCPP_INFO(this->logger_, "ground_threshold: %f", ground_params.threshold);
+
+  std::vector<double> ground_up;
+  this->get_parameter("ground_up", ground_up);
+  if (ground_up.size() == 3)
+  {
+    ground_params.up = { { static_cast<float>(ground_up[0]), static_cast<float>(ground_up[1]),
+                           static_cast<float>(ground_up[2]) } };
+    RCLCPP_INFO(this->logger_, "ground_up: [%f, %f, %f]", ground_up[0], ground_up[1], ground_up[2]);
+  }
+  else
+  {
+    RCLCPP_WARN(this->logger_, "ground_up must be [x, y, z], using [0, 0, 1]");
+  }
+
+  float ground_max_tilt_deg = 0.0F;
+  this->get_parameter("ground_max_tilt_deg", ground_max_tilt_deg);
+  RCLCPP_INFO(this->logger_, "ground_max_tilt_deg: %f", ground_max_tilt_deg);
+  ground_params.max_tilt_rad = ground_max_tilt_deg * static_cast<float>(M_PI) / 180.0F;
+
+  float ground_time_budget_ms = 0.0F;
+  this->get_parameter("ground_time_budget_ms", ground_time_budget_ms);
+  RCLCPP_INFO(this->logger_, "ground_time_budget_ms: %f", ground_time_budget_ms);
+  ground_params.time_budget = std::chrono::microseconds(static_cast<std::int64_t>(ground_time_budget_ms * 1000.0F));
+
+  this->get_parameter("ground_min_inlier_ratio", ground_params.min_inlier_ratio);
+  RCLCPP_INFO(this->logger_, "ground_min_inlier_ratio: %f", ground_params.min_inlier_ratio);
+  this->ground_estimator_.configure(ground_params);
+
+  this->get_parameter("height_grid", this->height_grid_);
+  RCLCPP_INFO(this->logger_, "height_grid: %s", this->height_grid_ ? "true" : "false");
+
+  this->get_parameter("grid_name", this->grid_name_);
+  RCLCPP_INFO(this->logger_, "grid_name: %s", this->grid_name_.c_str());
+
+  this->get_parameter("grid_frame", this->grid_frame_);
+  RCLCPP_INFO(this->logger_, "grid_frame: %s", this->grid_frame_.c_str());
+
+  float grid_resolution = 0.0F;
+  this->get_parameter("grid_resolution", grid_resolution);
+  RCLCPP_INFO(this->logger_, "grid_resolution: %f", grid_resolution);
+
+  std::vector<double> grid_size;
+  this->get_parameter("grid_size", grid_size);
+  std::vector<double> grid_origin;
+  this->get_parameter("grid_origin", grid_origin);
+  if (grid_resolution > 0.0F && grid_size.size() == 2 && grid_size[0] > 0.0 && grid_size[1] > 0.0 &&
+      grid_origin.size() == 2)
+  {
+    this->grid_params_.resolution = grid_resolution;
+    this->grid_params_.width = static_cast<std::uint32_t>(std::ceil(grid_size[0] / grid_resolution));
+    this->grid_params_.height = static_cast<std::uint32_t>(std::ceil(grid_size[1] / grid_resolution));
+    this->grid_params_.origin_x = static_cast<float>(grid_origin[0]);
+    this->grid_params_.origin_y = static_cast<float>(grid_origin[1]);
+    RCLCPP_INFO(this->logger_, "grid_size: [%f, %f]", grid_size[0], grid_size[1]);
+    RCLCPP_INFO(this->logger_, "grid_origin: [%f, %f]", grid_origin[0], grid_origin[1]);
+  }
+  else
+  {
+    RCLCPP_WARN(this->logger_, "grid_resolution, grid_size or grid_origin malformed, disabling the height grid");
+    this->height_grid_ = false;
+  }
+
+  // the heads sharing a grid publish it in turn, each with the header of its
+  // own cloud otherwise
+  if (this->height_grid_ && !this->grid_name_.empty() && this->grid_frame_.empty())
+  {
+    RCLCPP_ERROR(this->logger_, "grid_frame must be set to share the grid '%s' between heads",
+                 this->grid_name_.c_str());
+    return TC_RETVAL::FAILURE;
+  }
+
+  const auto grid_height_range = this->get_range_parameter("grid_height_range");
+  this->grid_params_.min_z = grid_height_range[0];
+  this->grid_params_.max_z = grid_height_range[1];
+
+  this->get_parameter("grid_min_points", this->grid_min_points_);
+  RCLCPP_INFO(this->logger_, "grid_min_points: %d", this->grid_min_points_);
+
+  this->get_parameter("grid_rate_hz", this->grid_rate_hz_);
+  RCLCPP_INFO(this->logger_, "grid_rate_hz: %f", this->grid_rate_hz_);
+
+  // heads sharing a grid publish it on a common topic
+  const std::string grid_topic = this->grid_name_.empty() ? std::string("~/grid") : this->grid_name_;
+  this->grid_pub_ = this->create_publisher<OccupancyGridMsg>(grid_topic, ifm3d_ros2::LowLatencyQoS());
+  this->grid_height_pub_ = this->create_publisher<HeightMapMsg>(grid_topic + "_height", ifm3d_ros2::LowLatencyQoS());
+
+  this->get_parameter("rgb_registration", this->rgb_registration_);
+  RCLCPP_INFO(this->logger_, "rgb_registration: %s", this->rgb_registration_.c_str());
+
+  this->get_parameter("rgb_registration_max_age", this->rgb_registration_max_age_);
+  RCLCPP_INFO(this->logger_, "rgb_registration_max_age: %f", this->rgb_registration_max_age_);
+
+  this->get_parameter("rgb_rectify", this->rgb_rectify_);
+  RCLCPP_INFO(this->logger_, "rgb_rectify: %s", this->rgb_rectify_ ? "true" : "false");
+
+  this->get_parameter("worker_threads", this->worker_threads_);
+  RCLCPP_INFO(this->logger_, "worker_threads: %d", this->worker_threads_);
+
   RCLCPP_INFO(this->logger_, "Parameters parsed OK.");
 
+  if (this->metrics_port_ != 0)
+  {
+    const auto err = MetricsRegistry::instance().start_server(this->metrics_bind_address_, this->metrics_port_);
+    if (err.empty())
+    {
+      RCLCPP_INFO(this->logger_, "Serving metrics on http://%s:%u/metrics", this->metrics_bind_address_.c_str(),
+                  this->metrics_port_);
+    }
+    else
+    {
+      RCLCPP_WARN(this->logger_, "Metrics endpoint not started: %s", err.c_str());
+    }
+  }
+
   //
   // We need a global lock on all the ifm3d core data structures
   //
@@ -316,6 +821,31 @@ TC_RETVAL CameraNode::on_configure(const rclcpp_lifecycle::State& prev_state)
   RCLCPP_INFO(this->logger_, "Initializing FrameGrabber with mask: %u", this->schema_mask_);
   this->fg_ = std::make_shared<ifm3d::FrameGrabber>(this->cam_, this->pcic_port_);
 
+  // the rate the governor scales, read once before it touches the port, so
+  // that an activation never takes a lowered rate for the nominal one
+  this->nominal_framerate_ = 0.0;
+  if (this->governor_mode_ == GovernorMode::FRAMERATE)
+  {
+    const auto port = "port" + std::to_string(static_cast<int>(this->pcic_port_) % xmlrpc_base_port);
+    try
+    {
+      this->nominal_framerate_ =
+          this->cam_->ToJSON().at("ports").at(port).at("acquisition").at("framerate").get<double>();
+      RCLCPP_INFO(this->logger_, "Governor: nominal framerate of %s is %.2f Hz", port.c_str(),
+                  this->nominal_framerate_);
+    }
+    catch (const std::exception& ex)
+    {
+      RCLCPP_WARN(this->logger_, "Governor: cannot read the framerate of %s yet: %s", port.c_str(), ex.what());
+    }
+  }
+
+  if (this->configured_once_)
+  {
+    this->metrics_->reconnects.inc();
+  }
+  this->configured_once_ = true;
+
   RCLCPP_INFO(this->logger_, "Configuration complete.");
   return TC_RETVAL::SUCCESS;
 }
@@ -328,31 +858,129 @@ TC_RETVAL CameraNode::on_activate(const rclcpp_lifecycle::State& prev_state)
   //  activate all publishers
   RCLCPP_INFO(this->logger_, "Activating publishers...");
   this->conf_pub_->on_activate();
+  for (auto& pub : this->conf_mask_pubs_)
+  {
+    pub->on_activate();
+  }
   this->distance_pub_->on_activate();
+  this->distance_noise_pub_->on_activate();
   this->amplitude_pub_->on_activate();
   this->raw_amplitude_pub_->on_activate();
   this->cloud_pub_->on_activate();
   this->extrinsics_pub_->on_activate();
   this->rgb_pub_->on_activate();
+  this->distance_preview_pub_->on_activate();
+  this->amplitude_preview_pub_->on_activate();
+  this->distance_tiles_pub_->on_activate();
+  this->sectors_pub_->on_activate();
+  this->cloud_ground_pub_->on_activate();
+  this->cloud_obstacles_pub_->on_activate();
+  this->ground_plane_pub_->on_activate();
+  this->grid_pub_->on_activate();
+  this->grid_height_pub_->on_activate();
+  this->rgb_registered_pub_->on_activate();
+  this->rgb_rect_pub_->on_activate();
+  this->rgb_rect_info_pub_->on_activate();
+  this->stats_mean_pub_->on_activate();
+  this->stats_stddev_pub_->on_activate();
+  this->stats_valid_ratio_pub_->on_activate();
+  this->resource_usage_pub_->on_activate();
+  this->diagnostics_pub_->on_activate();
   RCLCPP_INFO(this->logger_, "Publishers activated.");
 
-  // start the publishing loop
-  this->test_destroy_ = false;
-  this->pub_loop_ = std::thread(std::bind(&ifm3d_ros2::CameraNode::publish_loop, this));
+  if (this->resource_usage_period_secs_ > 0.0F)
+  {
+    this->resource_usage_timer_ =
+        this->create_wall_timer(std::chrono::duration<float>(this->resource_usage_period_secs_),
+                                std::bind(&ifm3d_ros2::CameraNode::publish_resource_usage, this));
+  }
 
-  return TC_RETVAL::SUCCESS;
-}
+  // every head starts at its nominal rate, and tries the framerate again
+  // after having fallen back to decimation
+  this->governor_.reset();
+  this->governor_decimation_ = 1;
+  this->governor_rate_failed_ = false;
+  this->governor_decimate_ = this->governor_mode_ == GovernorMode::DECIMATE;
+  if (this->governor_mode_ != GovernorMode::OFF)
+  {
+    if (this->governor_mode_ == GovernorMode::FRAMERATE)
+    {
+      const std::string fqn = this->get_fully_qualified_name();
+      this->governor_worker_ = std::make_unique<LatestJobWorker>(
+          [fqn] { ThreadRegistry::instance().tag(fqn + std::string("/governor"), "ifm3d_governor"); });
+    }
+    this->host_cpu_sampler_.sample();
+    this->governor_last_ = GovernorTotals{ std::chrono::steady_clock::now(), this->metrics_->publish_seconds.count(),
+                                           this->metrics_->publish_seconds.sum(), this->loop_busy_nanos_.load() };
+    this->governor_timer_ = this->create_wall_timer(std::chrono::duration<float>(this->governor_period_secs_),
+                                                    std::bind(&ifm3d_ros2::CameraNode::govern, this));
+  }
+
+  // processing stages, ahead of the publish loop feeding them
+  if (this->height_grid_)
+  {
+    this->shared_grid_ = SharedGrid::acquire(this->grid_name_, this->grid_params_);
+    if (!(this->shared_grid_->params() == this->grid_params_))
+    {
+      RCLCPP_WARN(this->logger_, "Grid '%s' was created by another head with a different geometry, using it",
+                  this->grid_name_.c_str());
+    }
+    this->grid_.configure(this->shared_grid_->params());
+    this->grid_contributor_ = this->shared_grid_->join();
+  }
+  if (!this->rgb_registration_.empty())
+  {
+    this->color_exchange_ = ColorFrameExchange::acquire(this->rgb_registration_);
+    this->color_sequence_ = 0;
+  }
+  if (this->ground_removal_ || this->height_grid_ || this->color_exchange_ || this->rgb_rectify_)
+  {
+    const std::string fqn = this->get_fully_qualified_name();
+    this->worker_pool_ = std::make_unique<WorkerPool>(
+        static_cast<std::size_t>(std::max(this->worker_threads_, 0)),
+        [fqn] { ThreadRegistry::instance().tag(fqn + std::string("/worker"), "ifm3d_worker"); });
+    this->ground_estimator_.reset();
+    this->stage_worker_ = std::make_unique<LatestJobWorker>(
+        [fqn] { ThreadRegistry::instance().tag(fqn + std::string("/stages"), "ifm3d_stages"); });
+  }
+  if (this->distance_filter_)
+  {
+    const std::string fqn = this->get_fully_qualified_name();
+    this->filter_pool_ = std::make_unique<WorkerPool>(
+        static_cast<std::size_t>(std::max(this->worker_threads_, 0)),
+        [fqn] { ThreadRegistry::instance().tag(fqn + std::string("/filter"), "ifm3d_filter"); });
+  }
+
+  // start the publishing loop, streaming: a port left idle when the node was
+  // deactivated needs a Softon
+  this->standby_ = false;
+  this->test_destroy_ = false;
+  this->pub_loop_ = std::thread(std::bind(&ifm3d_ros2::CameraNode::publish_loop, this));
+
+  // the port may be switched through the PowerState service of another head
+  this->port_standby_ = PortStandby::acquire(this->ip_, this->pcic_port_);
+  this->port_standby_listener_ = this->port_standby_->listen([this](bool standby) { this->set_standby(standby); });
+
+  return TC_RETVAL::SUCCESS;
+}
 
 TC_RETVAL CameraNode::on_deactivate(const rclcpp_lifecycle::State& prev_state)
 {
   RCLCPP_INFO(this->logger_, "on_deactivate(): %s -> %s", prev_state.label().c_str(),
               this->get_current_state().label().c_str());
 
+  this->unlisten_port_standby();
+
   //
   // stop the publish loop and join on the thread.
   //
   RCLCPP_INFO(this->logger_, "Stopping publishing thread...");
-  this->test_destroy_ = true;
+  {
+    // under the mutex, so that a loop going into standby cannot miss it
+    std::lock_guard<std::mutex> lock(this->standby_mutex_);
+    this->test_destroy_ = true;
+  }
+  this->standby_cv_.notify_all();
   if (this->pub_loop_.joinable())
   {
     this->pub_loop_.join();
@@ -363,13 +991,58 @@ TC_RETVAL CameraNode::on_deactivate(const rclcpp_lifecycle::State& prev_state)
     RCLCPP_WARN(this->logger_, "Publishing thread is not joinable!");
   }
 
+  // waits for the running stage jobs, before their publishers go away
+  this->stop_stages();
+
+  if (this->resource_usage_timer_)
+  {
+    this->resource_usage_timer_->cancel();
+    this->resource_usage_timer_.reset();
+  }
+
+  if (this->governor_timer_)
+  {
+    this->governor_timer_->cancel();
+    this->governor_timer_.reset();
+  }
+  // waits for the framerate being set (if any), then leaves the port at its
+  // nominal rate for the next activation
+  this->governor_worker_.reset();
+  if (this->governor_mode_ == GovernorMode::FRAMERATE && !this->governor_decimate_ && this->governor_.level() > 0)
+  {
+    this->governor_.reset();
+    this->apply_rate_factor(1.0);
+  }
+
   // explicitly deactive the publishers
   RCLCPP_INFO(this->logger_, "Deactivating publishers...");
+  this->diagnostics_pub_->on_deactivate();
+  this->resource_usage_pub_->on_deactivate();
+  this->stats_valid_ratio_pub_->on_deactivate();
+  this->stats_stddev_pub_->on_deactivate();
+  this->stats_mean_pub_->on_deactivate();
+  this->rgb_rect_info_pub_->on_deactivate();
+  this->rgb_rect_pub_->on_deactivate();
+  this->rgb_registered_pub_->on_deactivate();
+  this->grid_height_pub_->on_deactivate();
+  this->grid_pub_->on_deactivate();
+  this->ground_plane_pub_->on_deactivate();
+  this->cloud_obstacles_pub_->on_deactivate();
+  this->cloud_ground_pub_->on_deactivate();
+  this->sectors_pub_->on_deactivate();
+  this->distance_tiles_pub_->on_deactivate();
+  this->amplitude_preview_pub_->on_deactivate();
+  this->distance_preview_pub_->on_deactivate();
   this->extrinsics_pub_->on_deactivate();
   this->cloud_pub_->on_deactivate();
   this->raw_amplitude_pub_->on_deactivate();
   this->amplitude_pub_->on_deactivate();
+  this->distance_noise_pub_->on_deactivate();
   this->distance_pub_->on_deactivate();
+  for (auto it = this->conf_mask_pubs_.rbegin(); it != this->conf_mask_pubs_.rend(); ++it)
+  {
+    (*it)->on_deactivate();
+  }
   this->conf_pub_->on_deactivate();
   RCLCPP_INFO(this->logger_, "Publishers deactivated.");
 
@@ -382,6 +1055,14 @@ TC_RETVAL CameraNode::on_cleanup(const rclcpp_lifecycle::State& prev_state)
   RCLCPP_INFO(this->logger_, "on_cleanup(): %s -> %s", prev_state.label().c_str(),
               this->get_current_state().label().c_str());
 
+  {
+    std::lock_guard<std::mutex> lock(this->power_mutex_);
+    this->power_cam_.reset();
+  }
+
+  this->tf_static_sub_.reset();
+  this->tf_buffer_.reset();
+
   std::lock_guard<std::mutex> lock(this->gil_);
   RCLCPP_INFO(this->logger_, "Resetting core ifm3d data structures...");
   this->fg_.reset();
@@ -398,11 +1079,14 @@ TC_RETVAL CameraNode::on_shutdown(const rclcpp_lifecycle::State& prev_state)
               this->get_current_state().label().c_str());
 
   //
-  // We only need to make sure the pulishing loop has been stopped.
+  // We only need to make sure the pulishing loop has been stopped and that
+  // no transition we requested of ourselves follows the shutdown. The one
+  // running (if any) is joined by the dtor.
   //
   // ifm3d and cv::Mat dtors will dealloc the rest of our core data
   // structures.
   //
+  this->transition_worker_->stop();
   this->stop_publish_loop();
   return TC_RETVAL::SUCCESS;
 }
@@ -414,6 +1098,11 @@ TC_RETVAL CameraNode::on_error(const rclcpp_lifecycle::State& prev_state)
 
   this->stop_publish_loop();
 
+  {
+    std::lock_guard<std::mutex> lock(this->power_mutex_);
+    this->power_cam_.reset();
+  }
+
   std::lock_guard<std::mutex> lock(this->gil_);
   RCLCPP_INFO(this->logger_, "Resetting core ifm3d data structures...");
   this->fg_.reset();
@@ -431,6 +1120,66 @@ void CameraNode::init_params()
   static constexpr auto default_timeout_tolerance_secs{ 5.0 };
   static constexpr auto default_frame_latency_threshold{ 1.0 };
   static constexpr auto default_sync_clocks{ false };
+  static constexpr auto default_metrics_bind_address{ "127.0.0.1" };
+  static constexpr auto default_metrics_port{ 0 };
+  static constexpr auto default_resource_usage_period_secs{ 0.0 };
+  static constexpr auto default_governor{ "off" };
+  static constexpr auto default_governor_period_secs{ 1.0 };
+  static constexpr auto default_governor_cpu_high{ 0.85 };
+  static constexpr auto default_governor_cpu_low{ 0.6 };
+  static constexpr auto default_governor_publish_latency{ 0.01 };
+  static constexpr auto default_governor_max_level{ 3 };
+  static constexpr auto default_frame_budget_ms{ 0.0 };
+  static const std::vector<std::string> default_topic_priorities = frame_topic_names();
+  static const std::vector<double> default_topic_deadlines_ms{};
+  static constexpr auto default_distance_output{ "native" };
+  static constexpr auto default_cloud_encoding{ "float32" };
+  static constexpr auto default_cloud_intensity{ false };
+  static constexpr auto default_cloud_intensity_max{ 1000.0 };
+  static constexpr auto default_cloud_sigma{ false };
+  static constexpr auto default_cloud_noise_threshold{ 0.0 };
+  static constexpr auto default_cloud_target_frame{ "" };
+  static constexpr auto default_deskew_topic{ "" };
+  static constexpr auto default_deskew_source{ "odometry" };
+  static constexpr auto default_deskew_max_hold{ 0.1 };
+  static constexpr auto default_distance_filter{ false };
+  static constexpr auto default_distance_filter_radius{ 2 };
+  static constexpr auto default_distance_filter_eps{ 0.01 };
+  static constexpr auto default_preview_rate_hz{ 2.0 };
+  static constexpr auto default_preview_colormap{ "turbo" };
+  static constexpr auto default_preview_jpeg_quality{ 80 };
+  static const std::vector<double> default_preview_distance_range{ 0.0, 5.0 };
+  static const std::vector<double> default_preview_amplitude_range{ 0.0, 1000.0 };
+  static constexpr auto default_change_detection{ "off" };
+  static constexpr auto default_change_tile_size{ 16 };
+  static constexpr auto default_change_threshold_abs{ 0.02 };
+  static constexpr auto default_change_threshold_rel{ 0.01 };
+  static constexpr auto default_change_min_fraction{ 0.02 };
+  static constexpr auto default_change_keyframe_interval_secs{ 1.0 };
+  static constexpr auto default_sector_count{ 0 };
+  static const std::vector<double> default_sector_angle_range{ -M_PI, M_PI };
+  static const std::vector<double> default_sector_band_limits{ -100.0, 100.0 };
+  static const std::vector<std::int64_t> default_confidence_bits{ 0x1, 0x2, 0x4, 0x8 };
+  static const std::vector<std::string> default_stage_confidence_exclude{};
+  static constexpr auto default_ground_removal{ false };
+  static constexpr auto default_ground_threshold{ 0.03 };
+  static const std::vector<double> default_ground_up{ 0.0, 0.0, 1.0 };
+  static constexpr auto default_ground_max_tilt_deg{ 15.0 };
+  static constexpr auto default_ground_time_budget_ms{ 10.0 };
+  static constexpr auto default_ground_min_inlier_ratio{ 0.2 };
+  static constexpr auto default_height_grid{ false };
+  static constexpr auto default_grid_name{ "" };
+  static constexpr auto default_grid_frame{ "" };
+  static constexpr auto default_grid_resolution{ 0.05 };
+  static const std::vector<double> default_grid_size{ 10.0, 10.0 };
+  static const std::vector<double> default_grid_origin{ -5.0, -5.0 };
+  static const std::vector<double> default_grid_height_range{ 0.05, 2.0 };
+  static constexpr auto default_grid_min_points{ 3 };
+  static constexpr auto default_grid_rate_hz{ 5.0 };
+  static constexpr auto default_rgb_registration{ "" };
+  static constexpr auto default_rgb_registration_max_age{ 0.1 };
+  static constexpr auto default_rgb_rectify{ false };
+  static constexpr auto default_worker_threads{ 2 };
   RCLCPP_INFO(this->logger_, "declaring parameters...");
 
   rcl_interfaces::msg::ParameterDescriptor pcic_port_descriptor;
@@ -508,6 +1257,452 @@ void CameraNode::init_params()
   sync_clocks_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
   sync_clocks_descriptor.description = "Attempt to sync host and camera clock";
   this->declare_parameter("sync_clocks", default_sync_clocks, sync_clocks_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor metrics_bind_address_descriptor;
+  metrics_bind_address_descriptor.name = "metrics_bind_address";
+  metrics_bind_address_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  metrics_bind_address_descriptor.description = "Interface the OpenMetrics (Prometheus) endpoint binds to";
+  metrics_bind_address_descriptor.additional_constraints = "An address or resolvable name of a local interface";
+  this->declare_parameter("metrics_bind_address", default_metrics_bind_address, metrics_bind_address_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor metrics_port_descriptor;
+  metrics_port_descriptor.name = "metrics_port";
+  metrics_port_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  metrics_port_descriptor.description = "TCP port of the OpenMetrics (Prometheus) endpoint";
+  metrics_port_descriptor.additional_constraints = "0 disables the endpoint. Shared by all heads in a process.";
+  this->declare_parameter("metrics_port", default_metrics_port, metrics_port_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor resource_usage_period_secs_descriptor;
+  resource_usage_period_secs_descriptor.name = "resource_usage_period_secs";
+  resource_usage_period_secs_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  resource_usage_period_secs_descriptor.description =
+      "Period (seconds) for publishing per-thread CPU and memory usage on ~/resource_usage";
+  resource_usage_period_secs_descriptor.additional_constraints = "A period <= 0 disables the self-accounting";
+  this->declare_parameter("resource_usage_period_secs", default_resource_usage_period_secs,
+                          resource_usage_period_secs_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor governor_descriptor;
+  governor_descriptor.name = "governor";
+  governor_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  governor_descriptor.description =
+      "Lower the frame rate while the host or the subscribers cannot keep up, restore it once they can";
+  governor_descriptor.additional_constraints =
+      "One of `off`, `decimate` (skip frames) or `framerate` (lower the framerate of the port)";
+  this->declare_parameter("governor", default_governor, governor_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor governor_period_secs_descriptor;
+  governor_period_secs_descriptor.name = "governor_period_secs";
+  governor_period_secs_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  governor_period_secs_descriptor.description = "Period (seconds) of the governor's decisions";
+  this->declare_parameter("governor_period_secs", default_governor_period_secs, governor_period_secs_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor governor_cpu_high_descriptor;
+  governor_cpu_high_descriptor.name = "governor_cpu_high";
+  governor_cpu_high_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  governor_cpu_high_descriptor.description = "Busy fraction of all cores of the host above which the rate is lowered";
+  this->declare_parameter("governor_cpu_high", default_governor_cpu_high, governor_cpu_high_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor governor_cpu_low_descriptor;
+  governor_cpu_low_descriptor.name = "governor_cpu_low";
+  governor_cpu_low_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  governor_cpu_low_descriptor.description = "Busy fraction of all cores of the host below which the rate is restored";
+  this->declare_parameter("governor_cpu_low", default_governor_cpu_low, governor_cpu_low_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor governor_publish_latency_descriptor;
+  governor_publish_latency_descriptor.name = "governor_publish_latency";
+  governor_publish_latency_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  governor_publish_latency_descriptor.description =
+      "Mean duration (seconds) of a publish() call above which the rate is lowered, restored below half of it";
+  this->declare_parameter("governor_publish_latency", default_governor_publish_latency,
+                          governor_publish_latency_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor governor_max_level_descriptor;
+  governor_max_level_descriptor.name = "governor_max_level";
+  governor_max_level_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  governor_max_level_descriptor.description =
+      "Lowest rate the governor goes down to, as a level n running at 1 / (n + 1) of the nominal rate";
+  this->declare_parameter("governor_max_level", default_governor_max_level, governor_max_level_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor frame_budget_ms_descriptor;
+  frame_budget_ms_descriptor.name = "frame_budget_ms";
+  frame_budget_ms_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  frame_budget_ms_descriptor.description =
+      "Default deadline (milliseconds after the reception of a frame) of its topics, topics that would miss it are "
+      "skipped";
+  frame_budget_ms_descriptor.additional_constraints = "0 disables the deadlines";
+  this->declare_parameter("frame_budget_ms", default_frame_budget_ms, frame_budget_ms_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor topic_priorities_descriptor;
+  topic_priorities_descriptor.name = "topic_priorities";
+  topic_priorities_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  topic_priorities_descriptor.description = "Topics of a frame, most important first, in the order they are published";
+  topic_priorities_descriptor.additional_constraints =
+      "Of cloud, distance, confidence, amplitude, rgb, distance_noise, raw_amplitude; topics left out follow in this "
+      "order";
+  this->declare_parameter("topic_priorities", default_topic_priorities, topic_priorities_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor topic_deadlines_ms_descriptor;
+  topic_deadlines_ms_descriptor.name = "topic_deadlines_ms";
+  topic_deadlines_ms_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  topic_deadlines_ms_descriptor.description =
+      "Deadline (milliseconds after the reception of a frame) of each topic of topic_priorities";
+  topic_deadlines_ms_descriptor.additional_constraints =
+      "Empty or one per entry of topic_priorities; 0 uses frame_budget_ms, < 0 means no deadline";
+  this->declare_parameter("topic_deadlines_ms", default_topic_deadlines_ms, topic_deadlines_ms_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor distance_output_descriptor;
+  distance_output_descriptor.name = "distance_output";
+  distance_output_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  distance_output_descriptor.description = "Encoding of ~/distance";
+  distance_output_descriptor.additional_constraints =
+      "'native' (as delivered by the camera) or 'mm16' (16UC1 millimeters, 0 == invalid)";
+  this->declare_parameter("distance_output", default_distance_output, distance_output_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor cloud_encoding_descriptor;
+  cloud_encoding_descriptor.name = "cloud_encoding";
+  cloud_encoding_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  cloud_encoding_descriptor.description = "Encoding of the x, y, z fields of ~/cloud";
+  cloud_encoding_descriptor.additional_constraints =
+      "'float32' (meters, 12 bytes per point) or 'int16_mm' (millimeters, 6 bytes per point)";
+  this->declare_parameter("cloud_encoding", default_cloud_encoding, cloud_encoding_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor cloud_intensity_descriptor;
+  cloud_intensity_descriptor.name = "cloud_intensity";
+  cloud_intensity_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  cloud_intensity_descriptor.description =
+      "Add a UINT8 intensity field (from the normalized amplitude) to ~/cloud, only with cloud_encoding 'int16_mm'";
+  this->declare_parameter("cloud_intensity", default_cloud_intensity, cloud_intensity_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor cloud_intensity_max_descriptor;
+  cloud_intensity_max_descriptor.name = "cloud_intensity_max";
+  cloud_intensity_max_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  cloud_intensity_max_descriptor.description = "Normalized amplitude mapped to an intensity of 255";
+  this->declare_parameter("cloud_intensity_max", default_cloud_intensity_max, cloud_intensity_max_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor cloud_sigma_descriptor;
+  cloud_sigma_descriptor.name = "cloud_sigma";
+  cloud_sigma_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  cloud_sigma_descriptor.description = "Add the distance noise (meters) of every point to ~/cloud as a `sigma` field";
+  cloud_sigma_descriptor.additional_constraints = "Requires cloud_encoding float32";
+  this->declare_parameter("cloud_sigma", default_cloud_sigma, cloud_sigma_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor cloud_noise_threshold_descriptor;
+  cloud_noise_threshold_descriptor.name = "cloud_noise_threshold";
+  cloud_noise_threshold_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  cloud_noise_threshold_descriptor.description =
+      "Distance noise (meters) above which points of ~/cloud are invalidated (NaN), 0 to keep all points";
+  cloud_noise_threshold_descriptor.additional_constraints = "Requires cloud_encoding float32";
+  this->declare_parameter("cloud_noise_threshold", default_cloud_noise_threshold, cloud_noise_threshold_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor cloud_target_frame_descriptor;
+  cloud_target_frame_descriptor.name = "cloud_target_frame";
+  cloud_target_frame_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  cloud_target_frame_descriptor.description =
+      "Frame (e.g. base_link) to publish ~/cloud in, via the static transforms on /tf_static, empty for the optical "
+      "frame";
+  this->declare_parameter("cloud_target_frame", default_cloud_target_frame, cloud_target_frame_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor deskew_topic_descriptor;
+  deskew_topic_descriptor.name = "deskew_topic";
+  deskew_topic_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  deskew_topic_descriptor.description =
+      "Odometry or IMU topic whose twists move ~/cloud from the acquisition to the reception time, empty to disable";
+  deskew_topic_descriptor.additional_constraints = "Requires cloud_target_frame, the frame of the twists";
+  this->declare_parameter("deskew_topic", default_deskew_topic, deskew_topic_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor deskew_source_descriptor;
+  deskew_source_descriptor.name = "deskew_source";
+  deskew_source_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  deskew_source_descriptor.description = "Message type of deskew_topic";
+  deskew_source_descriptor.additional_constraints = "One of `odometry` (nav_msgs/Odometry) or `imu` (sensor_msgs/Imu)";
+  this->declare_parameter("deskew_source", default_deskew_source, deskew_source_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor deskew_max_hold_descriptor;
+  deskew_max_hold_descriptor.name = "deskew_max_hold";
+  deskew_max_hold_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  deskew_max_hold_descriptor.description =
+      "Time (seconds) the last twist is assumed to hold, beyond it clouds are published without deskew";
+  this->declare_parameter("deskew_max_hold", default_deskew_max_hold, deskew_max_hold_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor distance_filter_descriptor;
+  distance_filter_descriptor.name = "distance_filter";
+  distance_filter_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  distance_filter_descriptor.description =
+      "Smooth the distance with an edge-preserving filter guided by the amplitude, before ~/cloud is generated";
+  this->declare_parameter("distance_filter", default_distance_filter, distance_filter_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor distance_filter_radius_descriptor;
+  distance_filter_radius_descriptor.name = "distance_filter_radius";
+  distance_filter_radius_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  distance_filter_radius_descriptor.description = "Radius (pixels) of the windows of the distance filter";
+  this->declare_parameter("distance_filter_radius", default_distance_filter_radius,
+                          distance_filter_radius_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor distance_filter_eps_descriptor;
+  distance_filter_eps_descriptor.name = "distance_filter_eps";
+  distance_filter_eps_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  distance_filter_eps_descriptor.description =
+      "Regularization of the distance filter, larger values smooth across weaker amplitude edges";
+  this->declare_parameter("distance_filter_eps", default_distance_filter_eps, distance_filter_eps_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor preview_rate_hz_descriptor;
+  preview_rate_hz_descriptor.name = "preview_rate_hz";
+  preview_rate_hz_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  preview_rate_hz_descriptor.description =
+      "Maximum rate of ~/distance_preview/compressed and ~/amplitude_preview/compressed";
+  preview_rate_hz_descriptor.additional_constraints =
+      "A rate <= 0 disables the previews. Previews are only rendered while subscribed.";
+  this->declare_parameter("preview_rate_hz", default_preview_rate_hz, preview_rate_hz_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor preview_colormap_descriptor;
+  preview_colormap_descriptor.name = "preview_colormap";
+  preview_colormap_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  preview_colormap_descriptor.description = "Colormap of the preview images";
+  preview_colormap_descriptor.additional_constraints = "'turbo' or 'gray'";
+  this->declare_parameter("preview_colormap", default_preview_colormap, preview_colormap_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor preview_jpeg_quality_descriptor;
+  preview_jpeg_quality_descriptor.name = "preview_jpeg_quality";
+  preview_jpeg_quality_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  preview_jpeg_quality_descriptor.description = "JPEG quality of the preview images";
+  preview_jpeg_quality_descriptor.additional_constraints = "1 .. 100";
+  this->declare_parameter("preview_jpeg_quality", default_preview_jpeg_quality, preview_jpeg_quality_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor preview_distance_range_descriptor;
+  preview_distance_range_descriptor.name = "preview_distance_range";
+  preview_distance_range_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  preview_distance_range_descriptor.description = "[min, max] distance (meters) spanned by the preview colormap";
+  this->declare_parameter("preview_distance_range", default_preview_distance_range,
+                          preview_distance_range_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor preview_amplitude_range_descriptor;
+  preview_amplitude_range_descriptor.name = "preview_amplitude_range";
+  preview_amplitude_range_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  preview_amplitude_range_descriptor.description = "[min, max] normalized amplitude spanned by the preview colormap";
+  this->declare_parameter("preview_amplitude_range", default_preview_amplitude_range,
+                          preview_amplitude_range_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor change_detection_descriptor;
+  change_detection_descriptor.name = "change_detection";
+  change_detection_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  change_detection_descriptor.description = "Suppression of the ToF streams while the scene does not change";
+  change_detection_descriptor.additional_constraints =
+      "'off', 'skip' (publish changed frames and keyframes only) or 'tiles' (publish the changed tiles on "
+      "~/distance_tiles, all streams on keyframes only)";
+  this->declare_parameter("change_detection", default_change_detection, change_detection_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor change_tile_size_descriptor;
+  change_tile_size_descriptor.name = "change_tile_size";
+  change_tile_size_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  change_tile_size_descriptor.description = "Edge length (pixels) of the tiles compared by the change detection";
+  this->declare_parameter("change_tile_size", default_change_tile_size, change_tile_size_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor change_threshold_abs_descriptor;
+  change_threshold_abs_descriptor.name = "change_threshold_abs";
+  change_threshold_abs_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  change_threshold_abs_descriptor.description =
+      "Constant part (meters) of the distance noise a pixel must exceed to count as changed";
+  this->declare_parameter("change_threshold_abs", default_change_threshold_abs, change_threshold_abs_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor change_threshold_rel_descriptor;
+  change_threshold_rel_descriptor.name = "change_threshold_rel";
+  change_threshold_rel_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  change_threshold_rel_descriptor.description =
+      "Distance proportional part (fraction of the distance) of the noise a pixel must exceed to count as changed";
+  this->declare_parameter("change_threshold_rel", default_change_threshold_rel, change_threshold_rel_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor change_min_fraction_descriptor;
+  change_min_fraction_descriptor.name = "change_min_fraction";
+  change_min_fraction_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  change_min_fraction_descriptor.description = "Fraction of changed pixels above which a tile counts as changed";
+  this->declare_parameter("change_min_fraction", default_change_min_fraction, change_min_fraction_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor change_keyframe_interval_secs_descriptor;
+  change_keyframe_interval_secs_descriptor.name = "change_keyframe_interval_secs";
+  change_keyframe_interval_secs_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  change_keyframe_interval_secs_descriptor.description =
+      "Interval (seconds) of keyframes, published in full regardless of changes";
+  change_keyframe_interval_secs_descriptor.additional_constraints = "An interval <= 0 disables periodic keyframes";
+  this->declare_parameter("change_keyframe_interval_secs", default_change_keyframe_interval_secs,
+                          change_keyframe_interval_secs_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor sector_count_descriptor;
+  sector_count_descriptor.name = "sector_count";
+  sector_count_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  sector_count_descriptor.description = "Number of angular sectors of the nearest point summary on ~/sectors";
+  sector_count_descriptor.additional_constraints = "0 disables ~/sectors";
+  this->declare_parameter("sector_count", default_sector_count, sector_count_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor sector_angle_range_descriptor;
+  sector_angle_range_descriptor.name = "sector_angle_range";
+  sector_angle_range_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  sector_angle_range_descriptor.description =
+      "[min, max] azimuth atan2(y, x) (rad, in the frame of ~/cloud) split into sector_count sectors";
+  this->declare_parameter("sector_angle_range", default_sector_angle_range, sector_angle_range_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor sector_band_limits_descriptor;
+  sector_band_limits_descriptor.name = "sector_band_limits";
+  sector_band_limits_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  sector_band_limits_descriptor.description = "Increasing z edges (meters) of the height bands of ~/sectors";
+  this->declare_parameter("sector_band_limits", default_sector_band_limits, sector_band_limits_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor confidence_bits_descriptor;
+  confidence_bits_descriptor.name = "confidence_bits";
+  confidence_bits_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY;
+  confidence_bits_descriptor.description =
+      "Confidence bits of the [invalid, saturated, low_amplitude, out_of_range] masks (~/confidence/*)";
+  confidence_bits_descriptor.additional_constraints = "Four bit masks in 0 .. 65535";
+  this->declare_parameter("confidence_bits", default_confidence_bits, confidence_bits_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor stage_confidence_exclude_descriptor;
+  stage_confidence_exclude_descriptor.name = "stage_confidence_exclude";
+  stage_confidence_exclude_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  stage_confidence_exclude_descriptor.description =
+      "Points the processing stages ignore, by confidence mask: invalid, saturated, low_amplitude, out_of_range";
+  this->declare_parameter("stage_confidence_exclude", default_stage_confidence_exclude,
+                          stage_confidence_exclude_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor ground_removal_descriptor;
+  ground_removal_descriptor.name = "ground_removal";
+  ground_removal_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  ground_removal_descriptor.description =
+      "Estimate the ground plane of ~/cloud and publish ~/ground_plane, ~/cloud_ground and ~/cloud_obstacles";
+  this->declare_parameter("ground_removal", default_ground_removal, ground_removal_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor ground_threshold_descriptor;
+  ground_threshold_descriptor.name = "ground_threshold";
+  ground_threshold_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  ground_threshold_descriptor.description = "Distance (meters) to the ground plane up to which a point is ground";
+  this->declare_parameter("ground_threshold", default_ground_threshold, ground_threshold_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor ground_up_descriptor;
+  ground_up_descriptor.name = "ground_up";
+  ground_up_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  ground_up_descriptor.description =
+      "[x, y, z] up direction in the frame of ~/cloud, the ground normal points along it";
+  this->declare_parameter("ground_up", default_ground_up, ground_up_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor ground_max_tilt_deg_descriptor;
+  ground_max_tilt_deg_descriptor.name = "ground_max_tilt_deg";
+  ground_max_tilt_deg_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  ground_max_tilt_deg_descriptor.description = "Maximum angle (degrees) between the ground normal and ground_up";
+  this->declare_parameter("ground_max_tilt_deg", default_ground_max_tilt_deg, ground_max_tilt_deg_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor ground_time_budget_ms_descriptor;
+  ground_time_budget_ms_descriptor.name = "ground_time_budget_ms";
+  ground_time_budget_ms_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  ground_time_budget_ms_descriptor.description =
+      "Time (milliseconds) after which the ground plane hypothesis scoring stops and keeps the best one";
+  this->declare_parameter("ground_time_budget_ms", default_ground_time_budget_ms, ground_time_budget_ms_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor ground_min_inlier_ratio_descriptor;
+  ground_min_inlier_ratio_descriptor.name = "ground_min_inlier_ratio";
+  ground_min_inlier_ratio_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  ground_min_inlier_ratio_descriptor.description =
+      "Fraction of the valid points which must be ground for the plane to be valid";
+  this->declare_parameter("ground_min_inlier_ratio", default_ground_min_inlier_ratio,
+                          ground_min_inlier_ratio_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor height_grid_descriptor;
+  height_grid_descriptor.name = "height_grid";
+  height_grid_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  height_grid_descriptor.description = "Bin ~/cloud into an occupancy grid and a height map";
+  this->declare_parameter("height_grid", default_height_grid, height_grid_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor grid_name_descriptor;
+  grid_name_descriptor.name = "grid_name";
+  grid_name_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  grid_name_descriptor.description =
+      "Name (and topic) of a grid shared by the heads of the process, empty for a grid of this head on ~/grid";
+  this->declare_parameter("grid_name", default_grid_name, grid_name_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor grid_frame_descriptor;
+  grid_frame_descriptor.name = "grid_frame";
+  grid_frame_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  grid_frame_descriptor.description =
+      "frame_id of the grid, empty for the frame of ~/cloud (only for a grid of this head, see grid_name)";
+  this->declare_parameter("grid_frame", default_grid_frame, grid_frame_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor grid_resolution_descriptor;
+  grid_resolution_descriptor.name = "grid_resolution";
+  grid_resolution_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  grid_resolution_descriptor.description = "Edge length (meters) of the grid cells";
+  this->declare_parameter("grid_resolution", default_grid_resolution, grid_resolution_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor grid_size_descriptor;
+  grid_size_descriptor.name = "grid_size";
+  grid_size_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  grid_size_descriptor.description = "[x, y] extent (meters) of the grid";
+  this->declare_parameter("grid_size", default_grid_size, grid_size_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor grid_origin_descriptor;
+  grid_origin_descriptor.name = "grid_origin";
+  grid_origin_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  grid_origin_descriptor.description = "[x, y] position (meters) of the corner of cell (0, 0)";
+  this->declare_parameter("grid_origin", default_grid_origin, grid_origin_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor grid_height_range_descriptor;
+  grid_height_range_descriptor.name = "grid_height_range";
+  grid_height_range_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  grid_height_range_descriptor.description =
+      "[min, max] z (meters) of obstacle points, points below are ground, points above are ignored";
+  this->declare_parameter("grid_height_range", default_grid_height_range, grid_height_range_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor grid_min_points_descriptor;
+  grid_min_points_descriptor.name = "grid_min_points";
+  grid_min_points_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  grid_min_points_descriptor.description = "Number of obstacle points from which a cell is occupied";
+  this->declare_parameter("grid_min_points", default_grid_min_points, grid_min_points_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor grid_rate_hz_descriptor;
+  grid_rate_hz_descriptor.name = "grid_rate_hz";
+  grid_rate_hz_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  grid_rate_hz_descriptor.description = "Maximum rate of the grid, 0 for every frame";
+  this->declare_parameter("grid_rate_hz", default_grid_rate_hz, grid_rate_hz_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor rgb_registration_descriptor;
+  rgb_registration_descriptor.name = "rgb_registration";
+  rgb_registration_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  rgb_registration_descriptor.description =
+      "Name pairing a 2D head with the 3D heads publishing its colors on ~/rgb_registered, empty to disable";
+  rgb_registration_descriptor.additional_constraints =
+      "Set the same name on the 2D and the 3D heads, loaded into the same process (e.g., a component container)";
+  this->declare_parameter("rgb_registration", default_rgb_registration, rgb_registration_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor rgb_registration_max_age_descriptor;
+  rgb_registration_max_age_descriptor.name = "rgb_registration_max_age";
+  rgb_registration_max_age_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  rgb_registration_max_age_descriptor.description =
+      "Maximum time (seconds) between the RGB and the ToF frame registered to each other";
+  this->declare_parameter("rgb_registration_max_age", default_rgb_registration_max_age,
+                          rgb_registration_max_age_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor rgb_rectify_descriptor;
+  rgb_rectify_descriptor.name = "rgb_rectify";
+  rgb_rectify_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  rgb_rectify_descriptor.description = "Publish the undistorted RGB image on ~/rgb_rect (2D heads)";
+  rgb_rectify_descriptor.additional_constraints = "Only computed while subscribed";
+  this->declare_parameter("rgb_rectify", default_rgb_rectify, rgb_rectify_descriptor);
+
+  rcl_interfaces::msg::ParameterDescriptor worker_threads_descriptor;
+  worker_threads_descriptor.name = "worker_threads";
+  worker_threads_descriptor.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  worker_threads_descriptor.description =
+      "Number of threads, in addition to the stage thread, splitting the passes of the processing stages";
+  this->declare_parameter("worker_threads", default_worker_threads, worker_threads_descriptor);
+}
+
+std::array<float, 2> CameraNode::get_range_parameter(const std::string& name)
+{
+  std::vector<double> range;
+  this->get_parameter(name, range);
+  if (range.size() != 2 || !(range[0] < range[1]))
+  {
+    RCLCPP_WARN(this->logger_, "%s must be [min, max] with min < max, using [0, 1]", name.c_str());
+    return { 0.0F, 1.0F };
+  }
+  RCLCPP_INFO(this->logger_, "%s: [%f, %f]", name.c_str(), range[0], range[1]);
+  return { static_cast<float>(range[0]), static_cast<float>(range[1]) };
 }
 
 rcl_interfaces::msg::SetParametersResult CameraNode::set_params_cb(const std::vector<rclcpp::Parameter>& params)
@@ -518,23 +1713,20 @@ rcl_interfaces::msg::SetParametersResult CameraNode::set_params_cb(const std::ve
   // If we need to reconnect to the/a camera, we force a state transition
   // here.
   //
+  // The ones changed on the fly go out as a single snapshot, so the publish
+  // loop never sees half of a call. A call without any of them leaves the
+  // snapshot alone.
+  //
   bool reconfigure = false;
+  std::vector<rclcpp::Parameter> live_changes;
   for (const auto& param : params)
   {
     const std::string& name = param.get_name();
     RCLCPP_INFO(this->logger_, "Handling param change for: %s", name.c_str());
 
-    if (name == "timeout_millis")
-    {
-      this->timeout_millis_ = static_cast<int>(param.as_int());
-    }
-    else if (name == "timeout_tolerance_secs")
-    {
-      this->timeout_tolerance_secs_ = static_cast<float>(param.as_double());
-    }
-    else if (name == "frame_latency_thresh")
+    if (name == "timeout_millis" || name == "timeout_tolerance_secs" || name == "frame_latency_thresh")
     {
-      this->frame_latency_thresh_ = static_cast<float>(param.as_double());
+      live_changes.push_back(param);
     }
     else
     {
@@ -543,42 +1735,77 @@ rcl_interfaces::msg::SetParametersResult CameraNode::set_params_cb(const std::ve
     }
   }
 
+  if (!live_changes.empty())
+  {
+    const auto live_version = this->live_params_.update([&](LiveParams& live) {
+      for (const auto& param : live_changes)
+      {
+        if (param.get_name() == "timeout_millis")
+        {
+          live.timeout_millis = static_cast<int>(param.as_int());
+        }
+        else if (param.get_name() == "timeout_tolerance_secs")
+        {
+          live.timeout_tolerance_secs = static_cast<float>(param.as_double());
+        }
+        else
+        {
+          live.frame_latency_thresh = static_cast<float>(param.as_double());
+        }
+      }
+    });
+    RCLCPP_INFO(this->logger_, "Live parameters now at version %lu", static_cast<unsigned long>(live_version));
+  }
+
   rcl_interfaces::msg::SetParametersResult result;
   result.successful = true;
   result.reason = "OK";
 
   if (reconfigure)
   {
-    std::thread emit_reconfigure_t([this]() {
-      auto state_id = this->get_current_state().id();
-      switch (state_id)
-      {
-        case lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE:
-          this->cleanup();
-          break;
-
-        case lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE:
-          this->deactivate();
-          break;
-
-        default:
-          RCLCPP_WARN(this->logger_, "Skipping reconfiguration from state id: %d", state_id);
-          break;
-      }
-    });
-    emit_reconfigure_t.detach();
+    this->transition_worker_->request(TransitionRequest::RECONFIGURE);
   }
 
   RCLCPP_INFO(this->logger_, "Set param callback OK.");
   return result;
 }
 
+bool CameraNode::run_transition(TransitionRequest request)
+{
+  const auto state_id = this->get_current_state().id();
+  switch (transition_step(request, state_id))
+  {
+    case TransitionStep::DEACTIVATE:
+      return this->deactivate().id() == lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE;
+
+    case TransitionStep::CLEANUP:
+      return this->cleanup().id() == lifecycle_msgs::msg::State::PRIMARY_STATE_UNCONFIGURED;
+
+    case TransitionStep::NONE:
+      if (request == TransitionRequest::RECONFIGURE)
+      {
+        RCLCPP_WARN(this->logger_, "Skipping reconfiguration from state id: %d", state_id);
+      }
+      else
+      {
+        RCLCPP_INFO(this->logger_, "Skipping deactivation from state id: %d", state_id);
+      }
+      return true;
+  }
+  return false;
+}
+
 void CameraNode::stop_publish_loop()
 {
+  this->unlisten_port_standby();
   if (!this->test_destroy_)
   {
     RCLCPP_INFO(this->logger_, "Stopping publishing thread...");
-    this->test_destroy_ = true;
+    {
+      std::lock_guard<std::mutex> lock(this->standby_mutex_);
+      this->test_destroy_ = true;
+    }
+    this->standby_cv_.notify_all();
     if (this->pub_loop_.joinable())
     {
       this->pub_loop_.join();
@@ -589,11 +1816,458 @@ void CameraNode::stop_publish_loop()
       RCLCPP_WARN(this->logger_, "Publishing thread is not joinable!");
     }
   }
+
+  this->stop_stages();
+}
+
+void CameraNode::set_standby(bool standby)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->standby_mutex_);
+    if (this->standby_.exchange(standby) == standby)
+    {
+      return;
+    }
+  }
+  this->standby_cv_.notify_all();
+  RCLCPP_INFO(this->logger_, "%s", standby ? "Entering standby, port is idle" : "Leaving standby, resuming streaming");
+}
+
+void CameraNode::unlisten_port_standby()
+{
+  if (this->port_standby_)
+  {
+    this->port_standby_->unlisten(this->port_standby_listener_);
+    this->port_standby_.reset();
+  }
+}
+
+void CameraNode::stop_stages()
+{
+  this->stage_worker_.reset();
+  this->worker_pool_.reset();
+  this->filter_pool_.reset();
+  if (this->shared_grid_)
+  {
+    this->shared_grid_->leave(this->grid_contributor_);
+    this->shared_grid_.reset();
+  }
+  this->color_exchange_.reset();
+}
+
+void CameraNode::clear_grid_contribution()
+{
+  // queued behind the running stage job, so that a frame still being binned
+  // does not bring the cells back
+  if (this->stage_worker_ && this->shared_grid_)
+  {
+    this->stage_worker_->post([this] { this->shared_grid_->clear(this->grid_contributor_); });
+  }
+}
+
+void CameraNode::filter_distance(ifm3d::Buffer& dist, ifm3d::Buffer& amp, ifm3d::Buffer* xyz)
+{
+  const bool amp_float = amp.dataFormat() == ifm3d::pixel_format::FORMAT_32F;
+  if (dist.dataFormat() != ifm3d::pixel_format::FORMAT_32F ||
+      (!amp_float && amp.dataFormat() != ifm3d::pixel_format::FORMAT_16U) || dist.width() != amp.width() ||
+      dist.height() != amp.height())
+  {
+    RCLCPP_WARN_ONCE(this->logger_, "Distance or amplitude unsupported, distance filter disabled!");
+    return;
+  }
+
+  const std::size_t n = static_cast<std::size_t>(dist.width()) * dist.height();
+  auto* distance = dist.ptr<float>(0);
+  this->filtered_distance_.resize(n);
+  if (amp_float)
+  {
+    this->guided_filter_(distance, amp.ptr<float>(0), dist.width(), dist.height(), this->filtered_distance_.data(),
+                         *this->filter_pool_);
+  }
+  else
+  {
+    this->guided_filter_(distance, amp.ptr<std::uint16_t>(0), dist.width(), dist.height(),
+                         this->filtered_distance_.data(), *this->filter_pool_);
+  }
+
+  if (xyz != nullptr && xyz->dataFormat() == ifm3d::pixel_format::FORMAT_32F3 &&
+      static_cast<std::size_t>(xyz->width()) * xyz->height() == n)
+  {
+    rescale_points(xyz->ptr<float>(0), distance, this->filtered_distance_.data(), n);
+  }
+  std::copy(this->filtered_distance_.begin(), this->filtered_distance_.end(), distance);
+}
+
+void CameraNode::process_stages(StageFrame& frame)
+{
+  if (!frame.confidence.empty())
+  {
+    exclude_points(frame.xyz.data(), frame.confidence.data(), frame.confidence.size(),
+                   this->stage_confidence_exclude_);
+  }
+  if (this->ground_removal_ && !frame.xyz.empty())
+  {
+    this->remove_ground(frame.xyz, frame.xyz_header);
+  }
+  if (this->height_grid_ && !frame.xyz.empty())
+  {
+    this->update_grid(frame.xyz, frame.xyz_header);
+  }
+  if (!frame.distance.empty())
+  {
+    this->register_rgb(frame);
+  }
+  if (!frame.jpeg.empty())
+  {
+    this->rectify_rgb(frame);
+  }
+}
+
+void CameraNode::publish_confidence_masks(const ifm3d::Buffer& conf, const std_msgs::msg::Header& header)
+{
+  const bool u16 = conf.dataFormat() == ifm3d::pixel_format::FORMAT_16U;
+  if (!u16 && conf.dataFormat() != ifm3d::pixel_format::FORMAT_8U)
+  {
+    RCLCPP_WARN_ONCE(this->logger_, "Unsupported confidence format, not publishing ~/confidence/*");
+    return;
+  }
+  if (!u16 && !confidence_bits_fit(this->confidence_bits_, sizeof(std::uint8_t)))
+  {
+    RCLCPP_WARN_ONCE(this->logger_,
+                     "confidence_bits above 0xFF never match the 8 bit confidence image of this head, "
+                     "the masks only test the lower bits");
+  }
+
+  // all subscribed masks are decoded in one pass, converting the first one
+  std::array<ImageMsg, num_confidence_masks> msgs;
+  std::array<std::uint8_t*, num_confidence_masks> outputs{};
+  std::size_t first = num_confidence_masks;
+  for (std::size_t mask = num_confidence_masks; mask-- > 0;)
+  {
+    if (this->conf_mask_pubs_[mask]->get_subscription_count() == 0)
+    {
+      continue;
+    }
+    auto& msg = msgs[mask];
+    msg.header = header;
+    msg.height = conf.height();
+    msg.width = conf.width();
+    msg.encoding = "mono8";
+    msg.is_bigendian = false;
+    msg.step = conf.width();
+    msg.data.resize(static_cast<std::size_t>(msg.step) * msg.height);
+    outputs[mask] = msg.data.data();
+    first = mask;
+  }
+  if (first == num_confidence_masks)
+  {
+    return;
+  }
+
+  const std::size_t n = static_cast<std::size_t>(conf.width()) * conf.height();
+  for (std::size_t mask = first; mask < num_confidence_masks; ++mask)
+  {
+    if (outputs[mask] == nullptr)
+    {
+      continue;
+    }
+    convert_and_publish(
+        this->conf_mask_pubs_[mask],
+        [&] {
+          if (mask == first)
+          {
+            if (u16)
+            {
+              decode_confidence(conf.ptr<std::uint16_t>(0), n, this->confidence_bits_, outputs);
+            }
+            else
+            {
+              decode_confidence(conf.ptr<std::uint8_t>(0), n, this->confidence_bits_, outputs);
+            }
+          }
+          return std::move(msgs[mask]);
+        },
+        *this->metrics_);
+  }
+}
+
+void CameraNode::remove_ground(const std::vector<float>& xyz, const std_msgs::msg::Header& header)
+{
+  auto& stage_seconds = this->metrics_->stage_seconds;
+  const std::size_t n = xyz.size() / 3;
+
+  try
+  {
+    const auto t_start = std::chrono::steady_clock::now();
+    const auto result = this->ground_estimator_.estimate(xyz.data(), n, *this->worker_pool_);
+    const std::chrono::duration<float> compute_time = std::chrono::steady_clock::now() - t_start;
+
+    convert_and_publish(
+        this->ground_plane_pub_,
+        [&] {
+          GroundPlaneMsg msg;
+          msg.header = header;
+          msg.valid = result.valid;
+          msg.a = result.plane.a;
+          msg.b = result.plane.b;
+          msg.c = result.plane.c;
+          msg.d = result.plane.d;
+          msg.inliers = static_cast<std::uint32_t>(result.inliers);
+          msg.points = static_cast<std::uint32_t>(result.points);
+          msg.seeded = result.seeded;
+          msg.timed_out = result.timed_out;
+          msg.compute_time = compute_time.count();
+          return msg;
+        },
+        stage_seconds);
+
+    if (!result.valid || (this->cloud_ground_pub_->get_subscription_count() == 0 &&
+                          this->cloud_obstacles_pub_->get_subscription_count() == 0))
+    {
+      return;
+    }
+
+    this->ground_estimator_.split(xyz.data(), n, result.plane, this->ground_points_, this->obstacle_points_,
+                                  *this->worker_pool_);
+    convert_and_publish(
+        this->cloud_ground_pub_,
+        [&] { return xyz_to_ros_cloud(this->ground_points_.data(), this->ground_points_.size() / 3, header); },
+        stage_seconds);
+    convert_and_publish(
+        this->cloud_obstacles_pub_,
+        [&] { return xyz_to_ros_cloud(this->obstacle_points_.data(), this->obstacle_points_.size() / 3, header); },
+        stage_seconds);
+  }
+  catch (const std::exception& ex)
+  {
+    RCLCPP_ERROR(this->logger_, "Ground removal failed: %s", ex.what());
+  }
+}
+
+void CameraNode::update_grid(const std::vector<float>& xyz, const std_msgs::msg::Header& header)
+{
+  // heads sharing a grid publish on the same topic, so any of them sees all
+  // the subscribers
+  if (this->grid_pub_->get_subscription_count() == 0 && this->grid_height_pub_->get_subscription_count() == 0)
+  {
+    return;
+  }
+
+  auto& stage_seconds = this->metrics_->stage_seconds;
+  try
+  {
+    this->grid_.bin(xyz.data(), xyz.size() / 3, *this->worker_pool_);
+    this->shared_grid_->update(this->grid_contributor_, this->grid_);
+
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<float>(this->grid_rate_hz_ > 0.0F ? 1.0F / this->grid_rate_hz_ : 0.0F));
+    if (!this->shared_grid_->claim_publication(std::chrono::steady_clock::now(), period))
+    {
+      return;
+    }
+    this->shared_grid_->merge(this->grid_cells_);
+
+    const auto& params = this->shared_grid_->params();
+    std_msgs::msg::Header grid_header = header;
+    if (!this->grid_frame_.empty())
+    {
+      grid_header.frame_id = this->grid_frame_;
+    }
+
+    nav_msgs::msg::MapMetaData info;
+    info.map_load_time = grid_header.stamp;
+    info.resolution = params.resolution;
+    info.width = params.width;
+    info.height = params.height;
+    info.origin.position.x = params.origin_x;
+    info.origin.position.y = params.origin_y;
+    info.origin.orientation.w = 1.0;
+
+    if (this->grid_pub_->get_subscription_count() > 0)
+    {
+      convert_and_publish(
+          this->grid_pub_,
+          [&] {
+            OccupancyGridMsg msg;
+            msg.header = grid_header;
+            msg.info = info;
+            HeightGrid::to_occupancy(this->grid_cells_, static_cast<std::uint32_t>(std::max(this->grid_min_points_, 1)),
+                                     msg.data);
+            return msg;
+          },
+          stage_seconds);
+    }
+    if (this->grid_height_pub_->get_subscription_count() > 0)
+    {
+      convert_and_publish(
+          this->grid_height_pub_,
+          [&] {
+            HeightMapMsg msg;
+            msg.header = grid_header;
+            msg.info = info;
+            msg.max_height.reserve(this->grid_cells_.size());
+            msg.obstacle_count.reserve(this->grid_cells_.size());
+            msg.ground_count.reserve(this->grid_cells_.size());
+            for (const auto& cell : this->grid_cells_)
+            {
+              msg.max_height.push_back(cell.max_height);
+              msg.obstacle_count.push_back(cell.obstacles);
+              msg.ground_count.push_back(cell.ground);
+            }
+            return msg;
+          },
+          stage_seconds);
+    }
+  }
+  catch (const std::exception& ex)
+  {
+    RCLCPP_ERROR(this->logger_, "Height grid failed: %s", ex.what());
+  }
+}
+
+void CameraNode::register_rgb(const StageFrame& frame)
+{
+  const auto color = this->color_exchange_->latest();
+  if (!color)
+  {
+    return;
+  }
+  const auto stamp_nanos = rclcpp::Time(frame.header.stamp).nanoseconds();
+  if (std::fabs(static_cast<float>(stamp_nanos - color->stamp_nanos) / std::nano::den) >
+      this->rgb_registration_max_age_)
+  {
+    RCLCPP_DEBUG(this->logger_, "No RGB frame close enough in time, skipping ~/rgb_registered");
+    return;
+  }
+
+  try
+  {
+    if (!this->rgb_registration_lut_.configure(frame.calibration, frame.width, frame.height, color->calibration))
+    {
+      RCLCPP_WARN_ONCE(this->logger_, "Unsupported intrinsic model, not publishing ~/rgb_registered");
+      return;
+    }
+
+    // JPEG decoding dominates, so decode each RGB frame once, and only at the
+    // resolution sampling it at the ToF pixels needs
+    if (color->sequence != this->color_sequence_)
+    {
+      const auto err =
+          decode_jpeg_rgb(color->jpeg.data(), color->jpeg.size(), frame.width, frame.height, this->color_image_);
+      if (!err.empty())
+      {
+        RCLCPP_WARN(this->logger_, "Cannot decode the RGB frame: %s", err.c_str());
+        return;
+      }
+      this->color_sequence_ = color->sequence;
+    }
+
+    convert_and_publish(
+        this->rgb_registered_pub_,
+        [&] {
+          ImageMsg msg;
+          msg.header = frame.header;
+          msg.height = frame.height;
+          msg.width = frame.width;
+          msg.encoding = "rgb8";
+          msg.is_bigendian = false;
+          msg.step = frame.width * 3;
+          msg.data.resize(static_cast<std::size_t>(msg.step) * msg.height);
+          const auto& color_image = this->color_image_;
+          this->rgb_registration_lut_(frame.distance.data(), color_image.pixels.data(), color_image.width,
+                                      color_image.height, color_image.scale_denom, msg.data.data(),
+                                      *this->worker_pool_);
+          return msg;
+        },
+        this->metrics_->stage_seconds);
+  }
+  catch (const std::exception& ex)
+  {
+    RCLCPP_ERROR(this->logger_, "RGB registration failed: %s", ex.what());
+  }
+}
+
+void CameraNode::rectify_rgb(const StageFrame& frame)
+{
+  try
+  {
+    // `camera_info` alone only needs the size of the image, not its pixels
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    const auto size_err = read_jpeg_size(frame.jpeg.data(), frame.jpeg.size(), width, height);
+    if (!size_err.empty())
+    {
+      RCLCPP_WARN(this->logger_, "Cannot decode the RGB frame: %s", size_err.c_str());
+      return;
+    }
+
+    // the tables only depend on the calibration, so they survive reconnects
+    if (!this->rect_table_ ||
+        this->rect_table_->hash() != calibration_hash(frame.calibration.intrinsics, width, height))
+    {
+      RCLCPP_INFO(this->logger_, "Building the RGB rectification tables (%ux%u)...", width, height);
+      this->rect_table_ = RemapTable::build(frame.calibration.intrinsics, width, height, *this->worker_pool_);
+      if (!this->rect_table_)
+      {
+        RCLCPP_WARN_ONCE(this->logger_, "Unsupported intrinsic model %u, not publishing ~/rgb_rect",
+                         frame.calibration.intrinsics.model_id);
+        return;
+      }
+    }
+    auto& table = *this->rect_table_;
+
+    if (this->rgb_rect_pub_->get_subscription_count() > 0)
+    {
+      constexpr auto full_size = std::numeric_limits<std::uint32_t>::max();
+      const auto err =
+          decode_jpeg_rgb(frame.jpeg.data(), frame.jpeg.size(), full_size, full_size, this->rect_source_);
+      if (!err.empty())
+      {
+        RCLCPP_WARN(this->logger_, "Cannot decode the RGB frame: %s", err.c_str());
+        return;
+      }
+
+      const auto& image = this->rect_source_;
+      convert_and_publish(
+          this->rgb_rect_pub_,
+          [&] {
+            ImageMsg msg;
+            msg.header = frame.header;
+            msg.height = table.height();
+            msg.width = table.width();
+            msg.encoding = "rgb8";
+            msg.is_bigendian = false;
+            msg.step = table.width() * 3;
+            msg.data.resize(static_cast<std::size_t>(msg.step) * msg.height);
+            table.remap(image.pixels.data(), msg.data.data(), *this->worker_pool_);
+            return msg;
+          },
+          this->metrics_->stage_seconds);
+    }
+
+    const auto& pinhole = table.pinhole();
+    CameraInfoMsg info;
+    info.header = frame.header;
+    info.height = table.height();
+    info.width = table.width();
+    info.distortion_model = "plumb_bob";
+    info.d.assign(5, 0.0);
+    info.k = { pinhole.fx, 0.0, pinhole.cx, 0.0, pinhole.fy, pinhole.cy, 0.0, 0.0, 1.0 };
+    info.r = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+    info.p = { pinhole.fx, 0.0, pinhole.cx, 0.0, 0.0, pinhole.fy, pinhole.cy, 0.0, 0.0, 0.0, 1.0, 0.0 };
+    this->rgb_rect_info_pub_->publish(info);
+  }
+  catch (const std::exception& ex)
+  {
+    RCLCPP_ERROR(this->logger_, "RGB rectification failed: %s", ex.what());
+  }
 }
 
 void CameraNode::Config(const std::shared_ptr<rmw_request_id_t> /*unused*/, ConfigRequest req, ConfigResponse resp)
 {
   RCLCPP_INFO(this->logger_, "Handling config request...");
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/service"));
+  const auto t_start = std::chrono::steady_clock::now();
 
   if (this->get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE)
   {
@@ -635,12 +2309,16 @@ void CameraNode::Config(const std::shared_ptr<rmw_request_id_t> /*unused*/, Conf
     }
   }
 
+  this->metrics_->config_seconds.observe_since(t_start);
+
   RCLCPP_INFO(this->logger_, "Config request done.");
 }
 
 void CameraNode::Dump(const std::shared_ptr<rmw_request_id_t> /*unused*/, DumpRequest /*unused*/, DumpResponse resp)
 {
   RCLCPP_INFO(this->logger_, "Handling dump request...");
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/service"));
+  const auto t_start = std::chrono::steady_clock::now();
 
   if (this->get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE)
   {
@@ -681,6 +2359,8 @@ void CameraNode::Dump(const std::shared_ptr<rmw_request_id_t> /*unused*/, DumpRe
     }
   }
 
+  this->metrics_->dump_seconds.observe_since(t_start);
+
   RCLCPP_INFO(this->logger_, "Dump request done.");
 }
 
@@ -688,6 +2368,7 @@ void CameraNode::Softoff(const std::shared_ptr<rmw_request_id_t> /*unused*/, Sof
                          SoftoffResponse resp)
 {
   RCLCPP_INFO(this->logger_, "Handling SoftOff request...");
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/service"));
 
   if (this->get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE)
   {
@@ -725,6 +2406,10 @@ void CameraNode::Softoff(const std::shared_ptr<rmw_request_id_t> /*unused*/, Sof
     {
       RCLCPP_WARN(this->logger_, "SoftOff: %d", resp->status);
     }
+    else
+    {
+      this->set_standby(true);
+    }
   }
 
   RCLCPP_INFO(this->logger_, "SoftOff request done.");
@@ -734,6 +2419,7 @@ void CameraNode::Softon(const std::shared_ptr<rmw_request_id_t> /*unused*/, Soft
                         SoftonResponse resp)
 {
   RCLCPP_INFO(this->logger_, "Handling SoftOn request...");
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/service"));
 
   if (this->get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE)
   {
@@ -771,19 +2457,486 @@ void CameraNode::Softon(const std::shared_ptr<rmw_request_id_t> /*unused*/, Soft
     {
       RCLCPP_WARN(this->logger_, "SoftOn: %d", resp->status);
     }
+    else
+    {
+      this->set_standby(false);
+    }
   }
 
   RCLCPP_INFO(this->logger_, "SoftOn request done.");
 }
 
-//
-// Runs as a separate thread of execution, kicked off in `on_activate()`.
-//
-void CameraNode::publish_loop()
+void CameraNode::on_tf_static(const TFMessage& msg)
 {
-  rclcpp::Clock ros_clock(RCL_SYSTEM_TIME);
+  for (const auto& transform : msg.transforms)
+  {
+    this->tf_buffer_->setTransform(transform, "tf_static", true);
+  }
+
+  geometry_msgs::msg::TransformStamped stamped;
+  try
+  {
+    stamped = this->tf_buffer_->lookupTransform(this->cloud_target_frame_, this->optical_frame_, tf2::TimePointZero);
+  }
+  catch (const tf2::TransformException& ex)
+  {
+    // the rest of the chain may still be on its way
+    RCLCPP_DEBUG(this->logger_, "No transform into %s yet: %s", this->cloud_target_frame_.c_str(), ex.what());
+    return;
+  }
+
+  // the rotation of the unit quaternion and the translation, as `[R | t]`
+  const auto& q = stamped.transform.rotation;
+  const auto& t = stamped.transform.translation;
+  const double xx = q.x * q.x;
+  const double yy = q.y * q.y;
+  const double zz = q.z * q.z;
+  const double xy = q.x * q.y;
+  const double xz = q.x * q.z;
+  const double yz = q.y * q.z;
+  const double wx = q.w * q.x;
+  const double wy = q.w * q.y;
+  const double wz = q.w * q.z;
+  const std::array<double, 12> m{ { 1 - 2 * (yy + zz), 2 * (xy - wz), 2 * (xz + wy), t.x,  //
+                                    2 * (xy + wz), 1 - 2 * (xx + zz), 2 * (yz - wx), t.y,  //
+                                    2 * (xz - wy), 2 * (yz + wx), 1 - 2 * (xx + yy), t.z } };
+  auto transform = std::make_shared<PointTransform>();
+  std::transform(m.begin(), m.end(), transform->begin(), [](double v) { return static_cast<float>(v); });
+
+  std::lock_guard<std::mutex> lock(this->cloud_transform_mutex_);
+  if (!this->cloud_transform_ || *this->cloud_transform_ != *transform)
+  {
+    RCLCPP_INFO(this->logger_, "Publishing the cloud in %s, translation %.3f %.3f %.3f",
+                this->cloud_target_frame_.c_str(), t.x, t.y, t.z);
+    this->cloud_transform_ = std::move(transform);
+  }
+}
+
+void CameraNode::on_twist(const builtin_interfaces::msg::Time& stamp, const TwistSample& twist)
+{
+  const auto stamp_nanos = rclcpp::Time(stamp).nanoseconds();
+  if (stamp_nanos <= this->last_twist_nanos_)
+  {
+    return;
+  }
+  this->last_twist_nanos_ = stamp_nanos;
+
+  auto sample = twist;
+  sample.stamp_nanos = stamp_nanos;
+  this->twist_ring_.push(sample);
+}
+
+std::shared_ptr<const PointTransform> CameraNode::cloud_transform() const
+{
+  std::lock_guard<std::mutex> lock(this->cloud_transform_mutex_);
+  return this->cloud_transform_;
+}
+
+void CameraNode::PowerState(const std::shared_ptr<rmw_request_id_t> /*unused*/, PowerStateRequest req,
+                            PowerStateResponse resp)
+{
+  RCLCPP_INFO(this->logger_, "Handling PowerState request...");
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/service"));
+
+  if (this->get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE)
+  {
+    resp->status = power_state_not_active;
+    resp->msg = "Can only make a service request when node is ACTIVE";
+    RCLCPP_WARN(this->logger_, "%s", resp->msg.c_str());
+    return;
+  }
+  if (req->state != "RUN" && req->state != "IDLE")
+  {
+    resp->status = power_state_bad_request;
+    resp->msg = "Unknown state `" + req->state + "`, expected RUN or IDLE";
+    RCLCPP_WARN(this->logger_, "%s", resp->msg.c_str());
+    return;
+  }
+
+  resp->ports = req->ports.empty() ? std::vector<std::uint16_t>{ this->pcic_port_ } : req->ports;
+  std::vector<int> port_indices;
+  port_indices.reserve(resp->ports.size());
+  for (const auto port : resp->ports)
+  {
+    const int index = static_cast<int>(port) - xmlrpc_base_port;
+    if (index < 0 || index > max_port_index)
+    {
+      resp->status = power_state_bad_request;
+      resp->msg = "Port " + std::to_string(port) + " is not a PCIC port, expected " +
+                  std::to_string(xmlrpc_base_port) + " .. " + std::to_string(xmlrpc_base_port + max_port_index);
+      RCLCPP_WARN(this->logger_, "%s", resp->msg.c_str());
+      return;
+    }
+    port_indices.push_back(index);
+  }
+  resp->port_status.assign(resp->ports.size(), 0);
+
+  // runs a configuration update, returning 0 or the error code
+  const auto apply = [this](const std::string& update) -> std::int32_t {
+    try
+    {
+      this->power_cam_->FromJSONStr(update);
+      return 0;
+    }
+    catch (const ifm3d::Error& ex)
+    {
+      RCLCPP_WARN(this->logger_, "%s", ex.what());
+      return ex.code();
+    }
+    catch (const std::exception& std_ex)
+    {
+      RCLCPP_WARN(this->logger_, "%s", std_ex.what());
+      return power_state_failed;
+    }
+    catch (...)
+    {
+      return power_state_failed;
+    }
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(this->power_mutex_);
+    const auto t_start = std::chrono::steady_clock::now();
+
+    resp->msg = this->connect_power_cam();
+    if (!resp->msg.empty())
+    {
+      resp->status = power_state_no_connection;
+      RCLCPP_WARN(this->logger_, "PowerState: %s", resp->msg.c_str());
+      return;
+    }
+
+    // all ports in one update; if the VPU rejects it, each port on its own to
+    // tell which of them failed
+    resp->status = apply(port_states_json(port_indices, req->state));
+    if (resp->status != 0 && port_indices.size() > 1)
+    {
+      resp->status = 0;
+      for (std::size_t i = 0; i < port_indices.size(); ++i)
+      {
+        resp->port_status[i] = apply(port_states_json({ port_indices[i] }, req->state));
+        if (resp->status == 0)
+        {
+          resp->status = resp->port_status[i];
+        }
+      }
+    }
+    else
+    {
+      resp->port_status.assign(resp->ports.size(), resp->status);
+    }
+
+    resp->latency_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+    this->metrics_->power_state_seconds.observe(resp->latency_secs);
+  }
+
+  // switching a port works like Softoff / Softon for the head streaming from
+  // it, this one or another head of the process on the same VPU
+  for (std::size_t i = 0; i < resp->ports.size(); ++i)
+  {
+    if (resp->port_status[i] == 0)
+    {
+      PortStandby::acquire(this->ip_, resp->ports[i])->set(req->state == "IDLE");
+    }
+  }
+
+  const auto switched = std::count(resp->port_status.begin(), resp->port_status.end(), 0);
+  resp->msg = "Switched " + std::to_string(switched) + " of " + std::to_string(resp->ports.size()) + " ports to " +
+              req->state;
+  if (resp->status != 0)
+  {
+    RCLCPP_WARN(this->logger_, "PowerState: %d", resp->status);
+  }
+
+  RCLCPP_INFO(this->logger_, "PowerState request done: %s in %.3f s", resp->msg.c_str(), resp->latency_secs);
+}
+
+void CameraNode::Stats(const std::shared_ptr<rmw_request_id_t> /*unused*/, StatsRequest req, StatsResponse resp)
+{
+  RCLCPP_INFO(this->logger_, "Handling Stats request...");
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/service"));
+
+  if (this->get_current_state().id() != lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE)
+  {
+    resp->status = -1;
+    resp->msg = "Can only make a service request when node is ACTIVE";
+    RCLCPP_WARN(this->logger_, "%s", resp->msg.c_str());
+    return;
+  }
+  if (req->frames == 0)
+  {
+    resp->status = -3;
+    resp->msg = "frames must be positive";
+    return;
+  }
+
+  bool idle = false;
+  if (!this->stats_running_.compare_exchange_strong(idle, true))
+  {
+    resp->status = -2;
+    resp->msg = "Still accumulating the previous request";
+    return;
+  }
+
+  // picked up by the publish loop with its next frame
+  this->stats_request_.store(req->frames);
+  resp->status = 0;
+  resp->msg = "Accumulating " + std::to_string(req->frames) + " frames";
+  RCLCPP_INFO(this->logger_, "Stats request done: %s", resp->msg.c_str());
+}
+
+void CameraNode::publish_stats(const std_msgs::msg::Header& header)
+{
+  const auto& stats = this->pixel_stats_;
+  const auto to_image = [&](void (PixelStats::*result)(float*) const) {
+    ImageMsg msg;
+    msg.header = header;
+    msg.height = stats.height();
+    msg.width = stats.width();
+    msg.encoding = "32FC1";
+    msg.is_bigendian = false;
+    msg.step = stats.width() * sizeof(float);
+    msg.data.resize(static_cast<std::size_t>(msg.step) * msg.height);
+    (stats.*result)(reinterpret_cast<float*>(msg.data.data()));
+    return msg;
+  };
+
+  // once per `Stats` request, not part of the frame path figures
+  this->stats_mean_pub_->publish(to_image(&PixelStats::mean));
+  this->stats_stddev_pub_->publish(to_image(&PixelStats::stddev));
+  this->stats_valid_ratio_pub_->publish(to_image(&PixelStats::valid_ratio));
+  RCLCPP_INFO(this->logger_, "Published the statistics of %u frames", stats.frames());
+}
+
+void CameraNode::publish_resource_usage()
+{
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/timer"));
+
+  const auto sample = this->resource_sampler_.sample();
+
+  ResourceUsageMsg msg;
+  msg.header.stamp = this->now();
+  msg.header.frame_id = this->camera_frame_;
+  msg.period = sample.period;
+  msg.process_cpu_load = sample.process_cpu_load;
+  msg.rss_bytes = sample.rss_bytes;
+  msg.heap_in_use_bytes = sample.heap_in_use_bytes;
+  msg.conversion_cpu_time = static_cast<double>(this->metrics_->conversion_cpu_nanos.value()) / std::nano::den;
+  msg.publish_cpu_time = static_cast<double>(this->metrics_->publish_cpu_nanos.value()) / std::nano::den;
+
+  msg.threads.reserve(sample.threads.size());
+  for (const auto& thread : sample.threads)
+  {
+    ifm3d_ros2::msg::ThreadUsage usage;
+    usage.tid = thread.tid;
+    usage.name = thread.name;
+    usage.role = thread.role;
+    usage.cpu_time = thread.cpu_time;
+    usage.cpu_load = thread.cpu_load;
+    usage.voluntary_context_switches = thread.voluntary_ctx_switches;
+    usage.involuntary_context_switches = thread.involuntary_ctx_switches;
+    msg.threads.push_back(std::move(usage));
+  }
+
+  this->resource_usage_pub_->publish(msg);
+}
+
+std::string CameraNode::connect_power_cam()
+{
+  if (!this->power_cam_)
+  {
+    try
+    {
+      this->power_cam_ = ifm3d::Device::MakeShared(this->ip_, this->xmlrpc_port_, this->password_);
+    }
+    catch (const std::exception& ex)
+    {
+      return ex.what();
+    }
+  }
+  return "";
+}
+
+bool CameraNode::apply_rate_factor(double factor)
+{
+  std::lock_guard<std::mutex> lock(this->power_mutex_);
+  const auto error = this->connect_power_cam();
+  if (!error.empty())
+  {
+    RCLCPP_WARN(this->logger_, "Governor: %s", error.c_str());
+    return false;
+  }
+
+  const auto port = "port" + std::to_string(static_cast<int>(this->pcic_port_) % xmlrpc_base_port);
+  try
+  {
+    // the rate the port was configured with, if it could not be read in
+    // `on_configure()`
+    if (this->nominal_framerate_ <= 0.0)
+    {
+      this->nominal_framerate_ =
+          this->power_cam_->ToJSON().at("ports").at(port).at("acquisition").at("framerate").get<double>();
+      RCLCPP_INFO(this->logger_, "Governor: nominal framerate of %s is %.2f Hz", port.c_str(),
+                  this->nominal_framerate_);
+    }
+
+    json update;
+    update["ports"][port]["acquisition"]["framerate"] = this->nominal_framerate_ * factor;
+    this->power_cam_->FromJSON(update);
+    return true;
+  }
+  catch (const std::exception& ex)
+  {
+    RCLCPP_WARN(this->logger_, "Governor: cannot set the framerate of %s: %s", port.c_str(), ex.what());
+    return false;
+  }
+}
+
+void CameraNode::govern()
+{
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/timer"));
+
+  // the figures of the last period, of the publish loop only: it alone
+  // observes `publish_seconds` (the stages have `stage_seconds`), and it adds
+  // up the time from taking a frame to having published it
+  const auto& metrics = *this->metrics_;
+  const GovernorTotals totals{ std::chrono::steady_clock::now(), metrics.publish_seconds.count(),
+                               metrics.publish_seconds.sum(), this->loop_busy_nanos_.load() };
+  const auto& last = this->governor_last_;
+  const double period = std::chrono::duration<double>(totals.time - last.time).count();
+  const auto publishes = totals.publishes - last.publishes;
+
+  GovernorInputs inputs;
+  inputs.host_cpu_load = this->host_cpu_sampler_.sample();
+  inputs.publish_latency = publishes > 0 ? (totals.publish_secs - last.publish_secs) / publishes : 0.0;
+  inputs.loop_load =
+      period > 0.0 ? static_cast<double>(totals.loop_busy_nanos - last.loop_busy_nanos) / std::nano::den / period :
+                     0.0;
+  this->governor_last_ = totals;
+
+  // the framerate could not be set on the worker, decimate until the next
+  // activation
+  if (!this->governor_decimate_ && this->governor_rate_failed_)
+  {
+    RCLCPP_WARN(this->logger_, "Governor: decimating the frames instead of lowering the framerate");
+    this->governor_decimate_ = true;
+    this->governor_decimation_ = static_cast<std::uint32_t>(this->governor_.level() + 1);
+  }
+
+  // standing still is not headroom, the figures would restore the rate
+  if (this->standby_)
+  {
+    return;
+  }
+
+  const auto action = this->governor_.update(inputs);
+  if (action != GovernorAction::HOLD)
+  {
+    const auto factor = this->governor_.rate_factor();
+    RCLCPP_INFO(this->logger_, "Governor: %s to 1/%d of the nominal rate, %s",
+                action == GovernorAction::DEGRADE ? "degrading" : "restoring", this->governor_.level() + 1,
+                this->governor_.reason().c_str());
+
+    // XML-RPC round trips, off the executor; a newer decision replaces one
+    // not yet applied
+    if (!this->governor_decimate_)
+    {
+      this->governor_worker_->post([this, factor] {
+        if (!this->apply_rate_factor(factor))
+        {
+          if (this->nominal_framerate_ > 0.0)
+          {
+            this->apply_rate_factor(1.0);
+          }
+          this->governor_rate_failed_ = true;
+        }
+      });
+    }
+    this->governor_decimation_ = this->governor_decimate_ ? static_cast<std::uint32_t>(this->governor_.level() + 1) : 1;
+  }
+
+  const auto key_value = [](const std::string& key, const std::string& value) {
+    diagnostic_msgs::msg::KeyValue kv;
+    kv.key = key;
+    kv.value = value;
+    return kv;
+  };
+
+  diagnostic_msgs::msg::DiagnosticStatus status;
+  status.level = this->governor_.level() == 0 ? diagnostic_msgs::msg::DiagnosticStatus::OK :
+                                                diagnostic_msgs::msg::DiagnosticStatus::WARN;
+  status.name = this->get_fully_qualified_name() + std::string(": frame rate governor");
+  status.hardware_id = this->ip_;
+  status.message = std::string(action == GovernorAction::DEGRADE ? "degraded" :
+                               action == GovernorAction::RESTORE ? "restored" :
+                                                                   "holding") +
+                   " at 1/" + std::to_string(this->governor_.level() + 1) + " of the nominal rate: " +
+                   this->governor_.reason();
+  status.values.push_back(key_value("mode", this->governor_decimate_ ? "decimate" : "framerate"));
+  status.values.push_back(key_value("level", std::to_string(this->governor_.level())));
+  status.values.push_back(key_value("rate_factor", std::to_string(this->governor_.rate_factor())));
+  status.values.push_back(key_value("host_cpu_load", std::to_string(inputs.host_cpu_load)));
+  status.values.push_back(key_value("publish_latency", std::to_string(inputs.publish_latency)));
+  status.values.push_back(key_value("loop_load", std::to_string(inputs.loop_load)));
+  status.values.push_back(key_value("queue_depth", std::to_string(metrics.queue_depth.value())));
+  status.values.push_back(key_value("frames_skipped", std::to_string(metrics.frames_skipped.value())));
+  for (std::size_t topic = 0; topic < metrics.topics_skipped.size(); ++topic)
+  {
+    status.values.push_back(key_value("topics_skipped/" + metrics.topics_skipped.values()[topic],
+                                      std::to_string(metrics.topics_skipped[topic].value())));
+  }
+
+  DiagnosticArrayMsg msg;
+  msg.header.stamp = this->now();
+  msg.status.push_back(std::move(status));
+  this->diagnostics_pub_->publish(msg);
+}
+
+//
+// Runs as a separate thread of execution, kicked off in `on_activate()`.
+//
+void CameraNode::publish_loop()
+{
+  ThreadRegistry::instance().tag(this->get_fully_qualified_name() + std::string("/publish_loop"), "ifm3d_pub");
+
+  rclcpp::Clock ros_clock(RCL_SYSTEM_TIME);
 
   auto buffer_list = ifm3d_legacy::buffer_list_from_schema_mask(schema_mask_);
+  // the calibrations of either imager, a head only delivers its own
+  if (this->color_exchange_)
+  {
+    buffer_list.emplace_back(ifm3d::buffer_id::TOF_INFO);
+  }
+  if (this->color_exchange_ || this->rgb_rectify_)
+  {
+    buffer_list.emplace_back(ifm3d::buffer_id::RGB_INFO);
+  }
+  if (this->distance_filter_ &&
+      std::find(buffer_list.begin(), buffer_list.end(), ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE) == buffer_list.end())
+  {
+    buffer_list.emplace_back(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE);
+  }
+  if ((this->cloud_sigma_ || this->cloud_noise_threshold_ > 0.0F) &&
+      std::find(buffer_list.begin(), buffer_list.end(), ifm3d::buffer_id::RADIAL_DISTANCE_NOISE) == buffer_list.end())
+  {
+    buffer_list.emplace_back(ifm3d::buffer_id::RADIAL_DISTANCE_NOISE);
+  }
+  if (this->stage_confidence_exclude_ != 0 && (this->ground_removal_ || this->height_grid_) &&
+      std::find(buffer_list.begin(), buffer_list.end(), ifm3d::buffer_id::CONFIDENCE_IMAGE) == buffer_list.end())
+  {
+    buffer_list.emplace_back(ifm3d::buffer_id::CONFIDENCE_IMAGE);
+  }
+
+  this->distance_conv_.reset();
+  this->distance_noise_conv_.reset();
+  // a request still running when the loop stopped is dropped
+  this->pixel_stats_.start(0);
+  this->stats_request_.store(0);
+  this->stats_running_.store(false);
+  this->conf_conv_.reset();
+  this->amplitude_conv_.reset();
+  this->raw_amplitude_conv_.reset();
+  this->change_detector_.reset();
   fg_->Start(buffer_list);
 
   auto head = std_msgs::msg::Header();
@@ -796,33 +2949,116 @@ void CameraNode::publish_loop()
 
   rclcpp::Time last_frame_time = head.stamp;
 
+  const auto preview_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<float>(this->preview_rate_hz_ > 0.0F ? 1.0F / this->preview_rate_hz_ : 0.0F));
+  auto last_preview = std::chrono::steady_clock::time_point{};
+
+  const auto keyframe_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<float>(this->change_keyframe_interval_secs_));
+  auto last_keyframe = std::chrono::steady_clock::time_point{};
+
+  auto& metrics = *this->metrics_;
+
+  // when the last standby ended, to log how long resuming took
+  auto resumed = std::chrono::steady_clock::time_point{};
+
+  // frames received while the governor decimates
+  std::uint64_t governed_frames = 0;
+
+  std::uint64_t live_version = 0;
+
   RCLCPP_INFO(this->logger_, "Starting publishing loop...");
   while (rclcpp::ok() && (!this->test_destroy_))
   {
+    bool frame_in_flight = false;
+
+    // the parameters changed on the fly, pinned for this frame: one version
+    // throughout, whatever `set_params_cb` does meanwhile
+    const auto& live_snapshot = this->live_params_.pin();
+    const LiveParams& live = live_snapshot.value;
+    if (live_snapshot.version != live_version)
+    {
+      live_version = live_snapshot.version;
+      RCLCPP_INFO(this->logger_, "Live parameters (version %lu): timeout_millis %d, timeout_tolerance_secs %f, "
+                                 "frame_latency_thresh %f",
+                  static_cast<unsigned long>(live_version), live.timeout_millis, live.timeout_tolerance_secs,
+                  live.frame_latency_thresh);
+    }
+
+    //
+    // Standby: the port is idle on purpose, so sleep without holding `gil_`
+    // (Softon goes through right away) and keep the timeout watchdog quiet.
+    // The framegrabber, the publishers and all cached state stay as they are.
+    // Only leaving standby or stopping the loop wakes it up, both flip their
+    // flag under `standby_mutex_`.
+    //
+    if (this->standby_)
+    {
+      this->clear_grid_contribution();
+      {
+        std::unique_lock<std::mutex> lock(this->standby_mutex_);
+        this->standby_cv_.wait(lock, [this] { return !this->standby_ || this->test_destroy_; });
+      }
+      last_frame_time = ros_clock.now();
+      if (!this->standby_)
+      {
+        resumed = std::chrono::steady_clock::now();
+      }
+      continue;
+    }
+
     try
     {
       std::lock_guard<std::mutex> lock(this->gil_);
 
       auto future = fg_->WaitForFrame();
-      if (future.wait_for(std::chrono::duration<int, std::milli>(this->timeout_millis_)) != std::future_status::ready)
+      if (future.wait_for(std::chrono::duration<int, std::milli>(live.timeout_millis)) != std::future_status::ready)
       {
         // XXX: May not want to emit this if the camera is software
         //      triggered.
+        if (this->standby_)
+        {
+          // switched off through PowerState (which does not take `gil_`)
+          // while waiting
+          continue;
+        }
         RCLCPP_WARN(this->logger_, "Timeout waiting for camera!");
+        metrics.timeouts.inc();
+        this->clear_grid_contribution();
 
         if (std::fabs((rclcpp::Time(last_frame_time, RCL_SYSTEM_TIME) - ros_clock.now()).nanoseconds() /
-                      static_cast<float>(std::nano::den)) > this->timeout_tolerance_secs_)
+                      static_cast<float>(std::nano::den)) > live.timeout_tolerance_secs)
         {
           RCLCPP_WARN(this->logger_, "Timeouts exceeded tolerance threshold!");
 
-          std::thread deactivate_t([this]() { this->deactivate(); });
-          deactivate_t.detach();
+          this->transition_worker_->request(TransitionRequest::DEACTIVATE);
           break;
         }
 
         continue;
       }
       auto frame = future.get();
+      metrics.frames_in.inc();
+      if (resumed != std::chrono::steady_clock::time_point{})
+      {
+        RCLCPP_INFO(this->logger_, "First frame %.3f s after leaving standby",
+                    std::chrono::duration<double>(std::chrono::steady_clock::now() - resumed).count());
+        resumed = {};
+      }
+
+      // the governor keeps one frame in `governor_decimation_` while the host
+      // or the subscribers cannot keep up
+      const auto decimation = this->governor_decimation_.load(std::memory_order_relaxed);
+      if (decimation > 1 && governed_frames++ % decimation != 0)
+      {
+        metrics.frames_skipped.inc();
+        last_frame_time = ros_clock.now();
+        continue;
+      }
+
+      metrics.queue_depth.inc();
+      frame_in_flight = true;
+      const auto frame_start = steady_nanos();
 
       auto now = ros_clock.now();
 
@@ -831,7 +3067,7 @@ void CameraNode::publish_loop()
           RCL_SYSTEM_TIME);
 
       if (std::fabs((frame_time - now).nanoseconds() / static_cast<float>(std::nano::den)) >
-          this->frame_latency_thresh_)
+          live.frame_latency_thresh)
       {
         RCLCPP_WARN_ONCE(this->logger_, "Frame latency thresh exceeded, using reception timestamps!");
         head.stamp = now;
@@ -844,42 +3080,531 @@ void CameraNode::publish_loop()
       optical_head.stamp = head.stamp;
       last_frame_time = head.stamp;
 
+      // previews are rate limited and only rendered while subscribed
+      const auto now_steady = std::chrono::steady_clock::now();
+      const bool preview_due = this->preview_rate_hz_ > 0.0F && now_steady - last_preview >= preview_period;
+      bool previewed = false;
+
       //
-      // Publish the data
+      // Change detection: suppress the ToF streams of frames showing the same
+      // scene as the last published one
       //
+      bool publish_tof = true;
+      bool tiles_due = false;
+      bool tiles_keyframe = false;
+      if (this->change_detection_ != ChangeDetection::OFF && frame->HasBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE))
+      {
+        auto dist = frame->GetBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE);
+        if (dist.dataFormat() == ifm3d::pixel_format::FORMAT_32F)
+        {
+          const bool keyframe_due =
+              this->change_keyframe_interval_secs_ > 0.0F && now_steady - last_keyframe >= keyframe_interval;
+          const auto* distance = dist.ptr<float>(0);
+          const auto change = this->change_detector_.compare(distance, dist.width(), dist.height(), keyframe_due);
+          if (change.keyframe)
+          {
+            last_keyframe = now_steady;
+          }
+
+          // the tiles go out once the distance is filtered, see below
+          tiles_keyframe = change.keyframe;
+          tiles_due = this->change_detection_ == ChangeDetection::TILES && change.tiles_changed > 0;
+          publish_tof =
+              change.keyframe || (this->change_detection_ == ChangeDetection::SKIP && change.tiles_changed > 0);
+          this->change_detector_.commit(distance, publish_tof);
+          if (!publish_tof)
+          {
+            metrics.frames_unchanged.inc();
+          }
+        }
+        else
+        {
+          RCLCPP_WARN_ONCE(this->logger_, "Distance is not float meters, change detection disabled!");
+        }
+      }
 
-      if (frame->HasBuffer(ifm3d::buffer_id::JPEG_IMAGE))
+      //
+      // Temporal statistics, requested through the Stats service, of the
+      // distance as delivered (all frames, before the spatial filter)
+      //
+      const auto stats_frames = this->stats_request_.exchange(0);
+      if (stats_frames > 0)
       {
-        auto rgb = frame->GetBuffer(ifm3d::buffer_id::JPEG_IMAGE);
-        if (rgb.width() * rgb.height() != 0)
+        this->pixel_stats_.start(stats_frames);
+      }
+      if (this->pixel_stats_.active() && frame->HasBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE))
+      {
+        auto dist = frame->GetBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE);
+        if (dist.dataFormat() == ifm3d::pixel_format::FORMAT_32F)
         {
-          this->rgb_pub_->publish(ifm3d_to_ros_compressed_image(rgb, optical_head, "jpeg", logger_));
+          if (this->pixel_stats_.add(dist.ptr<float>(0), dist.width(), dist.height()))
+          {
+            this->publish_stats(optical_head);
+            this->stats_running_.store(false);
+          }
+        }
+        else
+        {
+          RCLCPP_WARN_ONCE(this->logger_, "Distance is not float meters, cannot accumulate statistics!");
+          this->pixel_stats_.start(0);
+          this->stats_running_.store(false);
         }
       }
-      if (frame->HasBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE))
+
+      //
+      // Spatial filter: smooths the distance (and the points along their
+      // rays) in place, so that all ToF outputs (the changed tiles as well)
+      // carry the filtered distance. Change detection runs before, on the
+      // distance as delivered, so that suppressed frames are not filtered.
+      //
+      if ((publish_tof || tiles_due) && this->filter_pool_ &&
+          frame->HasBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE) &&
+          frame->HasBuffer(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE))
       {
         auto dist = frame->GetBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE);
-        this->distance_pub_->publish(ifm3d_to_ros_image(dist, optical_head, logger_));
+        auto amp = frame->GetBuffer(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE);
+        const bool with_xyz = frame->HasBuffer(ifm3d::buffer_id::XYZ);
+        ifm3d::Buffer xyz;
+        if (with_xyz)
+        {
+          xyz = frame->GetBuffer(ifm3d::buffer_id::XYZ);
+        }
+        this->filter_distance(dist, amp, with_xyz ? &xyz : nullptr);
       }
-      if (frame->HasBuffer(ifm3d::buffer_id::CONFIDENCE_IMAGE))
+
+      if (tiles_due)
       {
-        auto conf = frame->GetBuffer(ifm3d::buffer_id::CONFIDENCE_IMAGE);
-        this->conf_pub_->publish(ifm3d_to_ros_image(conf, optical_head, logger_));
+        auto dist = frame->GetBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE);
+        convert_and_publish(
+            this->distance_tiles_pub_,
+            [&] {
+              DepthTilesMsg msg;
+              msg.header = optical_head;
+              msg.height = dist.height();
+              msg.width = dist.width();
+              msg.tile_size = this->change_detector_.tile_size();
+              msg.tiles_x = this->change_detector_.tiles_x();
+              msg.tiles_y = this->change_detector_.tiles_y();
+              msg.keyframe = tiles_keyframe;
+              msg.tile_map = this->change_detector_.tile_map();
+              this->change_detector_.append_changed_tiles(dist.ptr<float>(0), msg.data);
+              return msg;
+            },
+            metrics);
       }
-      if (frame->HasBuffer(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE))
+
+      //
+      // Frame of the points: with `cloud_target_frame`, `~/cloud`, `~/sectors`
+      // and the processing stages all get them transformed (and deskewed)
+      // into it, stamped with `cloud_head`
+      //
+      std::shared_ptr<const PointTransform> points_transform;
+      auto cloud_head = optical_head;
+      if (!this->cloud_target_frame_.empty() && frame->HasBuffer(ifm3d::buffer_id::XYZ))
       {
-        auto amp = frame->GetBuffer(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE);
-        this->amplitude_pub_->publish(ifm3d_to_ros_image(amp, optical_head, logger_));
+        points_transform = this->cloud_transform();
+        if (points_transform &&
+            frame->GetBuffer(ifm3d::buffer_id::XYZ).dataFormat() == ifm3d::pixel_format::FORMAT_32F3)
+        {
+          cloud_head.frame_id = this->cloud_target_frame_;
+        }
+        else
+        {
+          RCLCPP_WARN_ONCE(this->logger_,
+                           "No static transform %s -> %s (or XYZ is not float meters), publishing the points in the "
+                           "optical frame!",
+                           this->optical_frame_.c_str(), this->cloud_target_frame_.c_str());
+          points_transform.reset();
+        }
       }
-      if (frame->HasBuffer(ifm3d::buffer_id::AMPLITUDE_IMAGE))
+
+      // deskew: the points were seen at the acquisition time, move them into
+      // the target frame at the reception time
+      if (points_transform && !this->deskew_topic_.empty())
       {
-        auto raw_amp = frame->GetBuffer(ifm3d::buffer_id::AMPLITUDE_IMAGE);
-        this->raw_amplitude_pub_->publish(ifm3d_to_ros_image(raw_amp, optical_head, logger_));
+        const auto acquired = rclcpp::Time(optical_head.stamp).nanoseconds();
+        const auto reference = now.nanoseconds();
+        const auto max_hold = static_cast<std::int64_t>(this->deskew_max_hold_secs_ * 1e9F);
+        PointTransform motion;
+        if (this->twist_ring_.snapshot(acquired, this->twist_scratch_) &&
+            integrate_motion(this->twist_scratch_, acquired, reference, max_hold, motion))
+        {
+          points_transform =
+              std::make_shared<PointTransform>(compose_transforms(invert_transform(motion), *points_transform));
+          cloud_head.stamp = now;
+        }
+        else
+        {
+          RCLCPP_WARN_ONCE(this->logger_, "No recent twists on %s, publishing the points without deskew!",
+                           this->deskew_topic_.c_str());
+        }
       }
-      if (frame->HasBuffer(ifm3d::buffer_id::XYZ))
+
+      // the float meter points in the frame of `cloud_head`, transformed at
+      // most once per frame for the sectors and the stages (the cloud
+      // conversions fuse the transform)
+      bool points_transformed = false;
+      const auto cloud_frame_points = [&](ifm3d::Buffer& xyz) -> const float* {
+        if (!points_transform)
+        {
+          return xyz.ptr<float>(0);
+        }
+        if (!points_transformed)
+        {
+          const std::size_t n = static_cast<std::size_t>(xyz.width()) * xyz.height();
+          this->cloud_points_.resize(n * 3);
+          transform_points(*points_transform, xyz.ptr<float>(0), this->cloud_points_.data(), n);
+          points_transformed = true;
+        }
+        return this->cloud_points_.data();
+      };
+
+      //
+      // Publish the data, most important topic first. With deadlines, topics
+      // that would miss theirs are skipped for this frame.
+      //
+
+      // hand the frame to the 3D heads registering against it, while they
+      // have subscribers, whatever becomes of `~/rgb`
+      if (this->color_exchange_ && frame->HasBuffer(ifm3d::buffer_id::JPEG_IMAGE))
+      {
+        auto rgb = frame->GetBuffer(ifm3d::buffer_id::JPEG_IMAGE);
+        if (rgb.width() * rgb.height() != 0 && frame->HasBuffer(ifm3d::buffer_id::RGB_INFO) &&
+            this->color_exchange_->wanted(steady_nanos(), color_request_window_nanos))
+        {
+          try
+          {
+            auto color = std::make_shared<ColorFrame>();
+            color->stamp_nanos = rclcpp::Time(optical_head.stamp).nanoseconds();
+            color->calibration =
+                to_optic_calibration(ifm3d::RGBInfoV1::Deserialize(frame->GetBuffer(ifm3d::buffer_id::RGB_INFO)));
+            color->jpeg.assign(rgb.ptr<>(0), std::next(rgb.ptr<>(0), rgb.width() * rgb.height()));
+            this->color_exchange_->post(std::move(color));
+          }
+          catch (const std::exception& ex)
+          {
+            RCLCPP_WARN_ONCE(this->logger_, "Cannot read RGB_INFO, not sharing RGB frames: %s", ex.what());
+          }
+        }
+      }
+
+      // whether a topic has anything to publish from this frame
+      const auto due = [&](FrameTopic topic) {
+        switch (topic)
+        {
+          case FrameTopic::CLOUD:
+            return publish_tof && frame->HasBuffer(ifm3d::buffer_id::XYZ);
+          case FrameTopic::DISTANCE:
+            return publish_tof && frame->HasBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE);
+          case FrameTopic::CONFIDENCE:
+            return publish_tof && frame->HasBuffer(ifm3d::buffer_id::CONFIDENCE_IMAGE);
+          case FrameTopic::AMPLITUDE:
+            return publish_tof && frame->HasBuffer(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE);
+          case FrameTopic::RGB:
+            return frame->HasBuffer(ifm3d::buffer_id::JPEG_IMAGE);
+          case FrameTopic::DISTANCE_NOISE:
+            return publish_tof && frame->HasBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_NOISE) &&
+                   this->distance_noise_pub_->get_subscription_count() > 0;
+          case FrameTopic::RAW_AMPLITUDE:
+            return publish_tof && frame->HasBuffer(ifm3d::buffer_id::AMPLITUDE_IMAGE);
+        }
+        return false;
+      };
+
+      for (const auto topic : this->topic_scheduler_.order())
+      {
+        if (!due(topic))
+        {
+          continue;
+        }
+        const auto topic_start = std::chrono::steady_clock::now();
+        if (!this->topic_scheduler_.admit(topic, std::chrono::duration<double>(topic_start - now_steady).count()))
+        {
+          metrics.topics_skipped[static_cast<std::size_t>(topic)].inc();
+          RCLCPP_WARN_ONCE(this->logger_, "Frame budget exceeded, skipping topics past their deadline (see the "
+                                          "ifm3d_ros2_topics_skipped metric)");
+          continue;
+        }
+
+        switch (topic)
+        {
+          case FrameTopic::CLOUD:
+          {
+            // with a target frame, the transform is fused into the conversion
+            auto xyz = frame->GetBuffer(ifm3d::buffer_id::XYZ);
+            const auto& transform = points_transform;
+
+            if (this->cloud_encoding_ == CloudEncoding::INT16_MM &&
+                xyz.dataFormat() == ifm3d::pixel_format::FORMAT_32F3)
+            {
+              ifm3d::Buffer amp;
+              if (this->cloud_intensity_ && frame->HasBuffer(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE))
+              {
+                amp = frame->GetBuffer(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE);
+              }
+              convert_and_publish(
+                  this->cloud_pub_,
+                  [&] {
+                    return this->cloud_int16_conv_(xyz, &amp, this->cloud_intensity_max_, cloud_head, logger_,
+                                                   transform.get());
+                  },
+                  metrics);
+            }
+            else if ((this->cloud_sigma_ || this->cloud_noise_threshold_ > 0.0F) &&
+                     frame->HasBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_NOISE))
+            {
+              auto noise = frame->GetBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_NOISE);
+              const float max_noise = this->cloud_noise_threshold_ > 0.0F ? this->cloud_noise_threshold_ :
+                                                                             std::numeric_limits<float>::infinity();
+              convert_and_publish(
+                  this->cloud_pub_,
+                  [&] {
+                    return ifm3d_to_ros_cloud_with_noise(xyz, noise, this->cloud_sigma_, max_noise, cloud_head, logger_,
+                                                         transform.get());
+                  },
+                  metrics);
+            }
+            else if (transform)
+            {
+              convert_and_publish(
+                  this->cloud_pub_,
+                  [&] { return ifm3d_to_ros_cloud_transformed(xyz, *transform, cloud_head, logger_); }, metrics);
+            }
+            else
+            {
+              if (this->cloud_encoding_ == CloudEncoding::INT16_MM)
+              {
+                RCLCPP_WARN_ONCE(this->logger_, "XYZ is not float meters, publishing the cloud as float32!");
+              }
+              if (this->cloud_sigma_ || this->cloud_noise_threshold_ > 0.0F)
+              {
+                RCLCPP_WARN_ONCE(this->logger_, "No distance noise in the frame, publishing the cloud without it!");
+              }
+              convert_and_publish(
+                  this->cloud_pub_, [&] { return ifm3d_to_ros_cloud(xyz, optical_head, logger_); }, metrics);
+            }
+            break;
+          }
+          case FrameTopic::DISTANCE:
+          {
+            auto dist = frame->GetBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE);
+            if (this->distance_output_ == DistanceOutput::MM16 &&
+                dist.dataFormat() == ifm3d::pixel_format::FORMAT_32F)
+            {
+              convert_and_publish(
+                  this->distance_pub_, [&] { return ifm3d_to_ros_distance_mm16(dist, optical_head, logger_); },
+                  metrics);
+            }
+            else
+            {
+              if (this->distance_output_ == DistanceOutput::MM16)
+              {
+                RCLCPP_WARN_ONCE(this->logger_, "Distance is not float meters, publishing it unchanged!");
+              }
+              convert_and_publish(
+                  this->distance_pub_, [&] { return this->distance_conv_(dist, optical_head, logger_); }, metrics);
+            }
+            if (preview_due && this->distance_preview_pub_->get_subscription_count() > 0)
+            {
+              convert_and_publish(
+                  this->distance_preview_pub_,
+                  [&] {
+                    return this->distance_preview_(dist, this->preview_distance_range_[0],
+                                                   this->preview_distance_range_[1], optical_head, logger_);
+                  },
+                  metrics);
+              previewed = true;
+            }
+            break;
+          }
+          case FrameTopic::CONFIDENCE:
+          {
+            auto conf = frame->GetBuffer(ifm3d::buffer_id::CONFIDENCE_IMAGE);
+            convert_and_publish(
+                this->conf_pub_, [&] { return this->conf_conv_(conf, optical_head, logger_); }, metrics);
+            this->publish_confidence_masks(conf, optical_head);
+            break;
+          }
+          case FrameTopic::AMPLITUDE:
+          {
+            auto amp = frame->GetBuffer(ifm3d::buffer_id::NORM_AMPLITUDE_IMAGE);
+            convert_and_publish(
+                this->amplitude_pub_, [&] { return this->amplitude_conv_(amp, optical_head, logger_); }, metrics);
+            if (preview_due && this->amplitude_preview_pub_->get_subscription_count() > 0)
+            {
+              convert_and_publish(
+                  this->amplitude_preview_pub_,
+                  [&] {
+                    return this->amplitude_preview_(amp, this->preview_amplitude_range_[0],
+                                                    this->preview_amplitude_range_[1], optical_head, logger_);
+                  },
+                  metrics);
+              previewed = true;
+            }
+            break;
+          }
+          case FrameTopic::RGB:
+          {
+            auto rgb = frame->GetBuffer(ifm3d::buffer_id::JPEG_IMAGE);
+            if (rgb.width() * rgb.height() != 0)
+            {
+              convert_and_publish(
+                  this->rgb_pub_, [&] { return ifm3d_to_ros_compressed_image(rgb, optical_head, "jpeg", logger_); },
+                  metrics);
+            }
+            break;
+          }
+          case FrameTopic::DISTANCE_NOISE:
+          {
+            auto noise = frame->GetBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_NOISE);
+            convert_and_publish(
+                this->distance_noise_pub_, [&] { return this->distance_noise_conv_(noise, optical_head, logger_); },
+                metrics);
+            break;
+          }
+          case FrameTopic::RAW_AMPLITUDE:
+          {
+            auto raw_amp = frame->GetBuffer(ifm3d::buffer_id::AMPLITUDE_IMAGE);
+            convert_and_publish(
+                this->raw_amplitude_pub_, [&] { return this->raw_amplitude_conv_(raw_amp, optical_head, logger_); },
+                metrics);
+            break;
+          }
+        }
+
+        this->topic_scheduler_.account(
+            topic, std::chrono::duration<double>(std::chrono::steady_clock::now() - topic_start).count());
+      }
+
+      // the nearest point summary feeds safety watchdogs, so it is never
+      // suppressed by the change detection
+      if (this->sector_reducer_.params().num_sectors > 0 && frame->HasBuffer(ifm3d::buffer_id::XYZ))
       {
         auto xyz = frame->GetBuffer(ifm3d::buffer_id::XYZ);
-        this->cloud_pub_->publish(ifm3d_to_ros_cloud(xyz, optical_head, logger_));
+        if (xyz.dataFormat() == ifm3d::pixel_format::FORMAT_32F3)
+        {
+          convert_and_publish(
+              this->sectors_pub_,
+              [&] {
+                auto& reducer = this->sector_reducer_;
+                reducer.reduce(cloud_frame_points(xyz), static_cast<std::size_t>(xyz.width()) * xyz.height());
+
+                SectorSummaryMsg msg;
+                msg.header = cloud_head;
+                msg.angle_min = reducer.params().angle_min;
+                msg.angle_increment =
+                    (reducer.params().angle_max - reducer.params().angle_min) / reducer.params().num_sectors;
+                msg.num_sectors = reducer.params().num_sectors;
+                msg.band_limits = reducer.params().band_limits;
+                msg.min_range = reducer.min_range();
+                msg.point_count = reducer.point_count();
+                return msg;
+              },
+              metrics);
+        }
+        else
+        {
+          RCLCPP_WARN_ONCE(this->logger_, "XYZ is not float meters, not publishing ~/sectors!");
+        }
+      }
+
+      // the processing stages run on their own thread, working on a copy of
+      // the frame data, so that they never delay the publications above
+      if (this->stage_worker_ && publish_tof)
+      {
+        auto stage_frame = std::make_shared<StageFrame>();
+        stage_frame->header = optical_head;
+        stage_frame->xyz_header = cloud_head;
+
+        if ((this->ground_removal_ || this->height_grid_) && frame->HasBuffer(ifm3d::buffer_id::XYZ))
+        {
+          auto xyz = frame->GetBuffer(ifm3d::buffer_id::XYZ);
+          if (xyz.dataFormat() == ifm3d::pixel_format::FORMAT_32F3)
+          {
+            const auto* points = cloud_frame_points(xyz);
+            const std::size_t n = static_cast<std::size_t>(xyz.width()) * xyz.height();
+            stage_frame->xyz.assign(points, points + n * 3);
+
+            if (this->stage_confidence_exclude_ != 0)
+            {
+              auto conf = frame->HasBuffer(ifm3d::buffer_id::CONFIDENCE_IMAGE) ?
+                              frame->GetBuffer(ifm3d::buffer_id::CONFIDENCE_IMAGE) :
+                              ifm3d::Buffer();
+              if (conf.width() * conf.height() == n && conf.dataFormat() == ifm3d::pixel_format::FORMAT_16U)
+              {
+                stage_frame->confidence.assign(conf.ptr<std::uint16_t>(0), conf.ptr<std::uint16_t>(0) + n);
+              }
+              else if (conf.width() * conf.height() == n && conf.dataFormat() == ifm3d::pixel_format::FORMAT_8U)
+              {
+                stage_frame->confidence.assign(conf.ptr<std::uint8_t>(0), conf.ptr<std::uint8_t>(0) + n);
+              }
+              else
+              {
+                RCLCPP_WARN_ONCE(this->logger_, "No usable confidence image, the stages keep all points!");
+              }
+            }
+          }
+          else
+          {
+            RCLCPP_WARN_ONCE(this->logger_, "XYZ is not float meters, ground removal and height grid disabled!");
+          }
+        }
+
+        if (this->color_exchange_ && this->rgb_registered_pub_->get_subscription_count() > 0 &&
+            frame->HasBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE) && frame->HasBuffer(ifm3d::buffer_id::TOF_INFO))
+        {
+          this->color_exchange_->request(steady_nanos());
+          auto dist = frame->GetBuffer(ifm3d::buffer_id::RADIAL_DISTANCE_IMAGE);
+          if (dist.dataFormat() == ifm3d::pixel_format::FORMAT_32F)
+          {
+            try
+            {
+              stage_frame->calibration =
+                  to_optic_calibration(ifm3d::TOFInfoV4::Deserialize(frame->GetBuffer(ifm3d::buffer_id::TOF_INFO)));
+              stage_frame->width = dist.width();
+              stage_frame->height = dist.height();
+              const auto* distance = dist.ptr<float>(0);
+              stage_frame->distance.assign(distance, distance + static_cast<std::size_t>(dist.width()) * dist.height());
+            }
+            catch (const std::exception& ex)
+            {
+              RCLCPP_WARN_ONCE(this->logger_, "Cannot read TOF_INFO, not publishing ~/rgb_registered: %s", ex.what());
+            }
+          }
+          else
+          {
+            RCLCPP_WARN_ONCE(this->logger_, "Distance is not float meters, not publishing ~/rgb_registered!");
+          }
+        }
+
+        if (this->rgb_rectify_ &&
+            (this->rgb_rect_pub_->get_subscription_count() > 0 ||
+             this->rgb_rect_info_pub_->get_subscription_count() > 0) &&
+            frame->HasBuffer(ifm3d::buffer_id::JPEG_IMAGE) && frame->HasBuffer(ifm3d::buffer_id::RGB_INFO))
+        {
+          auto rgb = frame->GetBuffer(ifm3d::buffer_id::JPEG_IMAGE);
+          try
+          {
+            stage_frame->calibration =
+                to_optic_calibration(ifm3d::RGBInfoV1::Deserialize(frame->GetBuffer(ifm3d::buffer_id::RGB_INFO)));
+            stage_frame->jpeg.assign(rgb.ptr<>(0), std::next(rgb.ptr<>(0), rgb.width() * rgb.height()));
+          }
+          catch (const std::exception& ex)
+          {
+            RCLCPP_WARN_ONCE(this->logger_, "Cannot read RGB_INFO, not publishing ~/rgb_rect: %s", ex.what());
+          }
+        }
+
+        if ((!stage_frame->xyz.empty() || !stage_frame->distance.empty() || !stage_frame->jpeg.empty()) &&
+            !this->stage_worker_->post([this, stage_frame] { this->process_stages(*stage_frame); }))
+        {
+          RCLCPP_DEBUG(this->logger_, "Processing stages are behind, dropped a frame");
+        }
+      }
+
+      if (previewed)
+      {
+        last_preview = now_steady;
       }
 
       // TODO: Handle extrinsics
@@ -904,17 +3629,31 @@ void CameraNode::publish_loop()
       //      RCLCPP_WARN(this->logger_, "Out-of-range error fetching extrinsics");
       //    }
       //    this->extrinsics_pub_->publish(extrinsics_msg);
+
+      // suppressed frames are counted by `frames_unchanged` alone
+      if (publish_tof)
+      {
+        metrics.frames_out.inc();
+      }
+      metrics.queue_depth.dec();
+      this->loop_busy_nanos_.fetch_add(steady_nanos() - frame_start, std::memory_order_relaxed);
     } // end: try
     catch(const std::exception& ex){
       RCLCPP_ERROR(this->logger_, "Exception in publisher loop: %s", ex.what());
 
-      std::thread deactivate_t([this]() { this->deactivate(); });
-      deactivate_t.detach();
+      if (frame_in_flight)
+      {
+        metrics.frames_dropped.inc();
+        metrics.queue_depth.dec();
+      }
+
+      this->transition_worker_->request(TransitionRequest::DEACTIVATE);
       break;
     }
 
   }  // end: while (rclcpp::ok() && (! this->test_destroy_))
 
+  this->live_params_.unpin();
   fg_->Stop();
   RCLCPP_INFO(this->logger_, "Publish loop/thread exiting.");
 }
@@ -0,0 +1,157 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/change_detection.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+void flag_changed_pixels(const float* IFM3D_ROS2_RESTRICT cur, const float* IFM3D_ROS2_RESTRICT ref,
+                         std::uint8_t* IFM3D_ROS2_RESTRICT changed, std::size_t n, float abs, float rel)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const float c = cur[i];
+    const float r = ref[i];
+    const int cur_valid = c > 0.0F;  // NaN compares false
+    const int ref_valid = r > 0.0F;
+    const int moved = std::fabs(c - r) > abs + rel * r;
+    changed[i] = static_cast<std::uint8_t>((cur_valid ^ ref_valid) | (cur_valid & ref_valid & moved));
+  }
+}
+
+void ChangeDetector::configure(const Params& params)
+{
+  this->params_ = params;
+  this->params_.tile_size = std::max<std::uint32_t>(params.tile_size, 1);
+  this->reset();
+}
+
+void ChangeDetector::reset()
+{
+  this->width_ = 0;
+  this->height_ = 0;
+  this->reference_.clear();
+}
+
+ChangeDetector::Result ChangeDetector::compare(const float* distance, std::uint32_t width, std::uint32_t height,
+                                               bool force_keyframe)
+{
+  const std::uint32_t ts = this->params_.tile_size;
+  const bool new_geometry = width != this->width_ || height != this->height_;
+  if (new_geometry)
+  {
+    this->width_ = width;
+    this->height_ = height;
+    this->tiles_x_ = (width + ts - 1) / ts;
+    this->tiles_y_ = (height + ts - 1) / ts;
+    this->reference_.clear();
+  }
+
+  const std::size_t num_tiles = static_cast<std::size_t>(this->tiles_x_) * this->tiles_y_;
+  this->tile_map_.resize(num_tiles);
+
+  if (force_keyframe || this->reference_.empty())
+  {
+    std::fill(this->tile_map_.begin(), this->tile_map_.end(), 1);
+    return Result{ true, num_tiles };
+  }
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  this->changed_.resize(n);
+  flag_changed_pixels(distance, this->reference_.data(), this->changed_.data(), n, this->params_.threshold_abs,
+                      this->params_.threshold_rel);
+
+  this->counts_.assign(num_tiles, 0);
+  for (std::uint32_t y = 0; y < height; ++y)
+  {
+    const std::uint8_t* row = this->changed_.data() + static_cast<std::size_t>(y) * width;
+    std::uint32_t* counts = this->counts_.data() + static_cast<std::size_t>(y / ts) * this->tiles_x_;
+    for (std::uint32_t tx = 0; tx < this->tiles_x_; ++tx)
+    {
+      const std::uint32_t x0 = tx * ts;
+      const std::uint32_t x1 = std::min(x0 + ts, width);
+      std::uint32_t sum = 0;
+      for (std::uint32_t x = x0; x < x1; ++x)
+      {
+        sum += row[x];
+      }
+      counts[tx] += sum;
+    }
+  }
+
+  Result result{};
+  for (std::uint32_t ty = 0; ty < this->tiles_y_; ++ty)
+  {
+    const std::uint32_t tile_h = std::min(ts, height - ty * ts);
+    for (std::uint32_t tx = 0; tx < this->tiles_x_; ++tx)
+    {
+      const std::uint32_t tile_w = std::min(ts, width - tx * ts);
+      const std::size_t idx = static_cast<std::size_t>(ty) * this->tiles_x_ + tx;
+      const bool changed =
+          static_cast<float>(this->counts_[idx]) > this->params_.min_fraction * static_cast<float>(tile_w * tile_h);
+      this->tile_map_[idx] = changed ? 1 : 0;
+      result.tiles_changed += changed ? 1 : 0;
+    }
+  }
+  return result;
+}
+
+void ChangeDetector::commit(const float* distance, bool all_tiles)
+{
+  const std::size_t n = static_cast<std::size_t>(this->width_) * this->height_;
+  if (all_tiles || this->reference_.size() != n)
+  {
+    this->reference_.assign(distance, distance + n);
+    return;
+  }
+
+  const std::uint32_t ts = this->params_.tile_size;
+  for (std::uint32_t y = 0; y < this->height_; ++y)
+  {
+    const std::size_t row = static_cast<std::size_t>(y) * this->width_;
+    const std::uint8_t* tiles = this->tile_map_.data() + static_cast<std::size_t>(y / ts) * this->tiles_x_;
+    for (std::uint32_t tx = 0; tx < this->tiles_x_; ++tx)
+    {
+      if (tiles[tx] != 0)
+      {
+        const std::uint32_t x0 = tx * ts;
+        const std::uint32_t x1 = std::min(x0 + ts, this->width_);
+        std::copy(distance + row + x0, distance + row + x1, this->reference_.begin() + row + x0);
+      }
+    }
+  }
+}
+
+void ChangeDetector::append_changed_tiles(const float* distance, std::vector<float>& out) const
+{
+  const std::uint32_t ts = this->params_.tile_size;
+  for (std::uint32_t ty = 0; ty < this->tiles_y_; ++ty)
+  {
+    const std::uint32_t y0 = ty * ts;
+    const std::uint32_t y1 = std::min(y0 + ts, this->height_);
+    for (std::uint32_t tx = 0; tx < this->tiles_x_; ++tx)
+    {
+      if (this->tile_map_[static_cast<std::size_t>(ty) * this->tiles_x_ + tx] == 0)
+      {
+        continue;
+      }
+      const std::uint32_t x0 = tx * ts;
+      const std::uint32_t x1 = std::min(x0 + ts, this->width_);
+      for (std::uint32_t y = y0; y < y1; ++y)
+      {
+        const float* row = distance + static_cast<std::size_t>(y) * this->width_;
+        out.insert(out.end(), row + x0, row + x1);
+      }
+    }
+  }
+}
+
+}  // namespace ifm3d_ros2
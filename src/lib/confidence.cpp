@@ -0,0 +1,107 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/confidence.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+constexpr std::array<const char*, num_confidence_masks> mask_names{
+  { "valid", "saturated", "low_amplitude", "out_of_range" }
+};
+
+// pixels per block: the block of the confidence image stays in the L1 cache
+// while each requested mask is tested on it
+constexpr std::size_t block_size = 1024;
+
+template <typename T>
+void test_bits(const T* IFM3D_ROS2_RESTRICT conf, std::uint8_t* IFM3D_ROS2_RESTRICT out, std::size_t n, T bits,
+               std::uint8_t flip)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    out[i] = static_cast<std::uint8_t>(((conf[i] & bits) != 0 ? 0xFF : 0x00) ^ flip);
+  }
+}
+
+template <typename T>
+void decode(const T* conf, std::size_t n, const ConfidenceBits& bits,
+            const std::array<std::uint8_t*, num_confidence_masks>& out)
+{
+  for (std::size_t begin = 0; begin < n; begin += block_size)
+  {
+    const std::size_t count = std::min(block_size, n - begin);
+    for (std::size_t mask = 0; mask < num_confidence_masks; ++mask)
+    {
+      if (out[mask] != nullptr)
+      {
+        const std::uint8_t flip = mask == static_cast<std::size_t>(ConfidenceMask::VALID) ? 0xFF : 0x00;
+        // bits beyond `T` cannot be set in the image, i.e., they never match
+        const auto mask_bits = static_cast<T>(bits[mask] & std::numeric_limits<T>::max());
+        test_bits<T>(conf + begin, out[mask] + begin, count, mask_bits, flip);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+const char* confidence_mask_name(ConfidenceMask mask)
+{
+  return mask_names[static_cast<std::size_t>(mask)];
+}
+
+bool parse_confidence_mask(const std::string& name, ConfidenceMask& out)
+{
+  const auto it = std::find(mask_names.begin(), mask_names.end(), name);
+  if (it == mask_names.end())
+  {
+    return false;
+  }
+  out = static_cast<ConfidenceMask>(it - mask_names.begin());
+  return true;
+}
+
+bool confidence_bits_fit(const ConfidenceBits& bits, std::size_t pixel_bytes)
+{
+  const std::uint32_t limit = pixel_bytes >= sizeof(std::uint16_t) ? 0xFFFF : 0xFF;
+  return std::all_of(bits.begin(), bits.end(), [limit](std::uint16_t b) { return b <= limit; });
+}
+
+void decode_confidence(const std::uint16_t* conf, std::size_t n, const ConfidenceBits& bits,
+                       const std::array<std::uint8_t*, num_confidence_masks>& out)
+{
+  decode(conf, n, bits, out);
+}
+
+void decode_confidence(const std::uint8_t* conf, std::size_t n, const ConfidenceBits& bits,
+                       const std::array<std::uint8_t*, num_confidence_masks>& out)
+{
+  decode(conf, n, bits, out);
+}
+
+void exclude_points(float* IFM3D_ROS2_RESTRICT xyz, const std::uint16_t* IFM3D_ROS2_RESTRICT conf, std::size_t n,
+                    std::uint16_t bits)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const bool drop = (conf[i] & bits) != 0;
+    xyz[i * 3 + 0] = drop ? nan : xyz[i * 3 + 0];
+    xyz[i * 3 + 1] = drop ? nan : xyz[i * 3 + 1];
+    xyz[i * 3 + 2] = drop ? nan : xyz[i * 3 + 2];
+  }
+}
+
+}  // namespace ifm3d_ros2
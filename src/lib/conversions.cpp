@@ -0,0 +1,563 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/conversions.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include <rclcpp/logging.hpp>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+ImageConverter::Kernel ImageConverter::select(ifm3d::pixel_format format)
+{
+  using ifm3d::pixel_format;
+
+  switch (format)
+  {
+    case pixel_format::FORMAT_8U:
+      return &copy_image<pixel_format::FORMAT_8U>;
+    case pixel_format::FORMAT_8S:
+      return &copy_image<pixel_format::FORMAT_8S>;
+    case pixel_format::FORMAT_16U:
+      return &copy_image<pixel_format::FORMAT_16U>;
+    case pixel_format::FORMAT_16S:
+      return &copy_image<pixel_format::FORMAT_16S>;
+    case pixel_format::FORMAT_32U:
+      return &copy_image<pixel_format::FORMAT_32U>;
+    case pixel_format::FORMAT_32S:
+      return &copy_image<pixel_format::FORMAT_32S>;
+    case pixel_format::FORMAT_32F:
+      return &copy_image<pixel_format::FORMAT_32F>;
+    case pixel_format::FORMAT_64U:
+      return &copy_image<pixel_format::FORMAT_64U>;
+    case pixel_format::FORMAT_64F:
+      return &copy_image<pixel_format::FORMAT_64F>;
+    case pixel_format::FORMAT_16U2:
+      return &copy_image<pixel_format::FORMAT_16U2>;
+    case pixel_format::FORMAT_32F3:
+      return &copy_image<pixel_format::FORMAT_32F3>;
+    default:
+      return nullptr;
+  }
+}
+
+sensor_msgs::msg::Image ImageConverter::operator()(ifm3d::Buffer& image, const std_msgs::msg::Header& header,
+                                                   const rclcpp::Logger& logger)
+{
+  sensor_msgs::msg::Image result{};
+  result.header = header;
+  result.height = image.height();
+  result.width = image.width();
+  result.is_bigendian = 0;
+
+  if (image.begin<std::uint8_t>() == image.end<std::uint8_t>())
+  {
+    return result;
+  }
+
+  const auto format = image.dataFormat();
+  if (this->kernel_ == nullptr || format != this->format_)
+  {
+    this->kernel_ = select(format);
+    this->format_ = format;
+
+    if (this->kernel_ == nullptr)
+    {
+      RCLCPP_ERROR(logger, "Pixel format out of range (%ld > %ld)", static_cast<std::size_t>(format),
+                   max_pixel_format);
+      return result;
+    }
+  }
+
+  this->kernel_(image, result);
+  return result;
+}
+
+void distance_to_mm16(const float* IFM3D_ROS2_RESTRICT src, std::uint16_t* IFM3D_ROS2_RESTRICT dst, std::size_t n)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    float mm = src[i] * 1000.0F + 0.5F;
+    // written as selects so the loop vectorizes; NaN fails the first compare
+    mm = mm >= 1.0F ? mm : 0.0F;
+    mm = mm < static_cast<float>(mm16_max) ? mm : static_cast<float>(mm16_max);
+    dst[i] = static_cast<std::uint16_t>(static_cast<std::int32_t>(mm));
+  }
+}
+
+sensor_msgs::msg::Image ifm3d_to_ros_distance_mm16(ifm3d::Buffer& image, const std_msgs::msg::Header& header,
+                                                   const rclcpp::Logger& logger)
+{
+  sensor_msgs::msg::Image result{};
+  result.header = header;
+  result.height = image.height();
+  result.width = image.width();
+  result.is_bigendian = 0;
+  result.encoding = PixelTraits<ifm3d::pixel_format::FORMAT_16U>::encoding;
+  result.step = result.width * sizeof(std::uint16_t);
+
+  if (image.begin<std::uint8_t>() == image.end<std::uint8_t>())
+  {
+    return result;
+  }
+
+  if (image.dataFormat() != ifm3d::pixel_format::FORMAT_32F)
+  {
+    RCLCPP_ERROR(logger, "Unsupported pixel format %ld for millimeter distance",
+                 static_cast<std::size_t>(image.dataFormat()));
+    return result;
+  }
+
+  const std::size_t n = static_cast<std::size_t>(result.width) * result.height;
+  result.data.resize(n * sizeof(std::uint16_t));
+  distance_to_mm16(image.ptr<float>(0), reinterpret_cast<std::uint16_t*>(result.data.data()), n);
+  return result;
+}
+
+void transform_points(const PointTransform& transform, const float* IFM3D_ROS2_RESTRICT src,
+                      float* IFM3D_ROS2_RESTRICT dst, std::size_t n)
+{
+  const auto& m = transform;
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const float x = src[i * 3 + 0];
+    const float y = src[i * 3 + 1];
+    const float z = src[i * 3 + 2];
+    // invalid points (the origin, NaN) are copied as they are, blended
+    // rather than selected so the loop vectorizes
+    const float valid = x * x + y * y + z * z > 0.0F ? 1.0F : 0.0F;
+    const float invalid = 1.0F - valid;
+    dst[i * 3 + 0] = valid * (m[0] * x + m[1] * y + m[2] * z + m[3]) + invalid * x;
+    dst[i * 3 + 1] = valid * (m[4] * x + m[5] * y + m[6] * z + m[7]) + invalid * y;
+    dst[i * 3 + 2] = valid * (m[8] * x + m[9] * y + m[10] * z + m[11]) + invalid * z;
+  }
+}
+
+void quantize_mm16(const float* IFM3D_ROS2_RESTRICT src, std::int16_t* IFM3D_ROS2_RESTRICT dst, std::size_t n)
+{
+  constexpr float limit = 32767.0F;
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    float mm = src[i] * (1.0F / cloud_int16_scale);
+    mm += std::copysign(0.5F, mm);  // round half away from zero
+    mm = mm < limit ? mm : limit;
+    mm = mm > -limit ? mm : -limit;
+    mm = std::isnan(src[i]) ? 0.0F : mm;
+    dst[i] = static_cast<std::int16_t>(static_cast<std::int32_t>(mm));
+  }
+}
+
+template <typename T>
+void amplitude_to_u8(const T* IFM3D_ROS2_RESTRICT src, std::uint8_t* IFM3D_ROS2_RESTRICT dst, std::size_t n,
+                     float max_value)
+{
+  const float scale = max_value > 0.0F ? 255.0F / max_value : 0.0F;
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    float v = static_cast<float>(src[i]) * scale + 0.5F;
+    v = v >= 0.0F ? v : 0.0F;  // also maps NaN to 0
+    v = v < 255.0F ? v : 255.0F;
+    dst[i] = static_cast<std::uint8_t>(static_cast<std::int32_t>(v));
+  }
+}
+
+template IFM3D_ROS2_PUBLIC void amplitude_to_u8<float>(const float*, std::uint8_t*, std::size_t, float);
+template IFM3D_ROS2_PUBLIC void amplitude_to_u8<std::uint16_t>(const std::uint16_t*, std::uint8_t*, std::size_t,
+                                                               float);
+
+sensor_msgs::msg::PointCloud2 QuantizedCloudConverter::operator()(ifm3d::Buffer& xyz, ifm3d::Buffer* amplitude,
+                                                                  float intensity_max,
+                                                                  const std_msgs::msg::Header& header,
+                                                                  const rclcpp::Logger& logger,
+                                                                  const PointTransform* transform)
+{
+  sensor_msgs::msg::PointCloud2 result{};
+  result.header = header;
+  result.height = xyz.height();
+  result.width = xyz.width();
+  result.is_bigendian = false;
+
+  if (xyz.begin<std::uint8_t>() == xyz.end<std::uint8_t>())
+  {
+    return result;
+  }
+
+  if (xyz.dataFormat() != ifm3d::pixel_format::FORMAT_32F3)
+  {
+    RCLCPP_ERROR(logger, "Unsupported pixel format %ld for quantized point cloud",
+                 static_cast<std::size_t>(xyz.dataFormat()));
+    return result;
+  }
+
+  const std::size_t n = static_cast<std::size_t>(result.width) * result.height;
+
+  bool with_intensity = amplitude != nullptr && amplitude->width() * amplitude->height() != 0;
+  if (with_intensity && static_cast<std::size_t>(amplitude->width()) * amplitude->height() != n)
+  {
+    RCLCPP_WARN_ONCE(logger, "Amplitude and XYZ sizes differ, omitting the intensity field");
+    with_intensity = false;
+  }
+  if (with_intensity && amplitude->dataFormat() != ifm3d::pixel_format::FORMAT_32F &&
+      amplitude->dataFormat() != ifm3d::pixel_format::FORMAT_16U)
+  {
+    RCLCPP_WARN_ONCE(logger, "Unsupported amplitude format %ld, omitting the intensity field",
+                     static_cast<std::size_t>(amplitude->dataFormat()));
+    with_intensity = false;
+  }
+
+  for (const char* name : { "x", "y", "z" })
+  {
+    sensor_msgs::msg::PointField field{};
+    field.name = name;
+    field.offset = static_cast<std::uint32_t>(result.fields.size() * sizeof(std::int16_t));
+    field.datatype = sensor_msgs::msg::PointField::INT16;
+    field.count = 1;
+    result.fields.push_back(field);
+  }
+  result.point_step = 3 * sizeof(std::int16_t);
+
+  if (with_intensity)
+  {
+    sensor_msgs::msg::PointField intensity_field{};
+    intensity_field.name = "intensity";
+    intensity_field.offset = result.point_step;
+    intensity_field.datatype = sensor_msgs::msg::PointField::UINT8;
+    intensity_field.count = 1;
+    result.fields.push_back(intensity_field);
+    result.point_step += sizeof(std::uint8_t);
+  }
+
+  result.row_step = result.point_step * result.width;
+  // invalid points are kept as `(0, 0, 0)`, INT16 has no NaN
+  result.is_dense = false;
+  result.data.resize(static_cast<std::size_t>(result.row_step) * result.height);
+
+  const float* points = xyz.ptr<float>(0);
+  if (transform != nullptr)
+  {
+    this->xyz_m_.resize(3 * n);
+    transform_points(*transform, points, this->xyz_m_.data(), n);
+    points = this->xyz_m_.data();
+  }
+
+  if (!with_intensity)
+  {
+    // the message layout is exactly the quantized coordinates
+    quantize_mm16(points, reinterpret_cast<std::int16_t*>(result.data.data()), 3 * n);
+    return result;
+  }
+
+  this->xyz_mm_.resize(3 * n);
+  this->intensity_.resize(n);
+  quantize_mm16(points, this->xyz_mm_.data(), 3 * n);
+  if (amplitude->dataFormat() == ifm3d::pixel_format::FORMAT_32F)
+  {
+    amplitude_to_u8(amplitude->ptr<float>(0), this->intensity_.data(), n, intensity_max);
+  }
+  else
+  {
+    amplitude_to_u8(amplitude->ptr<std::uint16_t>(0), this->intensity_.data(), n, intensity_max);
+  }
+
+  auto* dst = result.data.data();
+  const auto* xyz_bytes = reinterpret_cast<const std::uint8_t*>(this->xyz_mm_.data());
+  for (std::size_t i = 0; i < n; ++i, dst += result.point_step)
+  {
+    std::memcpy(dst, xyz_bytes + i * 3 * sizeof(std::int16_t), 3 * sizeof(std::int16_t));
+    dst[3 * sizeof(std::int16_t)] = this->intensity_[i];
+  }
+
+  return result;
+}
+
+// `transform` is the identity when `Transform` is false, skipping it keeps
+// the copy exact
+template <std::size_t Stride, bool Transform>
+void filter_noisy_points(const float* IFM3D_ROS2_RESTRICT xyz, const float* IFM3D_ROS2_RESTRICT noise,
+                         float* IFM3D_ROS2_RESTRICT out, std::size_t n, float max_noise, const PointTransform& m)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    // a factor rather than a select per coordinate, so the loop vectorizes
+    const float keep = noise[i] > max_noise ? nan : 1.0F;  // NaN compares false
+    float x = xyz[i * 3 + 0];
+    float y = xyz[i * 3 + 1];
+    float z = xyz[i * 3 + 2];
+    if (Transform)
+    {
+      // see `transform_points()`
+      const float px = x;
+      const float py = y;
+      const float pz = z;
+      const float valid = px * px + py * py + pz * pz > 0.0F ? 1.0F : 0.0F;
+      const float invalid = 1.0F - valid;
+      x = valid * (m[0] * px + m[1] * py + m[2] * pz + m[3]) + invalid * px;
+      y = valid * (m[4] * px + m[5] * py + m[6] * pz + m[7]) + invalid * py;
+      z = valid * (m[8] * px + m[9] * py + m[10] * pz + m[11]) + invalid * pz;
+    }
+    out[i * Stride + 0] = x * keep;
+    out[i * Stride + 1] = y * keep;
+    out[i * Stride + 2] = z * keep;
+    if (Stride == 4)
+    {
+      out[i * Stride + 3] = noise[i];
+    }
+  }
+}
+
+void filter_noisy_points(const float* xyz, const float* noise, float* out, std::size_t n, float max_noise,
+                         bool with_sigma, const PointTransform* transform)
+{
+  static const PointTransform identity{ { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0 } };
+  const auto& m = transform != nullptr ? *transform : identity;
+
+  if (with_sigma)
+  {
+    transform != nullptr ? filter_noisy_points<4, true>(xyz, noise, out, n, max_noise, m) :
+                           filter_noisy_points<4, false>(xyz, noise, out, n, max_noise, m);
+  }
+  else
+  {
+    transform != nullptr ? filter_noisy_points<3, true>(xyz, noise, out, n, max_noise, m) :
+                           filter_noisy_points<3, false>(xyz, noise, out, n, max_noise, m);
+  }
+}
+
+sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud_with_noise(ifm3d::Buffer& xyz, ifm3d::Buffer& noise, bool with_sigma,
+                                                            float max_noise, const std_msgs::msg::Header& header,
+                                                            const rclcpp::Logger& logger,
+                                                            const PointTransform* transform)
+{
+  sensor_msgs::msg::PointCloud2 result{};
+  result.header = header;
+  result.height = xyz.height();
+  result.width = xyz.width();
+  result.is_bigendian = false;
+
+  if (xyz.begin<std::uint8_t>() == xyz.end<std::uint8_t>())
+  {
+    return result;
+  }
+
+  if (xyz.dataFormat() != ifm3d::pixel_format::FORMAT_32F3 || noise.dataFormat() != ifm3d::pixel_format::FORMAT_32F ||
+      xyz.width() != noise.width() || xyz.height() != noise.height())
+  {
+    RCLCPP_ERROR(logger, "Unsupported XYZ (%ld) or noise (%ld) buffer for point cloud",
+                 static_cast<std::size_t>(xyz.dataFormat()), static_cast<std::size_t>(noise.dataFormat()));
+    return result;
+  }
+
+  const std::size_t num_fields = with_sigma ? 4 : 3;
+  for (const char* name : { "x", "y", "z", "sigma" })
+  {
+    if (result.fields.size() == num_fields)
+    {
+      break;
+    }
+    sensor_msgs::msg::PointField field{};
+    field.name = name;
+    field.offset = static_cast<std::uint32_t>(result.fields.size() * sizeof(float));
+    field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+    field.count = 1;
+    result.fields.push_back(field);
+  }
+
+  const std::size_t n = static_cast<std::size_t>(result.width) * result.height;
+  result.point_step = static_cast<std::uint32_t>(result.fields.size() * sizeof(float));
+  result.row_step = result.point_step * result.width;
+  result.is_dense = false;  // invalid points are kept in place
+  result.data.resize(static_cast<std::size_t>(result.row_step) * result.height);
+  filter_noisy_points(xyz.ptr<float>(0), noise.ptr<float>(0), reinterpret_cast<float*>(result.data.data()), n,
+                      max_noise, with_sigma, transform);
+
+  return result;
+}
+
+sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud_transformed(ifm3d::Buffer& xyz, const PointTransform& transform,
+                                                             const std_msgs::msg::Header& header,
+                                                             const rclcpp::Logger& logger)
+{
+  sensor_msgs::msg::PointCloud2 result{};
+  result.header = header;
+  result.height = xyz.height();
+  result.width = xyz.width();
+  result.is_bigendian = false;
+
+  if (xyz.begin<std::uint8_t>() == xyz.end<std::uint8_t>())
+  {
+    return result;
+  }
+
+  if (xyz.dataFormat() != ifm3d::pixel_format::FORMAT_32F3)
+  {
+    RCLCPP_ERROR(logger, "Unsupported pixel format %ld for transformed point cloud",
+                 static_cast<std::size_t>(xyz.dataFormat()));
+    return result;
+  }
+
+  for (const char* name : { "x", "y", "z" })
+  {
+    sensor_msgs::msg::PointField field{};
+    field.name = name;
+    field.offset = static_cast<std::uint32_t>(result.fields.size() * sizeof(float));
+    field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+    field.count = 1;
+    result.fields.push_back(field);
+  }
+
+  const std::size_t n = static_cast<std::size_t>(result.width) * result.height;
+  result.point_step = 3 * sizeof(float);
+  result.row_step = result.point_step * result.width;
+  result.is_dense = false;  // invalid points are kept in place
+  result.data.resize(static_cast<std::size_t>(result.row_step) * result.height);
+  transform_points(transform, xyz.ptr<float>(0), reinterpret_cast<float*>(result.data.data()), n);
+
+  return result;
+}
+
+sensor_msgs::msg::PointCloud2 xyz_to_ros_cloud(const float* xyz, std::size_t n, const std_msgs::msg::Header& header)
+{
+  sensor_msgs::msg::PointCloud2 result{};
+  result.header = header;
+  result.height = 1;
+  result.width = static_cast<std::uint32_t>(n);
+  result.is_bigendian = false;
+
+  for (const char* name : { "x", "y", "z" })
+  {
+    sensor_msgs::msg::PointField field{};
+    field.name = name;
+    field.offset = static_cast<std::uint32_t>(result.fields.size() * sizeof(float));
+    field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+    field.count = 1;
+    result.fields.push_back(field);
+  }
+
+  result.point_step = 3 * sizeof(float);
+  result.row_step = result.point_step * result.width;
+  result.is_dense = true;
+  result.data.resize(result.row_step);
+  if (n > 0)
+  {
+    std::memcpy(result.data.data(), xyz, result.data.size());
+  }
+
+  return result;
+}
+
+sensor_msgs::msg::Image ifm3d_to_ros_image(ifm3d::Buffer& image, const std_msgs::msg::Header& header,
+                                           const rclcpp::Logger& logger)
+{
+  return ImageConverter()(image, header, logger);
+}
+
+sensor_msgs::msg::Image ifm3d_to_ros_image(ifm3d::Buffer&& image, const std_msgs::msg::Header& header,
+                                           const rclcpp::Logger& logger)
+{
+  return ifm3d_to_ros_image(image, header, logger);
+}
+
+sensor_msgs::msg::CompressedImage ifm3d_to_ros_compressed_image(ifm3d::Buffer& image,
+                                                                const std_msgs::msg::Header& header,
+                                                                const std::string& format,  // "jpeg" or "png"
+                                                                const rclcpp::Logger& logger)
+{
+  sensor_msgs::msg::CompressedImage result{};
+  result.header = header;
+  result.format = format;
+
+  if (const auto dataFormat = image.dataFormat();
+      dataFormat != ifm3d::pixel_format::FORMAT_8S && dataFormat != ifm3d::pixel_format::FORMAT_8U)
+  {
+    RCLCPP_ERROR(logger, "Invalid data format for %s data (%ld)", format.c_str(), static_cast<std::size_t>(dataFormat));
+    return result;
+  }
+
+  result.data.insert(result.data.end(), image.ptr<>(0), std::next(image.ptr<>(0), image.width() * image.height()));
+  return result;
+}
+
+sensor_msgs::msg::CompressedImage ifm3d_to_ros_compressed_image(ifm3d::Buffer&& image,
+                                                                const std_msgs::msg::Header& header,
+                                                                const std::string& format, const rclcpp::Logger& logger)
+{
+  return ifm3d_to_ros_compressed_image(image, header, format, logger);
+}
+
+sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud(ifm3d::Buffer& image, const std_msgs::msg::Header& header,
+                                                 const rclcpp::Logger& logger)
+{
+  sensor_msgs::msg::PointCloud2 result{};
+  result.header = header;
+  result.height = image.height();
+  result.width = image.width();
+  result.is_bigendian = false;
+
+  if (image.begin<std::uint8_t>() == image.end<std::uint8_t>())
+  {
+    return result;
+  }
+
+  if (image.dataFormat() != ifm3d::pixel_format::FORMAT_32F3 && image.dataFormat() != ifm3d::pixel_format::FORMAT_32F)
+  {
+    RCLCPP_ERROR(logger, "Unsupported pixel format %ld for point cloud", static_cast<std::size_t>(image.dataFormat()));
+    return result;
+  }
+
+  sensor_msgs::msg::PointField x_field{};
+  x_field.name = "x";
+  x_field.offset = 0;
+  x_field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+  x_field.count = 1;
+
+  sensor_msgs::msg::PointField y_field{};
+  y_field.name = "y";
+  y_field.offset = 4;
+  y_field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+  y_field.count = 1;
+
+  sensor_msgs::msg::PointField z_field{};
+  z_field.name = "z";
+  z_field.offset = 8;
+  z_field.datatype = sensor_msgs::msg::PointField::FLOAT32;
+  z_field.count = 1;
+
+  result.fields = {
+    x_field,
+    y_field,
+    z_field,
+  };
+
+  result.point_step = result.fields.size() * sizeof(float);
+  result.row_step = result.point_step * result.width;
+  result.is_dense = true;
+  result.data.insert(result.data.end(), image.ptr<>(0), std::next(image.ptr<>(0), result.row_step * result.height));
+
+  return result;
+}
+
+sensor_msgs::msg::PointCloud2 ifm3d_to_ros_cloud(ifm3d::Buffer&& image, const std_msgs::msg::Header& header,
+                                                 const rclcpp::Logger& logger)
+{
+  return ifm3d_to_ros_cloud(image, header, logger);
+}
+
+}  // namespace ifm3d_ros2
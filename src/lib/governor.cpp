@@ -0,0 +1,115 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/governor.hpp>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+std::string describe(const char* figure, double value, const char* relation, double limit, const char* unit,
+                     double scale)
+{
+  char text[96];
+  std::snprintf(text, sizeof(text), "%s %.1f %s %s %.1f %s", figure, value * scale, unit, relation, limit * scale,
+                unit);
+  return text;
+}
+
+}  // namespace
+
+FrameRateGovernor::FrameRateGovernor(const GovernorLimits& limits) : limits_(limits)
+{
+  this->limits_.max_level = std::max(this->limits_.max_level, 0);
+  this->limits_.restore_periods = std::max(this->limits_.restore_periods, 1);
+}
+
+GovernorAction FrameRateGovernor::update(const GovernorInputs& inputs)
+{
+  const auto& limits = this->limits_;
+
+  // pressure: one step down right away
+  std::string pressure;
+  if (inputs.host_cpu_load > limits.cpu_high)
+  {
+    pressure = describe("host CPU", inputs.host_cpu_load, ">", limits.cpu_high, "%", 100.0);
+  }
+  else if (inputs.publish_latency > limits.publish_latency)
+  {
+    pressure = describe("publish latency", inputs.publish_latency, ">", limits.publish_latency, "ms", 1000.0);
+  }
+  else if (inputs.loop_load > limits.loop_load)
+  {
+    pressure = describe("publish loop load", inputs.loop_load, ">", limits.loop_load, "%", 100.0);
+  }
+
+  if (!pressure.empty())
+  {
+    this->calm_periods_ = 0;
+    if (this->level_ < limits.max_level)
+    {
+      ++this->level_;
+      this->reason_ = pressure;
+      return GovernorAction::DEGRADE;
+    }
+    this->reason_ = pressure + ", already at the lowest rate";
+    return GovernorAction::HOLD;
+  }
+
+  if (this->level_ == 0)
+  {
+    this->calm_periods_ = 0;
+    this->reason_ = "nominal rate";
+    return GovernorAction::HOLD;
+  }
+
+  // headroom: every figure clear of its limit, the loop load also at the next
+  // higher rate (from `1 / (n + 1)` to `1 / n`)
+  const double loop_load_up = inputs.loop_load * (this->level_ + 1) / this->level_;
+  std::string lacking;
+  if (inputs.host_cpu_load >= limits.cpu_low)
+  {
+    lacking = describe("host CPU", inputs.host_cpu_load, ">=", limits.cpu_low, "%", 100.0);
+  }
+  else if (inputs.publish_latency >= limits.publish_latency / 2.0)
+  {
+    lacking = describe("publish latency", inputs.publish_latency, ">=", limits.publish_latency / 2.0, "ms", 1000.0);
+  }
+  else if (loop_load_up >= limits.loop_load * 0.8)
+  {
+    lacking = describe("publish loop load at the higher rate", loop_load_up, ">=", limits.loop_load * 0.8, "%", 100.0);
+  }
+
+  if (!lacking.empty())
+  {
+    this->calm_periods_ = 0;
+    this->reason_ = "no headroom: " + lacking;
+    return GovernorAction::HOLD;
+  }
+
+  if (++this->calm_periods_ < limits.restore_periods)
+  {
+    this->reason_ = "headroom for " + std::to_string(this->calm_periods_) + " of " +
+                    std::to_string(limits.restore_periods) + " periods";
+    return GovernorAction::HOLD;
+  }
+
+  this->calm_periods_ = 0;
+  --this->level_;
+  this->reason_ = "headroom for " + std::to_string(limits.restore_periods) + " periods";
+  return GovernorAction::RESTORE;
+}
+
+void FrameRateGovernor::reset()
+{
+  this->level_ = 0;
+  this->calm_periods_ = 0;
+  this->reason_.clear();
+}
+
+}  // namespace ifm3d_ros2
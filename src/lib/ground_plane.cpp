@@ -0,0 +1,398 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/ground_plane.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+// second order moments of a set of points, relative to some origin
+struct Moments
+{
+  double n{};
+  double x{}, y{}, z{};
+  double xx{}, xy{}, xz{}, yy{}, yz{}, zz{};
+};
+
+/**
+ * Least squares plane through the points of `m` (relative to `origin`):
+ * the normal is the direction of least variance, picked among the three
+ * axis-aligned solutions by the largest determinant (numerically the most
+ * stable one). Returns false for degenerate point sets.
+ */
+bool fit_plane(const Moments& m, const std::array<float, 3>& origin, Plane& out)
+{
+  if (m.n < 3.0)
+  {
+    return false;
+  }
+
+  const double cx = m.x / m.n;
+  const double cy = m.y / m.n;
+  const double cz = m.z / m.n;
+  const double xx = m.xx / m.n - cx * cx;
+  const double xy = m.xy / m.n - cx * cy;
+  const double xz = m.xz / m.n - cx * cz;
+  const double yy = m.yy / m.n - cy * cy;
+  const double yz = m.yz / m.n - cy * cz;
+  const double zz = m.zz / m.n - cz * cz;
+
+  const double det_x = yy * zz - yz * yz;
+  const double det_y = xx * zz - xz * xz;
+  const double det_z = xx * yy - xy * xy;
+  const double det_max = std::max({ det_x, det_y, det_z });
+  if (det_max <= 0.0)
+  {
+    return false;
+  }
+
+  double nx = 0.0;
+  double ny = 0.0;
+  double nz = 0.0;
+  if (det_max == det_x)
+  {
+    nx = det_x;
+    ny = xz * yz - xy * zz;
+    nz = xy * yz - xz * yy;
+  }
+  else if (det_max == det_y)
+  {
+    nx = xz * yz - xy * zz;
+    ny = det_y;
+    nz = xy * xz - yz * xx;
+  }
+  else
+  {
+    nx = xy * yz - xz * yy;
+    ny = xy * xz - yz * xx;
+    nz = det_z;
+  }
+
+  const double norm = std::sqrt(nx * nx + ny * ny + nz * nz);
+  out.a = static_cast<float>(nx / norm);
+  out.b = static_cast<float>(ny / norm);
+  out.c = static_cast<float>(nz / norm);
+  out.d = static_cast<float>(-(nx * (cx + origin[0]) + ny * (cy + origin[1]) + nz * (cz + origin[2])) / norm);
+  return true;
+}
+
+/**
+ * Flips `plane` to have its normal point along `up`, returns the cosine of
+ * the angle between them.
+ */
+float orient(Plane& plane, const std::array<float, 3>& up)
+{
+  float cos_tilt = plane.a * up[0] + plane.b * up[1] + plane.c * up[2];
+  if (cos_tilt < 0.0F)
+  {
+    plane = Plane{ -plane.a, -plane.b, -plane.c, -plane.d };
+    cos_tilt = -cos_tilt;
+  }
+  return cos_tilt;
+}
+
+}  // namespace
+
+void GroundPlaneEstimator::configure(const Params& params)
+{
+  this->params_ = params;
+
+  const auto& up = this->params_.up;
+  const float norm = std::sqrt(up[0] * up[0] + up[1] * up[1] + up[2] * up[2]);
+  this->params_.up = norm > 0.0F ? std::array<float, 3>{ { up[0] / norm, up[1] / norm, up[2] / norm } } :
+                                   std::array<float, 3>{ { 0.0F, 0.0F, 1.0F } };
+  this->params_.num_hypotheses = std::max<std::size_t>(params.num_hypotheses, 1);
+  this->reset();
+}
+
+void GroundPlaneEstimator::reset()
+{
+  this->has_previous_ = false;
+}
+
+bool GroundPlaneEstimator::make_hypothesis(std::size_t i, std::size_t j, std::size_t k, Plane& out) const
+{
+  const float ux = this->sx_[j] - this->sx_[i];
+  const float uy = this->sy_[j] - this->sy_[i];
+  const float uz = this->sz_[j] - this->sz_[i];
+  const float vx = this->sx_[k] - this->sx_[i];
+  const float vy = this->sy_[k] - this->sy_[i];
+  const float vz = this->sz_[k] - this->sz_[i];
+
+  const float nx = uy * vz - uz * vy;
+  const float ny = uz * vx - ux * vz;
+  const float nz = ux * vy - uy * vx;
+  const float norm = std::sqrt(nx * nx + ny * ny + nz * nz);
+  if (!(norm > 1e-9F))
+  {
+    return false;  // (nearly) collinear
+  }
+
+  out.a = nx / norm;
+  out.b = ny / norm;
+  out.c = nz / norm;
+  out.d = -(out.a * this->sx_[i] + out.b * this->sy_[i] + out.c * this->sz_[i]);
+  return orient(out, this->params_.up) >= std::cos(this->params_.max_tilt_rad);
+}
+
+std::uint32_t GroundPlaneEstimator::count_inliers(const Plane& plane, std::size_t begin, std::size_t end) const
+{
+  const float* IFM3D_ROS2_RESTRICT sx = this->sx_.data();
+  const float* IFM3D_ROS2_RESTRICT sy = this->sy_.data();
+  const float* IFM3D_ROS2_RESTRICT sz = this->sz_.data();
+  const float threshold = this->params_.threshold;
+
+  std::uint32_t count = 0;
+  IFM3D_ROS2_PRAGMA_SIMD_REDUCTION(+ : count)
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    count += std::fabs(plane.distance(sx[i], sy[i], sz[i])) < threshold ? 1 : 0;
+  }
+  return count;
+}
+
+GroundPlaneEstimator::Result GroundPlaneEstimator::estimate(const float* xyz, std::size_t n, WorkerPool& pool)
+{
+  const auto deadline = std::chrono::steady_clock::now() + this->params_.time_budget;
+  Result result{};
+
+  //
+  // Random subset of the valid points
+  //
+  this->sx_.clear();
+  this->sy_.clear();
+  this->sz_.clear();
+  if (n > 0)
+  {
+    std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+    for (std::size_t attempt = 0; attempt < 4 * this->params_.num_samples && this->sx_.size() < this->params_.num_samples;
+         ++attempt)
+    {
+      const float* p = xyz + pick(this->rng_) * 3;
+      if (p[0] * p[0] + p[1] * p[1] + p[2] * p[2] > 0.0F)  // NaN compares false
+      {
+        this->sx_.push_back(p[0]);
+        this->sy_.push_back(p[1]);
+        this->sz_.push_back(p[2]);
+      }
+    }
+  }
+
+  const std::size_t m = this->sx_.size();
+  if (m < 3)
+  {
+    this->has_previous_ = false;
+    return result;
+  }
+
+  //
+  // Hypotheses: the previous plane plus random ones, half of them drawn from
+  // the points close to the previous plane
+  //
+  this->hypotheses_.clear();
+  this->near_previous_.clear();
+  if (this->has_previous_)
+  {
+    this->hypotheses_.push_back(Hypothesis{ this->previous_, 0 });
+    result.seeded = true;
+
+    for (std::size_t i = 0; i < m; ++i)
+    {
+      if (std::fabs(this->previous_.distance(this->sx_[i], this->sy_[i], this->sz_[i])) < 2.0F * this->params_.threshold)
+      {
+        this->near_previous_.push_back(static_cast<std::uint32_t>(i));
+      }
+    }
+  }
+
+  std::uniform_int_distribution<std::size_t> pick_any(0, m - 1);
+  std::uniform_int_distribution<std::size_t> pick_near(0, std::max<std::size_t>(this->near_previous_.size(), 1) - 1);
+  const bool sample_near = this->near_previous_.size() >= 3;
+  for (std::size_t attempt = 0;
+       attempt < 4 * this->params_.num_hypotheses && this->hypotheses_.size() < this->params_.num_hypotheses; ++attempt)
+  {
+    std::size_t idx[3];
+    for (auto& i : idx)
+    {
+      i = (sample_near && attempt % 2 == 0) ? this->near_previous_[pick_near(this->rng_)] : pick_any(this->rng_);
+    }
+
+    Plane plane;
+    if (idx[0] != idx[1] && idx[0] != idx[2] && idx[1] != idx[2] && this->make_hypothesis(idx[0], idx[1], idx[2], plane))
+    {
+      this->hypotheses_.push_back(Hypothesis{ plane, 0 });
+    }
+  }
+
+  if (this->hypotheses_.empty())
+  {
+    this->has_previous_ = false;
+    return result;
+  }
+
+  //
+  // Preemptive scoring: score the surviving hypotheses on the next block of
+  // points, then keep the better half
+  //
+  const auto by_score = [](const Hypothesis& lhs, const Hypothesis& rhs) { return lhs.score > rhs.score; };
+  const auto halvings = static_cast<std::size_t>(std::ceil(std::log2(static_cast<double>(this->hypotheses_.size()))));
+  const std::size_t block = std::max<std::size_t>(16, m / (halvings + 1));
+
+  std::size_t alive = this->hypotheses_.size();
+  for (std::size_t begin = 0; alive > 1 && begin < m; begin += block)
+  {
+    const std::size_t end = std::min(begin + block, m);
+    for (std::size_t h = 0; h < alive; ++h)
+    {
+      this->hypotheses_[h].score += this->count_inliers(this->hypotheses_[h].plane, begin, end);
+    }
+
+    const std::size_t keep = std::max<std::size_t>(alive / 2, 1);
+    std::nth_element(this->hypotheses_.begin(), this->hypotheses_.begin() + (keep - 1),
+                     this->hypotheses_.begin() + alive, by_score);
+    alive = keep;
+
+    if (std::chrono::steady_clock::now() > deadline)
+    {
+      result.timed_out = alive > 1;
+      break;
+    }
+  }
+  const Plane best =
+      std::max_element(this->hypotheses_.begin(), this->hypotheses_.begin() + alive, [](const auto& lhs, const auto& rhs) {
+        return lhs.score < rhs.score;
+      })->plane;
+
+  //
+  // Refinement: least squares fit to the inliers among all points, relative
+  // to the point of the plane closest to the origin to limit cancellation
+  //
+  const std::array<float, 3> origin{ { -best.d * best.a, -best.d * best.b, -best.d * best.c } };
+  const float threshold = this->params_.threshold;
+  Moments total{};
+  std::size_t points = 0;
+  std::mutex total_mutex;
+
+  pool.parallel_for(n, [&](std::size_t begin, std::size_t end) {
+    const float* IFM3D_ROS2_RESTRICT p = xyz;
+    const Plane plane = best;
+    const float ox = origin[0];
+    const float oy = origin[1];
+    const float oz = origin[2];
+    const float thr = threshold;
+    float cnt = 0.0F, valid = 0.0F;
+    float sx = 0.0F, sy = 0.0F, sz = 0.0F;
+    float sxx = 0.0F, sxy = 0.0F, sxz = 0.0F, syy = 0.0F, syz = 0.0F, szz = 0.0F;
+
+    IFM3D_ROS2_PRAGMA_SIMD_REDUCTION(+ : cnt, valid, sx, sy, sz, sxx, sxy, sxz, syy, syz, szz)
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const float x = p[i * 3 + 0];
+      const float y = p[i * 3 + 1];
+      const float z = p[i * 3 + 2];
+      const float v = x * x + y * y + z * z > 0.0F ? 1.0F : 0.0F;  // NaN compares false
+      const float w = std::fabs(plane.distance(x, y, z)) < thr ? v : 0.0F;
+      // zero the outliers (and NaNs) before weighting, NaN * 0 is still NaN
+      const float dx = w * ((w > 0.0F ? x : ox) - ox);
+      const float dy = w * ((w > 0.0F ? y : oy) - oy);
+      const float dz = w * ((w > 0.0F ? z : oz) - oz);
+      valid += v;
+      cnt += w;
+      sx += dx;
+      sy += dy;
+      sz += dz;
+      sxx += dx * dx;
+      sxy += dx * dy;
+      sxz += dx * dz;
+      syy += dy * dy;
+      syz += dy * dz;
+      szz += dz * dz;
+    }
+
+    std::lock_guard<std::mutex> lock(total_mutex);
+    points += static_cast<std::size_t>(valid);
+    total.n += cnt;
+    total.x += sx;
+    total.y += sy;
+    total.z += sz;
+    total.xx += sxx;
+    total.xy += sxy;
+    total.xz += sxz;
+    total.yy += syy;
+    total.yz += syz;
+    total.zz += szz;
+  });
+
+  Plane refined;
+  result.plane = best;
+  if (fit_plane(total, origin, refined) && orient(refined, this->params_.up) >= std::cos(this->params_.max_tilt_rad))
+  {
+    result.plane = refined;
+  }
+  else
+  {
+    orient(result.plane, this->params_.up);
+  }
+
+  result.points = points;
+  result.inliers = static_cast<std::size_t>(total.n);
+  result.valid = points > 0 && static_cast<float>(result.inliers) >= this->params_.min_inlier_ratio * points;
+
+  this->has_previous_ = result.valid;
+  this->previous_ = result.plane;
+  return result;
+}
+
+void GroundPlaneEstimator::split(const float* xyz, std::size_t n, const Plane& plane, std::vector<float>& ground,
+                                 std::vector<float>& obstacles, WorkerPool& pool)
+{
+  // 0: invalid, 1: ground, 2: obstacle
+  this->labels_.resize(n);
+  const float threshold = this->params_.threshold;
+  pool.parallel_for(n, [&](std::size_t begin, std::size_t end) {
+    const float* IFM3D_ROS2_RESTRICT p = xyz;
+    std::uint8_t* IFM3D_ROS2_RESTRICT labels = this->labels_.data();
+    const Plane pl = plane;
+    const float thr = threshold;
+
+    IFM3D_ROS2_PRAGMA_SIMD
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const float x = p[i * 3 + 0];
+      const float y = p[i * 3 + 1];
+      const float z = p[i * 3 + 2];
+      const int valid = x * x + y * y + z * z > 0.0F ? 1 : 0;
+      const int obstacle = std::fabs(pl.distance(x, y, z)) < thr ? 0 : 1;
+      labels[i] = static_cast<std::uint8_t>(valid + valid * obstacle);
+    }
+  });
+
+  ground.clear();
+  obstacles.clear();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const float* p = xyz + i * 3;
+    switch (this->labels_[i])
+    {
+      case 1:
+        ground.insert(ground.end(), p, p + 3);
+        break;
+      case 2:
+        obstacles.insert(obstacles.end(), p, p + 3);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+}  // namespace ifm3d_ros2
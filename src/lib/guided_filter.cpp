@@ -0,0 +1,267 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/guided_filter.hpp>
+
+#include <algorithm>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+// sums of the guide and the distance over the valid pixels, for their means
+template <typename T>
+void guide_sum(const float* IFM3D_ROS2_RESTRICT distance, const T* IFM3D_ROS2_RESTRICT amplitude, std::size_t begin,
+               std::size_t end, float* sums)
+{
+  float s = 0.0F;
+  float d = 0.0F;
+  float c = 0.0F;
+
+  IFM3D_ROS2_PRAGMA_SIMD_REDUCTION(+ : s, d, c)
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const float a = static_cast<float>(amplitude[i]);
+    const float valid = (distance[i] > 0.0F ? 1.0F : 0.0F) * (a > 0.0F ? 1.0F : 0.0F);  // NaN compares false
+    s += valid * (a > 0.0F ? a : 0.0F);
+    d += valid * (distance[i] > 0.0F ? distance[i] : 0.0F);
+    c += valid;
+  }
+  sums[0] = s;
+  sums[1] = d;
+  sums[2] = c;
+}
+
+// The inputs of the box filters, zero at invalid pixels. The guide and the
+// distance are centered on their means (the guide's is 1), the linear models
+// do not change, but the variances and covariances of the windows no longer
+// cancel out most of the float precision.
+template <typename T>
+void weigh(const float* IFM3D_ROS2_RESTRICT distance, const T* IFM3D_ROS2_RESTRICT amplitude, float scale,
+           float offset, float* IFM3D_ROS2_RESTRICT guide, float* IFM3D_ROS2_RESTRICT w,
+           float* IFM3D_ROS2_RESTRICT wi, float* IFM3D_ROS2_RESTRICT wp, float* IFM3D_ROS2_RESTRICT wii,
+           float* IFM3D_ROS2_RESTRICT wip, std::size_t begin, std::size_t end)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const float valid = distance[i] > 0.0F ? 1.0F : 0.0F;
+    const float p = valid * ((distance[i] > 0.0F ? distance[i] : 0.0F) - offset);  // also maps NaN to 0
+    // clamped before scaling: selecting from a computed value keeps the loop
+    // from vectorizing
+    const float a = static_cast<float>(amplitude[i]);
+    const float g = (a > 0.0F ? a : 0.0F) * scale - 1.0F;
+    guide[i] = g;
+    w[i] = valid;
+    wi[i] = valid * g;
+    wp[i] = p;
+    wii[i] = valid * g * g;
+    wip[i] = g * p;
+  }
+}
+
+void add_row(float* IFM3D_ROS2_RESTRICT acc, const float* IFM3D_ROS2_RESTRICT row, std::size_t n)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    acc[i] += row[i];
+  }
+}
+
+void sub_row(float* IFM3D_ROS2_RESTRICT acc, const float* IFM3D_ROS2_RESTRICT row, std::size_t n)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    acc[i] -= row[i];
+  }
+}
+
+// Window sums of `in` for the rows [row_begin, row_end), windows clipped to
+// the image. The column sums slide down the rows (vectorized over the row),
+// the window sums along each row. Both only ever add and remove the values
+// of one window, so the float sums do not drift with the image size.
+void box_sums(const float* in, float* out, std::size_t width, std::size_t height, std::size_t radius,
+              std::size_t row_begin, std::size_t row_end, std::vector<float>& col)
+{
+  col.assign(width, 0.0F);
+  for (std::size_t y = row_begin > radius ? row_begin - radius : 0; y < std::min(height, row_begin + radius + 1); ++y)
+  {
+    add_row(col.data(), in + y * width, width);
+  }
+
+  const std::size_t first = std::min(radius, width - 1);
+  for (std::size_t y = row_begin; y < row_end; ++y)
+  {
+    if (y > row_begin)
+    {
+      if (y + radius < height)
+      {
+        add_row(col.data(), in + (y + radius) * width, width);
+      }
+      if (y >= radius + 1)
+      {
+        sub_row(col.data(), in + (y - radius - 1) * width, width);
+      }
+    }
+
+    float sum = 0.0F;
+    for (std::size_t x = 0; x <= first; ++x)
+    {
+      sum += col[x];
+    }
+    float* dst = out + y * width;
+    for (std::size_t x = 0; x < width; ++x)
+    {
+      dst[x] = sum;
+      if (x + radius + 1 < width)
+      {
+        sum += col[x + radius + 1];
+      }
+      if (x >= radius)
+      {
+        sum -= col[x - radius];
+      }
+    }
+  }
+}
+
+// Coefficients of the linear model of every window, from its sums: `a`
+// replaces the sum of the guide, `b` that of the distance, both weighted to
+// be averaged over the windows again.
+void coefficients(const float* IFM3D_ROS2_RESTRICT w, const float* IFM3D_ROS2_RESTRICT n,
+                  float* IFM3D_ROS2_RESTRICT si, float* IFM3D_ROS2_RESTRICT sp, const float* IFM3D_ROS2_RESTRICT sii,
+                  const float* IFM3D_ROS2_RESTRICT sip, float eps, std::size_t begin, std::size_t end)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const float inv = 1.0F / (n[i] + (n[i] > 0.5F ? 0.0F : 1.0F));  // blended, no valid pixel in the window
+    const float mi = si[i] * inv;
+    const float mp = sp[i] * inv;
+    const float var = sii[i] * inv - mi * mi;
+    const float cov = sip[i] * inv - mi * mp;
+    const float a = cov / (var + eps);
+    const float b = mp - a * mi;
+    si[i] = w[i] * a;
+    sp[i] = w[i] * b;
+  }
+}
+
+// the mean of the models of the windows covering a pixel, at the valid pixels
+void apply(const float* IFM3D_ROS2_RESTRICT distance, const float* IFM3D_ROS2_RESTRICT guide,
+           const float* IFM3D_ROS2_RESTRICT w, const float* IFM3D_ROS2_RESTRICT n, const float* IFM3D_ROS2_RESTRICT sa,
+           const float* IFM3D_ROS2_RESTRICT sb, float offset, float* IFM3D_ROS2_RESTRICT out, std::size_t begin,
+           std::size_t end)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    // a valid pixel is in its own window, so `n >= 1`
+    const float inv = 1.0F / (n[i] + (n[i] > 0.5F ? 0.0F : 1.0F));
+    const float q = (sa[i] * guide[i] + sb[i]) * inv + offset;
+    out[i] = distance[i] + w[i] * (q - distance[i]);  // keeps invalid pixels (NaN included)
+  }
+}
+
+}  // namespace
+
+void GuidedFilter::configure(const Params& params)
+{
+  this->params_ = params;
+}
+
+void GuidedFilter::operator()(const float* distance, const float* amplitude, std::uint32_t width,
+                              std::uint32_t height, float* out, WorkerPool& pool)
+{
+  this->filter(distance, amplitude, width, height, out, pool);
+}
+
+void GuidedFilter::operator()(const float* distance, const std::uint16_t* amplitude, std::uint32_t width,
+                              std::uint32_t height, float* out, WorkerPool& pool)
+{
+  this->filter(distance, amplitude, width, height, out, pool);
+}
+
+template <typename T>
+void GuidedFilter::filter(const float* distance, const T* amplitude, std::uint32_t width, std::uint32_t height,
+                          float* out, WorkerPool& pool)
+{
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  if (n == 0)
+  {
+    return;
+  }
+  for (auto* plane : { &this->guide_, &this->w_, &this->wi_, &this->wp_, &this->wii_, &this->wip_, &this->n_,
+                       &this->si_, &this->sp_, &this->sii_, &this->sip_ })
+  {
+    plane->resize(n);
+  }
+
+  std::vector<float> sums(pool.concurrency() * 3, 0.0F);
+  const std::size_t chunks = pool.parallel_chunks(n, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+    guide_sum(distance, amplitude, begin, end, sums.data() + chunk * 3);
+  });
+  float sum = 0.0F;
+  float distance_sum = 0.0F;
+  float count = 0.0F;
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+  {
+    sum += sums[chunk * 3];
+    distance_sum += sums[chunk * 3 + 1];
+    count += sums[chunk * 3 + 2];
+  }
+  const float scale = sum > 0.0F ? count / sum : 0.0F;
+  const float offset = count > 0.0F ? distance_sum / count : 0.0F;
+
+  pool.parallel_for(n, [&](std::size_t begin, std::size_t end) {
+    weigh(distance, amplitude, scale, offset, this->guide_.data(), this->w_.data(), this->wi_.data(),
+          this->wp_.data(), this->wii_.data(), this->wip_.data(), begin, end);
+  });
+
+  // each pass reads the rows around its tile, so the passes are separated by
+  // the end of the `parallel_for()`
+  const std::size_t radius = this->params_.radius;
+  const float eps = this->params_.eps;
+  pool.parallel_for(height, [&](std::size_t row_begin, std::size_t row_end) {
+    std::vector<float> col;
+    box_sums(this->w_.data(), this->n_.data(), width, height, radius, row_begin, row_end, col);
+    box_sums(this->wi_.data(), this->si_.data(), width, height, radius, row_begin, row_end, col);
+    box_sums(this->wp_.data(), this->sp_.data(), width, height, radius, row_begin, row_end, col);
+    box_sums(this->wii_.data(), this->sii_.data(), width, height, radius, row_begin, row_end, col);
+    box_sums(this->wip_.data(), this->sip_.data(), width, height, radius, row_begin, row_end, col);
+    coefficients(this->w_.data(), this->n_.data(), this->si_.data(), this->sp_.data(), this->sii_.data(),
+                 this->sip_.data(), eps, row_begin * width, row_end * width);
+  });
+
+  pool.parallel_for(height, [&](std::size_t row_begin, std::size_t row_end) {
+    std::vector<float> col;
+    box_sums(this->si_.data(), this->sii_.data(), width, height, radius, row_begin, row_end, col);
+    box_sums(this->sp_.data(), this->sip_.data(), width, height, radius, row_begin, row_end, col);
+    apply(distance, this->guide_.data(), this->w_.data(), this->n_.data(), this->sii_.data(), this->sip_.data(),
+          offset, out, row_begin * width, row_end * width);
+  });
+}
+
+void rescale_points(float* IFM3D_ROS2_RESTRICT xyz, const float* IFM3D_ROS2_RESTRICT distance,
+                    const float* IFM3D_ROS2_RESTRICT filtered, std::size_t n)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const float valid = distance[i] > 0.0F ? 1.0F : 0.0F;  // NaN compares false
+    const float d = distance[i] > 0.0F ? distance[i] : 1.0F;
+    const float f = filtered[i] > 0.0F ? filtered[i] : 0.0F;
+    const float scale = 1.0F + valid * (f / d - 1.0F);
+    xyz[i * 3 + 0] *= scale;
+    xyz[i * 3 + 1] *= scale;
+    xyz[i * 3 + 2] *= scale;
+  }
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,202 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/height_grid.hpp>
+
+#include <algorithm>
+
+#include <ifm3d_ros2/shared_registry.hpp>
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+// combines the cells of `src` into `dst`
+void merge_cells(const GridCell* IFM3D_ROS2_RESTRICT src, GridCell* IFM3D_ROS2_RESTRICT dst, std::size_t begin,
+                 std::size_t end)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t c = begin; c < end; ++c)
+  {
+    const float h = src[c].max_height;
+    dst[c].max_height = h > dst[c].max_height ? h : dst[c].max_height;
+    dst[c].obstacles += src[c].obstacles;
+    dst[c].ground += src[c].ground;
+  }
+}
+
+}  // namespace
+
+void HeightGrid::configure(const GridParams& params)
+{
+  this->params_ = params;
+  this->cells_.assign(static_cast<std::size_t>(params.width) * params.height, GridCell::empty());
+  this->partials_.clear();
+}
+
+void HeightGrid::bin(const float* xyz, std::size_t n, WorkerPool& pool)
+{
+  const std::size_t num_cells = this->cells_.size();
+  this->partials_.resize(pool.concurrency());
+  this->cell_x_.resize(n);
+  this->cell_y_.resize(n);
+
+  const std::size_t chunks = pool.parallel_chunks(n, [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+    const float* IFM3D_ROS2_RESTRICT p = xyz;
+    std::int32_t* IFM3D_ROS2_RESTRICT cell_x = this->cell_x_.data();
+    std::int32_t* IFM3D_ROS2_RESTRICT cell_y = this->cell_y_.data();
+    const float inv_resolution = 1.0F / this->params_.resolution;
+    const float ox = this->params_.origin_x;
+    const float oy = this->params_.origin_y;
+    const float max_z = this->params_.max_z;
+    const auto width = static_cast<float>(this->params_.width);
+    const auto height = static_cast<float>(this->params_.height);
+
+    // cell coordinates, -1 for points off the grid (or invalid). The cell
+    // index is only combined in the scatter below: doing it here makes GCC
+    // branch around the conversions, which keeps the loop from vectorizing.
+    IFM3D_ROS2_PRAGMA_SIMD
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const float x = p[i * 3 + 0];
+      const float y = p[i * 3 + 1];
+      const float z = p[i * 3 + 2];
+      const float fx = (x - ox) * inv_resolution;
+      const float fy = (y - oy) * inv_resolution;
+      const int inside = (x * x + y * y + z * z > 0.0F) & (fx >= 0.0F) & (fx < width) & (fy >= 0.0F) &
+                         (fy < height) & (z < max_z);  // NaN compares false
+      const float cx = inside ? fx : -1.0F;
+      const float cy = inside ? fy : -1.0F;
+      cell_x[i] = static_cast<std::int32_t>(cx);
+      cell_y[i] = static_cast<std::int32_t>(cy);
+    }
+
+    // scatter into a partial grid of this chunk
+    auto& partial = this->partials_[chunk];
+    partial.assign(num_cells, GridCell::empty());
+    GridCell* cells = partial.data();
+    const float min_z = this->params_.min_z;
+    const std::size_t row = this->params_.width;
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      if (cell_x[i] < 0)
+      {
+        continue;
+      }
+
+      GridCell& cell = cells[static_cast<std::size_t>(cell_y[i]) * row + static_cast<std::size_t>(cell_x[i])];
+      const float z = p[i * 3 + 2];
+      if (z >= min_z)
+      {
+        cell.max_height = z > cell.max_height ? z : cell.max_height;
+        ++cell.obstacles;
+      }
+      else
+      {
+        ++cell.ground;
+      }
+    }
+  });
+
+  if (chunks == 0)
+  {
+    std::fill(this->cells_.begin(), this->cells_.end(), GridCell::empty());
+    return;
+  }
+
+  // merge the partial grids, split by cells
+  pool.parallel_for(num_cells, [&](std::size_t begin, std::size_t end) {
+    std::copy(this->partials_[0].begin() + begin, this->partials_[0].begin() + end, this->cells_.begin() + begin);
+    for (std::size_t k = 1; k < chunks; ++k)
+    {
+      merge_cells(this->partials_[k].data(), this->cells_.data(), begin, end);
+    }
+  });
+}
+
+void HeightGrid::to_occupancy(const std::vector<GridCell>& cells, std::uint32_t min_points,
+                              std::vector<std::int8_t>& out)
+{
+  out.resize(cells.size());
+  const GridCell* IFM3D_ROS2_RESTRICT src = cells.data();
+  std::int8_t* IFM3D_ROS2_RESTRICT dst = out.data();
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t c = 0; c < cells.size(); ++c)
+  {
+    const std::int8_t seen = src[c].ground > 0 ? 0 : -1;
+    dst[c] = src[c].obstacles >= min_points ? 100 : seen;
+  }
+}
+
+std::shared_ptr<SharedGrid> SharedGrid::acquire(const std::string& name, const GridParams& params)
+{
+  if (name.empty())
+  {
+    return std::make_shared<SharedGrid>(params);
+  }
+
+  return acquire_shared<SharedGrid>(name, [&] { return std::make_shared<SharedGrid>(params); });
+}
+
+std::size_t SharedGrid::join()
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  const std::size_t id = this->next_id_++;
+  this->contributions_[id].assign(static_cast<std::size_t>(this->params_.width) * this->params_.height,
+                                  GridCell::empty());
+  return id;
+}
+
+void SharedGrid::leave(std::size_t id)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->contributions_.erase(id);
+}
+
+void SharedGrid::update(std::size_t id, const HeightGrid& grid)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  auto it = this->contributions_.find(id);
+  if (it != this->contributions_.end() && grid.cells().size() == it->second.size())
+  {
+    std::copy(grid.cells().begin(), grid.cells().end(), it->second.begin());
+  }
+}
+
+void SharedGrid::clear(std::size_t id)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  auto it = this->contributions_.find(id);
+  if (it != this->contributions_.end())
+  {
+    std::fill(it->second.begin(), it->second.end(), GridCell::empty());
+  }
+}
+
+bool SharedGrid::claim_publication(std::chrono::steady_clock::time_point now,
+                                   std::chrono::steady_clock::duration period)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  if (now - this->last_publication_ < period)
+  {
+    return false;
+  }
+  this->last_publication_ = now;
+  return true;
+}
+
+void SharedGrid::merge(std::vector<GridCell>& out) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  out.assign(static_cast<std::size_t>(this->params_.width) * this->params_.height, GridCell::empty());
+  for (const auto& contribution : this->contributions_)
+  {
+    merge_cells(contribution.second.data(), out.data(), 0, out.size());
+  }
+}
+
+}  // namespace ifm3d_ros2
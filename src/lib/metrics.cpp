@@ -0,0 +1,433 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/metrics.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+// frame path stages: 100us .. 1s
+const std::vector<double> frame_path_buckets{ 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+                                              0.01,   0.025,   0.05,   0.1,   0.25,   1.0 };
+
+// service round trips (XMLRPC to the VPU): 1ms .. 10s
+const std::vector<double> service_buckets{ 0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 };
+
+constexpr int poll_interval_millis = 200;
+constexpr int client_timeout_secs = 1;
+constexpr std::size_t max_request_size = 8192;
+
+std::string escape_label(const std::string& value)
+{
+  std::string out;
+  out.reserve(value.size());
+  for (const char c : value)
+  {
+    switch (c)
+    {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+        break;
+    }
+  }
+  return out;
+}
+
+std::string format_bound(double bound)
+{
+  std::ostringstream os;
+  os << bound;
+  return os.str();
+}
+
+struct CounterFamily
+{
+  const char* name;
+  const char* help;
+  const Counter HeadMetrics::*member;
+};
+
+struct GaugeFamily
+{
+  const char* name;
+  const char* help;
+  const Gauge HeadMetrics::*member;
+};
+
+struct HistogramFamily
+{
+  const char* name;
+  const char* help;
+  const Histogram HeadMetrics::*member;
+};
+
+const CounterFamily counter_families[] = {
+  { "ifm3d_ros2_frames_received", "Frames delivered by the framegrabber.", &HeadMetrics::frames_in },
+  { "ifm3d_ros2_frames_published", "Frames converted and published.", &HeadMetrics::frames_out },
+  { "ifm3d_ros2_frames_dropped", "Frames received but not published.", &HeadMetrics::frames_dropped },
+  { "ifm3d_ros2_frame_timeouts", "Waits for a frame that timed out.", &HeadMetrics::timeouts },
+  { "ifm3d_ros2_reconnects", "Re-initializations of the connection to the camera.", &HeadMetrics::reconnects },
+  { "ifm3d_ros2_frames_unchanged", "Frames not published because the scene did not change.",
+    &HeadMetrics::frames_unchanged },
+  { "ifm3d_ros2_frames_skipped", "Frames skipped by the frame rate governor.", &HeadMetrics::frames_skipped },
+  { "ifm3d_ros2_transitions_coalesced", "Lifecycle transition requests merged into a queued one.",
+    &HeadMetrics::transitions_coalesced },
+  { "ifm3d_ros2_transitions_failed", "Lifecycle transitions requested by the node that failed.",
+    &HeadMetrics::transitions_failed },
+  { "ifm3d_ros2_conversion_cpu_nanoseconds", "CPU time of the publish loop spent converting buffers.",
+    &HeadMetrics::conversion_cpu_nanos },
+  { "ifm3d_ros2_publish_cpu_nanoseconds", "CPU time of the publish loop spent in publish().",
+    &HeadMetrics::publish_cpu_nanos },
+};
+
+const GaugeFamily gauge_families[] = {
+  { "ifm3d_ros2_queue_depth", "Frames held by the publish loop and not yet published.", &HeadMetrics::queue_depth },
+};
+
+const HistogramFamily histogram_families[] = {
+  { "ifm3d_ros2_conversion_seconds", "Time to convert a buffer into a ROS message.",
+    &HeadMetrics::conversion_seconds },
+  { "ifm3d_ros2_publish_seconds", "Time spent in publish().", &HeadMetrics::publish_seconds },
+  { "ifm3d_ros2_stage_seconds", "Time to convert and publish a message of a processing stage.",
+    &HeadMetrics::stage_seconds },
+  { "ifm3d_ros2_dump_seconds", "Latency of the Dump service.", &HeadMetrics::dump_seconds },
+  { "ifm3d_ros2_config_seconds", "Latency of the Config service.", &HeadMetrics::config_seconds },
+  { "ifm3d_ros2_power_state_seconds", "Latency of the configuration updates of the PowerState service.",
+    &HeadMetrics::power_state_seconds },
+  { "ifm3d_ros2_transition_seconds", "Time from a lifecycle transition requested by the node to its end.",
+    &HeadMetrics::transition_seconds },
+};
+
+bool send_all(int fd, const std::string& data)
+{
+  std::size_t sent = 0;
+  while (sent < data.size())
+  {
+    const auto n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+    {
+      return false;
+    }
+    sent += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool is_scrape_request(const std::string& request)
+{
+  if (request.rfind("GET ", 0) != 0)
+  {
+    return false;
+  }
+  const auto target_end = request.find_first_of(" \r\n", 4);
+  if (target_end == std::string::npos)
+  {
+    return false;
+  }
+  const auto target = request.substr(4, target_end - 4);
+  const auto path = target.substr(0, target.find('?'));
+  return path == "/metrics" || path == "/";
+}
+
+Histogram::Histogram(std::vector<double> bounds)
+  : bounds_(std::move(bounds)), buckets_(new std::atomic<std::uint64_t>[bounds_.size() + 1])
+{
+  for (std::size_t i = 0; i <= this->bounds_.size(); ++i)
+  {
+    this->buckets_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::observe(double seconds)
+{
+  const auto idx = static_cast<std::size_t>(
+      std::distance(this->bounds_.begin(), std::lower_bound(this->bounds_.begin(), this->bounds_.end(), seconds)));
+  this->buckets_[idx].fetch_add(1, std::memory_order_relaxed);
+  this->count_.fetch_add(1, std::memory_order_relaxed);
+
+  auto sum = this->sum_.load(std::memory_order_relaxed);
+  while (!this->sum_.compare_exchange_weak(sum, sum + seconds, std::memory_order_relaxed))
+  {
+  }
+}
+
+std::vector<std::uint64_t> Histogram::cumulative_counts() const
+{
+  std::vector<std::uint64_t> counts(this->bounds_.size() + 1);
+  std::uint64_t acc = 0;
+  for (std::size_t i = 0; i < counts.size(); ++i)
+  {
+    acc += this->buckets_[i].load(std::memory_order_relaxed);
+    counts[i] = acc;
+  }
+  return counts;
+}
+
+LabeledCounters::LabeledCounters(std::vector<std::string> values)
+  : values_(std::move(values)), counters_(new Counter[this->values_.size()])
+{
+}
+
+HeadMetrics::HeadMetrics(std::string head_name, std::vector<std::string> topic_names)
+  : head(std::move(head_name))
+  , topics_skipped(std::move(topic_names))
+  , conversion_seconds(frame_path_buckets)
+  , publish_seconds(frame_path_buckets)
+  , stage_seconds(frame_path_buckets)
+  , dump_seconds(service_buckets)
+  , config_seconds(service_buckets)
+  , power_state_seconds(service_buckets)
+  , transition_seconds(service_buckets)
+{
+}
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+  static MetricsRegistry registry;
+  return registry;
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+  this->server_running_ = false;
+  if (this->server_thread_.joinable())
+  {
+    this->server_thread_.join();
+  }
+  if (this->listen_fd_ >= 0)
+  {
+    ::close(this->listen_fd_);
+  }
+}
+
+std::shared_ptr<HeadMetrics> MetricsRegistry::register_head(const std::string& head,
+                                                          std::vector<std::string> topic_names)
+{
+  auto metrics = std::make_shared<HeadMetrics>(head, std::move(topic_names));
+
+  std::lock_guard<std::mutex> lock(this->heads_mutex_);
+  this->heads_.erase(std::remove_if(this->heads_.begin(), this->heads_.end(),
+                                    [](const std::weak_ptr<HeadMetrics>& h) { return h.expired(); }),
+                     this->heads_.end());
+  this->heads_.push_back(metrics);
+  return metrics;
+}
+
+std::string MetricsRegistry::start_server(const std::string& address, std::uint16_t port)
+{
+  std::lock_guard<std::mutex> lock(this->server_mutex_);
+
+  if (this->server_running_)
+  {
+    if (address == this->server_address_ && port == this->server_port_)
+    {
+      return "";
+    }
+    return "metrics endpoint already running on " + this->server_address_ + ":" +
+           std::to_string(this->server_port_);
+  }
+
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+
+  addrinfo* res = nullptr;
+  const auto port_str = std::to_string(port);
+  if (const int rc = ::getaddrinfo(address.c_str(), port_str.c_str(), &hints, &res); rc != 0)
+  {
+    return "cannot resolve '" + address + "': " + ::gai_strerror(rc);
+  }
+
+  const int fd = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd < 0)
+  {
+    ::freeaddrinfo(res);
+    return std::string("socket(): ") + std::strerror(errno);
+  }
+
+  const int one = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  if (::bind(fd, res->ai_addr, res->ai_addrlen) != 0 || ::listen(fd, 8) != 0)
+  {
+    const std::string err = std::strerror(errno);
+    ::freeaddrinfo(res);
+    ::close(fd);
+    return "cannot listen on " + address + ":" + port_str + ": " + err;
+  }
+  ::freeaddrinfo(res);
+
+  this->listen_fd_ = fd;
+  this->server_address_ = address;
+  this->server_port_ = port;
+  this->server_running_ = true;
+  this->server_thread_ = std::thread(&MetricsRegistry::serve, this);
+  return "";
+}
+
+std::string MetricsRegistry::render()
+{
+  std::vector<std::shared_ptr<HeadMetrics>> heads;
+  {
+    std::lock_guard<std::mutex> lock(this->heads_mutex_);
+    for (const auto& h : this->heads_)
+    {
+      if (auto head = h.lock())
+      {
+        heads.push_back(std::move(head));
+      }
+    }
+  }
+
+  std::ostringstream os;
+  os << std::setprecision(9);
+
+  for (const auto& family : counter_families)
+  {
+    os << "# TYPE " << family.name << " counter\n# HELP " << family.name << " " << family.help << "\n";
+    for (const auto& head : heads)
+    {
+      os << family.name << "_total{head=\"" << escape_label(head->head) << "\"} " << ((*head).*family.member).value()
+         << "\n";
+    }
+  }
+
+  // labelled by topic as well
+  {
+    const char* name = "ifm3d_ros2_topics_skipped";
+    os << "# TYPE " << name << " counter\n# HELP " << name
+       << " Topics of a frame skipped because they would have missed their deadline.\n";
+    for (const auto& head : heads)
+    {
+      const auto& topics = head->topics_skipped;
+      for (std::size_t topic = 0; topic < topics.size(); ++topic)
+      {
+        os << name << "_total{head=\"" << escape_label(head->head) << "\",topic=\""
+           << escape_label(topics.values()[topic]) << "\"} " << topics[topic].value() << "\n";
+      }
+    }
+  }
+
+  for (const auto& family : gauge_families)
+  {
+    os << "# TYPE " << family.name << " gauge\n# HELP " << family.name << " " << family.help << "\n";
+    for (const auto& head : heads)
+    {
+      os << family.name << "{head=\"" << escape_label(head->head) << "\"} " << ((*head).*family.member).value()
+         << "\n";
+    }
+  }
+
+  for (const auto& family : histogram_families)
+  {
+    os << "# TYPE " << family.name << " histogram\n# HELP " << family.name << " " << family.help << "\n";
+    for (const auto& head : heads)
+    {
+      const auto& hist = (*head).*family.member;
+      const auto label = escape_label(head->head);
+      const auto counts = hist.cumulative_counts();
+      for (std::size_t i = 0; i < hist.bounds().size(); ++i)
+      {
+        os << family.name << "_bucket{head=\"" << label << "\",le=\"" << format_bound(hist.bounds()[i]) << "\"} "
+           << counts[i] << "\n";
+      }
+      // `count` is read separately from the buckets, so use the `+Inf`
+      // bucket to keep the exposition self-consistent.
+      os << family.name << "_bucket{head=\"" << label << "\",le=\"+Inf\"} " << counts.back() << "\n";
+      os << family.name << "_sum{head=\"" << label << "\"} " << hist.sum() << "\n";
+      os << family.name << "_count{head=\"" << label << "\"} " << counts.back() << "\n";
+    }
+  }
+
+  os << "# EOF\n";
+  return os.str();
+}
+
+//
+// Deliberately minimal HTTP/1.0 server: one request per connection, served
+// sequentially on a single thread. Scrapes are rare (seconds apart) and
+// cheap, so there is no need for anything fancier.
+//
+void MetricsRegistry::serve()
+{
+  while (this->server_running_)
+  {
+    pollfd pfd{ this->listen_fd_, POLLIN, 0 };
+    if (::poll(&pfd, 1, poll_interval_millis) <= 0 || !(pfd.revents & POLLIN))
+    {
+      continue;
+    }
+
+    const int client = ::accept(this->listen_fd_, nullptr, nullptr);
+    if (client < 0)
+    {
+      continue;
+    }
+
+    timeval tv{ client_timeout_secs, 0 };
+    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < max_request_size)
+    {
+      const auto n = ::recv(client, buf, sizeof(buf), 0);
+      if (n <= 0)
+      {
+        break;
+      }
+      request.append(buf, static_cast<std::size_t>(n));
+    }
+
+    std::string status = "404 Not Found";
+    std::string content_type = "text/plain; charset=utf-8";
+    std::string body = "Not Found\n";
+
+    if (is_scrape_request(request))
+    {
+      status = "200 OK";
+      content_type = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+      body = this->render();
+    }
+
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: " << content_type << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    send_all(client, response.str());
+    ::close(client);
+  }
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,205 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/motion_compensation.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+using Matrix3 = std::array<double, 9>;
+
+Matrix3 multiply(const Matrix3& a, const Matrix3& b)
+{
+  Matrix3 c{};
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    for (std::size_t j = 0; j < 3; ++j)
+    {
+      c[i * 3 + j] = a[i * 3 + 0] * b[0 * 3 + j] + a[i * 3 + 1] * b[1 * 3 + j] + a[i * 3 + 2] * b[2 * 3 + j];
+    }
+  }
+  return c;
+}
+
+// rotation by the angle-axis vector `w` (Rodrigues)
+Matrix3 rotation(const std::array<double, 3>& w)
+{
+  const double theta = std::sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+  // sin(theta) / theta and (1 - cos(theta)) / theta^2, by their series close to 0
+  const double a = theta < 1e-6 ? 1.0 - theta * theta / 6.0 : std::sin(theta) / theta;
+  const double b = theta < 1e-6 ? 0.5 - theta * theta / 24.0 : (1.0 - std::cos(theta)) / (theta * theta);
+  return { { 1.0 - b * (w[1] * w[1] + w[2] * w[2]), b * w[0] * w[1] - a * w[2], b * w[0] * w[2] + a * w[1],  //
+             b * w[0] * w[1] + a * w[2], 1.0 - b * (w[0] * w[0] + w[2] * w[2]), b * w[1] * w[2] - a * w[0],  //
+             b * w[0] * w[2] - a * w[1], b * w[1] * w[2] + a * w[0], 1.0 - b * (w[0] * w[0] + w[1] * w[1]) } };
+}
+
+// twist at `t`, linear between the samples and held beyond them
+std::array<double, 6> twist_at(const std::vector<TwistSample>& samples, std::int64_t t)
+{
+  const auto next = std::upper_bound(samples.begin(), samples.end(), t,
+                                     [](std::int64_t stamp, const TwistSample& s) { return stamp < s.stamp_nanos; });
+  const auto& a = next == samples.begin() ? *next : *(next - 1);
+  const auto& b = next == samples.end() ? a : *next;
+  const double span = static_cast<double>(b.stamp_nanos - a.stamp_nanos);
+  const double f = span > 0.0 ? static_cast<double>(t - a.stamp_nanos) / span : 0.0;
+
+  std::array<double, 6> twist{};
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    twist[i] = a.linear[i] + f * (b.linear[i] - a.linear[i]);
+    twist[3 + i] = a.angular[i] + f * (b.angular[i] - a.angular[i]);
+  }
+  return twist;
+}
+
+}  // namespace
+
+void TwistRing::push(const TwistSample& sample)
+{
+  const auto index = this->pushed_.load(std::memory_order_relaxed);
+  auto& slot = this->slots_[index % capacity];
+
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.stamp_nanos.store(sample.stamp_nanos, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    slot.twist[i].store(sample.linear[i], std::memory_order_relaxed);
+    slot.twist[3 + i].store(sample.angular[i], std::memory_order_relaxed);
+  }
+  slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+  this->pushed_.store(index + 1, std::memory_order_release);
+}
+
+bool TwistRing::snapshot(std::int64_t since_nanos, std::vector<TwistSample>& out) const
+{
+  out.clear();
+  const auto pushed = this->pushed_.load(std::memory_order_acquire);
+  const auto oldest =
+      std::max(pushed > capacity ? pushed - capacity : 0, this->cleared_.load(std::memory_order_acquire));
+
+  // newest first, until the first sample at or before `since_nanos`
+  for (auto index = pushed; index > oldest; --index)
+  {
+    const auto& slot = this->slots_[(index - 1) % capacity];
+    const auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * (index - 1) + 2)
+    {
+      break;  // overwritten by now
+    }
+
+    TwistSample sample;
+    sample.stamp_nanos = slot.stamp_nanos.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      sample.linear[i] = slot.twist[i].load(std::memory_order_relaxed);
+      sample.angular[i] = slot.twist[3 + i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+    {
+      break;  // overwritten while copying
+    }
+
+    out.push_back(sample);
+    if (sample.stamp_nanos <= since_nanos)
+    {
+      break;
+    }
+  }
+
+  std::reverse(out.begin(), out.end());
+  return !out.empty();
+}
+
+void TwistRing::clear()
+{
+  this->cleared_.store(this->pushed_.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+bool integrate_motion(const std::vector<TwistSample>& samples, std::int64_t from_nanos, std::int64_t to_nanos,
+                      std::int64_t max_hold_nanos, PointTransform& motion)
+{
+  const auto begin = std::min(from_nanos, to_nanos);
+  const auto end = std::max(from_nanos, to_nanos);
+  if (samples.empty() || samples.front().stamp_nanos > begin || end - samples.back().stamp_nanos > max_hold_nanos)
+  {
+    return false;
+  }
+
+  // steps between `begin`, the samples in between and `end`, each with the
+  // twist at its middle
+  Matrix3 r{ { 1, 0, 0, 0, 1, 0, 0, 0, 1 } };
+  std::array<double, 3> t{};
+  auto step_begin = begin;
+  auto next = std::upper_bound(samples.begin(), samples.end(), begin,
+                               [](std::int64_t stamp, const TwistSample& s) { return stamp < s.stamp_nanos; });
+  while (step_begin < end)
+  {
+    const auto step_end = next != samples.end() && next->stamp_nanos < end ? (next++)->stamp_nanos : end;
+    const double dt = static_cast<double>(step_end - step_begin) * 1e-9;
+    const auto twist = twist_at(samples, step_begin + (step_end - step_begin) / 2);
+
+    // the translation over the step, along the arc (midpoint rule)
+    const auto half = multiply(r, rotation({ { twist[3] * dt / 2, twist[4] * dt / 2, twist[5] * dt / 2 } }));
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+      t[i] += (half[i * 3 + 0] * twist[0] + half[i * 3 + 1] * twist[1] + half[i * 3 + 2] * twist[2]) * dt;
+    }
+    r = multiply(r, rotation({ { twist[3] * dt, twist[4] * dt, twist[5] * dt } }));
+    step_begin = step_end;
+  }
+
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    for (std::size_t j = 0; j < 3; ++j)
+    {
+      motion[i * 4 + j] = static_cast<float>(r[i * 3 + j]);
+    }
+    motion[i * 4 + 3] = static_cast<float>(t[i]);
+  }
+  if (to_nanos < from_nanos)
+  {
+    motion = invert_transform(motion);
+  }
+  return true;
+}
+
+PointTransform compose_transforms(const PointTransform& a, const PointTransform& b)
+{
+  PointTransform c{};
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    for (std::size_t j = 0; j < 4; ++j)
+    {
+      c[i * 4 + j] = a[i * 4 + 0] * b[0 * 4 + j] + a[i * 4 + 1] * b[1 * 4 + j] + a[i * 4 + 2] * b[2 * 4 + j];
+    }
+    c[i * 4 + 3] += a[i * 4 + 3];
+  }
+  return c;
+}
+
+PointTransform invert_transform(const PointTransform& transform)
+{
+  // [R^T | -R^T * t]
+  const auto& m = transform;
+  PointTransform inverse{};
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    for (std::size_t j = 0; j < 3; ++j)
+    {
+      inverse[i * 4 + j] = m[j * 4 + i];
+    }
+    inverse[i * 4 + 3] = -(m[0 * 4 + i] * m[3] + m[1 * 4 + i] * m[7] + m[2 * 4 + i] * m[11]);
+  }
+  return inverse;
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,114 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/pixel_stats.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+void welford(const float* IFM3D_ROS2_RESTRICT x, float* IFM3D_ROS2_RESTRICT count, float* IFM3D_ROS2_RESTRICT mean,
+             float* IFM3D_ROS2_RESTRICT m2, std::size_t n)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    // invalid samples are blended out rather than skipped
+    const float valid = x[i] > 0.0F ? 1.0F : 0.0F;  // NaN compares false
+    const float xv = x[i] > 0.0F ? x[i] : 0.0F;
+    const float c = count[i] + valid;
+    const float inv = 1.0F / (c + (c > 0.5F ? 0.0F : 1.0F));
+    const float delta = xv - mean[i];
+    const float updated = mean[i] + valid * delta * inv;
+    m2[i] += valid * delta * (xv - updated);
+    mean[i] = updated;
+    count[i] = c;
+  }
+}
+
+}  // namespace
+
+void PixelStats::start(std::uint32_t frames)
+{
+  this->requested_ = frames;
+  this->added_ = 0;
+}
+
+bool PixelStats::add(const float* distance, std::uint32_t width, std::uint32_t height)
+{
+  if (!this->active())
+  {
+    return false;
+  }
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  if (this->added_ == 0 || width != this->width_ || height != this->height_)
+  {
+    this->added_ = 0;
+    this->width_ = width;
+    this->height_ = height;
+    this->count_.assign(n, 0.0F);
+    this->mean_.assign(n, 0.0F);
+    this->m2_.assign(n, 0.0F);
+  }
+
+  welford(distance, this->count_.data(), this->mean_.data(), this->m2_.data(), n);
+  ++this->added_;
+  return !this->active();
+}
+
+void PixelStats::mean(float* IFM3D_ROS2_RESTRICT out) const
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float* IFM3D_ROS2_RESTRICT count = this->count_.data();
+  const float* IFM3D_ROS2_RESTRICT mean = this->mean_.data();
+  const std::size_t n = this->count_.size();
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    // loaded unconditionally, a load under the select keeps the loop scalar
+    const float m = mean[i];
+    out[i] = count[i] > 0.5F ? m : nan;
+  }
+}
+
+void PixelStats::stddev(float* IFM3D_ROS2_RESTRICT out) const
+{
+  const float* IFM3D_ROS2_RESTRICT count = this->count_.data();
+  const float* IFM3D_ROS2_RESTRICT m2 = this->m2_.data();
+  const std::size_t n = this->count_.size();
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    // pixels without samples have `m2 == 0`, so they take the root of -1,
+    // i.e., NaN: selecting NaN after the root keeps the loop scalar
+    const float m = m2[i] > 0.0F ? m2[i] : 0.0F;
+    const float empty = count[i] > 0.5F ? 0.0F : 1.0F;
+    out[i] = std::sqrt(m / (count[i] + empty) - empty);
+  }
+}
+
+void PixelStats::valid_ratio(float* IFM3D_ROS2_RESTRICT out) const
+{
+  const float scale = this->added_ > 0 ? 1.0F / static_cast<float>(this->added_) : 0.0F;
+  const float* IFM3D_ROS2_RESTRICT count = this->count_.data();
+  const std::size_t n = this->count_.size();
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    out[i] = count[i] * scale;
+  }
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,42 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/port_standby.hpp>
+
+#include <ifm3d_ros2/shared_registry.hpp>
+
+namespace ifm3d_ros2
+{
+std::shared_ptr<PortStandby> PortStandby::acquire(const std::string& ip, std::uint16_t port)
+{
+  return acquire_shared<PortStandby>(ip + ":" + std::to_string(port), [] { return std::make_shared<PortStandby>(); });
+}
+
+std::size_t PortStandby::listen(Listener listener)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  const std::size_t id = this->next_id_++;
+  this->listeners_[id] = std::move(listener);
+  return id;
+}
+
+void PortStandby::unlisten(std::size_t id)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  this->listeners_.erase(id);
+}
+
+std::size_t PortStandby::set(bool standby)
+{
+  // under the lock, so that a listener is never called after `unlisten()`
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  for (const auto& listener : this->listeners_)
+  {
+    listener.second(standby);
+  }
+  return this->listeners_.size();
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,338 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/preview.hpp>
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+
+#include <jpeglib.h>
+
+#include <rclcpp/logging.hpp>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+// initial size of the JPEG output, grown as needed
+constexpr std::size_t jpeg_chunk_size = 16384;
+
+/**
+ * Polynomial approximation of the Turbo colormap (Mikhailov, Google 2019),
+ * `x` in [0, 1].
+ */
+void turbo(float x, std::uint8_t* rgb)
+{
+  const float r =
+      0.13572138F + x * (4.61539260F + x * (-42.66032258F + x * (132.13108234F + x * (-152.94239396F + x * 59.28637943F))));
+  const float g =
+      0.09140261F + x * (2.19418839F + x * (4.84296658F + x * (-14.18503333F + x * (4.27729857F + x * 2.82956604F))));
+  const float b =
+      0.10667330F + x * (12.64194608F + x * (-60.58204836F + x * (110.36276771F + x * (-89.90310912F + x * 27.34824973F))));
+
+  const auto to_u8 = [](float c) {
+    return static_cast<std::uint8_t>(std::clamp(c, 0.0F, 1.0F) * 255.0F + 0.5F);
+  };
+  rgb[0] = to_u8(r);
+  rgb[1] = to_u8(g);
+  rgb[2] = to_u8(b);
+}
+
+//
+// libjpeg reports errors through a callback that must not return, so we
+// jump back into `encode_jpeg_rgb()` / `decode_jpeg_rgb()`.
+//
+struct JpegErrorManager
+{
+  jpeg_error_mgr pub;
+  std::jmp_buf jump;
+  char message[JMSG_LENGTH_MAX];
+};
+
+void on_jpeg_error(j_common_ptr cinfo)
+{
+  auto* err = reinterpret_cast<JpegErrorManager*>(cinfo->err);
+  (*cinfo->err->format_message)(cinfo, err->message);
+  std::longjmp(err->jump, 1);
+}
+
+//
+// Destination manager writing straight into a `std::vector`, avoiding the
+// extra copy (and the malloc'ed buffer) of `jpeg_mem_dest()`.
+//
+struct VectorDestination
+{
+  jpeg_destination_mgr pub;
+  std::vector<std::uint8_t>* out;
+};
+
+void init_destination(j_compress_ptr cinfo)
+{
+  auto* dest = reinterpret_cast<VectorDestination*>(cinfo->dest);
+  dest->out->resize(std::max(dest->out->size(), jpeg_chunk_size));
+  dest->pub.next_output_byte = dest->out->data();
+  dest->pub.free_in_buffer = dest->out->size();
+}
+
+boolean empty_output_buffer(j_compress_ptr cinfo)
+{
+  auto* dest = reinterpret_cast<VectorDestination*>(cinfo->dest);
+  const auto used = dest->out->size();
+  dest->out->resize(used * 2);
+  dest->pub.next_output_byte = dest->out->data() + used;
+  dest->pub.free_in_buffer = dest->out->size() - used;
+  return TRUE;
+}
+
+void term_destination(j_compress_ptr cinfo)
+{
+  auto* dest = reinterpret_cast<VectorDestination*>(cinfo->dest);
+  dest->out->resize(dest->out->size() - dest->pub.free_in_buffer);
+}
+
+}  // namespace
+
+bool parse_colormap(const std::string& name, Colormap& out)
+{
+  if (name == "turbo")
+  {
+    out = Colormap::TURBO;
+    return true;
+  }
+  if (name == "gray")
+  {
+    out = Colormap::GRAY;
+    return true;
+  }
+  return false;
+}
+
+ColormapLut make_colormap_lut(Colormap colormap)
+{
+  ColormapLut lut{};  // entry 0 (invalid) stays black
+  for (std::size_t i = 1; i < 256; ++i)
+  {
+    const float x = static_cast<float>(i - 1) / 254.0F;
+    auto* rgb = lut.data() + i * 3;
+    switch (colormap)
+    {
+      case Colormap::TURBO:
+        turbo(x, rgb);
+        break;
+      case Colormap::GRAY:
+        rgb[0] = rgb[1] = rgb[2] = static_cast<std::uint8_t>(i);
+        break;
+    }
+  }
+  return lut;
+}
+
+template <typename T>
+void range_to_lut_index(const T* IFM3D_ROS2_RESTRICT src, std::uint8_t* IFM3D_ROS2_RESTRICT dst, std::size_t n,
+                        float min_value, float max_value)
+{
+  const float scale = max_value > min_value ? 254.0F / (max_value - min_value) : 0.0F;
+  const float offset = 1.5F - min_value * scale;  // index 1 at `min_value`, rounded
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const float v = static_cast<float>(src[i]);
+    float idx = v * scale + offset;
+    idx = idx > 1.0F ? idx : 1.0F;
+    idx = idx < 255.0F ? idx : 255.0F;
+    idx = v > 0.0F ? idx : 0.0F;  // also maps NaN to 0
+    dst[i] = static_cast<std::uint8_t>(static_cast<std::int32_t>(idx));
+  }
+}
+
+template IFM3D_ROS2_PUBLIC void range_to_lut_index<float>(const float*, std::uint8_t*, std::size_t, float, float);
+template IFM3D_ROS2_PUBLIC void range_to_lut_index<std::uint16_t>(const std::uint16_t*, std::uint8_t*, std::size_t,
+                                                                  float, float);
+template IFM3D_ROS2_PUBLIC void range_to_lut_index<std::uint8_t>(const std::uint8_t*, std::uint8_t*, std::size_t,
+                                                                 float, float);
+
+std::string encode_jpeg_rgb(const std::uint8_t* rgb, std::uint32_t width, std::uint32_t height, int quality,
+                            std::vector<std::uint8_t>& out)
+{
+  jpeg_compress_struct cinfo{};
+  JpegErrorManager jerr{};
+  VectorDestination dest{};
+
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = &on_jpeg_error;
+  if (setjmp(jerr.jump))
+  {
+    jpeg_destroy_compress(&cinfo);
+    out.clear();
+    return jerr.message;
+  }
+
+  jpeg_create_compress(&cinfo);
+
+  dest.pub.init_destination = &init_destination;
+  dest.pub.empty_output_buffer = &empty_output_buffer;
+  dest.pub.term_destination = &term_destination;
+  dest.out = &out;
+  cinfo.dest = &dest.pub;
+
+  cinfo.image_width = width;
+  cinfo.image_height = height;
+  cinfo.input_components = 3;
+  cinfo.in_color_space = JCS_RGB;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, std::clamp(quality, 1, 100), TRUE);
+
+  jpeg_start_compress(&cinfo, TRUE);
+  const std::size_t stride = static_cast<std::size_t>(width) * 3;
+  while (cinfo.next_scanline < cinfo.image_height)
+  {
+    auto* row = const_cast<JSAMPROW>(rgb + cinfo.next_scanline * stride);
+    jpeg_write_scanlines(&cinfo, &row, 1);
+  }
+  jpeg_finish_compress(&cinfo);
+  jpeg_destroy_compress(&cinfo);
+  return "";
+}
+
+std::string read_jpeg_size(const std::uint8_t* data, std::size_t size, std::uint32_t& width, std::uint32_t& height)
+{
+  jpeg_decompress_struct cinfo{};
+  JpegErrorManager jerr{};
+
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = &on_jpeg_error;
+  if (setjmp(jerr.jump))
+  {
+    jpeg_destroy_decompress(&cinfo);
+    width = height = 0;
+    return jerr.message;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo, const_cast<std::uint8_t*>(data), static_cast<unsigned long>(size));
+  jpeg_read_header(&cinfo, TRUE);
+  width = cinfo.image_width;
+  height = cinfo.image_height;
+  jpeg_destroy_decompress(&cinfo);
+  return "";
+}
+
+std::string decode_jpeg_rgb(const std::uint8_t* data, std::size_t size, std::uint32_t min_width,
+                            std::uint32_t min_height, RgbImage& out)
+{
+  jpeg_decompress_struct cinfo{};
+  JpegErrorManager jerr{};
+
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = &on_jpeg_error;
+  if (setjmp(jerr.jump))
+  {
+    jpeg_destroy_decompress(&cinfo);
+    out.width = out.height = 0;
+    return jerr.message;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  jpeg_mem_src(&cinfo, const_cast<std::uint8_t*>(data), static_cast<unsigned long>(size));
+  jpeg_read_header(&cinfo, TRUE);
+
+  out.scale_denom = 1;
+  for (std::uint32_t denom = 8; denom > 1; denom /= 2)
+  {
+    if ((cinfo.image_width + denom - 1) / denom >= min_width && (cinfo.image_height + denom - 1) / denom >= min_height)
+    {
+      out.scale_denom = denom;
+      break;
+    }
+  }
+  cinfo.out_color_space = JCS_RGB;
+  cinfo.scale_num = 1;
+  cinfo.scale_denom = out.scale_denom;
+
+  jpeg_start_decompress(&cinfo);
+  out.width = cinfo.output_width;
+  out.height = cinfo.output_height;
+  const std::size_t stride = static_cast<std::size_t>(out.width) * 3;
+  out.pixels.resize(stride * out.height);
+  while (cinfo.output_scanline < cinfo.output_height)
+  {
+    auto* row = out.pixels.data() + cinfo.output_scanline * stride;
+    jpeg_read_scanlines(&cinfo, &row, 1);
+  }
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  return "";
+}
+
+PreviewRenderer::PreviewRenderer(Colormap colormap, int quality)
+  : lut_(make_colormap_lut(colormap)), quality_(quality)
+{
+}
+
+void PreviewRenderer::set_colormap(Colormap colormap)
+{
+  this->lut_ = make_colormap_lut(colormap);
+}
+
+void PreviewRenderer::set_quality(int quality)
+{
+  this->quality_ = quality;
+}
+
+sensor_msgs::msg::CompressedImage PreviewRenderer::operator()(ifm3d::Buffer& image, float min_value, float max_value,
+                                                              const std_msgs::msg::Header& header,
+                                                              const rclcpp::Logger& logger)
+{
+  sensor_msgs::msg::CompressedImage result{};
+  result.header = header;
+  result.format = "bgr8; jpeg compressed bgr8";
+
+  const std::size_t n = static_cast<std::size_t>(image.width()) * image.height();
+  if (n == 0)
+  {
+    return result;
+  }
+
+  this->index_.resize(n);
+  switch (image.dataFormat())
+  {
+    case ifm3d::pixel_format::FORMAT_32F:
+      range_to_lut_index(image.ptr<float>(0), this->index_.data(), n, min_value, max_value);
+      break;
+    case ifm3d::pixel_format::FORMAT_16U:
+      range_to_lut_index(image.ptr<std::uint16_t>(0), this->index_.data(), n, min_value, max_value);
+      break;
+    case ifm3d::pixel_format::FORMAT_8U:
+      range_to_lut_index(image.ptr<std::uint8_t>(0), this->index_.data(), n, min_value, max_value);
+      break;
+    default:
+      RCLCPP_WARN_ONCE(logger, "No preview for pixel format %ld", static_cast<std::size_t>(image.dataFormat()));
+      return result;
+  }
+
+  this->rgb_.resize(n * 3);
+  const auto* lut = this->lut_.data();
+  auto* rgb = this->rgb_.data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto* color = lut + this->index_[i] * 3;
+    rgb[i * 3 + 0] = color[0];
+    rgb[i * 3 + 1] = color[1];
+    rgb[i * 3 + 2] = color[2];
+  }
+
+  const auto err = encode_jpeg_rgb(rgb, image.width(), image.height(), this->quality_, result.data);
+  if (!err.empty())
+  {
+    RCLCPP_ERROR(logger, "Failed to encode preview: %s", err.c_str());
+  }
+  return result;
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,216 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/rectification.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+constexpr std::uint64_t fnv_offset = 14695981039346656037ULL;
+constexpr std::uint64_t fnv_prime = 1099511628211ULL;
+
+std::uint64_t fnv1a(const void* data, std::size_t size, std::uint64_t hash)
+{
+  const auto* bytes = static_cast<const std::uint8_t*>(data);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash = (hash ^ bytes[i]) * fnv_prime;
+  }
+  return hash;
+}
+
+// Source positions (pixel centers at integers) to table entries. The integer
+// parts are stored apart from the weights, combining them in here keeps the
+// loop from vectorizing.
+void to_entries(const float* IFM3D_ROS2_RESTRICT u, const float* IFM3D_ROS2_RESTRICT v,
+                std::int32_t* IFM3D_ROS2_RESTRICT x0, std::int32_t* IFM3D_ROS2_RESTRICT y0,
+                std::uint16_t* IFM3D_ROS2_RESTRICT wx, std::uint16_t* IFM3D_ROS2_RESTRICT wy, float max_u,
+                float max_v, std::size_t n)
+{
+  const float max_x0 = max_u - 1.0F;
+  const float max_y0 = max_v - 1.0F;
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    // up to half a pixel beyond the outer pixel centers, clamped to them
+    const std::int32_t inside = (u[i] > -0.5F) & (u[i] < max_u + 0.5F) & (v[i] > -0.5F) & (v[i] < max_v + 0.5F);
+    float uc = u[i] > 0.0F ? u[i] : 0.0F;
+    float vc = v[i] > 0.0F ? v[i] : 0.0F;
+    uc = uc < max_u ? uc : max_u;
+    vc = vc < max_v ? vc : max_v;
+    // the right / bottom neighbor must exist, so the last column (row) is
+    // reached with a weight of 1 from the one before
+    float xf = uc < max_x0 ? uc : max_x0;
+    float yf = vc < max_y0 ? vc : max_y0;
+    const std::int32_t xi = static_cast<std::int32_t>(xf);
+    const std::int32_t yi = static_cast<std::int32_t>(yf);
+    wx[i] = static_cast<std::uint16_t>((uc - static_cast<float>(xi)) * 256.0F + 0.5F);
+    wy[i] = static_cast<std::uint16_t>((vc - static_cast<float>(yi)) * 256.0F + 0.5F);
+    x0[i] = inside * (xi + 1) - 1;
+    y0[i] = yi;
+  }
+}
+
+// Bilinear blend in 8 bit fixed point, on the gathered neighbors of a row:
+// each neighbor is a (little endian) 32 bit word holding the R, G and B bytes
+// and one ignored byte, so the loop vectorizes over the pixels.
+void blend(const std::uint32_t* IFM3D_ROS2_RESTRICT a00, const std::uint32_t* IFM3D_ROS2_RESTRICT a01,
+           const std::uint32_t* IFM3D_ROS2_RESTRICT a10, const std::uint32_t* IFM3D_ROS2_RESTRICT a11,
+           const std::uint16_t* IFM3D_ROS2_RESTRICT wx, const std::uint16_t* IFM3D_ROS2_RESTRICT wy,
+           std::uint32_t* IFM3D_ROS2_RESTRICT out, std::size_t n)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const std::uint32_t ax = wx[i];
+    const std::uint32_t bx = 256U - ax;
+    const std::uint32_t ay = wy[i];
+    const std::uint32_t by = 256U - ay;
+    std::uint32_t pixel = 0;
+    for (std::uint32_t shift = 0; shift < 24; shift += 8)
+    {
+      const std::uint32_t top = ((a00[i] >> shift) & 0xFFU) * bx + ((a01[i] >> shift) & 0xFFU) * ax;
+      const std::uint32_t bottom = ((a10[i] >> shift) & 0xFFU) * bx + ((a11[i] >> shift) & 0xFFU) * ax;
+      pixel |= ((top * by + bottom * ay + 32768U) >> 16) << shift;
+    }
+    out[i] = pixel;
+  }
+}
+
+}  // namespace
+
+std::uint64_t calibration_hash(const IntrinsicModel& model, std::uint32_t width, std::uint32_t height)
+{
+  std::uint64_t hash = fnv_offset;
+  hash = fnv1a(&model.model_id, sizeof(model.model_id), hash);
+  hash = fnv1a(model.parameters.data(), sizeof(float) * model.parameters.size(), hash);
+  hash = fnv1a(&width, sizeof(width), hash);
+  return fnv1a(&height, sizeof(height), hash);
+}
+
+std::shared_ptr<RemapTable> RemapTable::build(const IntrinsicModel& model, std::uint32_t width, std::uint32_t height,
+                                              WorkerPool& pool)
+{
+  if (!is_supported_model(model.model_id) || width < 2 || height < 2)
+  {
+    return nullptr;
+  }
+
+  auto table = std::make_shared<RemapTable>();
+  table->hash_ = calibration_hash(model, width, height);
+  table->width_ = width;
+  table->height_ = height;
+  // the forward models map `x / z` to `fx * x / z + mx - 0.5`
+  table->pinhole_ = PinholeModel{ model.parameters[0], model.parameters[1], model.parameters[2] - 0.5F,
+                                  model.parameters[3] - 0.5F };
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  table->offsets_.resize(n);
+  table->wx_.resize(n);
+  table->wy_.resize(n);
+
+  const auto pinhole = table->pinhole_;
+  const float max_u = static_cast<float>(width - 1);
+  const float max_v = static_cast<float>(height - 1);
+  const std::size_t stride = static_cast<std::size_t>(width) * 3;
+
+  pool.parallel_for(height, [&](std::size_t row_begin, std::size_t row_end) {
+    // rays through the pixels of a row of the pinhole camera, at z = 1
+    std::vector<float> x(width);
+    std::vector<float> y(width);
+    const std::vector<float> z(width, 1.0F);
+    std::vector<float> u(width);
+    std::vector<float> v(width);
+    std::vector<std::int32_t> x0(width);
+    std::vector<std::int32_t> y0(width);
+
+    for (std::size_t row = row_begin; row < row_end; ++row)
+    {
+      const float yn = (static_cast<float>(row) - pinhole.cy) / pinhole.fy;
+      for (std::uint32_t col = 0; col < width; ++col)
+      {
+        x[col] = (static_cast<float>(col) - pinhole.cx) / pinhole.fx;
+        y[col] = yn;
+      }
+      project_points(model, x.data(), y.data(), z.data(), u.data(), v.data(), 0, width);
+
+      const std::size_t first = row * width;
+      to_entries(u.data(), v.data(), x0.data(), y0.data(), table->wx_.data() + first, table->wy_.data() + first,
+                 max_u, max_v, width);
+      for (std::uint32_t col = 0; col < width; ++col)
+      {
+        table->offsets_[first + col] =
+            x0[col] < 0 ? -1 : static_cast<std::int32_t>(static_cast<std::size_t>(y0[col]) * stride + x0[col] * 3);
+      }
+    }
+  });
+  return table;
+}
+
+void RemapTable::remap(const std::uint8_t* src, std::uint8_t* dst, WorkerPool& pool)
+{
+  const std::size_t width = this->width_;
+  const std::size_t stride = width * 3;
+  // the neighbors are read as 32 bit words, the bottom right one of the last
+  // pixels only as far as the image goes
+  const std::size_t last_word = stride * this->height_ - 4;
+
+  const std::size_t chunk_words = 5 * width;
+  this->rows_.resize(pool.concurrency() * chunk_words);
+
+  pool.parallel_chunks(this->height_, [&](std::size_t chunk, std::size_t row_begin, std::size_t row_end) {
+    std::uint32_t* a00 = this->rows_.data() + chunk * chunk_words;
+    std::uint32_t* a01 = a00 + width;
+    std::uint32_t* a10 = a01 + width;
+    std::uint32_t* a11 = a10 + width;
+    std::uint32_t* pixels = a11 + width;
+
+    for (std::size_t row = row_begin; row < row_end; ++row)
+    {
+      const std::size_t first = row * width;
+      for (std::size_t col = 0; col < width; ++col)
+      {
+        const std::int32_t offset = this->offsets_[first + col];
+        if (offset < 0)
+        {
+          a00[col] = a01[col] = a10[col] = a11[col] = 0;
+          continue;
+        }
+        const std::size_t o = static_cast<std::size_t>(offset);
+        std::memcpy(&a00[col], src + o, 4);
+        std::memcpy(&a01[col], src + o + 3, 4);
+        std::memcpy(&a10[col], src + o + stride, 4);
+        if (o + stride + 3 <= last_word)
+        {
+          std::memcpy(&a11[col], src + o + stride + 3, 4);
+        }
+        else
+        {
+          a11[col] = 0;
+          std::memcpy(&a11[col], src + o + stride + 3, 3);
+        }
+      }
+
+      blend(a00, a01, a10, a11, this->wx_.data() + first, this->wy_.data() + first, pixels, width);
+
+      // overlapping 32 bit stores, the next pixel overwrites the 4th byte
+      auto* out = dst + row * stride;
+      for (std::size_t col = 0; col + 1 < width; ++col)
+      {
+        std::memcpy(out + col * 3, &pixels[col], 4);
+      }
+      std::memcpy(out + (width - 1) * 3, &pixels[width - 1], 3);
+    }
+  });
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,211 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/rgb_registration.hpp>
+
+#include <cstring>
+
+#include <ifm3d_ros2/shared_registry.hpp>
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+// `d * ray + t` for the pixels with a valid distance, a point behind the RGB
+// imager otherwise
+void rays_to_points(const float* IFM3D_ROS2_RESTRICT distance, const float* IFM3D_ROS2_RESTRICT rx,
+                    const float* IFM3D_ROS2_RESTRICT ry, const float* IFM3D_ROS2_RESTRICT rz,
+                    const std::array<float, 3>& t, float* IFM3D_ROS2_RESTRICT px, float* IFM3D_ROS2_RESTRICT py,
+                    float* IFM3D_ROS2_RESTRICT pz, std::size_t begin, std::size_t end)
+{
+  const float tx = t[0];
+  const float ty = t[1];
+  const float tz = t[2];
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const float d = distance[i] > 0.0F ? distance[i] : 0.0F;  // also maps NaN to 0
+    const float valid = distance[i] > 0.0F ? 1.0F : 0.0F;
+    px[i] = d * rx[i] + tx;
+    py[i] = d * ry[i] + ty;
+    pz[i] = valid * (d * rz[i] + tz + 1.0F) - 1.0F;
+  }
+}
+
+// Pixel coordinates at the decoded resolution, split into the top left
+// neighbor (`-1` if out of the image) and the bilinear weights. The integer
+// parts go to arrays of their own, as combining them in here keeps the loop
+// from vectorizing.
+void sample_positions(float* IFM3D_ROS2_RESTRICT u, float* IFM3D_ROS2_RESTRICT v,
+                      std::int32_t* IFM3D_ROS2_RESTRICT ix, std::int32_t* IFM3D_ROS2_RESTRICT iy, float scale,
+                      float max_u, float max_v, std::size_t begin, std::size_t end)
+{
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const float us = (u[i] + 0.5F) * scale - 0.5F;
+    const float vs = (v[i] + 0.5F) * scale - 0.5F;
+    // up to half a pixel beyond the outer pixel centers, clamped to them
+    const std::int32_t inside = (us > -0.5F) & (us < max_u + 0.5F) & (vs > -0.5F) & (vs < max_v + 0.5F);
+    float uc = us > 0.0F ? us : 0.0F;
+    float vc = vs > 0.0F ? vs : 0.0F;
+    uc = uc < max_u ? uc : max_u;
+    vc = vc < max_v ? vc : max_v;
+    const std::int32_t x0 = static_cast<std::int32_t>(uc);
+    const std::int32_t y0 = static_cast<std::int32_t>(vc);
+    u[i] = uc - static_cast<float>(x0);
+    v[i] = vc - static_cast<float>(y0);
+    ix[i] = inside * (x0 + 1) - 1;
+    iy[i] = y0;
+  }
+}
+
+}  // namespace
+
+bool RgbRegistration::configure(const OpticCalibration& tof, std::uint32_t width, std::uint32_t height,
+                                const OpticCalibration& rgb)
+{
+  if (this->valid_ && this->width_ == width && this->height_ == height && this->tof_ == tof && this->rgb_ == rgb)
+  {
+    return true;
+  }
+
+  this->tof_ = tof;
+  this->rgb_ = rgb;
+  this->width_ = width;
+  this->height_ = height;
+
+  std::vector<float> rays;
+  this->valid_ = is_supported_model(rgb.intrinsics.model_id) && pixel_rays(tof.inverse_intrinsics, width, height, rays);
+  if (!this->valid_)
+  {
+    return false;
+  }
+
+  // ToF optic -> user -> RGB optic: R_rgb^T * R_tof and R_rgb^T * (t_tof - t_rgb)
+  const auto rt = extrinsic_rotation(tof.extrinsics);
+  const auto rr = extrinsic_rotation(rgb.extrinsics);
+  std::array<float, 9> r{};
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    for (std::size_t j = 0; j < 3; ++j)
+    {
+      r[i * 3 + j] = rr[0 * 3 + i] * rt[0 * 3 + j] + rr[1 * 3 + i] * rt[1 * 3 + j] + rr[2 * 3 + i] * rt[2 * 3 + j];
+    }
+  }
+  const std::array<float, 3> dt{ { tof.extrinsics[0] - rgb.extrinsics[0], tof.extrinsics[1] - rgb.extrinsics[1],
+                                   tof.extrinsics[2] - rgb.extrinsics[2] } };
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    this->t_[i] = rr[0 * 3 + i] * dt[0] + rr[1 * 3 + i] * dt[1] + rr[2 * 3 + i] * dt[2];
+  }
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  this->rx_.resize(n);
+  this->ry_.resize(n);
+  this->rz_.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const float* ray = rays.data() + i * 3;
+    this->rx_[i] = r[0] * ray[0] + r[1] * ray[1] + r[2] * ray[2];
+    this->ry_[i] = r[3] * ray[0] + r[4] * ray[1] + r[5] * ray[2];
+    this->rz_[i] = r[6] * ray[0] + r[7] * ray[1] + r[8] * ray[2];
+  }
+  for (auto* scratch : { &this->px_, &this->py_, &this->pz_, &this->u_, &this->v_ })
+  {
+    scratch->resize(n);
+  }
+  this->ix_.resize(n);
+  this->iy_.resize(n);
+  return true;
+}
+
+void RgbRegistration::operator()(const float* distance, const std::uint8_t* rgb, std::uint32_t rgb_width,
+                                 std::uint32_t rgb_height, std::uint32_t rgb_scale_denom, std::uint8_t* out,
+                                 WorkerPool& pool)
+{
+  const std::size_t n = static_cast<std::size_t>(this->width_) * this->height_;
+  if (!this->valid_ || rgb_width == 0 || rgb_height == 0)
+  {
+    std::memset(out, 0, n * 3);
+    return;
+  }
+
+  const float scale = 1.0F / static_cast<float>(rgb_scale_denom > 0 ? rgb_scale_denom : 1);
+  const float max_u = static_cast<float>(rgb_width - 1);
+  const float max_v = static_cast<float>(rgb_height - 1);
+  const std::size_t stride = static_cast<std::size_t>(rgb_width) * 3;
+
+  pool.parallel_for(n, [&](std::size_t begin, std::size_t end) {
+    rays_to_points(distance, this->rx_.data(), this->ry_.data(), this->rz_.data(), this->t_, this->px_.data(),
+                   this->py_.data(), this->pz_.data(), begin, end);
+    project_points(this->rgb_.intrinsics, this->px_.data(), this->py_.data(), this->pz_.data(), this->u_.data(),
+                   this->v_.data(), begin, end);
+
+    auto* ix = this->ix_.data();
+    auto* iy = this->iy_.data();
+    sample_positions(this->u_.data(), this->v_.data(), ix, iy, scale, max_u, max_v, begin, end);
+
+    // gathers, which do not vectorize well for 8 bit pixels
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      auto* dst = out + i * 3;
+      if (ix[i] < 0)
+      {
+        dst[0] = dst[1] = dst[2] = 0;
+        continue;
+      }
+      const std::size_t x0 = static_cast<std::size_t>(ix[i]);
+      const std::size_t y0 = static_cast<std::size_t>(iy[i]);
+      const std::size_t dx = x0 + 1 < rgb_width ? 3 : 0;
+      const std::size_t dy = y0 + 1 < rgb_height ? stride : 0;
+      const std::uint8_t* p00 = rgb + y0 * stride + x0 * 3;
+      const float fx = this->u_[i];
+      const float fy = this->v_[i];
+      const float w00 = (1.0F - fx) * (1.0F - fy);
+      const float w01 = fx * (1.0F - fy);
+      const float w10 = (1.0F - fx) * fy;
+      const float w11 = fx * fy;
+      for (std::size_t c = 0; c < 3; ++c)
+      {
+        dst[c] = static_cast<std::uint8_t>(w00 * p00[c] + w01 * p00[dx + c] + w10 * p00[dy + c] +
+                                           w11 * p00[dy + dx + c] + 0.5F);
+      }
+    }
+  });
+}
+
+std::shared_ptr<ColorFrameExchange> ColorFrameExchange::acquire(const std::string& name)
+{
+  return acquire_shared<ColorFrameExchange>(name, [] { return std::make_shared<ColorFrameExchange>(); });
+}
+
+void ColorFrameExchange::request(std::int64_t now_nanos)
+{
+  this->last_request_.store(now_nanos, std::memory_order_relaxed);
+}
+
+bool ColorFrameExchange::wanted(std::int64_t now_nanos, std::int64_t window_nanos) const
+{
+  const auto last = this->last_request_.load(std::memory_order_relaxed);
+  return last >= 0 && now_nanos - last <= window_nanos;
+}
+
+void ColorFrameExchange::post(std::shared_ptr<ColorFrame> frame)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  frame->sequence = this->next_sequence_++;
+  this->latest_ = std::move(frame);
+}
+
+std::shared_ptr<const ColorFrame> ColorFrameExchange::latest() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  return this->latest_;
+}
+
+}  // namespace ifm3d_ros2
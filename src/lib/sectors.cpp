@@ -0,0 +1,102 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/sectors.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <ifm3d_ros2/simd.hpp>
+
+namespace ifm3d_ros2
+{
+void SectorReducer::configure(const Params& params)
+{
+  this->params_ = params;
+  this->num_bins_ = static_cast<std::size_t>(this->num_bands()) * this->params_.num_sectors;
+}
+
+//
+// The bin of a point cannot be precomputed per pixel: the XYZ buffer is
+// already transformed by the extrinsics, so with any translation the
+// azimuth of a pixel depends on its distance, and the height band always
+// does. Instead, the bins are computed per point by vectorized passes over
+// the buffer, followed by a single scalar scatter into the (few) bins. The
+// passes work on squared ranges, only the per bin minima get a `sqrt()`.
+//
+void SectorReducer::reduce(const float* IFM3D_ROS2_RESTRICT xyz, std::size_t n)
+{
+  this->min_range_.assign(this->num_bins_ + 1, std::numeric_limits<float>::infinity());
+  this->point_count_.assign(this->num_bins_ + 1, 0);
+
+  const auto num_sectors = this->params_.num_sectors;
+  if (this->num_bins_ == 0 || !(this->params_.angle_max > this->params_.angle_min))
+  {
+    this->min_range_.pop_back();
+    this->point_count_.pop_back();
+    return;
+  }
+
+  this->sector_.resize(n);
+  this->band_.assign(n, 0);
+  this->range2_.resize(n);
+  this->z_.resize(n);
+
+  std::int32_t* IFM3D_ROS2_RESTRICT sector = this->sector_.data();
+  std::int32_t* IFM3D_ROS2_RESTRICT band = this->band_.data();
+  float* IFM3D_ROS2_RESTRICT range2 = this->range2_.data();
+  float* IFM3D_ROS2_RESTRICT z = this->z_.data();
+
+  const float angle_min = this->params_.angle_min;
+  const float sectors_per_rad = static_cast<float>(num_sectors) / (this->params_.angle_max - angle_min);
+  const float max_sector = static_cast<float>(num_sectors);
+
+  IFM3D_ROS2_PRAGMA_SIMD
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const float x = xyz[i * 3 + 0];
+    const float y = xyz[i * 3 + 1];
+    const float r2 = x * x + y * y;
+    const float s = (fast_atan2(y, x) - angle_min) * sectors_per_rad;
+    const int valid = (r2 > 0.0F) & (s >= 0.0F) & (s < max_sector);  // NaN compares false
+    const float sv = valid ? s : -1.0F;
+    sector[i] = static_cast<std::int32_t>(sv);
+    range2[i] = r2;
+    z[i] = xyz[i * 3 + 2];
+  }
+
+  // band + 1 == number of edges at or below z, i.e., 0 below the first edge
+  for (const float limit : this->params_.band_limits)
+  {
+    IFM3D_ROS2_PRAGMA_SIMD
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      band[i] += z[i] >= limit ? 1 : 0;
+    }
+  }
+
+  const auto num_bands = static_cast<std::int32_t>(this->num_bands());
+  const auto trash = static_cast<std::int32_t>(this->num_bins_);
+  auto* min_range = this->min_range_.data();
+  auto* point_count = this->point_count_.data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const std::int32_t b = band[i] - 1;
+    const std::int32_t bin =
+        (sector[i] >= 0 && b >= 0 && b < num_bands) ? b * static_cast<std::int32_t>(num_sectors) + sector[i] : trash;
+    min_range[bin] = std::min(min_range[bin], range2[i]);
+    ++point_count[bin];
+  }
+
+  this->min_range_.pop_back();
+  this->point_count_.pop_back();
+  for (auto& r : this->min_range_)
+  {
+    r = std::sqrt(r);
+  }
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,274 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/thread_accounting.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include <dirent.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+constexpr std::size_t max_thread_name_length = 15;
+
+std::vector<pid_t> list_threads()
+{
+  std::vector<pid_t> tids;
+  if (DIR* dir = ::opendir("/proc/self/task"))
+  {
+    while (const dirent* entry = ::readdir(dir))
+    {
+      const auto tid = std::atoi(entry->d_name);
+      if (tid > 0)
+      {
+        tids.push_back(static_cast<pid_t>(tid));
+      }
+    }
+    ::closedir(dir);
+  }
+  std::sort(tids.begin(), tids.end());
+  return tids;
+}
+
+std::string task_path(pid_t tid, const char* file)
+{
+  return "/proc/self/task/" + std::to_string(tid) + "/" + file;
+}
+
+std::string read_thread_name(pid_t tid)
+{
+  std::ifstream in(task_path(tid, "comm"));
+  std::string name;
+  std::getline(in, name);
+  return name;
+}
+
+//
+// CPU time (user + system, seconds) of thread `tid` from its `stat` file.
+// Most threads of the process are not ours (middleware, ifm3d), so there is
+// no pthread handle to ask `pthread_getcpuclockid()` for their clock. A
+// thread that exited in the meantime just fails to read.
+//
+bool read_thread_cpu_time(pid_t tid, double& seconds)
+{
+  std::ifstream in(task_path(tid, "stat"));
+  std::string stat;
+  if (!std::getline(in, stat))
+  {
+    return false;
+  }
+
+  // the name (field 2) may contain anything, fields 3.. follow its last ')'
+  const auto name_end = stat.rfind(')');
+  if (name_end == std::string::npos)
+  {
+    return false;
+  }
+  std::istringstream fields(stat.substr(name_end + 1));
+  std::string skipped;
+  for (int field = 3; field < 14; ++field)
+  {
+    fields >> skipped;
+  }
+  std::uint64_t utime = 0;
+  std::uint64_t stime = 0;
+  if (!(fields >> utime >> stime))
+  {
+    return false;
+  }
+
+  static const double ticks_per_second = static_cast<double>(::sysconf(_SC_CLK_TCK));
+  seconds = static_cast<double>(utime + stime) / ticks_per_second;
+  return true;
+}
+
+/**
+ * Looks up `key` (e.g., "VmRSS:") in a /proc `status` style file and returns
+ * the first number following it, 0 if not found.
+ */
+std::uint64_t read_status_field(const std::string& path, const std::string& key)
+{
+  std::ifstream in(path);
+  std::string line;
+  while (std::getline(in, line))
+  {
+    if (line.compare(0, key.size(), key) == 0)
+    {
+      std::istringstream is(line.substr(key.size()));
+      std::uint64_t value = 0;
+      is >> value;
+      return value;
+    }
+  }
+  return 0;
+}
+
+std::uint64_t heap_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  const auto info = ::mallinfo2();
+  return static_cast<std::uint64_t>(info.uordblks) + static_cast<std::uint64_t>(info.hblkhd);
+#elif defined(__GLIBC__)
+  const auto info = ::mallinfo();
+  return static_cast<std::uint64_t>(static_cast<unsigned int>(info.uordblks)) +
+         static_cast<std::uint64_t>(static_cast<unsigned int>(info.hblkhd));
+#else
+  return 0;
+#endif
+}
+
+}  // namespace
+
+ThreadRegistry& ThreadRegistry::instance()
+{
+  static ThreadRegistry registry;
+  return registry;
+}
+
+pid_t ThreadRegistry::current_tid()
+{
+  return static_cast<pid_t>(::syscall(SYS_gettid));
+}
+
+void ThreadRegistry::tag(const std::string& role, const std::string& thread_name)
+{
+  if (!thread_name.empty())
+  {
+    ::pthread_setname_np(::pthread_self(), thread_name.substr(0, max_thread_name_length).c_str());
+  }
+
+  const auto tid = current_tid();
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  auto& roles = this->roles_[tid];
+  if (roles.empty())
+  {
+    roles = role;
+  }
+  else if (("," + roles + ",").find("," + role + ",") == std::string::npos)
+  {
+    roles += "," + role;
+  }
+}
+
+std::string ThreadRegistry::role(pid_t tid)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  const auto it = this->roles_.find(tid);
+  return it == this->roles_.end() ? std::string() : it->second;
+}
+
+void ThreadRegistry::prune(const std::vector<pid_t>& alive)
+{
+  std::lock_guard<std::mutex> lock(this->mutex_);
+  for (auto it = this->roles_.begin(); it != this->roles_.end();)
+  {
+    if (std::binary_search(alive.begin(), alive.end(), it->first))
+    {
+      ++it;
+    }
+    else
+    {
+      it = this->roles_.erase(it);
+    }
+  }
+}
+
+ResourceSample ResourceSampler::sample()
+{
+  ResourceSample result;
+
+  const auto now = std::chrono::steady_clock::now();
+  const bool have_previous = this->last_wall_.time_since_epoch().count() != 0;
+  result.period = have_previous ? std::chrono::duration<double>(now - this->last_wall_).count() : 0.0;
+  this->last_wall_ = now;
+
+  const auto tids = list_threads();
+  auto& registry = ThreadRegistry::instance();
+  registry.prune(tids);
+
+  std::map<pid_t, double> cpu_times;
+  for (const auto tid : tids)
+  {
+    double cpu_time = 0.0;
+    if (!read_thread_cpu_time(tid, cpu_time))
+    {
+      // thread exited while we were looking
+      continue;
+    }
+
+    ThreadSample thread;
+    thread.tid = tid;
+    thread.name = read_thread_name(tid);
+    thread.role = registry.role(tid);
+    thread.cpu_time = cpu_time;
+
+    const auto status = task_path(tid, "status");
+    thread.voluntary_ctx_switches = read_status_field(status, "voluntary_ctxt_switches:");
+    thread.involuntary_ctx_switches = read_status_field(status, "nonvoluntary_ctxt_switches:");
+
+    const auto prev = this->last_cpu_time_.find(tid);
+    if (result.period > 0.0 && prev != this->last_cpu_time_.end())
+    {
+      thread.cpu_load = std::max(0.0, thread.cpu_time - prev->second) / result.period;
+      result.process_cpu_load += thread.cpu_load;
+    }
+
+    cpu_times[tid] = thread.cpu_time;
+    result.threads.push_back(std::move(thread));
+  }
+  this->last_cpu_time_ = std::move(cpu_times);
+
+  result.rss_bytes = read_status_field("/proc/self/status", "VmRSS:") * 1024;
+  result.heap_in_use_bytes = heap_in_use();
+
+  return result;
+}
+
+HostCpuSampler::HostCpuSampler(std::string stat_path) : stat_path_(std::move(stat_path))
+{
+}
+
+double HostCpuSampler::sample()
+{
+  // cpu  user nice system idle iowait irq softirq steal ...
+  std::ifstream in(this->stat_path_);
+  std::string label;
+  in >> label;
+  if (label != "cpu")
+  {
+    return 0.0;
+  }
+  std::uint64_t total = 0;
+  std::uint64_t idle = 0;
+  std::uint64_t value = 0;
+  for (int field = 0; field < 8 && in >> value; ++field)
+  {
+    total += value;
+    if (field == 3 || field == 4)
+    {
+      idle += value;
+    }
+  }
+
+  const auto busy = total - idle;
+  const bool have_previous = this->last_total_ != 0 && total > this->last_total_;
+  const double load =
+      have_previous ? static_cast<double>(busy - std::min(busy, this->last_busy_)) / (total - this->last_total_) : 0.0;
+  this->last_busy_ = busy;
+  this->last_total_ = total;
+  return std::min(load, 1.0);
+}
+
+}  // namespace ifm3d_ros2
@@ -0,0 +1,93 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/topic_schedule.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace ifm3d_ros2
+{
+namespace
+{
+constexpr std::array<const char*, num_frame_topics> topic_names{
+  "cloud", "distance", "confidence", "amplitude", "rgb", "distance_noise", "raw_amplitude",
+};
+
+// weight of the latest cost in the moving average
+constexpr double cost_weight = 0.1;
+
+// decay of the expected cost of a skipped topic
+constexpr double skip_decay = 0.9;
+
+}  // namespace
+
+const char* frame_topic_name(FrameTopic topic)
+{
+  return topic_names[static_cast<std::size_t>(topic)];
+}
+
+bool frame_topic_from_name(const std::string& name, FrameTopic& topic)
+{
+  const auto it = std::find(topic_names.begin(), topic_names.end(), name);
+  if (it == topic_names.end())
+  {
+    return false;
+  }
+  topic = static_cast<FrameTopic>(std::distance(topic_names.begin(), it));
+  return true;
+}
+
+std::vector<std::string> frame_topic_names()
+{
+  return { topic_names.begin(), topic_names.end() };
+}
+
+TopicScheduler::TopicScheduler()
+{
+  this->configure({}, {});
+}
+
+void TopicScheduler::configure(const std::vector<FrameTopic>& priorities,
+                               const std::array<double, num_frame_topics>& deadlines)
+{
+  std::size_t n = 0;
+  const auto add = [this, &n](FrameTopic topic) {
+    if (std::find(this->order_.begin(), this->order_.begin() + n, topic) == this->order_.begin() + n)
+    {
+      this->order_[n++] = topic;
+    }
+  };
+  for (const auto topic : priorities)
+  {
+    add(topic);
+  }
+  for (std::size_t i = 0; i < num_frame_topics; ++i)
+  {
+    add(static_cast<FrameTopic>(i));
+  }
+
+  this->deadlines_ = deadlines;
+  this->costs_.fill(0.0);
+}
+
+bool TopicScheduler::admit(FrameTopic topic, double elapsed)
+{
+  const auto i = static_cast<std::size_t>(topic);
+  if (this->deadlines_[i] <= 0.0 || elapsed + this->costs_[i] <= this->deadlines_[i])
+  {
+    return true;
+  }
+  this->costs_[i] *= skip_decay;
+  return false;
+}
+
+void TopicScheduler::account(FrameTopic topic, double cost)
+{
+  auto& expected = this->costs_[static_cast<std::size_t>(topic)];
+  expected = expected == 0.0 ? cost : expected + cost_weight * (cost - expected);
+}
+
+}  // namespace ifm3d_ros2
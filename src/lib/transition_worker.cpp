@@ -0,0 +1,144 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/transition_worker.hpp>
+
+#include <algorithm>
+#include <utility>
+
+#include <lifecycle_msgs/msg/state.hpp>
+
+namespace ifm3d_ros2
+{
+const char* transition_request_name(TransitionRequest request)
+{
+  switch (request)
+  {
+    case TransitionRequest::DEACTIVATE:
+      return "deactivate";
+    case TransitionRequest::RECONFIGURE:
+      return "reconfigure";
+  }
+  return "unknown";
+}
+
+TransitionStep transition_step(TransitionRequest request, std::uint8_t state_id)
+{
+  switch (state_id)
+  {
+    case lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE:
+      return TransitionStep::DEACTIVATE;
+
+    case lifecycle_msgs::msg::State::PRIMARY_STATE_INACTIVE:
+      return request == TransitionRequest::RECONFIGURE ? TransitionStep::CLEANUP : TransitionStep::NONE;
+
+    default:
+      return TransitionStep::NONE;
+  }
+}
+
+TransitionWorker::TransitionWorker(Handler handler, Observer observer, std::function<void()> on_start)
+  : handler_(std::move(handler)), observer_(std::move(observer))
+{
+  this->thread_ = std::thread(&TransitionWorker::run, this, std::move(on_start));
+}
+
+TransitionWorker::~TransitionWorker()
+{
+  this->stop();
+  this->thread_.join();
+}
+
+bool TransitionWorker::request(TransitionRequest request)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    if (this->stop_)
+    {
+      return false;
+    }
+    const auto i = static_cast<std::size_t>(request);
+    if (std::find(this->queue_.begin(), this->queue_.end(), request) != this->queue_.end())
+    {
+      ++this->coalesced_[i];
+      return false;
+    }
+    this->queue_.push_back(request);
+    this->requested_at_[i] = Clock::now();
+    this->coalesced_[i] = 0;
+  }
+  this->cv_.notify_one();
+  return true;
+}
+
+void TransitionWorker::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->stop_ = true;
+    this->queue_.clear();
+  }
+  this->cv_.notify_one();
+  this->idle_cv_.notify_all();
+}
+
+bool TransitionWorker::wait_idle(std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  return this->idle_cv_.wait_for(lock, timeout, [this] { return this->queue_.empty() && !this->running_; });
+}
+
+void TransitionWorker::run(const std::function<void()>& on_start)
+{
+  if (on_start)
+  {
+    on_start();
+  }
+
+  while (true)
+  {
+    TransitionTiming timing;
+    Clock::time_point t_start;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex_);
+      this->cv_.wait(lock, [this] { return this->stop_ || !this->queue_.empty(); });
+      if (this->stop_)
+      {
+        return;
+      }
+      timing.request = this->queue_.front();
+      this->queue_.pop_front();
+      this->running_ = true;
+
+      const auto i = static_cast<std::size_t>(timing.request);
+      t_start = Clock::now();
+      timing.wait_seconds = std::chrono::duration<double>(t_start - this->requested_at_[i]).count();
+      timing.coalesced = this->coalesced_[i];
+    }
+
+    try
+    {
+      timing.ok = this->handler_(timing.request);
+    }
+    catch (...)
+    {
+      timing.ok = false;
+    }
+    timing.run_seconds = std::chrono::duration<double>(Clock::now() - t_start).count();
+
+    if (this->observer_)
+    {
+      this->observer_(timing);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->running_ = false;
+    }
+    this->idle_cv_.notify_all();
+  }
+}
+
+}  // namespace ifm3d_ros2
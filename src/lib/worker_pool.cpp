@@ -0,0 +1,180 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <ifm3d_ros2/worker_pool.hpp>
+
+#include <utility>
+
+namespace ifm3d_ros2
+{
+WorkerPool::WorkerPool(std::size_t num_threads, std::function<void()> on_start)
+{
+  this->workers_.reserve(num_threads);
+  for (std::size_t i = 0; i < num_threads; ++i)
+  {
+    this->workers_.emplace_back(&WorkerPool::run, this, i + 1, on_start);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->stop_ = true;
+  }
+  this->start_cv_.notify_all();
+  for (auto& worker : this->workers_)
+  {
+    worker.join();
+  }
+}
+
+void WorkerPool::parallel_for(std::size_t n, const std::function<void(std::size_t, std::size_t)>& fn)
+{
+  this->parallel_chunks(n, [&fn](std::size_t /*chunk*/, std::size_t begin, std::size_t end) { fn(begin, end); });
+}
+
+std::size_t WorkerPool::parallel_chunks(std::size_t n,
+                                        const std::function<void(std::size_t, std::size_t, std::size_t)>& fn)
+{
+  if (n == 0)
+  {
+    return 0;
+  }
+  if (this->workers_.empty() || n < this->concurrency())
+  {
+    fn(0, 0, n);
+    return 1;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->job_ = &fn;
+    this->job_size_ = n;
+    this->pending_ = this->workers_.size();
+    this->error_ = nullptr;
+    ++this->generation_;
+  }
+  this->start_cv_.notify_all();
+
+  this->run_chunk(0);
+
+  std::unique_lock<std::mutex> lock(this->mutex_);
+  this->done_cv_.wait(lock, [this] { return this->pending_ == 0; });
+  this->job_ = nullptr;
+  if (this->error_)
+  {
+    std::rethrow_exception(std::exchange(this->error_, nullptr));
+  }
+  return this->concurrency();
+}
+
+void WorkerPool::run_chunk(std::size_t index)
+{
+  const std::size_t chunks = this->concurrency();
+  const std::size_t begin = this->job_size_ * index / chunks;
+  const std::size_t end = this->job_size_ * (index + 1) / chunks;
+
+  try
+  {
+    (*this->job_)(index, begin, end);
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    if (!this->error_)
+    {
+      this->error_ = std::current_exception();
+    }
+  }
+}
+
+void WorkerPool::run(std::size_t index, const std::function<void()>& on_start)
+{
+  if (on_start)
+  {
+    on_start();
+  }
+
+  std::uint64_t seen = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->mutex_);
+      this->start_cv_.wait(lock, [this, seen] { return this->stop_ || this->generation_ != seen; });
+      if (this->stop_)
+      {
+        return;
+      }
+      seen = this->generation_;
+    }
+
+    this->run_chunk(index);
+
+    bool last = false;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      last = --this->pending_ == 0;
+    }
+    if (last)
+    {
+      this->done_cv_.notify_one();
+    }
+  }
+}
+
+LatestJobWorker::LatestJobWorker(std::function<void()> on_start)
+  : thread_(&LatestJobWorker::run, this, std::move(on_start))
+{
+}
+
+LatestJobWorker::~LatestJobWorker()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->stop_ = true;
+    this->queued_ = nullptr;
+  }
+  this->cv_.notify_one();
+  this->thread_.join();
+}
+
+bool LatestJobWorker::post(std::function<void()> job)
+{
+  bool replaced = false;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    replaced = static_cast<bool>(this->queued_);
+    this->queued_ = std::move(job);
+  }
+  this->cv_.notify_one();
+  return !replaced;
+}
+
+void LatestJobWorker::run(const std::function<void()>& on_start)
+{
+  if (on_start)
+  {
+    on_start();
+  }
+
+  while (true)
+  {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex_);
+      this->cv_.wait(lock, [this] { return this->stop_ || this->queued_; });
+      if (this->stop_)
+      {
+        return;
+      }
+      job = std::move(this->queued_);
+      this->queued_ = nullptr;
+    }
+    job();
+  }
+}
+
+}  // namespace ifm3d_ros2
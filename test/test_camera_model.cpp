@@ -0,0 +1,291 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/camera_model.hpp>
+#include <ifm3d_ros2/rgb_registration.hpp>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace
+{
+using ifm3d_ros2::ColorFrameExchange;
+using ifm3d_ros2::IntrinsicModel;
+using ifm3d_ros2::OpticCalibration;
+using ifm3d_ros2::RgbRegistration;
+using ifm3d_ros2::WorkerPool;
+
+constexpr std::uint32_t width = 32;
+constexpr std::uint32_t height = 24;
+
+IntrinsicModel model(std::uint32_t id, std::vector<float> parameters)
+{
+  IntrinsicModel result;
+  result.model_id = id;
+  for (std::size_t i = 0; i < parameters.size(); ++i)
+  {
+    result.parameters[i] = parameters[i];
+  }
+  return result;
+}
+
+// fx, fy, mx, my, alpha, k1 .. k5 without distortion, the inverse of itself
+IntrinsicModel pinhole()
+{
+  return model(ifm3d_ros2::model_bouguet, { 40.0F, 42.0F, 16.2F, 11.9F, 0.0F });
+}
+
+/**
+ * Projects the rays of all pixels through `forward` and expects to land on
+ * the pixel centers again.
+ */
+void expect_round_trip(const IntrinsicModel& forward, const IntrinsicModel& inverse, float tolerance)
+{
+  std::vector<float> rays;
+  ASSERT_TRUE(ifm3d_ros2::pixel_rays(inverse, width, height, rays));
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  std::vector<float> x(n), y(n), z(n), u(n), v(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    EXPECT_NEAR(rays[i * 3] * rays[i * 3] + rays[i * 3 + 1] * rays[i * 3 + 1] + rays[i * 3 + 2] * rays[i * 3 + 2],
+                1.0F, 1e-5F);
+    // any point along the ray projects to the same pixel
+    const float d = 0.5F + static_cast<float>(i % 7);
+    x[i] = d * rays[i * 3];
+    y[i] = d * rays[i * 3 + 1];
+    z[i] = d * rays[i * 3 + 2];
+  }
+  ifm3d_ros2::project_points(forward, x.data(), y.data(), z.data(), u.data(), v.data(), 0, n);
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    EXPECT_NEAR(u[i], static_cast<float>(i % width), tolerance) << "pixel " << i;
+    EXPECT_NEAR(v[i], static_cast<float>(i / width), tolerance) << "pixel " << i;
+  }
+}
+
+TEST(CameraModel, BouguetRoundTrip)
+{
+  expect_round_trip(pinhole(), pinhole(), 1e-3F);
+
+  // skewed as well
+  const auto skewed = model(ifm3d_ros2::model_bouguet, { 40.0F, 42.0F, 16.2F, 11.9F, 0.05F });
+  expect_round_trip(skewed, skewed, 1e-3F);
+}
+
+TEST(CameraModel, FisheyeRoundTrip)
+{
+  // without distortion the model is equidistant, `theta_max` beyond any ray
+  const auto fisheye = model(ifm3d_ros2::model_fisheye, { 20.0F, 20.0F, 16.0F, 12.0F, 0.0F, 0, 0, 0, 0, 3.0F });
+  expect_round_trip(fisheye, fisheye, 1e-2F);
+}
+
+TEST(CameraModel, BouguetMatchesTheReference)
+{
+  const std::vector<float> p{ 40.0F, 42.0F, 16.2F, 11.9F, 0.01F, -0.2F, 0.05F, 1e-3F, -2e-3F, 0.01F };
+  const auto bouguet = model(ifm3d_ros2::model_bouguet, p);
+
+  std::vector<float> x, y, z;
+  for (float px = -0.6F; px <= 0.6F; px += 0.1F)
+  {
+    for (float py = -0.4F; py <= 0.4F; py += 0.1F)
+    {
+      x.push_back(px);
+      y.push_back(py);
+      z.push_back(1.5F);
+    }
+  }
+  const std::size_t n = x.size();
+  std::vector<float> u(n), v(n);
+  ifm3d_ros2::project_points(bouguet, x.data(), y.data(), z.data(), u.data(), v.data(), 0, n);
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const double xn = static_cast<double>(x[i]) / z[i];
+    const double yn = static_cast<double>(y[i]) / z[i];
+    const double r2 = xn * xn + yn * yn;
+    const double radial = 1.0 + p[5] * r2 + p[6] * r2 * r2 + p[9] * r2 * r2 * r2;
+    const double xd = xn * radial + 2.0 * p[7] * xn * yn + p[8] * (r2 + 2.0 * xn * xn);
+    const double yd = yn * radial + p[7] * (r2 + 2.0 * yn * yn) + 2.0 * p[8] * xn * yn;
+    EXPECT_NEAR(u[i], (xd + p[4] * yd) * p[0] + p[2] - 0.5, 1e-3) << "point " << i;
+    EXPECT_NEAR(v[i], yd * p[1] + p[3] - 0.5, 1e-3) << "point " << i;
+  }
+}
+
+TEST(CameraModel, PointsBehindTheImager)
+{
+  const float x[] = { 0.1F, 0.1F, 0.0F };
+  const float y[] = { 0.1F, -0.2F, 0.0F };
+  const float z[] = { -1.0F, 0.0F, 0.0F };
+  float u[3];
+  float v[3];
+  ifm3d_ros2::project_points(pinhole(), x, y, z, u, v, 0, 3);
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(u[i], -1.0F);
+    EXPECT_EQ(v[i], -1.0F);
+  }
+}
+
+TEST(CameraModel, UnsupportedModels)
+{
+  std::vector<float> rays;
+  EXPECT_FALSE(ifm3d_ros2::pixel_rays(model(1, { 40.0F, 42.0F, 16.0F, 12.0F }), width, height, rays));
+  EXPECT_FALSE(ifm3d_ros2::is_supported_model(1));
+}
+
+/**
+ * An RGB image encoding the coordinates of its pixels, `8 * column` in red
+ * and `8 * row` in green, so that a registered pixel tells where it was
+ * sampled.
+ */
+std::vector<std::uint8_t> coordinate_image(std::uint32_t w, std::uint32_t h)
+{
+  std::vector<std::uint8_t> rgb(static_cast<std::size_t>(w) * h * 3);
+  for (std::uint32_t row = 0; row < h; ++row)
+  {
+    for (std::uint32_t col = 0; col < w; ++col)
+    {
+      auto* px = rgb.data() + (static_cast<std::size_t>(row) * w + col) * 3;
+      px[0] = static_cast<std::uint8_t>(8 * col);
+      px[1] = static_cast<std::uint8_t>(8 * row);
+      px[2] = 200;
+    }
+  }
+  return rgb;
+}
+
+OpticCalibration calibration(float trans_x)
+{
+  OpticCalibration result;
+  result.intrinsics = pinhole();
+  result.inverse_intrinsics = pinhole();
+  result.extrinsics = { trans_x, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F };
+  return result;
+}
+
+TEST(RgbRegistration, CoincidentImagersSampleTheSamePixel)
+{
+  WorkerPool pool(3);
+  RgbRegistration registration;
+  ASSERT_TRUE(registration.configure(calibration(0.0F), width, height, calibration(0.0F)));
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  std::vector<float> distance(n, 2.0F);
+  distance[5] = 0.0F;
+  distance[77] = std::numeric_limits<float>::quiet_NaN();
+
+  const auto rgb = coordinate_image(width, height);
+  std::vector<std::uint8_t> out(n * 3, 1);
+  registration(distance.data(), rgb.data(), width, height, 1, out.data(), pool);
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto* px = out.data() + i * 3;
+    if (i == 5 || i == 77)
+    {
+      EXPECT_EQ(px[0] + px[1] + px[2], 0) << "invalid pixel " << i << " is not black";
+      continue;
+    }
+    EXPECT_EQ(px[0], rgb[i * 3]) << "pixel " << i;
+    EXPECT_EQ(px[1], rgb[i * 3 + 1]) << "pixel " << i;
+    EXPECT_EQ(px[2], 200) << "pixel " << i;
+  }
+}
+
+TEST(RgbRegistration, SamplesAtTheParallax)
+{
+  // the ToF imager 5 cm left of the RGB imager (x of the optic frames)
+  constexpr float baseline = 0.05F;
+  constexpr float d = 1.0F;
+  const auto pin = pinhole();
+  const float fx = pin.parameters[0];
+
+  WorkerPool pool(2);
+  RgbRegistration registration;
+  ASSERT_TRUE(registration.configure(calibration(-baseline), width, height, calibration(0.0F)));
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  std::vector<float> distance(n, d);
+  const auto rgb = coordinate_image(width, height);
+  std::vector<std::uint8_t> out(n * 3);
+  registration(distance.data(), rgb.data(), width, height, 1, out.data(), pool);
+
+  std::vector<float> rays;
+  ASSERT_TRUE(ifm3d_ros2::pixel_rays(pin, width, height, rays));
+  for (std::uint32_t row = 0; row < height; ++row)
+  {
+    for (std::uint32_t col = 0; col < width; ++col)
+    {
+      const std::size_t i = static_cast<std::size_t>(row) * width + col;
+      const float* ray = rays.data() + i * 3;
+      // the point, shifted into the RGB optic frame, through the pinhole
+      const float u = fx * (d * ray[0] - baseline) / (d * ray[2]) + pin.parameters[2] - 0.5F;
+      if (u < 0.0F || u > static_cast<float>(width - 1))
+      {
+        continue;
+      }
+      EXPECT_NEAR(out[i * 3] / 8.0F, u, 1.0F / 8.0F) << "pixel " << col << ", " << row;
+      EXPECT_EQ(out[i * 3 + 1], rgb[i * 3 + 1]) << "pixel " << col << ", " << row;
+    }
+  }
+}
+
+TEST(RgbRegistration, SamplesDownscaledImages)
+{
+  WorkerPool pool(2);
+  RgbRegistration registration;
+  ASSERT_TRUE(registration.configure(calibration(0.0F), width, height, calibration(0.0F)));
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  std::vector<float> distance(n, 3.0F);
+  const auto rgb = coordinate_image(width / 2, height / 2);
+  std::vector<std::uint8_t> out(n * 3);
+  registration(distance.data(), rgb.data(), width / 2, height / 2, 2, out.data(), pool);
+
+  // interior pixels fall between the pixels of the half resolution image
+  for (std::uint32_t row = 1; row + 1 < height; ++row)
+  {
+    for (std::uint32_t col = 1; col + 1 < width; ++col)
+    {
+      const std::size_t i = static_cast<std::size_t>(row) * width + col;
+      EXPECT_NEAR(out[i * 3], 8.0F * ((col + 0.5F) / 2.0F - 0.5F), 1.0F) << "pixel " << col << ", " << row;
+      EXPECT_NEAR(out[i * 3 + 1], 8.0F * ((row + 0.5F) / 2.0F - 0.5F), 1.0F) << "pixel " << col << ", " << row;
+    }
+  }
+}
+
+TEST(RgbRegistration, RejectsUnsupportedModels)
+{
+  auto rgb = calibration(0.0F);
+  rgb.intrinsics.model_id = 1;
+  RgbRegistration registration;
+  EXPECT_FALSE(registration.configure(calibration(0.0F), width, height, rgb));
+}
+
+TEST(ColorFrameExchange, SharedByName)
+{
+  auto a = ColorFrameExchange::acquire("left");
+  auto b = ColorFrameExchange::acquire("left");
+  auto c = ColorFrameExchange::acquire("right");
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+
+  // released with its last user
+  std::weak_ptr<ColorFrameExchange> weak = a;
+  a.reset();
+  b.reset();
+  EXPECT_TRUE(weak.expired());
+  EXPECT_EQ(ColorFrameExchange::acquire("left")->latest(), nullptr);
+}
+
+}  // namespace
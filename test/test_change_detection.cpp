@@ -0,0 +1,196 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/change_detection.hpp>
+
+namespace
+{
+using ifm3d_ros2::ChangeDetector;
+
+// 2 x 2 tiles of 4 pixels, clipped to 3 pixels in the last column / row
+constexpr std::uint32_t width = 7;
+constexpr std::uint32_t height = 7;
+constexpr std::size_t n = width * height;
+
+ChangeDetector::Params params()
+{
+  ChangeDetector::Params result;
+  result.tile_size = 4;
+  result.threshold_abs = 0.02F;
+  result.threshold_rel = 0.01F;
+  result.min_fraction = 0.0F;  // a single pixel changes a tile
+  return result;
+}
+
+std::vector<float> flat(float distance)
+{
+  return std::vector<float>(n, distance);
+}
+
+float& at(std::vector<float>& image, std::uint32_t x, std::uint32_t y)
+{
+  return image[static_cast<std::size_t>(y) * width + x];
+}
+
+TEST(ChangeDetection, FlagsChangedPixels)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const std::vector<float> ref{ 1.0F, 1.0F, 1.0F, 2.0F, 0.0F, nan, 1.0F, 1.0F, 0.0F };
+  const std::vector<float> cur{ 1.02F, 1.04F, 0.96F, 2.035F, 0.0F, 1.0F, nan, -1.0F, nan };
+  // within abs + rel * ref: 0.03 at 1 m, 0.04 at 2 m; turning (in)valid
+  // changes, staying invalid does not
+  const std::vector<std::uint8_t> expected{ 0, 1, 1, 0, 0, 1, 1, 1, 0 };
+  std::vector<std::uint8_t> changed(ref.size(), 7);
+  ifm3d_ros2::flag_changed_pixels(cur.data(), ref.data(), changed.data(), ref.size(), 0.02F, 0.01F);
+  EXPECT_EQ(changed, expected);
+}
+
+TEST(ChangeDetection, FirstFrameIsAKeyframe)
+{
+  ChangeDetector detector;
+  detector.configure(params());
+  const auto image = flat(1.0F);
+
+  auto result = detector.compare(image.data(), width, height, false);
+  EXPECT_TRUE(result.keyframe);
+  EXPECT_EQ(result.tiles_changed, 4U);
+  EXPECT_EQ(detector.tiles_x(), 2U);
+  EXPECT_EQ(detector.tiles_y(), 2U);
+  EXPECT_EQ(detector.tile_map(), (std::vector<std::uint8_t>{ 1, 1, 1, 1 }));
+  detector.commit(image.data(), true);
+
+  result = detector.compare(image.data(), width, height, false);
+  EXPECT_FALSE(result.keyframe);
+  EXPECT_EQ(result.tiles_changed, 0U);
+
+  // forced, after a reset and on a new size
+  EXPECT_TRUE(detector.compare(image.data(), width, height, true).keyframe);
+  detector.reset();
+  EXPECT_TRUE(detector.compare(image.data(), width, height, false).keyframe);
+  detector.commit(image.data(), true);
+  EXPECT_TRUE(detector.compare(image.data(), width, height - 1, false).keyframe);
+}
+
+TEST(ChangeDetection, FlagsTheTilesOfChangedPixels)
+{
+  ChangeDetector detector;
+  detector.configure(params());
+  auto image = flat(1.0F);
+  detector.compare(image.data(), width, height, false);
+  detector.commit(image.data(), true);
+
+  // the last (clipped) tile and the top left one
+  at(image, 6, 6) = 1.5F;
+  at(image, 1, 2) = 0.5F;
+  const auto result = detector.compare(image.data(), width, height, false);
+  EXPECT_FALSE(result.keyframe);
+  EXPECT_EQ(result.tiles_changed, 2U);
+  EXPECT_EQ(detector.tile_map(), (std::vector<std::uint8_t>{ 1, 0, 0, 1 }));
+
+  // tiles of 16 pixels (9 clipped), more than 10 % must change
+  auto fraction = params();
+  fraction.min_fraction = 0.1F;
+  detector.configure(fraction);
+  detector.compare(flat(1.0F).data(), width, height, false);
+  detector.commit(flat(1.0F).data(), true);
+  image = flat(1.0F);
+  at(image, 0, 0) = 2.0F;
+  at(image, 6, 6) = 2.0F;
+  EXPECT_EQ(detector.compare(image.data(), width, height, false).tiles_changed, 1U);
+  EXPECT_EQ(detector.tile_map(), (std::vector<std::uint8_t>{ 0, 0, 0, 1 }));
+  at(image, 1, 0) = 2.0F;
+  EXPECT_EQ(detector.compare(image.data(), width, height, false).tiles_changed, 2U);
+}
+
+TEST(ChangeDetection, CommitsOnlyTheFlaggedTiles)
+{
+  ChangeDetector detector;
+  detector.configure(params());
+  detector.compare(flat(1.0F).data(), width, height, false);
+  detector.commit(flat(1.0F).data(), true);
+
+  // a slow drift: each frame is compared against the last committed one,
+  // not against the previous frame, so it is caught in the end
+  for (const float drift : { 1.01F, 1.02F, 1.04F })
+  {
+    const auto image = flat(drift);
+    const auto result = detector.compare(image.data(), width, height, false);
+    detector.commit(image.data(), false);
+    EXPECT_EQ(result.tiles_changed, drift < 1.03F ? 0U : 4U) << drift;
+  }
+
+  // only the flagged (top left) tile makes it into the reference
+  auto image = flat(1.04F);
+  for (std::uint32_t y = 0; y < 4; ++y)
+  {
+    for (std::uint32_t x = 0; x < 4; ++x)
+    {
+      at(image, x, y) = 2.0F;
+    }
+  }
+  ASSERT_EQ(detector.compare(image.data(), width, height, false).tiles_changed, 1U);
+  detector.commit(image.data(), false);
+  const auto everywhere = flat(2.0F);
+  EXPECT_EQ(detector.compare(everywhere.data(), width, height, false).tiles_changed, 3U);
+  EXPECT_EQ(detector.tile_map(), (std::vector<std::uint8_t>{ 0, 1, 1, 1 }));
+
+  // not committing keeps the reference as it is
+  EXPECT_EQ(detector.compare(everywhere.data(), width, height, false).tiles_changed, 3U);
+  detector.commit(everywhere.data(), true);
+  EXPECT_EQ(detector.compare(everywhere.data(), width, height, false).tiles_changed, 0U);
+}
+
+TEST(ChangeDetection, AppendsTheChangedTiles)
+{
+  ChangeDetector detector;
+  detector.configure(params());
+  detector.compare(flat(1.0F).data(), width, height, false);
+  detector.commit(flat(1.0F).data(), true);
+
+  auto image = flat(1.0F);
+  for (std::uint32_t y = 0; y < height; ++y)
+  {
+    for (std::uint32_t x = 0; x < width; ++x)
+    {
+      at(image, x, y) = 2.0F + static_cast<float>(y * width + x);
+    }
+  }
+  // the top left tile did not change, all others did
+  for (std::uint32_t y = 0; y < 4; ++y)
+  {
+    for (std::uint32_t x = 0; x < 4; ++x)
+    {
+      at(image, x, y) = 1.0F;
+    }
+  }
+  ASSERT_EQ(detector.compare(image.data(), width, height, false).tiles_changed, 3U);
+
+  std::vector<float> tiles{ -1.0F };
+  detector.append_changed_tiles(image.data(), tiles);
+  // top right 3 x 4, bottom left 4 x 3, bottom right 3 x 3
+  ASSERT_EQ(tiles.size(), 1U + 12U + 12U + 9U);
+  EXPECT_EQ(tiles[0], -1.0F);
+  std::vector<float> expected{ -1.0F };
+  for (const auto& tile : { std::vector<std::uint32_t>{ 4, 7, 0, 4 }, std::vector<std::uint32_t>{ 0, 4, 4, 7 },
+                            std::vector<std::uint32_t>{ 4, 7, 4, 7 } })
+  {
+    for (std::uint32_t y = tile[2]; y < tile[3]; ++y)
+    {
+      for (std::uint32_t x = tile[0]; x < tile[1]; ++x)
+      {
+        expected.push_back(at(image, x, y));
+      }
+    }
+  }
+  EXPECT_EQ(tiles, expected);
+}
+
+}  // namespace
@@ -0,0 +1,139 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/confidence.hpp>
+
+namespace
+{
+using ifm3d_ros2::ConfidenceBits;
+using ifm3d_ros2::ConfidenceMask;
+using ifm3d_ros2::num_confidence_masks;
+
+// more than two blocks of 1024 pixels, the last one partial
+constexpr std::size_t n = 2500;
+
+// invalid (bit 0), saturated (bit 1), low amplitude (bits 2 and 3), out of
+// range (bit 9, beyond 8 bit images)
+const ConfidenceBits bits{ { 0x0001, 0x0002, 0x000C, 0x0200 } };
+
+template <typename T>
+std::vector<T> confidence()
+{
+  std::vector<T> conf(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    conf[i] = static_cast<T>((i * 37) & 0x3FF);
+  }
+  return conf;
+}
+
+/**
+ * Decodes `conf` into all masks (but `skipped`) and compares them to a test
+ * of the bits pixel by pixel.
+ */
+template <typename T>
+void expect_decoded(const std::vector<T>& conf, std::size_t skipped)
+{
+  std::array<std::vector<std::uint8_t>, num_confidence_masks> masks;
+  std::array<std::uint8_t*, num_confidence_masks> out{};
+  for (std::size_t m = 0; m < num_confidence_masks; ++m)
+  {
+    masks[m].assign(n, 7);
+    out[m] = m == skipped ? nullptr : masks[m].data();
+  }
+  ifm3d_ros2::decode_confidence(conf.data(), n, bits, out);
+
+  for (std::size_t m = 0; m < num_confidence_masks; ++m)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      if (m == skipped)
+      {
+        ASSERT_EQ(masks[m][i], 7) << "mask " << m << ", pixel " << i;
+        continue;
+      }
+      const bool any = (static_cast<std::uint32_t>(conf[i]) & bits[m]) != 0;
+      const bool set = m == static_cast<std::size_t>(ConfidenceMask::VALID) ? !any : any;
+      ASSERT_EQ(masks[m][i], set ? 255 : 0) << "mask " << m << ", pixel " << i;
+    }
+  }
+}
+
+TEST(Confidence, Decodes16BitPixels)
+{
+  const auto conf = confidence<std::uint16_t>();
+  expect_decoded(conf, num_confidence_masks);
+  expect_decoded(conf, static_cast<std::size_t>(ConfidenceMask::SATURATED));
+}
+
+TEST(Confidence, Decodes8BitPixels)
+{
+  const auto conf = confidence<std::uint8_t>();
+  expect_decoded(conf, static_cast<std::size_t>(ConfidenceMask::VALID));
+
+  // bit 9 never matches 8 bit pixels
+  std::vector<std::uint8_t> out_of_range(n, 1);
+  std::array<std::uint8_t*, num_confidence_masks> out{};
+  out[static_cast<std::size_t>(ConfidenceMask::OUT_OF_RANGE)] = out_of_range.data();
+  ifm3d_ros2::decode_confidence(conf.data(), n, bits, out);
+  EXPECT_EQ(out_of_range, std::vector<std::uint8_t>(n, 0));
+
+  EXPECT_TRUE(ifm3d_ros2::confidence_bits_fit(bits, 2));
+  EXPECT_FALSE(ifm3d_ros2::confidence_bits_fit(bits, 1));
+  EXPECT_TRUE(ifm3d_ros2::confidence_bits_fit(ConfidenceBits{ { 0x01, 0x02, 0x0C, 0x80 } }, 1));
+}
+
+TEST(Confidence, MaskNames)
+{
+  for (std::size_t m = 0; m < num_confidence_masks; ++m)
+  {
+    const auto mask = static_cast<ConfidenceMask>(m);
+    ConfidenceMask parsed = ConfidenceMask::VALID;
+    ASSERT_TRUE(ifm3d_ros2::parse_confidence_mask(ifm3d_ros2::confidence_mask_name(mask), parsed));
+    EXPECT_EQ(parsed, mask);
+  }
+  EXPECT_STREQ(ifm3d_ros2::confidence_mask_name(ConfidenceMask::LOW_AMPLITUDE), "low_amplitude");
+
+  ConfidenceMask parsed = ConfidenceMask::SATURATED;
+  EXPECT_FALSE(ifm3d_ros2::parse_confidence_mask("Valid", parsed));
+  EXPECT_FALSE(ifm3d_ros2::parse_confidence_mask("", parsed));
+  EXPECT_EQ(parsed, ConfidenceMask::SATURATED);
+}
+
+TEST(Confidence, ExcludesPoints)
+{
+  const std::vector<std::uint16_t> conf{ 0x0000, 0x0001, 0x0100, 0x0003, 0x0200 };
+  std::vector<float> xyz(conf.size() * 3);
+  for (std::size_t i = 0; i < xyz.size(); ++i)
+  {
+    xyz[i] = 0.5F + static_cast<float>(i);
+  }
+  ifm3d_ros2::exclude_points(xyz.data(), conf.data(), conf.size(), 0x0201);
+
+  const bool dropped[] = { false, true, false, true, true };
+  for (std::size_t i = 0; i < conf.size(); ++i)
+  {
+    for (std::size_t c = 0; c < 3; ++c)
+    {
+      if (dropped[i])
+      {
+        EXPECT_TRUE(std::isnan(xyz[i * 3 + c])) << "point " << i;
+      }
+      else
+      {
+        EXPECT_EQ(xyz[i * 3 + c], 0.5F + static_cast<float>(i * 3 + c)) << "point " << i;
+      }
+    }
+  }
+}
+
+}  // namespace
@@ -0,0 +1,108 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/conversions.hpp>
+
+namespace
+{
+using ifm3d_ros2::PointTransform;
+
+const float nan = std::numeric_limits<float>::quiet_NaN();
+
+// 90 degrees about z, then 1 m up
+const PointTransform transform{ { 0, -1, 0, 0.5F,  //
+                                  1, 0, 0, 0,      //
+                                  0, 0, 1, 1 } };
+
+// a valid point, an invalid one (the origin) and a NaN one
+const std::vector<float> points{ 1.0F, 2.0F, 3.0F, 0.0F, 0.0F, 0.0F, nan, nan, nan };
+
+TEST(Conversions, TransformKeepsInvalidPoints)
+{
+  std::vector<float> out(points.size());
+  ifm3d_ros2::transform_points(transform, points.data(), out.data(), 3);
+
+  EXPECT_FLOAT_EQ(out[0], -1.5F);
+  EXPECT_FLOAT_EQ(out[1], 1.0F);
+  EXPECT_FLOAT_EQ(out[2], 4.0F);
+  for (std::size_t i = 3; i < 6; ++i)
+  {
+    EXPECT_EQ(out[i], 0.0F) << "the origin moved to the translation";
+  }
+  for (std::size_t i = 6; i < 9; ++i)
+  {
+    EXPECT_TRUE(std::isnan(out[i]));
+  }
+}
+
+TEST(Conversions, NoiseFilterKeepsInvalidPoints)
+{
+  const std::vector<float> noise{ 0.01F, 0.01F, 0.01F };
+  for (const bool with_sigma : { false, true })
+  {
+    for (const PointTransform* m : { static_cast<const PointTransform*>(nullptr), &transform })
+    {
+      const std::size_t stride = with_sigma ? 4 : 3;
+      std::vector<float> out(3 * stride);
+      ifm3d_ros2::filter_noisy_points(points.data(), noise.data(), out.data(), 3, 1.0F, with_sigma, m);
+
+      EXPECT_FLOAT_EQ(out[0], m != nullptr ? -1.5F : 1.0F);
+      for (std::size_t c = 0; c < 3; ++c)
+      {
+        EXPECT_EQ(out[stride + c], 0.0F);
+        EXPECT_TRUE(std::isnan(out[2 * stride + c]));
+      }
+    }
+  }
+}
+
+TEST(Conversions, TransformedPointsQuantizeInvalidToZero)
+{
+  std::vector<float> transformed(points.size());
+  ifm3d_ros2::transform_points(transform, points.data(), transformed.data(), 3);
+  std::vector<std::int16_t> mm(points.size());
+  ifm3d_ros2::quantize_mm16(transformed.data(), mm.data(), mm.size());
+
+  EXPECT_EQ(mm[0], -1500);
+  EXPECT_EQ(mm[1], 1000);
+  EXPECT_EQ(mm[2], 4000);
+  for (std::size_t i = 3; i < mm.size(); ++i)
+  {
+    EXPECT_EQ(mm[i], 0);
+  }
+}
+
+TEST(Conversions, DistanceToMillimeters)
+{
+  const float inf = std::numeric_limits<float>::infinity();
+  // rounded to the nearest millimeter; below 1 mm, negative and NaN are
+  // invalid (0); beyond 65.535 m saturated
+  const std::vector<float> meters{ 1.2344F, 1.2346F, 0.0F, 0.0004F, 0.0006F, -1.0F, nan, 65.535F, 70.0F, inf };
+  const std::vector<std::uint16_t> expected{ 1234, 1235, 0, 0, 1, 0, 0, 65535, 65535, 65535 };
+
+  // long enough for the vectorized loop and its remainder
+  std::vector<float> src;
+  std::vector<std::uint16_t> want;
+  for (int repeat = 0; repeat < 7; ++repeat)
+  {
+    src.insert(src.end(), meters.begin(), meters.end());
+    want.insert(want.end(), expected.begin(), expected.end());
+  }
+  std::vector<std::uint16_t> mm(src.size(), 42);
+  ifm3d_ros2::distance_to_mm16(src.data(), mm.data(), src.size());
+  for (std::size_t i = 0; i < mm.size(); ++i)
+  {
+    EXPECT_EQ(mm[i], want[i]) << src[i] << " m";
+  }
+}
+
+}  // namespace
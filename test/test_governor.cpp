@@ -0,0 +1,192 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/governor.hpp>
+#include <ifm3d_ros2/thread_accounting.hpp>
+
+namespace
+{
+using ifm3d_ros2::FrameRateGovernor;
+using ifm3d_ros2::GovernorAction;
+using ifm3d_ros2::GovernorInputs;
+using ifm3d_ros2::GovernorLimits;
+using ifm3d_ros2::HostCpuSampler;
+
+GovernorInputs figures(double host_cpu_load, double publish_latency, double loop_load)
+{
+  GovernorInputs inputs;
+  inputs.host_cpu_load = host_cpu_load;
+  inputs.publish_latency = publish_latency;
+  inputs.loop_load = loop_load;
+  return inputs;
+}
+
+// well clear of the default limits, also at the higher rates
+const GovernorInputs calm = figures(0.1, 0.001, 0.05);
+
+TEST(FrameRateGovernor, DegradesOneLevelPerPeriodUpToMaxLevel)
+{
+  GovernorLimits limits;
+  limits.max_level = 2;
+  FrameRateGovernor governor(limits);
+  EXPECT_EQ(governor.level(), 0);
+  EXPECT_DOUBLE_EQ(governor.rate_factor(), 1.0);
+
+  EXPECT_EQ(governor.update(figures(0.9, 0.001, 0.1)), GovernorAction::DEGRADE);
+  EXPECT_EQ(governor.level(), 1);
+  EXPECT_DOUBLE_EQ(governor.rate_factor(), 0.5);
+  EXPECT_EQ(governor.update(figures(0.1, 0.02, 0.1)), GovernorAction::DEGRADE);
+  EXPECT_EQ(governor.level(), 2);
+
+  EXPECT_EQ(governor.update(figures(0.1, 0.001, 0.95)), GovernorAction::HOLD);
+  EXPECT_EQ(governor.level(), 2);
+  EXPECT_NE(governor.reason().find("lowest rate"), std::string::npos) << governor.reason();
+}
+
+TEST(FrameRateGovernor, ClampsTheLimits)
+{
+  GovernorLimits limits;
+  limits.max_level = -1;
+  limits.restore_periods = 0;
+  FrameRateGovernor governor(limits);
+  EXPECT_EQ(governor.update(figures(1.0, 1.0, 1.0)), GovernorAction::HOLD);
+  EXPECT_EQ(governor.level(), 0);
+}
+
+TEST(FrameRateGovernor, RestoresAfterCalmPeriodsInARow)
+{
+  GovernorLimits limits;
+  limits.restore_periods = 3;
+  FrameRateGovernor governor(limits);
+  governor.update(figures(0.9, 0.0, 0.0));
+  governor.update(figures(0.9, 0.0, 0.0));
+  ASSERT_EQ(governor.level(), 2);
+
+  EXPECT_EQ(governor.update(calm), GovernorAction::HOLD);
+  EXPECT_EQ(governor.update(calm), GovernorAction::HOLD);
+  EXPECT_EQ(governor.update(calm), GovernorAction::RESTORE);
+  EXPECT_EQ(governor.level(), 1);
+
+  // a period without headroom starts the count again
+  EXPECT_EQ(governor.update(calm), GovernorAction::HOLD);
+  EXPECT_EQ(governor.update(calm), GovernorAction::HOLD);
+  EXPECT_EQ(governor.update(figures(0.7, 0.001, 0.05)), GovernorAction::HOLD);
+  EXPECT_EQ(governor.level(), 1);
+  EXPECT_EQ(governor.update(calm), GovernorAction::HOLD);
+  EXPECT_EQ(governor.update(calm), GovernorAction::HOLD);
+  EXPECT_EQ(governor.update(calm), GovernorAction::RESTORE);
+  EXPECT_EQ(governor.level(), 0);
+
+  // nothing to restore at the nominal rate
+  EXPECT_EQ(governor.update(calm), GovernorAction::HOLD);
+  EXPECT_EQ(governor.level(), 0);
+}
+
+TEST(FrameRateGovernor, HoldsBetweenTheLimits)
+{
+  GovernorLimits limits;
+  limits.restore_periods = 1;
+  FrameRateGovernor governor(limits);
+  governor.update(figures(0.9, 0.0, 0.0));
+  ASSERT_EQ(governor.level(), 1);
+
+  // neither above the degrade limits nor below the restore limits
+  for (const auto& inputs : { figures(0.7, 0.001, 0.05), figures(0.1, 0.007, 0.05), figures(0.1, 0.001, 0.4) })
+  {
+    EXPECT_EQ(governor.update(inputs), GovernorAction::HOLD) << governor.reason();
+    EXPECT_EQ(governor.level(), 1);
+  }
+
+  // the loop load doubles at the higher rate: 0.3 -> 0.6, below 80 % of 0.9
+  EXPECT_EQ(governor.update(figures(0.1, 0.001, 0.3)), GovernorAction::RESTORE);
+  EXPECT_EQ(governor.level(), 0);
+}
+
+TEST(FrameRateGovernor, Reset)
+{
+  FrameRateGovernor governor;
+  governor.update(figures(0.9, 0.0, 0.0));
+  governor.update(calm);
+  governor.reset();
+  EXPECT_EQ(governor.level(), 0);
+  EXPECT_TRUE(governor.reason().empty());
+
+  // the calm periods start over as well
+  GovernorLimits limits;
+  limits.restore_periods = 2;
+  FrameRateGovernor other(limits);
+  other.update(figures(0.9, 0.0, 0.0));
+  other.update(calm);
+  other.reset();
+  other.update(figures(0.9, 0.0, 0.0));
+  EXPECT_EQ(other.update(calm), GovernorAction::HOLD);
+  EXPECT_EQ(other.update(calm), GovernorAction::RESTORE);
+}
+
+/**
+ * A `/proc/stat` of its own, rewritten for every sample.
+ */
+class HostCpuSamplerTest : public ::testing::Test
+{
+protected:
+  void write(const std::string& line)
+  {
+    std::ofstream out(this->path_, std::ios::trunc);
+    out << line << "\ncpu0 1 2 3 4 5 6 7 8 9 10\nintr 12345\n";
+  }
+
+  void TearDown() override
+  {
+    std::remove(this->path_.c_str());
+  }
+
+  const std::string path_ = ::testing::TempDir() + "ifm3d_ros2_proc_stat";
+};
+
+TEST_F(HostCpuSamplerTest, BusyFractionSinceTheLastSample)
+{
+  HostCpuSampler sampler(this->path_);
+  // user nice system idle iowait irq softirq steal (guest fields ignored)
+  this->write("cpu  100 0 100 700 100 0 0 0 50 0");
+  EXPECT_EQ(sampler.sample(), 0.0);
+
+  // 300 of 400 jiffies busy
+  this->write("cpu  300 0 200 780 120 0 0 0 50 0");
+  EXPECT_DOUBLE_EQ(sampler.sample(), 0.75);
+
+  // all idle or waiting for I/O
+  this->write("cpu  300 0 200 880 220 0 0 0 50 0");
+  EXPECT_DOUBLE_EQ(sampler.sample(), 0.0);
+
+  // irq, softirq and steal are busy as well
+  this->write("cpu  300 0 200 880 220 10 10 20 50 0");
+  EXPECT_DOUBLE_EQ(sampler.sample(), 1.0);
+}
+
+TEST_F(HostCpuSamplerTest, NoLoadWithoutAValidPreviousSample)
+{
+  HostCpuSampler sampler(this->path_);
+  this->write("cpu  300 0 200 780 120 0 0 0");
+  sampler.sample();
+
+  // the counters went backwards (e.g., another host's file)
+  this->write("cpu  100 0 100 700 100 0 0 0");
+  EXPECT_EQ(sampler.sample(), 0.0);
+
+  this->write("intr 12345");
+  EXPECT_EQ(sampler.sample(), 0.0);
+
+  HostCpuSampler missing(this->path_ + "_missing");
+  EXPECT_EQ(missing.sample(), 0.0);
+  EXPECT_EQ(missing.sample(), 0.0);
+}
+
+}  // namespace
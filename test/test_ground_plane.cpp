@@ -0,0 +1,175 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/ground_plane.hpp>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace
+{
+using ifm3d_ros2::GroundPlaneEstimator;
+using ifm3d_ros2::Plane;
+using ifm3d_ros2::WorkerPool;
+
+// tilted by about 6 degrees, 1.2 m below the sensor
+Plane tilted()
+{
+  const float norm = std::sqrt(0.1F * 0.1F + 0.05F * 0.05F + 1.0F);
+  return Plane{ -0.1F / norm, 0.05F / norm, 1.0F / norm, 1.2F / norm };
+}
+
+/**
+ * `ground` points on `plane` with up to 1 cm of noise, `outliers` points
+ * above it (boxes, walls) and a few invalid ones.
+ */
+std::vector<float> cloud(const Plane& plane, std::size_t ground, std::size_t outliers)
+{
+  std::mt19937 rng(42U);
+  std::uniform_real_distribution<float> lateral(-3.0F, 3.0F);
+  std::uniform_real_distribution<float> noise(-0.01F, 0.01F);
+  std::uniform_real_distribution<float> height(0.1F, 2.0F);
+
+  std::vector<float> xyz;
+  const auto on_plane = [&](float x, float y, float offset) {
+    // solve `a x + b y + c z + d = offset` for z
+    const float z = (offset - plane.d - plane.a * x - plane.b * y) / plane.c;
+    xyz.insert(xyz.end(), { x, y, z });
+  };
+  for (std::size_t i = 0; i < ground; ++i)
+  {
+    on_plane(lateral(rng) + 4.0F, lateral(rng), noise(rng));
+  }
+  for (std::size_t i = 0; i < outliers; ++i)
+  {
+    on_plane(lateral(rng) + 4.0F, lateral(rng), height(rng));
+  }
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  xyz.insert(xyz.end(), { 0.0F, 0.0F, 0.0F, nan, nan, nan });
+  return xyz;
+}
+
+GroundPlaneEstimator::Params params()
+{
+  GroundPlaneEstimator::Params result;
+  result.threshold = 0.03F;
+  // no early stop on slow (e.g., instrumented) builds
+  result.time_budget = std::chrono::seconds(10);
+  return result;
+}
+
+void expect_plane_near(const Plane& actual, const Plane& expected)
+{
+  EXPECT_NEAR(actual.a, expected.a, 0.005F);
+  EXPECT_NEAR(actual.b, expected.b, 0.005F);
+  EXPECT_NEAR(actual.c, expected.c, 0.001F);
+  EXPECT_NEAR(actual.d, expected.d, 0.005F);
+}
+
+TEST(GroundPlane, FindsATiltedPlaneAmongOutliers)
+{
+  const auto plane = tilted();
+  const auto xyz = cloud(plane, 7000, 3000);
+  const std::size_t n = xyz.size() / 3;
+  WorkerPool pool(2);
+  GroundPlaneEstimator estimator;
+  estimator.configure(params());
+
+  auto result = estimator.estimate(xyz.data(), n, pool);
+  ASSERT_TRUE(result.valid);
+  EXPECT_FALSE(result.seeded);
+  EXPECT_FALSE(result.timed_out);
+  EXPECT_EQ(result.points, 10000U);
+  // (nearly) all ground points, none of the outliers
+  EXPECT_GE(result.inliers, 6900U);
+  EXPECT_LE(result.inliers, 7000U);
+  expect_plane_near(result.plane, plane);
+
+  // the next frame starts from the plane found
+  result = estimator.estimate(xyz.data(), n, pool);
+  ASSERT_TRUE(result.valid);
+  EXPECT_TRUE(result.seeded);
+  expect_plane_near(result.plane, plane);
+
+  estimator.reset();
+  EXPECT_FALSE(estimator.estimate(xyz.data(), n, pool).seeded);
+}
+
+TEST(GroundPlane, NormalPointsUp)
+{
+  // the same plane, its normal given the other way round
+  const auto plane = tilted();
+  const Plane flipped{ -plane.a, -plane.b, -plane.c, -plane.d };
+  const auto xyz = cloud(flipped, 2000, 0);
+  WorkerPool pool(0);
+  GroundPlaneEstimator estimator;
+  estimator.configure(params());
+
+  const auto result = estimator.estimate(xyz.data(), xyz.size() / 3, pool);
+  ASSERT_TRUE(result.valid);
+  expect_plane_near(result.plane, plane);
+}
+
+TEST(GroundPlane, RejectsTooSteepOrTooFewPoints)
+{
+  WorkerPool pool(0);
+  GroundPlaneEstimator estimator;
+  estimator.configure(params());
+
+  // a wall 3 m in front of the sensor
+  std::vector<float> wall;
+  for (int y = -20; y < 20; ++y)
+  {
+    for (int z = -20; z < 20; ++z)
+    {
+      wall.insert(wall.end(), { 3.0F, 0.05F * static_cast<float>(y), 0.05F * static_cast<float>(z) });
+    }
+  }
+  EXPECT_FALSE(estimator.estimate(wall.data(), wall.size() / 3, pool).valid);
+
+  // the ground, but mostly clutter
+  auto p = params();
+  p.min_inlier_ratio = 0.5F;
+  estimator.configure(p);
+  const auto clutter = cloud(tilted(), 300, 1000);
+  EXPECT_FALSE(estimator.estimate(clutter.data(), clutter.size() / 3, pool).valid);
+
+  const std::vector<float> two{ 1.0F, 0.0F, -1.0F, 2.0F, 0.0F, -1.0F };
+  EXPECT_FALSE(estimator.estimate(two.data(), 2, pool).valid);
+  EXPECT_FALSE(estimator.estimate(nullptr, 0, pool).valid);
+}
+
+TEST(GroundPlane, SplitsGroundFromObstacles)
+{
+  const auto plane = tilted();
+  const auto xyz = cloud(plane, 500, 200);
+  WorkerPool pool(2);
+  GroundPlaneEstimator estimator;
+  estimator.configure(params());
+
+  std::vector<float> ground{ 1.0F };
+  std::vector<float> obstacles;
+  estimator.split(xyz.data(), xyz.size() / 3, plane, ground, obstacles, pool);
+  // the invalid points are neither
+  EXPECT_EQ(ground.size(), 500U * 3);
+  EXPECT_EQ(obstacles.size(), 200U * 3);
+  for (std::size_t i = 0; i < ground.size(); i += 3)
+  {
+    EXPECT_LT(std::fabs(plane.distance(ground[i], ground[i + 1], ground[i + 2])), 0.03F);
+  }
+  for (std::size_t i = 0; i < obstacles.size(); i += 3)
+  {
+    EXPECT_GE(std::fabs(plane.distance(obstacles[i], obstacles[i + 1], obstacles[i + 2])), 0.03F);
+  }
+}
+
+}  // namespace
@@ -0,0 +1,287 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/guided_filter.hpp>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace
+{
+using ifm3d_ros2::GuidedFilter;
+using ifm3d_ros2::WorkerPool;
+
+constexpr float tolerance = 2e-5F;  // meters
+
+bool is_valid(float distance)
+{
+  return distance > 0.0F;  // NaN compares false
+}
+
+/**
+ * The guided filter straight from its definition, in double precision: every
+ * window fits the distance of its valid pixels as a linear function of the
+ * guide, and a valid pixel gets the mean of the models of the valid windows
+ * covering it.
+ */
+template <typename T>
+std::vector<double> reference(const std::vector<float>& distance, const std::vector<T>& amplitude, int width,
+                              int height, int radius, double eps)
+{
+  const auto n = distance.size();
+  double sum = 0.0;
+  double count = 0.0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (is_valid(distance[i]) && amplitude[i] > 0)
+    {
+      sum += static_cast<double>(amplitude[i]);
+      count += 1.0;
+    }
+  }
+  std::vector<double> guide(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    guide[i] = std::max(static_cast<double>(amplitude[i]), 0.0) * (sum > 0.0 ? count / sum : 0.0);
+  }
+
+  const auto window = [&](int x, int y, auto&& fn) {
+    for (int wy = std::max(0, y - radius); wy <= std::min(height - 1, y + radius); ++wy)
+    {
+      for (int wx = std::max(0, x - radius); wx <= std::min(width - 1, x + radius); ++wx)
+      {
+        const auto j = static_cast<std::size_t>(wy) * width + wx;
+        if (is_valid(distance[j]))
+        {
+          fn(j);
+        }
+      }
+    }
+  };
+
+  std::vector<double> a(n, 0.0);
+  std::vector<double> b(n, 0.0);
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      double wn = 0.0, si = 0.0, sp = 0.0, sii = 0.0, sip = 0.0;
+      window(x, y, [&](std::size_t j) {
+        wn += 1.0;
+        si += guide[j];
+        sp += distance[j];
+        sii += guide[j] * guide[j];
+        sip += guide[j] * distance[j];
+      });
+      if (wn == 0.0)
+      {
+        continue;
+      }
+      const double mi = si / wn;
+      const double mp = sp / wn;
+      const auto k = static_cast<std::size_t>(y) * width + x;
+      a[k] = (sip / wn - mi * mp) / (sii / wn - mi * mi + eps);
+      b[k] = mp - a[k] * mi;
+    }
+  }
+
+  std::vector<double> out(distance.begin(), distance.end());
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      const auto i = static_cast<std::size_t>(y) * width + x;
+      if (!is_valid(distance[i]))
+      {
+        continue;
+      }
+      double wn = 0.0, q = 0.0;
+      window(x, y, [&](std::size_t k) {
+        wn += 1.0;
+        q += a[k] * guide[i] + b[k];
+      });
+      out[i] = q / wn;
+    }
+  }
+  return out;
+}
+
+/**
+ * A slanted plane (1 .. 2 m) with noise and a step, seen with an amplitude
+ * that has the same step, plus invalid pixels: a few 0 and NaN ones, and an
+ * invalid column and row crossing the image.
+ */
+struct Scene
+{
+  int width;
+  int height;
+  std::vector<float> distance;
+  std::vector<std::uint16_t> amplitude;
+};
+
+Scene make_scene(int width, int height)
+{
+  Scene scene{ width, height, {}, {} };
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0F, 0.005F);
+  std::uniform_int_distribution<int> amp_noise(-40, 40);
+
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      const bool near = x < width / 2;
+      scene.distance.push_back((near ? 1.0F : 1.5F) + 0.3F * y / height + noise(rng));
+      scene.amplitude.push_back(static_cast<std::uint16_t>((near ? 1200 : 400) + 10 * x + amp_noise(rng)));
+    }
+  }
+  for (int y = 0; y < height; ++y)
+  {
+    scene.distance[static_cast<std::size_t>(y) * width + width / 3] = 0.0F;
+  }
+  for (int x = 0; x < width; ++x)
+  {
+    scene.distance[static_cast<std::size_t>(height / 2) * width + x] = std::numeric_limits<float>::quiet_NaN();
+  }
+  scene.distance[0] = 0.0F;
+  scene.distance[5] = std::numeric_limits<float>::quiet_NaN();
+  scene.distance[static_cast<std::size_t>(width) * 3 + 7] = 0.0F;
+  scene.amplitude[static_cast<std::size_t>(width) * 4 + 9] = 0;  // valid distance, no guide
+  return scene;
+}
+
+void expect_matches_reference(const Scene& scene, const std::vector<float>& out, const std::vector<double>& expected)
+{
+  for (std::size_t i = 0; i < out.size(); ++i)
+  {
+    const auto x = static_cast<int>(i % scene.width);
+    const auto y = static_cast<int>(i / scene.width);
+    if (std::isnan(scene.distance[i]))
+    {
+      EXPECT_TRUE(std::isnan(out[i])) << "pixel " << x << ", " << y << " became valid";
+    }
+    else if (scene.distance[i] == 0.0F)
+    {
+      EXPECT_EQ(out[i], 0.0F) << "pixel " << x << ", " << y << " became valid";
+    }
+    else
+    {
+      EXPECT_NEAR(out[i], expected[i], tolerance) << "pixel " << x << ", " << y;
+    }
+  }
+}
+
+TEST(GuidedFilter, MatchesTheDoublePrecisionReference)
+{
+  const auto scene = make_scene(64, 48);
+  WorkerPool pool(0);
+
+  for (const std::uint32_t radius : { 1U, 2U, 4U })
+  {
+    for (const float eps : { 0.001F, 0.01F, 0.1F })
+    {
+      SCOPED_TRACE("radius " + std::to_string(radius) + ", eps " + std::to_string(eps));
+      GuidedFilter filter;
+      filter.configure({ radius, eps });
+      std::vector<float> out(scene.distance.size());
+      filter(scene.distance.data(), scene.amplitude.data(), scene.width, scene.height, out.data(), pool);
+      expect_matches_reference(
+          scene, out,
+          reference(scene.distance, scene.amplitude, scene.width, scene.height, static_cast<int>(radius), eps));
+    }
+  }
+}
+
+TEST(GuidedFilter, FloatAndIntegerGuidesAgree)
+{
+  const auto scene = make_scene(40, 30);
+  const std::vector<float> amplitude(scene.amplitude.begin(), scene.amplitude.end());
+  WorkerPool pool(0);
+  GuidedFilter filter;
+  filter.configure({ 2, 0.01F });
+
+  std::vector<float> from_u16(scene.distance.size());
+  std::vector<float> from_float(scene.distance.size());
+  filter(scene.distance.data(), scene.amplitude.data(), scene.width, scene.height, from_u16.data(), pool);
+  filter(scene.distance.data(), amplitude.data(), scene.width, scene.height, from_float.data(), pool);
+  for (std::size_t i = 0; i < from_u16.size(); ++i)
+  {
+    if (std::isnan(scene.distance[i]))
+    {
+      EXPECT_TRUE(std::isnan(from_float[i]));
+      continue;
+    }
+    EXPECT_EQ(from_u16[i], from_float[i]) << "pixel " << i;
+  }
+}
+
+TEST(GuidedFilter, TileSeamsAreInvisible)
+{
+  // rows are split into one tile per thread, with an odd height the tiles
+  // differ in size; each tile sums the windows reaching into its neighbors
+  const auto scene = make_scene(50, 37);
+  const std::uint32_t radius = 3;
+  const float eps = 0.01F;
+  const auto expected = reference(scene.distance, scene.amplitude, scene.width, scene.height, radius, eps);
+
+  std::vector<float> serial(scene.distance.size());
+  {
+    WorkerPool pool(0);
+    GuidedFilter filter;
+    filter.configure({ radius, eps });
+    filter(scene.distance.data(), scene.amplitude.data(), scene.width, scene.height, serial.data(), pool);
+  }
+
+  for (const std::size_t threads : { 1U, 2U, 4U, 7U })
+  {
+    SCOPED_TRACE(std::to_string(threads + 1) + " tiles");
+    WorkerPool pool(threads);
+    GuidedFilter filter;
+    filter.configure({ radius, eps });
+    std::vector<float> out(scene.distance.size());
+    // twice, the second frame reuses the buffers of the first
+    for (int frame = 0; frame < 2; ++frame)
+    {
+      filter(scene.distance.data(), scene.amplitude.data(), scene.width, scene.height, out.data(), pool);
+      expect_matches_reference(scene, out, expected);
+      for (std::size_t i = 0; i < out.size(); ++i)
+      {
+        if (!std::isnan(scene.distance[i]))
+        {
+          EXPECT_NEAR(out[i], serial[i], 1e-6F) << "pixel " << i % scene.width << ", " << i / scene.width;
+        }
+      }
+    }
+  }
+}
+
+TEST(GuidedFilter, WindowsWithoutValidPixels)
+{
+  // a single valid pixel, isolated by more than the radius
+  const int width = 9;
+  const int height = 9;
+  std::vector<float> distance(width * height, 0.0F);
+  std::vector<std::uint16_t> amplitude(width * height, 500);
+  distance[4 * width + 4] = 1.25F;
+
+  WorkerPool pool(2);
+  GuidedFilter filter;
+  filter.configure({ 2, 0.01F });
+  std::vector<float> out(distance.size(), -1.0F);
+  filter(distance.data(), amplitude.data(), width, height, out.data(), pool);
+  for (std::size_t i = 0; i < out.size(); ++i)
+  {
+    EXPECT_NEAR(out[i], distance[i], tolerance) << "pixel " << i;
+  }
+}
+
+}  // namespace
@@ -0,0 +1,193 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/height_grid.hpp>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace
+{
+using ifm3d_ros2::GridCell;
+using ifm3d_ros2::GridParams;
+using ifm3d_ros2::HeightGrid;
+using ifm3d_ros2::SharedGrid;
+using ifm3d_ros2::WorkerPool;
+
+// 4 x 3 cells of 0.5 m from (-1, -1), obstacles from 0.1 m up to 1 m
+GridParams params()
+{
+  GridParams result;
+  result.resolution = 0.5F;
+  result.width = 4;
+  result.height = 3;
+  result.origin_x = -1.0F;
+  result.origin_y = -1.0F;
+  result.min_z = 0.1F;
+  result.max_z = 1.0F;
+  return result;
+}
+
+const GridCell& cell(const std::vector<GridCell>& cells, std::uint32_t x, std::uint32_t y)
+{
+  return cells[static_cast<std::size_t>(y) * params().width + x];
+}
+
+void expect_empty(const GridCell& c)
+{
+  EXPECT_TRUE(std::isinf(c.max_height) && c.max_height < 0.0F);
+  EXPECT_EQ(c.obstacles, 0U);
+  EXPECT_EQ(c.ground, 0U);
+}
+
+/**
+ * Points in the cells (0, 0) (ground and obstacles), (3, 2) (an obstacle)
+ * and outside of the grid or invalid, repeated `repeat` times to spread
+ * them across the threads.
+ */
+std::vector<float> points(int repeat)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> xyz;
+  for (int i = 0; i < repeat; ++i)
+  {
+    xyz.insert(xyz.end(), { -0.9F, -0.9F, 0.0F,  // ground
+                            -0.6F, -0.6F, 0.3F,  // obstacles
+                            -0.9F, -0.6F, 0.7F,  //
+                            0.9F, 0.4F, 0.5F,    // (3, 2)
+                            0.9F, 0.4F, 1.5F,    // above max_z
+                            1.1F, 0.0F, 0.5F,    // off the grid
+                            -1.1F, 0.0F, 0.5F,   //
+                            0.0F, 0.6F, 0.5F,    //
+                            0.0F, 0.0F, 0.0F,    // invalid
+                            nan, nan, nan });
+  }
+  return xyz;
+}
+
+TEST(HeightGrid, BinsThePoints)
+{
+  for (const std::size_t threads : { 0, 1, 3 })
+  {
+    WorkerPool pool(threads);
+    HeightGrid grid;
+    grid.configure(params());
+    ASSERT_EQ(grid.cells().size(), 12U);
+
+    const auto xyz = points(25);
+    grid.bin(xyz.data(), xyz.size() / 3, pool);
+    const auto& cells = grid.cells();
+
+    EXPECT_FLOAT_EQ(cell(cells, 0, 0).max_height, 0.7F) << threads << " threads";
+    EXPECT_EQ(cell(cells, 0, 0).obstacles, 50U);
+    EXPECT_EQ(cell(cells, 0, 0).ground, 25U);
+    EXPECT_FLOAT_EQ(cell(cells, 3, 2).max_height, 0.5F);
+    EXPECT_EQ(cell(cells, 3, 2).obstacles, 25U);
+    EXPECT_EQ(cell(cells, 3, 2).ground, 0U);
+    for (std::uint32_t y = 0; y < 3; ++y)
+    {
+      for (std::uint32_t x = 0; x < 4; ++x)
+      {
+        if (!(x == 0 && y == 0) && !(x == 3 && y == 2))
+        {
+          expect_empty(cell(cells, x, y));
+        }
+      }
+    }
+
+    // the next frame replaces the cells
+    grid.bin(xyz.data(), 3, pool);
+    EXPECT_EQ(cell(grid.cells(), 0, 0).obstacles, 2U);
+    expect_empty(cell(grid.cells(), 3, 2));
+    grid.bin(nullptr, 0, pool);
+    expect_empty(cell(grid.cells(), 0, 0));
+  }
+}
+
+TEST(HeightGrid, Occupancy)
+{
+  const std::vector<GridCell> cells{ GridCell::empty(), GridCell{ 0.5F, 3, 0 }, GridCell{ 0.5F, 2, 7 },
+                                     GridCell{ -std::numeric_limits<float>::infinity(), 0, 1 } };
+  std::vector<std::int8_t> occupancy;
+  HeightGrid::to_occupancy(cells, 3, occupancy);
+  EXPECT_EQ(occupancy, (std::vector<std::int8_t>{ -1, 100, 0, 0 }));
+}
+
+TEST(SharedGrid, MergesTheContributions)
+{
+  WorkerPool pool(0);
+  const auto shared = SharedGrid::acquire("test_height_grid", params());
+  const auto left = shared->join();
+  const auto right = shared->join();
+  EXPECT_NE(left, right);
+
+  HeightGrid grid;
+  grid.configure(shared->params());
+  std::vector<float> xyz{ -0.9F, -0.9F, 0.3F, -0.9F, -0.9F, 0.0F };
+  grid.bin(xyz.data(), 2, pool);
+  shared->update(left, grid);
+  xyz = { -0.9F, -0.9F, 0.8F, -0.9F, -0.9F, 0.2F, 0.9F, 0.4F, 0.0F };
+  grid.bin(xyz.data(), 3, pool);
+  shared->update(right, grid);
+
+  // the highest point, the sum of the counts
+  std::vector<GridCell> merged;
+  shared->merge(merged);
+  ASSERT_EQ(merged.size(), 12U);
+  EXPECT_FLOAT_EQ(cell(merged, 0, 0).max_height, 0.8F);
+  EXPECT_EQ(cell(merged, 0, 0).obstacles, 3U);
+  EXPECT_EQ(cell(merged, 0, 0).ground, 1U);
+  EXPECT_EQ(cell(merged, 3, 2).ground, 1U);
+
+  // an idle head contributes nothing, but stays in
+  shared->clear(right);
+  shared->merge(merged);
+  EXPECT_FLOAT_EQ(cell(merged, 0, 0).max_height, 0.3F);
+  EXPECT_EQ(cell(merged, 0, 0).obstacles, 1U);
+  expect_empty(cell(merged, 3, 2));
+  shared->update(right, grid);
+  shared->merge(merged);
+  EXPECT_EQ(cell(merged, 0, 0).obstacles, 3U);
+
+  shared->leave(right);
+  shared->update(right, grid);  // ignored after leaving
+  shared->merge(merged);
+  EXPECT_EQ(cell(merged, 0, 0).obstacles, 1U);
+  expect_empty(cell(merged, 3, 2));
+  shared->leave(left);
+}
+
+TEST(SharedGrid, SharedByName)
+{
+  const auto first = SharedGrid::acquire("test_height_grid_name", params());
+  auto other_params = params();
+  other_params.resolution = 0.25F;
+  const auto second = SharedGrid::acquire("test_height_grid_name", other_params);
+  EXPECT_EQ(first, second);
+  // the geometry of the first one stays
+  EXPECT_TRUE(second->params() == params());
+
+  // without a name, a grid of its own
+  EXPECT_NE(SharedGrid::acquire("", params()), SharedGrid::acquire("", params()));
+}
+
+TEST(SharedGrid, OnePublicationPerPeriod)
+{
+  const auto shared = SharedGrid::acquire("", params());
+  const auto start = std::chrono::steady_clock::now();
+  const auto period = std::chrono::milliseconds(200);
+  EXPECT_TRUE(shared->claim_publication(start, period));
+  EXPECT_FALSE(shared->claim_publication(start + std::chrono::milliseconds(100), period));
+  EXPECT_TRUE(shared->claim_publication(start + period, period));
+  EXPECT_FALSE(shared->claim_publication(start + period, period));
+}
+
+}  // namespace
@@ -0,0 +1,87 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/metrics.hpp>
+
+namespace
+{
+using ifm3d_ros2::is_scrape_request;
+using ifm3d_ros2::MetricsRegistry;
+
+bool contains(const std::string& text, const std::string& line)
+{
+  return text.find(line + "\n") != std::string::npos;
+}
+
+TEST(Metrics, ServesOnlyTheMetricsPaths)
+{
+  EXPECT_TRUE(is_scrape_request("GET /metrics HTTP/1.1\r\nHost: x\r\n\r\n"));
+  EXPECT_TRUE(is_scrape_request("GET /metrics?name=x HTTP/1.1\r\n\r\n"));
+  EXPECT_TRUE(is_scrape_request("GET / HTTP/1.0\r\n\r\n"));
+
+  EXPECT_FALSE(is_scrape_request("GET /metricsfoo HTTP/1.1\r\n\r\n"));
+  EXPECT_FALSE(is_scrape_request("GET /metrics/x HTTP/1.1\r\n\r\n"));
+  EXPECT_FALSE(is_scrape_request("GET /index.html HTTP/1.1\r\n\r\n"));
+  EXPECT_FALSE(is_scrape_request("POST /metrics HTTP/1.1\r\n\r\n"));
+  EXPECT_FALSE(is_scrape_request("GET /metrics"));
+  EXPECT_FALSE(is_scrape_request(""));
+}
+
+TEST(Metrics, RendersRegisteredHeads)
+{
+  auto& registry = MetricsRegistry::instance();
+  auto head = registry.register_head("/cam\"a\"");
+  head->frames_in.inc(3);
+  head->queue_depth.set(2);
+  head->publish_seconds.observe(0.0002);
+  head->publish_seconds.observe(0.003);
+  head->publish_seconds.observe(5.0);
+
+  const auto text = registry.render();
+  const std::string label = "head=\"/cam\\\"a\\\"\"";
+
+  EXPECT_TRUE(contains(text, "# TYPE ifm3d_ros2_frames_received counter"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_frames_received_total{" + label + "} 3"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_queue_depth{" + label + "} 2"));
+
+  // cumulative buckets, the last one at `+Inf` matching the count
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_publish_seconds_bucket{" + label + ",le=\"0.0001\"} 0"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_publish_seconds_bucket{" + label + ",le=\"0.00025\"} 1"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_publish_seconds_bucket{" + label + ",le=\"0.005\"} 2"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_publish_seconds_bucket{" + label + ",le=\"1\"} 2"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_publish_seconds_bucket{" + label + ",le=\"+Inf\"} 3"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_publish_seconds_count{" + label + "} 3"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_publish_seconds_sum{" + label + "} 5.0032"));
+
+  ASSERT_GE(text.size(), 6u);
+  EXPECT_EQ(text.substr(text.size() - 6), "# EOF\n");
+
+  // released heads leave the exposition
+  head.reset();
+  EXPECT_EQ(registry.render().find(label), std::string::npos);
+}
+
+TEST(Metrics, RendersTheTopicLabels)
+{
+  auto& registry = MetricsRegistry::instance();
+  auto head = registry.register_head("/cam_b", { "cloud", "rgb" });
+  ASSERT_EQ(head->topics_skipped.size(), 2u);
+  head->topics_skipped[1].inc(4);
+
+  const auto text = registry.render();
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_topics_skipped_total{head=\"/cam_b\",topic=\"cloud\"} 0"));
+  EXPECT_TRUE(contains(text, "ifm3d_ros2_topics_skipped_total{head=\"/cam_b\",topic=\"rgb\"} 4"));
+
+  // none without topics
+  auto other = registry.register_head("/cam_c");
+  EXPECT_EQ(other->topics_skipped.size(), 0u);
+  EXPECT_EQ(registry.render().find("head=\"/cam_c\",topic="), std::string::npos);
+}
+
+}  // namespace
@@ -0,0 +1,211 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/motion_compensation.hpp>
+
+namespace
+{
+using ifm3d_ros2::PointTransform;
+using ifm3d_ros2::TwistRing;
+using ifm3d_ros2::TwistSample;
+
+constexpr std::int64_t ms = 1000000;  // nanoseconds
+
+TwistSample sample(std::int64_t stamp_nanos, std::array<float, 3> linear, std::array<float, 3> angular)
+{
+  TwistSample result;
+  result.stamp_nanos = stamp_nanos;
+  result.linear = linear;
+  result.angular = angular;
+  return result;
+}
+
+// constant twist sampled every 10 ms over [0, `end_nanos`]
+std::vector<TwistSample> constant(std::array<float, 3> linear, std::array<float, 3> angular, std::int64_t end_nanos)
+{
+  std::vector<TwistSample> samples;
+  for (std::int64_t t = 0; t <= end_nanos; t += 10 * ms)
+  {
+    samples.push_back(sample(t, linear, angular));
+  }
+  return samples;
+}
+
+void expect_transform_near(const PointTransform& actual, const PointTransform& expected, float tolerance)
+{
+  for (std::size_t i = 0; i < actual.size(); ++i)
+  {
+    EXPECT_NEAR(actual[i], expected[i], tolerance) << "element " << i;
+  }
+}
+
+const PointTransform identity{ { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0 } };
+
+TEST(TwistRing, SnapshotFromTheLastSampleBefore)
+{
+  TwistRing ring;
+  std::vector<TwistSample> out;
+  EXPECT_FALSE(ring.snapshot(0, out));
+
+  for (std::int64_t i = 0; i < 10; ++i)
+  {
+    ring.push(sample(i * 10 * ms, { { static_cast<float>(i), 0, 0 } }, {}));
+  }
+  ASSERT_TRUE(ring.snapshot(35 * ms, out));
+  ASSERT_EQ(out.size(), 7U);
+  EXPECT_EQ(out.front().stamp_nanos, 30 * ms);
+  EXPECT_EQ(out.back().stamp_nanos, 90 * ms);
+  EXPECT_EQ(out.back().linear[0], 9.0F);
+
+  // all of them if none is old enough
+  ASSERT_TRUE(ring.snapshot(-1, out));
+  EXPECT_EQ(out.size(), 10U);
+}
+
+TEST(TwistRing, WrapsAround)
+{
+  TwistRing ring;
+  const auto pushed = static_cast<std::int64_t>(TwistRing::capacity) * 2 + 17;
+  for (std::int64_t i = 0; i < pushed; ++i)
+  {
+    ring.push(sample(i * ms, { { static_cast<float>(i), 0, 0 } }, {}));
+  }
+
+  std::vector<TwistSample> out;
+  ASSERT_TRUE(ring.snapshot(0, out));
+  ASSERT_EQ(out.size(), TwistRing::capacity);
+  for (std::size_t i = 0; i < out.size(); ++i)
+  {
+    const auto index = pushed - static_cast<std::int64_t>(TwistRing::capacity) + static_cast<std::int64_t>(i);
+    EXPECT_EQ(out[i].stamp_nanos, index * ms);
+    EXPECT_EQ(out[i].linear[0], static_cast<float>(index));
+  }
+}
+
+TEST(TwistRing, Clear)
+{
+  TwistRing ring;
+  ring.push(sample(5 * ms, {}, {}));
+  ring.push(sample(6 * ms, {}, {}));
+  ring.clear();
+
+  std::vector<TwistSample> out;
+  EXPECT_FALSE(ring.snapshot(0, out));
+
+  // restarting at an earlier time
+  ring.push(sample(1 * ms, {}, {}));
+  ASSERT_TRUE(ring.snapshot(0, out));
+  ASSERT_EQ(out.size(), 1U);
+  EXPECT_EQ(out.front().stamp_nanos, 1 * ms);
+}
+
+TEST(IntegrateMotion, ConstantTwistFollowsTheArc)
+{
+  // 1 m/s forward, turning at 0.5 rad/s about z: a circle of 2 m radius
+  const float v = 1.0F;
+  const float w = 0.5F;
+  const auto samples = constant({ { v, 0, 0 } }, { { 0, 0, w } }, 1000 * ms);
+
+  PointTransform motion;
+  ASSERT_TRUE(ifm3d_ros2::integrate_motion(samples, 100 * ms, 900 * ms, 0, motion));
+  const float theta = w * 0.8F;
+  const PointTransform expected{ { std::cos(theta), -std::sin(theta), 0, v * std::sin(theta) / w,  //
+                                   std::sin(theta), std::cos(theta), 0, v * (1 - std::cos(theta)) / w,  //
+                                   0, 0, 1, 0 } };
+  expect_transform_near(motion, expected, 1e-5F);
+
+  // backwards in time the inverse
+  ASSERT_TRUE(ifm3d_ros2::integrate_motion(samples, 900 * ms, 100 * ms, 0, motion));
+  expect_transform_near(motion, ifm3d_ros2::invert_transform(expected), 1e-5F);
+}
+
+TEST(IntegrateMotion, ConstantTwistAboutAnyAxis)
+{
+  // the exponential of the twist: R = exp([w]), t = V * v
+  const std::array<float, 3> v{ { 0.3F, -0.2F, 0.1F } };
+  const std::array<float, 3> w{ { 0.2F, -0.4F, 0.7F } };
+  const double dt = 0.5;
+  const auto samples = constant(v, w, 600 * ms);
+
+  PointTransform motion;
+  ASSERT_TRUE(ifm3d_ros2::integrate_motion(samples, 50 * ms, 550 * ms, 0, motion));
+
+  double k[9] = { 0, -w[2] * dt, w[1] * dt, w[2] * dt, 0, -w[0] * dt, -w[1] * dt, w[0] * dt, 0 };
+  double k2[9] = {};
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      for (int l = 0; l < 3; ++l)
+      {
+        k2[i * 3 + j] += k[i * 3 + l] * k[l * 3 + j];
+      }
+    }
+  }
+  const double theta = std::sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) * dt;
+  const double a = std::sin(theta) / theta;
+  const double b = (1 - std::cos(theta)) / (theta * theta);
+  const double c = (theta - std::sin(theta)) / (theta * theta * theta);
+  PointTransform expected{};
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      const double eye = i == j ? 1.0 : 0.0;
+      expected[i * 4 + j] = static_cast<float>(eye + a * k[i * 3 + j] + b * k2[i * 3 + j]);
+      expected[i * 4 + 3] += static_cast<float>((eye + b * k[i * 3 + j] + c * k2[i * 3 + j]) * v[j] * dt);
+    }
+  }
+  expect_transform_near(motion, expected, 1e-5F);
+}
+
+TEST(IntegrateMotion, InterpolatesBetweenSamples)
+{
+  // accelerating from 0 to 2 m/s over 1 s: 1 m
+  const std::vector<TwistSample> samples{ sample(0, {}, {}), sample(1000 * ms, { { 2, 0, 0 } }, {}) };
+  PointTransform motion;
+  ASSERT_TRUE(ifm3d_ros2::integrate_motion(samples, 0, 1000 * ms, 0, motion));
+  EXPECT_NEAR(motion[3], 1.0F, 1e-6F);
+}
+
+TEST(IntegrateMotion, HoldsTheLastTwistUpToMaxHold)
+{
+  const auto samples = constant({ { 1, 0, 0 } }, {}, 100 * ms);
+  PointTransform motion;
+
+  // the samples must reach back to the start
+  EXPECT_FALSE(ifm3d_ros2::integrate_motion(samples, -1 * ms, 50 * ms, 0, motion));
+  EXPECT_FALSE(ifm3d_ros2::integrate_motion({}, 0, 50 * ms, 0, motion));
+
+  ASSERT_TRUE(ifm3d_ros2::integrate_motion(samples, 50 * ms, 150 * ms, 50 * ms, motion));
+  EXPECT_NEAR(motion[3], 0.1F, 1e-6F);
+  EXPECT_FALSE(ifm3d_ros2::integrate_motion(samples, 50 * ms, 151 * ms, 50 * ms, motion));
+}
+
+TEST(Transforms, ComposeWithTheInverseIsTheIdentity)
+{
+  // rotation about (1, 1, 1) by 120 degrees (permuting the axes) and a
+  // translation
+  const PointTransform t{ { 0, 0, 1, 0.5F,  //
+                            1, 0, 0, -1.25F,  //
+                            0, 1, 0, 2.0F } };
+  expect_transform_near(ifm3d_ros2::compose_transforms(ifm3d_ros2::invert_transform(t), t), identity, 1e-6F);
+  expect_transform_near(ifm3d_ros2::compose_transforms(t, ifm3d_ros2::invert_transform(t)), identity, 1e-6F);
+
+  // `b` first, then `a`
+  const PointTransform shift{ { 1, 0, 0, 1, 0, 1, 0, 0, 0, 0, 1, 0 } };
+  const auto ab = ifm3d_ros2::compose_transforms(t, shift);
+  EXPECT_FLOAT_EQ(ab[3], 0.5F);
+  EXPECT_FLOAT_EQ(ab[7], -0.25F);
+  EXPECT_FLOAT_EQ(ab[11], 2.0F);
+}
+
+}  // namespace
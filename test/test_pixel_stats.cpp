@@ -0,0 +1,159 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/pixel_stats.hpp>
+
+namespace
+{
+using ifm3d_ros2::PixelStats;
+
+constexpr std::uint32_t width = 13;
+constexpr std::uint32_t height = 5;
+constexpr std::size_t n = width * height;
+
+const float nan = std::numeric_limits<float>::quiet_NaN();
+
+/**
+ * Noisy distance images far from the origin (where a naive sum of squares
+ * cancels out), pixel 0 never valid, pixel 1 valid every third frame.
+ */
+std::vector<std::vector<float>> frames(std::size_t count)
+{
+  std::mt19937 rng(7U);
+  std::normal_distribution<float> noise(0.0F, 0.005F);
+  std::vector<std::vector<float>> result(count, std::vector<float>(n));
+  for (std::size_t f = 0; f < count; ++f)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      result[f][i] = 30.0F + 0.1F * static_cast<float>(i) + noise(rng);
+    }
+    result[f][0] = f % 2 == 0 ? 0.0F : nan;
+    if (f % 3 != 0)
+    {
+      result[f][1] = -1.0F;
+    }
+  }
+  return result;
+}
+
+TEST(PixelStats, WelfordMatchesTwoPass)
+{
+  const auto images = frames(50);
+  PixelStats stats;
+  EXPECT_FALSE(stats.active());
+  EXPECT_FALSE(stats.add(images[0].data(), width, height));
+
+  stats.start(50);
+  for (std::size_t f = 0; f < images.size(); ++f)
+  {
+    EXPECT_TRUE(stats.active());
+    EXPECT_EQ(stats.add(images[f].data(), width, height), f + 1 == images.size());
+  }
+  EXPECT_FALSE(stats.active());
+  EXPECT_EQ(stats.frames(), 50U);
+  EXPECT_EQ(stats.width(), width);
+  EXPECT_EQ(stats.height(), height);
+
+  std::vector<float> mean(n);
+  std::vector<float> stddev(n);
+  std::vector<float> valid_ratio(n);
+  stats.mean(mean.data());
+  stats.stddev(stddev.data());
+  stats.valid_ratio(valid_ratio.data());
+
+  EXPECT_TRUE(std::isnan(mean[0]));
+  EXPECT_TRUE(std::isnan(stddev[0]));
+  EXPECT_EQ(valid_ratio[0], 0.0F);
+  EXPECT_FLOAT_EQ(valid_ratio[1], 17.0F / 50.0F);
+  EXPECT_FLOAT_EQ(valid_ratio[2], 1.0F);
+
+  // two passes in double precision over the valid samples
+  for (std::size_t i = 1; i < n; ++i)
+  {
+    double sum = 0.0;
+    std::size_t count = 0;
+    for (const auto& image : images)
+    {
+      if (image[i] > 0.0F)
+      {
+        sum += image[i];
+        ++count;
+      }
+    }
+    const double ref_mean = sum / static_cast<double>(count);
+    double squares = 0.0;
+    for (const auto& image : images)
+    {
+      if (image[i] > 0.0F)
+      {
+        squares += (image[i] - ref_mean) * (image[i] - ref_mean);
+      }
+    }
+    const double ref_stddev = std::sqrt(squares / static_cast<double>(count));
+
+    // a few float ulps at 30 m
+    EXPECT_NEAR(mean[i], ref_mean, 3e-5) << "pixel " << i;
+    // about 5 mm, to within a few percent at 30 m
+    EXPECT_NEAR(stddev[i], ref_stddev, 2e-4) << "pixel " << i;
+  }
+}
+
+TEST(PixelStats, SingleSampleHasNoSpread)
+{
+  PixelStats stats;
+  stats.start(1);
+  std::vector<float> image(n, 2.5F);
+  image[3] = nan;
+  EXPECT_TRUE(stats.add(image.data(), width, height));
+
+  std::vector<float> stddev(n);
+  stats.stddev(stddev.data());
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (i == 3)
+    {
+      EXPECT_TRUE(std::isnan(stddev[i]));
+    }
+    else
+    {
+      EXPECT_EQ(stddev[i], 0.0F) << "pixel " << i;
+    }
+  }
+}
+
+TEST(PixelStats, RestartsOnANewRunOrSize)
+{
+  PixelStats stats;
+  stats.start(3);
+  const std::vector<float> near(n, 1.0F);
+  const std::vector<float> far(n, 3.0F);
+  stats.add(near.data(), width, height);
+  stats.add(near.data(), width, height);
+
+  // another size drops what was accumulated
+  EXPECT_FALSE(stats.add(far.data(), height, width));
+  EXPECT_EQ(stats.frames(), 1U);
+  EXPECT_EQ(stats.width(), height);
+
+  std::vector<float> mean(n);
+  stats.mean(mean.data());
+  EXPECT_EQ(mean[0], 3.0F);
+
+  stats.start(1);
+  EXPECT_TRUE(stats.add(near.data(), width, height));
+  stats.mean(mean.data());
+  EXPECT_EQ(mean[0], 1.0F);
+}
+
+}  // namespace
@@ -0,0 +1,43 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/port_standby.hpp>
+
+namespace
+{
+using ifm3d_ros2::PortStandby;
+
+TEST(PortStandby, SharedByVpuAndPort)
+{
+  const auto own = PortStandby::acquire("192.168.0.69", 50012);
+  EXPECT_EQ(PortStandby::acquire("192.168.0.69", 50012), own);
+  EXPECT_NE(PortStandby::acquire("192.168.0.69", 50010), own);
+  EXPECT_NE(PortStandby::acquire("192.168.0.70", 50012), own);
+}
+
+TEST(PortStandby, CallsTheListeners)
+{
+  const auto port = PortStandby::acquire("192.168.0.69", 50011);
+  std::vector<bool> calls;
+  const auto id = port->listen([&calls](bool standby) { calls.push_back(standby); });
+
+  // switched through another head acquiring the same port
+  EXPECT_EQ(PortStandby::acquire("192.168.0.69", 50011)->set(true), 1U);
+  EXPECT_EQ(port->set(false), 1U);
+  EXPECT_EQ(calls, (std::vector<bool>{ true, false }));
+
+  port->unlisten(id);
+  EXPECT_EQ(port->set(true), 0U);
+  EXPECT_EQ(calls.size(), 2U);
+
+  // nobody streams from this port
+  EXPECT_EQ(PortStandby::acquire("192.168.0.69", 50013)->set(true), 0U);
+}
+
+}  // namespace
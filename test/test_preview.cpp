@@ -0,0 +1,144 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/preview.hpp>
+
+namespace
+{
+using ifm3d_ros2::Colormap;
+using ifm3d_ros2::RgbImage;
+
+TEST(Preview, RangeToLutIndex)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  // [1, 3] onto [1, 255]: clamped outside, 0 for what is not positive
+  const std::vector<float> values{ 1.0F, 2.0F, 3.0F, 0.5F, 10.0F, 0.0F, -1.0F, nan, 1.0F + 2.0F / 254.0F };
+  const std::vector<std::uint8_t> expected{ 1, 128, 255, 1, 255, 0, 0, 0, 2 };
+
+  // long enough for the vectorized loop and its remainder
+  std::vector<float> src;
+  std::vector<std::uint8_t> want;
+  for (int repeat = 0; repeat < 5; ++repeat)
+  {
+    src.insert(src.end(), values.begin(), values.end());
+    want.insert(want.end(), expected.begin(), expected.end());
+  }
+  std::vector<std::uint8_t> index(src.size());
+  ifm3d_ros2::range_to_lut_index(src.data(), index.data(), src.size(), 1.0F, 3.0F);
+  for (std::size_t i = 0; i < index.size(); ++i)
+  {
+    EXPECT_EQ(index[i], want[i]) << src[i];
+  }
+}
+
+TEST(Preview, RangeToLutIndexOfIntegers)
+{
+  const std::vector<std::uint16_t> wide{ 0, 100, 1100, 2100, 65535 };
+  std::vector<std::uint8_t> index(wide.size());
+  ifm3d_ros2::range_to_lut_index(wide.data(), index.data(), wide.size(), 100.0F, 2100.0F);
+  EXPECT_EQ(index, (std::vector<std::uint8_t>{ 0, 1, 128, 255, 255 }));
+
+  const std::vector<std::uint8_t> narrow{ 0, 1, 255 };
+  ifm3d_ros2::range_to_lut_index(narrow.data(), index.data(), narrow.size(), 0.0F, 254.0F);
+  EXPECT_EQ(index[0], 0);
+  EXPECT_EQ(index[1], 2);
+  EXPECT_EQ(index[2], 255);
+
+  // an empty range maps all valid values to the first entry
+  ifm3d_ros2::range_to_lut_index(wide.data(), index.data(), wide.size(), 5.0F, 5.0F);
+  EXPECT_EQ(index, (std::vector<std::uint8_t>{ 0, 1, 1, 1, 1 }));
+}
+
+TEST(Preview, ColormapLut)
+{
+  for (const auto colormap : { Colormap::TURBO, Colormap::GRAY })
+  {
+    const auto lut = ifm3d_ros2::make_colormap_lut(colormap);
+    EXPECT_EQ(lut[0], 0);
+    EXPECT_EQ(lut[1], 0);
+    EXPECT_EQ(lut[2], 0);
+  }
+  const auto gray = ifm3d_ros2::make_colormap_lut(Colormap::GRAY);
+  EXPECT_EQ(gray[128 * 3 + 1], 128);
+
+  // near is blue, far is red
+  const auto turbo = ifm3d_ros2::make_colormap_lut(Colormap::TURBO);
+  EXPECT_GT(turbo[40 * 3 + 2], turbo[40 * 3 + 0]);
+  EXPECT_GT(turbo[230 * 3 + 0], turbo[230 * 3 + 2]);
+}
+
+TEST(Preview, JpegRoundTrip)
+{
+  // smooth gradients survive the compression
+  constexpr std::uint32_t width = 64;
+  constexpr std::uint32_t height = 48;
+  std::vector<std::uint8_t> rgb(width * height * 3);
+  for (std::uint32_t row = 0; row < height; ++row)
+  {
+    for (std::uint32_t col = 0; col < width; ++col)
+    {
+      auto* pixel = rgb.data() + (row * width + col) * 3;
+      pixel[0] = static_cast<std::uint8_t>(col * 4);
+      pixel[1] = static_cast<std::uint8_t>(row * 5);
+      pixel[2] = 128;
+    }
+  }
+
+  std::vector<std::uint8_t> jpeg;
+  ASSERT_EQ(ifm3d_ros2::encode_jpeg_rgb(rgb.data(), width, height, 95, jpeg), "");
+  ASSERT_GT(jpeg.size(), 2U);
+  EXPECT_EQ(jpeg[0], 0xFF);
+  EXPECT_EQ(jpeg[1], 0xD8);
+
+  std::uint32_t jpeg_width = 0;
+  std::uint32_t jpeg_height = 0;
+  ASSERT_EQ(ifm3d_ros2::read_jpeg_size(jpeg.data(), jpeg.size(), jpeg_width, jpeg_height), "");
+  EXPECT_EQ(jpeg_width, width);
+  EXPECT_EQ(jpeg_height, height);
+
+  RgbImage decoded;
+  ASSERT_EQ(ifm3d_ros2::decode_jpeg_rgb(jpeg.data(), jpeg.size(), width, height, decoded), "");
+  EXPECT_EQ(decoded.scale_denom, 1U);
+  ASSERT_EQ(decoded.width, width);
+  ASSERT_EQ(decoded.height, height);
+  ASSERT_EQ(decoded.pixels.size(), rgb.size());
+  double error = 0.0;
+  for (std::size_t i = 0; i < rgb.size(); ++i)
+  {
+    error += std::abs(static_cast<int>(decoded.pixels[i]) - static_cast<int>(rgb[i]));
+  }
+  EXPECT_LT(error / static_cast<double>(rgb.size()), 2.0);
+
+  // scaled down while decoding, as far as the minimum size allows
+  ASSERT_EQ(ifm3d_ros2::decode_jpeg_rgb(jpeg.data(), jpeg.size(), 16, 12, decoded), "");
+  EXPECT_EQ(decoded.scale_denom, 4U);
+  EXPECT_EQ(decoded.width, width / 4);
+  EXPECT_EQ(decoded.height, height / 4);
+  EXPECT_EQ(decoded.pixels.size(), static_cast<std::size_t>(decoded.width) * decoded.height * 3);
+}
+
+TEST(Preview, JpegErrorsAreReported)
+{
+  const std::vector<std::uint8_t> garbage{ 0x00, 0x01, 0x02, 0x03 };
+  std::uint32_t width = 1;
+  std::uint32_t height = 1;
+  EXPECT_NE(ifm3d_ros2::read_jpeg_size(garbage.data(), garbage.size(), width, height), "");
+  EXPECT_EQ(width, 0U);
+  EXPECT_EQ(height, 0U);
+
+  RgbImage decoded;
+  EXPECT_NE(ifm3d_ros2::decode_jpeg_rgb(garbage.data(), garbage.size(), 1, 1, decoded), "");
+  EXPECT_EQ(decoded.width, 0U);
+}
+
+}  // namespace
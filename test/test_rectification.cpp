@@ -0,0 +1,153 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/camera_model.hpp>
+#include <ifm3d_ros2/rectification.hpp>
+#include <ifm3d_ros2/worker_pool.hpp>
+
+namespace
+{
+using ifm3d_ros2::IntrinsicModel;
+using ifm3d_ros2::RemapTable;
+using ifm3d_ros2::WorkerPool;
+
+constexpr std::uint32_t width = 32;
+constexpr std::uint32_t height = 24;
+
+IntrinsicModel model(std::uint32_t id, std::vector<float> parameters)
+{
+  IntrinsicModel result;
+  result.model_id = id;
+  for (std::size_t i = 0; i < parameters.size(); ++i)
+  {
+    result.parameters[i] = parameters[i];
+  }
+  return result;
+}
+
+// fx, fy, mx, my, alpha, k1 .. k5
+IntrinsicModel bouguet(float k1)
+{
+  return model(ifm3d_ros2::model_bouguet, { 40.0F, 42.0F, 16.2F, 11.9F, 0.0F, k1, 0.0F, 0.0F, 0.0F, 0.0F });
+}
+
+// a smooth RGB image, so that a bilinear blend barely depends on rounding
+std::vector<std::uint8_t> gradient_image()
+{
+  std::vector<std::uint8_t> rgb(static_cast<std::size_t>(width) * height * 3);
+  for (std::uint32_t row = 0; row < height; ++row)
+  {
+    for (std::uint32_t col = 0; col < width; ++col)
+    {
+      auto* px = rgb.data() + (static_cast<std::size_t>(row) * width + col) * 3;
+      px[0] = static_cast<std::uint8_t>(20 + 7 * col);
+      px[1] = static_cast<std::uint8_t>(30 + 9 * row);
+      px[2] = static_cast<std::uint8_t>(250 - 3 * col - 2 * row);
+    }
+  }
+  return rgb;
+}
+
+TEST(RemapTable, IdentityWithoutDistortion)
+{
+  const auto src = gradient_image();
+  for (const std::size_t threads : { 0, 3 })
+  {
+    WorkerPool pool(threads);
+    const auto table = RemapTable::build(bouguet(0.0F), width, height, pool);
+    ASSERT_NE(table, nullptr);
+    EXPECT_EQ(table->width(), width);
+    EXPECT_EQ(table->height(), height);
+    EXPECT_FLOAT_EQ(table->pinhole().fx, 40.0F);
+    EXPECT_FLOAT_EQ(table->pinhole().fy, 42.0F);
+    EXPECT_FLOAT_EQ(table->pinhole().cx, 15.7F);
+    EXPECT_FLOAT_EQ(table->pinhole().cy, 11.4F);
+
+    std::vector<std::uint8_t> dst(src.size(), 1);
+    table->remap(src.data(), dst.data(), pool);
+    for (std::size_t i = 0; i < src.size(); ++i)
+    {
+      EXPECT_NEAR(dst[i], src[i], 1) << "byte " << i << ", " << threads << " threads";
+    }
+  }
+}
+
+TEST(RemapTable, MatchesABilinearReference)
+{
+  // pincushion distortion, the corners of the pinhole camera see outside
+  const auto distorted = bouguet(0.3F);
+  const auto src = gradient_image();
+  WorkerPool pool(2);
+  const auto table = RemapTable::build(distorted, width, height, pool);
+  ASSERT_NE(table, nullptr);
+  std::vector<std::uint8_t> dst(src.size());
+  table->remap(src.data(), dst.data(), pool);
+
+  const std::size_t n = static_cast<std::size_t>(width) * height;
+  std::vector<float> x(n), y(n), z(n, 1.0F), u(n), v(n);
+  const auto& pinhole = table->pinhole();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    x[i] = (static_cast<float>(i % width) - pinhole.cx) / pinhole.fx;
+    y[i] = (static_cast<float>(i / width) - pinhole.cy) / pinhole.fy;
+  }
+  ifm3d_ros2::project_points(distorted, x.data(), y.data(), z.data(), u.data(), v.data(), 0, n);
+
+  const double max_u = width - 1;
+  const double max_v = height - 1;
+  std::size_t black = 0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto* out = dst.data() + i * 3;
+    if (u[i] <= -0.5F || u[i] >= max_u + 0.5 || v[i] <= -0.5F || v[i] >= max_v + 0.5)
+    {
+      EXPECT_EQ(out[0] | out[1] | out[2], 0) << "pixel " << i;
+      ++black;
+      continue;
+    }
+
+    const double uc = std::min(std::max(static_cast<double>(u[i]), 0.0), max_u);
+    const double vc = std::min(std::max(static_cast<double>(v[i]), 0.0), max_v);
+    const auto x0 = static_cast<std::size_t>(std::min(uc, max_u - 1.0));
+    const auto y0 = static_cast<std::size_t>(std::min(vc, max_v - 1.0));
+    const double ax = uc - static_cast<double>(x0);
+    const double ay = vc - static_cast<double>(y0);
+    for (std::size_t c = 0; c < 3; ++c)
+    {
+      const auto at = [&](std::size_t col, std::size_t row) {
+        return static_cast<double>(src[(row * width + col) * 3 + c]);
+      };
+      const double top = at(x0, y0) * (1.0 - ax) + at(x0 + 1, y0) * ax;
+      const double bottom = at(x0, y0 + 1) * (1.0 - ax) + at(x0 + 1, y0 + 1) * ax;
+      // 8 bit weights
+      EXPECT_NEAR(out[c], top * (1.0 - ay) + bottom * ay, 1.5) << "pixel " << i << ", channel " << c;
+    }
+  }
+  EXPECT_GT(black, 0U);
+  EXPECT_LT(black, n / 4);
+}
+
+TEST(RemapTable, HashAndUnsupportedModels)
+{
+  WorkerPool pool(0);
+  const auto table = RemapTable::build(bouguet(0.1F), width, height, pool);
+  ASSERT_NE(table, nullptr);
+  EXPECT_EQ(table->hash(), ifm3d_ros2::calibration_hash(bouguet(0.1F), width, height));
+  EXPECT_NE(table->hash(), ifm3d_ros2::calibration_hash(bouguet(0.2F), width, height));
+  EXPECT_NE(table->hash(), ifm3d_ros2::calibration_hash(bouguet(0.1F), height, width));
+
+  EXPECT_EQ(RemapTable::build(model(1, { 40.0F, 42.0F, 16.0F, 12.0F }), width, height, pool), nullptr);
+  EXPECT_EQ(RemapTable::build(bouguet(0.0F), 1, height, pool), nullptr);
+  EXPECT_EQ(RemapTable::build(bouguet(0.0F), width, 1, pool), nullptr);
+}
+
+}  // namespace
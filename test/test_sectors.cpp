@@ -0,0 +1,156 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/sectors.hpp>
+
+namespace
+{
+using ifm3d_ros2::SectorReducer;
+
+constexpr float pi = 3.14159265F;
+const float inf = std::numeric_limits<float>::infinity();
+const float nan = std::numeric_limits<float>::quiet_NaN();
+
+TEST(FastAtan2, ErrorBound)
+{
+  // all around the circle, at several radii, and on the axes
+  double max_error = 0.0;
+  for (int i = 0; i < 3600; ++i)
+  {
+    const double angle = -M_PI + (i + 0.5) * 2.0 * M_PI / 3600.0;
+    for (const float radius : { 1e-3F, 1.0F, 250.0F })
+    {
+      const auto x = static_cast<float>(radius * std::cos(angle));
+      const auto y = static_cast<float>(radius * std::sin(angle));
+      max_error = std::max(max_error, std::fabs(static_cast<double>(ifm3d_ros2::fast_atan2(y, x)) - std::atan2(y, x)));
+    }
+  }
+  EXPECT_LT(max_error, 1e-5);
+
+  EXPECT_NEAR(ifm3d_ros2::fast_atan2(0.0F, 1.0F), 0.0F, 1e-5F);
+  EXPECT_NEAR(ifm3d_ros2::fast_atan2(1.0F, 0.0F), pi / 2, 1e-5F);
+  EXPECT_NEAR(ifm3d_ros2::fast_atan2(-1.0F, 0.0F), -pi / 2, 1e-5F);
+  EXPECT_NEAR(ifm3d_ros2::fast_atan2(1.0F, 1.0F), pi / 4, 1e-5F);
+  EXPECT_NEAR(std::fabs(ifm3d_ros2::fast_atan2(0.0F, -1.0F)), pi, 1e-5F);
+  // the origin has no direction, just no NaN
+  EXPECT_EQ(ifm3d_ros2::fast_atan2(0.0F, 0.0F), 0.0F);
+}
+
+SectorReducer::Params params()
+{
+  // 4 sectors of 22.5 degrees across the front, 2 bands: [0, 1), [1, 2) m
+  SectorReducer::Params result;
+  result.num_sectors = 4;
+  result.angle_min = -pi / 4;
+  result.angle_max = pi / 4;
+  result.band_limits = { 0.0F, 1.0F, 2.0F };
+  return result;
+}
+
+// a point at `range` and `angle`, `z` up
+void push(std::vector<float>& xyz, float range, float angle, float z)
+{
+  xyz.push_back(range * std::cos(angle));
+  xyz.push_back(range * std::sin(angle));
+  xyz.push_back(z);
+}
+
+TEST(SectorReducer, NearestPointPerBin)
+{
+  SectorReducer reducer;
+  reducer.configure(params());
+  EXPECT_EQ(reducer.num_bands(), 2U);
+
+  const float step = pi / 8;  // per sector
+  std::vector<float> xyz;
+  push(xyz, 3.0F, -0.1F, 0.5F);  // sector 1, band 0
+  push(xyz, 2.0F, -0.05F, 0.2F);
+  push(xyz, 4.0F, 0.1F, 0.5F);  // sector 2, band 0
+  push(xyz, 1.5F, 0.1F, 1.5F);  // sector 2, band 1
+  push(xyz, 5.0F, -pi / 4 + 0.01F, 1.0F);  // sector 0, band 1 (edges belong to the band above)
+  push(xyz, 6.0F, step + 0.01F, 1.99F);  // sector 3, band 1
+  // long enough for the vectorized loop and its remainder
+  for (int i = 0; i < 20; ++i)
+  {
+    push(xyz, 7.0F + static_cast<float>(i), step + 0.01F, 0.9F);  // sector 3, band 0
+  }
+
+  reducer.reduce(xyz.data(), xyz.size() / 3);
+  const auto& min_range = reducer.min_range();
+  const auto& count = reducer.point_count();
+  ASSERT_EQ(min_range.size(), 8U);
+  ASSERT_EQ(count.size(), 8U);
+
+  const std::vector<float> expected_range{ inf, 2.0F, 4.0F, 7.0F, 5.0F, inf, 1.5F, 6.0F };
+  const std::vector<std::uint32_t> expected_count{ 0, 2, 1, 20, 1, 0, 1, 1 };
+  for (std::size_t bin = 0; bin < 8; ++bin)
+  {
+    if (std::isinf(expected_range[bin]))
+    {
+      EXPECT_TRUE(std::isinf(min_range[bin])) << "bin " << bin;
+    }
+    else
+    {
+      EXPECT_NEAR(min_range[bin], expected_range[bin], 1e-5F) << "bin " << bin;
+    }
+  }
+  EXPECT_EQ(count, expected_count);
+}
+
+TEST(SectorReducer, IgnoresPointsOutside)
+{
+  SectorReducer reducer;
+  reducer.configure(params());
+
+  std::vector<float> xyz;
+  push(xyz, 1.0F, pi / 2, 0.5F);  // beside the sectors
+  push(xyz, 1.0F, -pi / 4 - 0.01F, 0.5F);
+  push(xyz, 1.0F, pi / 4 + 0.01F, 0.5F);
+  push(xyz, 1.0F, 0.0F, -0.1F);  // below the bands
+  push(xyz, 1.0F, 0.0F, 2.0F);  // above (the last edge closes the last band)
+  xyz.insert(xyz.end(), { 0.0F, 0.0F, 0.0F, nan, nan, nan, 1.0F, nan, 0.5F });  // invalid
+
+  reducer.reduce(xyz.data(), xyz.size() / 3);
+  for (std::size_t bin = 0; bin < reducer.point_count().size(); ++bin)
+  {
+    EXPECT_EQ(reducer.point_count()[bin], 0U) << "bin " << bin;
+    EXPECT_TRUE(std::isinf(reducer.min_range()[bin])) << "bin " << bin;
+  }
+}
+
+TEST(SectorReducer, NoBinsWithoutBandsOrAngles)
+{
+  SectorReducer reducer;
+  auto p = params();
+  p.band_limits = { 1.0F };
+  reducer.configure(p);
+  EXPECT_EQ(reducer.num_bands(), 0U);
+
+  std::vector<float> xyz;
+  push(xyz, 1.0F, 0.0F, 0.5F);
+  reducer.reduce(xyz.data(), 1);
+  EXPECT_TRUE(reducer.min_range().empty());
+  EXPECT_TRUE(reducer.point_count().empty());
+
+  p = params();
+  p.angle_max = p.angle_min;
+  reducer.configure(p);
+  reducer.reduce(xyz.data(), 1);
+  ASSERT_EQ(reducer.point_count().size(), 8U);
+  for (const auto count : reducer.point_count())
+  {
+    EXPECT_EQ(count, 0U);
+  }
+}
+
+}  // namespace
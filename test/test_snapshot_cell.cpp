@@ -0,0 +1,145 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/snapshot.hpp>
+
+namespace
+{
+using ifm3d_ros2::SnapshotCell;
+
+std::atomic<int> live_values{};
+
+/**
+ * Parameters whose fields must always be seen from the same write: every
+ * field is derived from `n`, and the string makes the copy non-trivial.
+ */
+struct Params
+{
+  Params() : Params(0)
+  {
+  }
+
+  explicit Params(int n) : a(n), b(2 * n), c(std::to_string(n))
+  {
+    ++live_values;
+  }
+
+  Params(const Params& other) : a(other.a), b(other.b), c(other.c)
+  {
+    ++live_values;
+  }
+
+  Params& operator=(const Params&) = default;
+
+  ~Params()
+  {
+    --live_values;
+  }
+
+  bool consistent() const
+  {
+    return b == 2 * a && c == std::to_string(a);
+  }
+
+  int a;
+  int b;
+  std::string c;
+};
+
+TEST(SnapshotCell, VersionsEveryWrite)
+{
+  SnapshotCell<Params> cell;
+  EXPECT_EQ(cell.pin().version, 1u);
+  EXPECT_EQ(cell.store(Params(5)), 2u);
+  EXPECT_EQ(cell.update([](Params& params) { params = Params(params.a + 1); }), 3u);
+
+  const auto& snapshot = cell.pin();
+  EXPECT_EQ(snapshot.version, 3u);
+  EXPECT_EQ(snapshot.value.a, 6);
+  EXPECT_TRUE(snapshot.value.consistent());
+  EXPECT_EQ(cell.copy().value.a, 6);
+}
+
+TEST(SnapshotCell, PinnedSnapshotOutlivesWrites)
+{
+  SnapshotCell<Params> cell(Params(1));
+  const auto& pinned = cell.pin();
+  for (int i = 2; i < 100; ++i)
+  {
+    cell.store(Params(i));
+  }
+  EXPECT_EQ(pinned.version, 1u);
+  EXPECT_EQ(pinned.value.a, 1);
+  EXPECT_TRUE(pinned.value.consistent());
+
+  EXPECT_EQ(cell.pin().value.a, 99);
+}
+
+TEST(SnapshotCell, ConsistentUnderConcurrentWrites)
+{
+  const int live_before = live_values;
+  {
+    SnapshotCell<Params> cell;
+    std::atomic_bool writing{ true };
+
+    // stops and joins the writers however the reader leaves, a failed
+    // assertion included
+    struct Writers
+    {
+      std::atomic_bool& writing;
+      std::vector<std::thread> threads;
+
+      ~Writers()
+      {
+        this->writing = false;
+        for (auto& thread : this->threads)
+        {
+          thread.join();
+        }
+      }
+    } writers{ writing, {} };
+
+    for (int t = 0; t < 4; ++t)
+    {
+      writers.threads.emplace_back([&cell, &writing] {
+        while (writing)
+        {
+          cell.update([](Params& params) { params = Params(params.a + 1); });
+        }
+      });
+    }
+
+    // the reader: one pin per "frame", never a mix of two writes, never going
+    // back in time
+    std::uint64_t last_version = 0;
+    int last_a = -1;
+    for (int frame = 0; frame < 200000; ++frame)
+    {
+      const auto& snapshot = cell.pin();
+      ASSERT_TRUE(snapshot.value.consistent()) << "version " << snapshot.version;
+      ASSERT_GE(snapshot.version, last_version);
+      ASSERT_GE(snapshot.value.a, last_a);
+      // every update adds one, starting from version 1 at 0
+      ASSERT_EQ(static_cast<std::uint64_t>(snapshot.value.a) + 1, snapshot.version);
+      last_version = snapshot.version;
+      last_a = snapshot.value.a;
+
+      // the replaced snapshots do not pile up
+      ASSERT_LE(live_values - live_before, 3 + 4 * 2);
+    }
+    cell.unpin();
+  }
+  EXPECT_EQ(live_values, live_before);
+}
+
+}  // namespace
@@ -0,0 +1,142 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/topic_schedule.hpp>
+
+namespace
+{
+using ifm3d_ros2::FrameTopic;
+using ifm3d_ros2::num_frame_topics;
+using ifm3d_ros2::TopicScheduler;
+
+using Order = std::array<FrameTopic, num_frame_topics>;
+
+std::array<double, num_frame_topics> no_deadlines()
+{
+  return {};
+}
+
+TEST(TopicSchedule, NamesRoundTrip)
+{
+  const auto names = ifm3d_ros2::frame_topic_names();
+  ASSERT_EQ(names.size(), num_frame_topics);
+  for (std::size_t i = 0; i < num_frame_topics; ++i)
+  {
+    FrameTopic topic;
+    ASSERT_TRUE(ifm3d_ros2::frame_topic_from_name(names[i], topic)) << names[i];
+    EXPECT_EQ(topic, static_cast<FrameTopic>(i));
+    EXPECT_EQ(ifm3d_ros2::frame_topic_name(topic), names[i]);
+  }
+
+  FrameTopic topic = FrameTopic::RGB;
+  EXPECT_FALSE(ifm3d_ros2::frame_topic_from_name("depth", topic));
+  EXPECT_FALSE(ifm3d_ros2::frame_topic_from_name("", topic));
+  EXPECT_EQ(topic, FrameTopic::RGB);
+}
+
+TEST(TopicScheduler, DefaultOrder)
+{
+  TopicScheduler scheduler;
+  const Order expected{ FrameTopic::CLOUD, FrameTopic::DISTANCE,       FrameTopic::CONFIDENCE,   FrameTopic::AMPLITUDE,
+                        FrameTopic::RGB,   FrameTopic::DISTANCE_NOISE, FrameTopic::RAW_AMPLITUDE };
+  EXPECT_EQ(scheduler.order(), expected);
+  for (const auto topic : scheduler.order())
+  {
+    EXPECT_EQ(scheduler.deadline(topic), 0.0);
+    EXPECT_TRUE(scheduler.admit(topic, 10.0));
+  }
+}
+
+TEST(TopicScheduler, LeftOutTopicsFollowInTheirDefaultOrder)
+{
+  TopicScheduler scheduler;
+  // duplicates count once, at their first position
+  scheduler.configure({ FrameTopic::RGB, FrameTopic::DISTANCE, FrameTopic::RGB }, no_deadlines());
+  const Order expected{ FrameTopic::RGB,        FrameTopic::DISTANCE,  FrameTopic::CLOUD,
+                        FrameTopic::CONFIDENCE, FrameTopic::AMPLITUDE, FrameTopic::DISTANCE_NOISE,
+                        FrameTopic::RAW_AMPLITUDE };
+  EXPECT_EQ(scheduler.order(), expected);
+
+  // unknown names never make it into the priorities
+  std::vector<FrameTopic> priorities;
+  for (const std::string name : { "raw_amplitude", "depth", "cloud" })
+  {
+    FrameTopic topic;
+    if (ifm3d_ros2::frame_topic_from_name(name, topic))
+    {
+      priorities.push_back(topic);
+    }
+  }
+  scheduler.configure(priorities, no_deadlines());
+  const Order reordered{ FrameTopic::RAW_AMPLITUDE, FrameTopic::CLOUD, FrameTopic::DISTANCE,
+                         FrameTopic::CONFIDENCE,    FrameTopic::AMPLITUDE, FrameTopic::RGB,
+                         FrameTopic::DISTANCE_NOISE };
+  EXPECT_EQ(scheduler.order(), reordered);
+}
+
+TEST(TopicScheduler, AdmitsWhatFitsIntoTheDeadline)
+{
+  TopicScheduler scheduler;
+  auto deadlines = no_deadlines();
+  deadlines[static_cast<std::size_t>(FrameTopic::CLOUD)] = 0.010;
+  scheduler.configure({}, deadlines);
+  EXPECT_EQ(scheduler.deadline(FrameTopic::CLOUD), 0.010);
+
+  // nothing known about the cost yet
+  EXPECT_TRUE(scheduler.admit(FrameTopic::CLOUD, 0.009));
+  scheduler.account(FrameTopic::CLOUD, 0.004);
+  EXPECT_DOUBLE_EQ(scheduler.expected_cost(FrameTopic::CLOUD), 0.004);
+
+  EXPECT_TRUE(scheduler.admit(FrameTopic::CLOUD, 0.006));
+  EXPECT_FALSE(scheduler.admit(FrameTopic::CLOUD, 0.0061));
+
+  // topics without a deadline always go out
+  scheduler.account(FrameTopic::RGB, 1.0);
+  EXPECT_TRUE(scheduler.admit(FrameTopic::RGB, 1.0));
+}
+
+TEST(TopicScheduler, ExpectedCostIsAMovingAverage)
+{
+  TopicScheduler scheduler;
+  scheduler.account(FrameTopic::DISTANCE, 0.002);
+  scheduler.account(FrameTopic::DISTANCE, 0.012);
+  EXPECT_NEAR(scheduler.expected_cost(FrameTopic::DISTANCE), 0.003, 1e-12);
+
+  // a new configuration forgets the costs
+  scheduler.configure({}, no_deadlines());
+  EXPECT_EQ(scheduler.expected_cost(FrameTopic::DISTANCE), 0.0);
+}
+
+TEST(TopicScheduler, SkippedTopicsAreTriedAgain)
+{
+  TopicScheduler scheduler;
+  auto deadlines = no_deadlines();
+  deadlines[static_cast<std::size_t>(FrameTopic::AMPLITUDE)] = 0.010;
+  scheduler.configure({}, deadlines);
+  scheduler.account(FrameTopic::AMPLITUDE, 0.008);
+
+  // each skip lowers the expected cost by 10 %, under the same load the
+  // topic gets its turn again after a few frames
+  int skipped = 0;
+  while (!scheduler.admit(FrameTopic::AMPLITUDE, 0.005))
+  {
+    ++skipped;
+    ASSERT_LT(skipped, 100);
+  }
+  EXPECT_EQ(skipped, 5);  // 0.008 * 0.9^5 = 0.0047
+  EXPECT_NEAR(scheduler.expected_cost(FrameTopic::AMPLITUDE), 0.008 * 0.59049, 1e-12);
+
+  // admitting leaves it as it is
+  EXPECT_TRUE(scheduler.admit(FrameTopic::AMPLITUDE, 0.005));
+  EXPECT_NEAR(scheduler.expected_cost(FrameTopic::AMPLITUDE), 0.008 * 0.59049, 1e-12);
+}
+
+}  // namespace
@@ -0,0 +1,407 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2019 ifm electronic, gmbh
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <ifm3d_ros2/transition_worker.hpp>
+#include <lifecycle_msgs/msg/state.hpp>
+
+namespace
+{
+using ifm3d_ros2::TransitionRequest;
+using ifm3d_ros2::TransitionTiming;
+using ifm3d_ros2::TransitionWorker;
+using namespace std::chrono_literals;
+
+/**
+ * Stand-in for a camera head and its lifecycle node: while active, a stream
+ * thread (the publish loop) delivers frames and faults every
+ * `frames_per_fault` frames, requesting its own deactivation like the
+ * publish loop does on a timeout. Deactivating joins the stream thread.
+ */
+class SimulatedHead
+{
+public:
+  enum class State
+  {
+    UNCONFIGURED,
+    INACTIVE,
+    ACTIVE,
+  };
+
+  explicit SimulatedHead(int frames_per_fault) : frames_per_fault_(frames_per_fault)
+  {
+  }
+
+  ~SimulatedHead()
+  {
+    this->stop_stream();
+  }
+
+  void attach(TransitionWorker* worker)
+  {
+    this->worker_ = worker;
+  }
+
+  void configure()
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->state_ = State::INACTIVE;
+  }
+
+  void activate()
+  {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    ASSERT_EQ(this->state_, State::INACTIVE);
+    this->state_ = State::ACTIVE;
+    this->streaming_ = true;
+    this->stream_ = std::thread(&SimulatedHead::stream, this);
+  }
+
+  // the handler of the worker
+  bool transition(TransitionRequest request)
+  {
+    const int concurrent = ++this->in_transition_;
+    this->max_concurrent_ = std::max(this->max_concurrent_.load(), concurrent);
+
+    bool ok = true;
+    State state;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      state = this->state_;
+    }
+    if (state == State::ACTIVE)
+    {
+      this->stop_stream();
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->state_ = State::INACTIVE;
+      ++this->deactivations_;
+    }
+    else if (state == State::INACTIVE && request == TransitionRequest::RECONFIGURE)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      this->state_ = State::UNCONFIGURED;
+    }
+    else
+    {
+      ok = state != State::UNCONFIGURED;
+    }
+
+    --this->in_transition_;
+    this->state_cv_.notify_all();
+    return ok;
+  }
+
+  bool wait_for(State state, std::chrono::milliseconds timeout)
+  {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    return this->state_cv_.wait_for(lock, timeout, [this, state] { return this->state_ == state; });
+  }
+
+  int deactivations() const
+  {
+    return this->deactivations_;
+  }
+
+  int max_concurrent() const
+  {
+    return this->max_concurrent_;
+  }
+
+private:
+  void stream()
+  {
+    int frames = 0;
+    while (this->streaming_)
+    {
+      std::this_thread::sleep_for(100us);
+      if (++frames % this->frames_per_fault_ == 0)
+      {
+        // a burst: the loop and the timeouts of its neighbours all report
+        for (int i = 0; i < 3; ++i)
+        {
+          this->worker_->request(TransitionRequest::DEACTIVATE);
+        }
+        return;
+      }
+    }
+  }
+
+  void stop_stream()
+  {
+    this->streaming_ = false;
+    if (this->stream_.joinable())
+    {
+      this->stream_.join();
+    }
+  }
+
+  const int frames_per_fault_;
+  TransitionWorker* worker_{};
+
+  std::mutex mutex_{};
+  std::condition_variable state_cv_{};
+  State state_{ State::UNCONFIGURED };
+  std::atomic_bool streaming_{};
+  std::thread stream_{};
+
+  std::atomic<int> in_transition_{};
+  std::atomic<int> max_concurrent_{};
+  std::atomic<int> deactivations_{};
+};
+
+struct Timings
+{
+  void observe(const TransitionTiming& timing)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->all.push_back(timing);
+  }
+
+  std::vector<TransitionTiming> snapshot()
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->all;
+  }
+
+  std::mutex mutex;
+  std::vector<TransitionTiming> all;
+};
+
+TEST(TransitionWorker, RecoversFromRepeatedFaults)
+{
+  constexpr int cycles = 200;
+
+  SimulatedHead head(20);
+  Timings timings;
+  TransitionWorker worker([&head](TransitionRequest request) { return head.transition(request); },
+                          [&timings](const TransitionTiming& timing) { timings.observe(timing); });
+  head.attach(&worker);
+
+  // the lifecycle manager: brings the head back up after every fault
+  head.configure();
+  for (int i = 0; i < cycles; ++i)
+  {
+    head.activate();
+    ASSERT_TRUE(head.wait_for(SimulatedHead::State::INACTIVE, 2s)) << "cycle " << i;
+    ASSERT_TRUE(worker.wait_idle(2s)) << "cycle " << i;
+  }
+
+  EXPECT_EQ(head.deactivations(), cycles);
+  EXPECT_EQ(head.max_concurrent(), 1);
+
+  // the bursts of faults coalesce: one deactivation each, the requests coming
+  // in while it runs find nothing left to do
+  const auto all = timings.snapshot();
+  ASSERT_GE(all.size(), static_cast<std::size_t>(cycles));
+  EXPECT_LE(all.size(), static_cast<std::size_t>(cycles) * 3);
+  std::uint64_t merged = 0;
+  for (const auto& timing : all)
+  {
+    EXPECT_EQ(timing.request, TransitionRequest::DEACTIVATE);
+    EXPECT_TRUE(timing.ok);
+    // loose bounds only, a loaded machine stretches them; the waits above
+    // already bound each cycle
+    EXPECT_GE(timing.wait_seconds, 0.0);
+    EXPECT_LT(timing.wait_seconds, 2.0);
+    EXPECT_GE(timing.run_seconds, 0.0);
+    EXPECT_LT(timing.run_seconds, 2.0);
+    merged += timing.coalesced;
+  }
+  EXPECT_EQ(all.size() + merged, static_cast<std::size_t>(cycles) * 3);
+}
+
+TEST(TransitionWorker, CoalescesQueuedRequests)
+{
+  std::mutex gate_mutex;
+  std::condition_variable gate_cv;
+  bool open = false;
+  std::atomic<int> started{};
+
+  Timings timings;
+  TransitionWorker worker(
+      [&](TransitionRequest /*request*/) {
+        ++started;
+        std::unique_lock<std::mutex> lock(gate_mutex);
+        gate_cv.wait(lock, [&open] { return open; });
+        return true;
+      },
+      [&timings](const TransitionTiming& timing) { timings.observe(timing); });
+
+  // one runs (and blocks), everything else piles up behind it
+  ASSERT_TRUE(worker.request(TransitionRequest::DEACTIVATE));
+  while (started == 0)
+  {
+    std::this_thread::yield();
+  }
+
+  constexpr int threads = 8;
+  constexpr int requests_per_thread = 1000;
+  std::atomic<int> queued{};
+  std::vector<std::thread> faulting;
+  for (int t = 0; t < threads; ++t)
+  {
+    faulting.emplace_back([&worker, &queued, t] {
+      for (int i = 0; i < requests_per_thread; ++i)
+      {
+        const auto request = (t + i) % 2 == 0 ? TransitionRequest::DEACTIVATE : TransitionRequest::RECONFIGURE;
+        queued += worker.request(request) ? 1 : 0;
+      }
+    });
+  }
+  for (auto& thread : faulting)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(queued, 2);
+
+  {
+    std::lock_guard<std::mutex> lock(gate_mutex);
+    open = true;
+  }
+  gate_cv.notify_all();
+  ASSERT_TRUE(worker.wait_idle(2s));
+
+  // in the order they came in, with all the others merged into them
+  const auto all = timings.snapshot();
+  ASSERT_EQ(all.size(), 3u);
+  EXPECT_EQ(all[0].coalesced, 0u);
+  EXPECT_EQ(all[1].coalesced + all[2].coalesced, static_cast<std::uint64_t>(threads * requests_per_thread - 2));
+  EXPECT_NE(all[1].request, all[2].request);
+}
+
+TEST(TransitionWorker, RequestsFromTheHandler)
+{
+  std::atomic<int> runs{};
+  TransitionWorker* self = nullptr;
+  TransitionWorker worker([&](TransitionRequest request) {
+    // e.g., a reconfiguration that deactivates first, then cleans up
+    if (++runs < 10)
+    {
+      self->request(request);
+    }
+    return true;
+  });
+  self = &worker;
+
+  worker.request(TransitionRequest::RECONFIGURE);
+  ASSERT_TRUE(worker.wait_idle(2s));
+  EXPECT_EQ(runs, 10);
+}
+
+TEST(TransitionWorker, FailedTransitionsDoNotStopTheWorker)
+{
+  Timings timings;
+  TransitionWorker worker(
+      [](TransitionRequest request) -> bool {
+        if (request == TransitionRequest::DEACTIVATE)
+        {
+          throw std::runtime_error("device unreachable");
+        }
+        return false;
+      },
+      [&timings](const TransitionTiming& timing) { timings.observe(timing); });
+
+  for (int i = 0; i < 10; ++i)
+  {
+    worker.request(TransitionRequest::DEACTIVATE);
+    ASSERT_TRUE(worker.wait_idle(2s));
+    worker.request(TransitionRequest::RECONFIGURE);
+    ASSERT_TRUE(worker.wait_idle(2s));
+  }
+
+  const auto all = timings.snapshot();
+  ASSERT_EQ(all.size(), 20u);
+  for (const auto& timing : all)
+  {
+    EXPECT_FALSE(timing.ok);
+  }
+}
+
+TEST(TransitionWorker, StopsAndJoinsUnderLoad)
+{
+  for (int round = 0; round < 20; ++round)
+  {
+    std::atomic_bool faulting{ true };
+    std::atomic<int> runs{};
+    auto worker = std::make_unique<TransitionWorker>([&runs](TransitionRequest /*request*/) {
+      ++runs;
+      std::this_thread::sleep_for(1ms);
+      return true;
+    });
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+      threads.emplace_back([&worker, &faulting, t] {
+        while (faulting)
+        {
+          worker->request(t % 2 == 0 ? TransitionRequest::DEACTIVATE : TransitionRequest::RECONFIGURE);
+        }
+      });
+    }
+    std::this_thread::sleep_for(5ms);
+
+    // shutdown: nothing queued runs any more, the running one finishes
+    worker->stop();
+    const int after_stop = runs;
+    EXPECT_FALSE(worker->request(TransitionRequest::DEACTIVATE));
+
+    faulting = false;
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+
+    const auto t_start = std::chrono::steady_clock::now();
+    worker.reset();
+    EXPECT_LT(std::chrono::steady_clock::now() - t_start, 2s);  // a hang rather than a slow machine
+    EXPECT_LE(runs - after_stop, 1);
+  }
+}
+
+TEST(TransitionStep, OnlyFromTheStatesTheRequestAppliesTo)
+{
+  using ifm3d_ros2::transition_step;
+  using ifm3d_ros2::TransitionStep;
+  using lifecycle_msgs::msg::State;
+
+  EXPECT_EQ(transition_step(TransitionRequest::DEACTIVATE, State::PRIMARY_STATE_ACTIVE), TransitionStep::DEACTIVATE);
+  // another deactivation got ahead of it
+  EXPECT_EQ(transition_step(TransitionRequest::DEACTIVATE, State::PRIMARY_STATE_INACTIVE), TransitionStep::NONE);
+  EXPECT_EQ(transition_step(TransitionRequest::DEACTIVATE, State::PRIMARY_STATE_UNCONFIGURED), TransitionStep::NONE);
+
+  // reconfiguring an active node deactivates it, an inactive one is cleaned
+  // up
+  EXPECT_EQ(transition_step(TransitionRequest::RECONFIGURE, State::PRIMARY_STATE_ACTIVE), TransitionStep::DEACTIVATE);
+  EXPECT_EQ(transition_step(TransitionRequest::RECONFIGURE, State::PRIMARY_STATE_INACTIVE), TransitionStep::CLEANUP);
+  EXPECT_EQ(transition_step(TransitionRequest::RECONFIGURE, State::PRIMARY_STATE_UNCONFIGURED), TransitionStep::NONE);
+
+  // nothing while finalized, unknown or in the middle of a transition
+  for (const auto request : { TransitionRequest::DEACTIVATE, TransitionRequest::RECONFIGURE })
+  {
+    for (const auto state : { State::PRIMARY_STATE_UNKNOWN, State::PRIMARY_STATE_FINALIZED,
+                              State::TRANSITION_STATE_CONFIGURING, State::TRANSITION_STATE_CLEANINGUP,
+                              State::TRANSITION_STATE_SHUTTINGDOWN, State::TRANSITION_STATE_ACTIVATING,
+                              State::TRANSITION_STATE_DEACTIVATING, State::TRANSITION_STATE_ERRORPROCESSING })
+    {
+      EXPECT_EQ(transition_step(request, state), TransitionStep::NONE)
+          << ifm3d_ros2::transition_request_name(request) << " from state id " << static_cast<int>(state);
+    }
+  }
+}
+
+}  // namespace